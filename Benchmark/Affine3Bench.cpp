@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+#include "Math/Matrix4.h"
+#include "Math/Affine3.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t AFFINE_SET_SIZE = 1024;
+
+struct TRSSet
+{
+    std::vector<Mat4> mat4s;
+    std::vector<Affine3> affines;
+};
+
+static const TRSSet& GetTRSSet()
+{
+    static TRSSet s_set;
+    if (s_set.mat4s.empty())
+    {
+        Random::getThreadLocal().seed(1);
+        for (size_t i = 0; i < AFFINE_SET_SIZE; ++i)
+        {
+            Vec3 pos(RandomUnitization() * 100.0f, RandomUnitization() * 100.0f, RandomUnitization() * 100.0f);
+            Vec3 scl(0.5f + RandomUnitization(), 0.5f + RandomUnitization(), 0.5f + RandomUnitization());
+            Quat rot(RandomUnitization() * TWO_PI, Vec3(RandomUnitization() - 0.5f, RandomUnitization() - 0.5f, RandomUnitization() - 0.5f));
+            s_set.mat4s.push_back(Mat4::transform(pos, scl, rot));
+            s_set.affines.push_back(Affine3::transform(pos, scl, rot));
+        }
+    }
+    return s_set;
+}
+
+CN_BENCHMARK(Affine3, Mat4Multiply)
+{
+    const std::vector<Mat4> &set = GetTRSSet().mat4s;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4 r = set[i % AFFINE_SET_SIZE] * set[(i + 1) % AFFINE_SET_SIZE];
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Affine3, Multiply)
+{
+    const std::vector<Affine3> &set = GetTRSSet().affines;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Affine3 r = set[i % AFFINE_SET_SIZE] * set[(i + 1) % AFFINE_SET_SIZE];
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Affine3, Mat4Inverse)
+{
+    const std::vector<Mat4> &set = GetTRSSet().mat4s;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4 r = set[i % AFFINE_SET_SIZE];
+        r.inverse();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Affine3, Inverse)
+{
+    const std::vector<Affine3> &set = GetTRSSet().affines;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Affine3 r = set[i % AFFINE_SET_SIZE];
+        r.inverse();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Affine3, InverseTRS)
+{
+    const std::vector<Affine3> &set = GetTRSSet().affines;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Affine3 r = set[i % AFFINE_SET_SIZE];
+        r.inverseTRS();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Affine3, Mat4TransformPoint)
+{
+    const std::vector<Mat4> &set = GetTRSSet().mat4s;
+    Vec3 v(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = set[i % AFFINE_SET_SIZE] * v;
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Affine3, TransformPoint)
+{
+    const std::vector<Affine3> &set = GetTRSSet().affines;
+    Vec3 v(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = set[i % AFFINE_SET_SIZE] * v;
+        DoNotOptimize(r);
+    }
+}
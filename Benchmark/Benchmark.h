@@ -0,0 +1,65 @@
+#ifndef _CN_BENCHMARK_
+#define _CN_BENCHMARK_
+#include "Prerequisites.h"
+#include <functional>
+
+namespace Canaan
+{
+    class BenchState
+    {
+    public:
+
+        BenchState(size_t iterations)
+            : m_iterations(iterations)
+        {
+        }
+
+        size_t iterations() const { return m_iterations; }
+
+        // number of elements processed per iteration, for bulk kernels
+        void setItemsPerIteration(size_t items) { m_itemsPerIteration = items; }
+        size_t getItemsPerIteration() const { return m_itemsPerIteration; }
+
+    private:
+
+        size_t m_iterations;
+        size_t m_itemsPerIteration = 1;
+    };
+
+    typedef void (*BenchFunc)(BenchState &state);
+
+    struct BenchCase
+    {
+        std::string group;
+        std::string name;
+        BenchFunc   func;
+    };
+
+    std::vector<BenchCase>& GetBenchCases();
+
+    struct BenchRegistrar
+    {
+        BenchRegistrar(const char *group, const char *name, BenchFunc func)
+        {
+            GetBenchCases().push_back({ group, name, func });
+        }
+    };
+
+    // keeps the optimizer from discarding a result that is otherwise unused
+    template<typename T> inline void DoNotOptimize(const T &value)
+    {
+    #if defined(_MSC_VER)
+        static volatile const void *s_sink;
+        s_sink = &value;
+    #else
+        asm volatile("" : : "r"(&value) : "memory");
+    #endif
+    }
+}
+
+#define CN_BENCHMARK(_GROUP, _NAME) \
+    static void _GROUP##_##_NAME(Canaan::BenchState &state); \
+    static Canaan::BenchRegistrar _GROUP##_##_NAME##_registrar(#_GROUP, #_NAME, _GROUP##_##_NAME); \
+    static void _GROUP##_##_NAME(Canaan::BenchState &state)
+
+#endif
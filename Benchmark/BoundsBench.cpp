@@ -0,0 +1,258 @@
+#include "Benchmark.h"
+#include "Math/Frustum.h"
+#include "Math/Ray.h"
+#include "Math/AABBStream.h"
+#include "Math/SphereStream.h"
+#include "Math/Bounds.h"
+#include "Math/Matrix4.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t BOUNDS_COUNT = 1000000;
+
+struct BoundsSet
+{
+    AABBArray boxes;
+    SphereArray spheres;
+    AABBStream boxStream;
+    SphereStream sphereStream;
+};
+
+// boxes and spheres scattered over a 1km cube, roughly a sixth of them in view
+static const BoundsSet& GetBoundsSet()
+{
+    static BoundsSet s_set;
+    if (s_set.boxes.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(9);
+        for (size_t i = 0; i < BOUNDS_COUNT; ++i)
+        {
+            Vec3 center(random.nextRange(-500.0f, 500.0f), random.nextRange(-500.0f, 500.0f), random.nextRange(-500.0f, 500.0f));
+            Vec3 extents(random.nextRange(0.1f, 4.0f), random.nextRange(0.1f, 4.0f), random.nextRange(0.1f, 4.0f));
+            s_set.boxes.push_back(AABB(center - extents, center + extents));
+            s_set.spheres.push_back(Sphere(center, extents.length()));
+        }
+        s_set.boxStream.fromArray(s_set.boxes);
+        s_set.sphereStream.fromArray(s_set.spheres);
+    }
+    return s_set;
+}
+
+static Frustum GetFrustum()
+{
+    Mat4 view = Mat4::lookAt(Vec3(0.0f, 20.0f, 50.0f), Vec3::ZERO, Vec3::UNIT_Y);
+    view.inverse();
+    return Frustum(Mat4::perspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f) * view);
+}
+
+static const Ray BENCH_RAY(Vec3(-500.0f, 1.0f, 2.0f), Vec3(1.0f, 0.002f, -0.001f));
+
+CN_BENCHMARK(Bounds, FrustumAABB)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Frustum frustum = GetFrustum();
+    std::vector<uint8_t> visible(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t b = 0; b < BOUNDS_COUNT; ++b)
+            visible[b] = frustum.intersects(set.boxes[b]);
+        DoNotOptimize(visible[0]);
+    }
+}
+
+CN_BENCHMARK(Bounds, FrustumAABBStream)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Frustum frustum = GetFrustum();
+    std::vector<uint8_t> visible(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t count = frustum.intersects(set.boxStream, visible.data());
+        DoNotOptimize(count);
+    }
+}
+
+CN_BENCHMARK(Bounds, FrustumSphere)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Frustum frustum = GetFrustum();
+    std::vector<uint8_t> visible(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t b = 0; b < BOUNDS_COUNT; ++b)
+            visible[b] = frustum.intersects(set.spheres[b]);
+        DoNotOptimize(visible[0]);
+    }
+}
+
+CN_BENCHMARK(Bounds, FrustumSphereStream)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Frustum frustum = GetFrustum();
+    std::vector<uint8_t> visible(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t count = frustum.intersects(set.sphereStream, visible.data());
+        DoNotOptimize(count);
+    }
+}
+
+CN_BENCHMARK(Bounds, RayAABB)
+{
+    const BoundsSet &set = GetBoundsSet();
+    std::vector<uint8_t> hits(BOUNDS_COUNT);
+    std::vector<Real> distances(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t b = 0; b < BOUNDS_COUNT; ++b)
+            hits[b] = BENCH_RAY.intersects(set.boxes[b], &distances[b]);
+        DoNotOptimize(hits[0]);
+    }
+}
+
+CN_BENCHMARK(Bounds, RayAABBStream)
+{
+    const BoundsSet &set = GetBoundsSet();
+    std::vector<uint8_t> hits(BOUNDS_COUNT);
+    std::vector<Real> distances(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t count = BENCH_RAY.intersects(set.boxStream, hits.data(), distances.data());
+        DoNotOptimize(count);
+    }
+}
+
+CN_BENCHMARK(Bounds, RaySphereStream)
+{
+    const BoundsSet &set = GetBoundsSet();
+    std::vector<uint8_t> hits(BOUNDS_COUNT);
+    std::vector<Real> distances(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t count = BENCH_RAY.intersects(set.sphereStream, hits.data(), distances.data());
+        DoNotOptimize(count);
+    }
+}
+
+static Mat4 GetBoundsTransform()
+{
+    return Mat4::transform(Vec3(10.0f, -5.0f, 3.0f), Vec3(1.5f, 0.5f, 2.0f), Quat(0.7f, Vec3(0.6f, 0.6f, 0.52915f)));
+}
+
+// the naive transform: all eight corners through the matrix
+CN_BENCHMARK(Bounds, TransformAABBCorners)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Mat4 mat = GetBoundsTransform();
+    AABBArray out(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t b = 0; b < BOUNDS_COUNT; ++b)
+        {
+            AABB box = AABB::EMPTY;
+            for (size_t c = 0; c < 8; ++c)
+                box.merge(mat * set.boxes[b].getCorner(c));
+            out[b] = box;
+        }
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Bounds, TransformAABBArvo)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Mat4 mat = GetBoundsTransform();
+    AABBArray out(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t b = 0; b < BOUNDS_COUNT; ++b)
+        {
+            out[b] = set.boxes[b];
+            out[b].transform(mat);
+        }
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Bounds, TransformAABBStream)
+{
+    const BoundsSet &set = GetBoundsSet();
+    Mat4 mat = GetBoundsTransform();
+    AABBStream out(BOUNDS_COUNT);
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        set.boxStream.transform(mat, out);
+        DoNotOptimize(out.minX()[0]);
+    }
+}
+
+// a 1M point cloud, the bounds of a large scanned mesh
+static const Vec3Array& GetPointCloud()
+{
+    static Vec3Array s_points;
+    if (s_points.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(20);
+        s_points.resize(BOUNDS_COUNT);
+        random.fillRange(-50.0f, 50.0f, &s_points[0].x, BOUNDS_COUNT * 3);
+    }
+    return s_points;
+}
+
+CN_BENCHMARK(Bounds, PointsAABBLoop)
+{
+    const Vec3Array &points = GetPointCloud();
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        AABB box = AABB::EMPTY;
+        for (const Vec3 &point : points)
+            box.merge(point);
+        DoNotOptimize(box);
+    }
+}
+
+CN_BENCHMARK(Bounds, PointsAABB)
+{
+    const Vec3Array &points = GetPointCloud();
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        DoNotOptimize(Bounds::computeAABB(points.data(), points.size()));
+}
+
+CN_BENCHMARK(Bounds, PointsSphere)
+{
+    const Vec3Array &points = GetPointCloud();
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        DoNotOptimize(Bounds::computeSphere(points.data(), points.size()));
+}
+
+CN_BENCHMARK(Bounds, PointsOBB)
+{
+    const Vec3Array &points = GetPointCloud();
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        DoNotOptimize(Bounds::computeOBB(points.data(), points.size()));
+}
+
+CN_BENCHMARK(Bounds, MergeAABB)
+{
+    const BoundsSet &set = GetBoundsSet();
+    state.setItemsPerIteration(BOUNDS_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        DoNotOptimize(Bounds::merge(set.boxes.data(), set.boxes.size()));
+}
@@ -0,0 +1,60 @@
+#include "Benchmark.h"
+#include "Math/Matrix3.h"
+#include "Math/Matrix4.h"
+#include <algorithm>
+
+using namespace Canaan;
+
+// Copies and value-passing of the math types. With trivially copyable
+// types std::copy lowers to memmove and temporaries stay in registers.
+
+static const size_t COPY_SET_SIZE = 4096;
+
+template<typename T> static void CopyArray(BenchState &state, const T &value)
+{
+    std::vector<T> src(COPY_SET_SIZE, value);
+    std::vector<T> dst(COPY_SET_SIZE, value);
+    state.setItemsPerIteration(COPY_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        std::copy(src.begin(), src.end(), dst.begin());
+        DoNotOptimize(dst[0]);
+    }
+}
+
+CN_BENCHMARK(Copy, Vec3Array)
+{
+    CopyArray(state, Vec3(1.0f, 2.0f, 3.0f));
+}
+
+CN_BENCHMARK(Copy, QuatArray)
+{
+    CopyArray(state, Quat(0.5f, 0.5f, 0.5f, 0.5f));
+}
+
+CN_BENCHMARK(Copy, Mat3Array)
+{
+    CopyArray(state, Mat3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+CN_BENCHMARK(Copy, Mat4Array)
+{
+    CopyArray(state, Mat4::transform(Vec3(1.0f, 2.0f, 3.0f), Vec3::UNIT_SCALE, Quat::IDENTITY));
+}
+
+CN_BENCHMARK(Copy, Vec3Expression)
+{
+    // builds and copies several Vec3 temporaries per iteration
+    Vec3Array points(COPY_SET_SIZE, Vec3(1.0f, 2.0f, 3.0f));
+    state.setItemsPerIteration(COPY_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 acc(0.0f);
+        for (size_t k = 0; k < COPY_SET_SIZE; ++k)
+        {
+            Vec3 p = points[k];
+            acc += (p - Vec3(0.5f)) * Vec3(2.0f, 1.0f, 0.5f) + Vec3(0.0f, 1.0f, 0.0f);
+        }
+        DoNotOptimize(acc);
+    }
+}
@@ -0,0 +1,201 @@
+#include "Benchmark.h"
+#include "Math/Mathematics.h"
+#include "Math/Quaternion.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t FAST_SET_SIZE = 4096;
+
+static const std::vector<Real>& GetAngleSet()
+{
+    static std::vector<Real> s_set;
+    if (s_set.empty())
+    {
+        Random::getThreadLocal().seed(1);
+        for (size_t i = 0; i < FAST_SET_SIZE; ++i)
+            s_set.push_back((RandomUnitization() - 0.5f) * 4.0f * TWO_PI);
+    }
+    return s_set;
+}
+
+static const std::vector<Quat>& GetQuatSet()
+{
+    static std::vector<Quat> s_set;
+    if (s_set.empty())
+    {
+        Random::getThreadLocal().seed(2);
+        for (size_t i = 0; i < FAST_SET_SIZE; ++i)
+            s_set.push_back(Quat(RandomUnitization() * TWO_PI, Vec3(RandomUnitization() - 0.5f, RandomUnitization() - 0.5f, RandomUnitization() - 0.5f)));
+    }
+    return s_set;
+}
+
+CN_BENCHMARK(FastMath, SinCosLibm)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> s(FAST_SET_SIZE), c(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < FAST_SET_SIZE; ++k)
+        {
+            s[k] = sin(angles[k]);
+            c[k] = cos(angles[k]);
+        }
+        DoNotOptimize(s[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, SinCosFast)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> s(FAST_SET_SIZE), c(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < FAST_SET_SIZE; ++k)
+            FastSinCos(angles[k], s[k], c[k]);
+        DoNotOptimize(s[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, SinCosFastBatch)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> s(FAST_SET_SIZE), c(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        FastSinCos(angles.data(), s.data(), c.data(), FAST_SET_SIZE);
+        DoNotOptimize(s[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, Atan2Libm)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> r(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < FAST_SET_SIZE; ++k)
+            r[k] = atan2(angles[k], angles[FAST_SET_SIZE - 1 - k]);
+        DoNotOptimize(r[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, Atan2Fast)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> r(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < FAST_SET_SIZE; ++k)
+            r[k] = FastAtan2(angles[k], angles[FAST_SET_SIZE - 1 - k]);
+        DoNotOptimize(r[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, Atan2FastBatch)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> x(angles.rbegin(), angles.rend());
+    std::vector<Real> r(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        FastAtan2(angles.data(), x.data(), r.data(), FAST_SET_SIZE);
+        DoNotOptimize(r[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, InvSqrtLibm)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> r(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < FAST_SET_SIZE; ++k)
+            r[k] = 1.0f / sqrt(angles[k] * angles[k] + 1.0f);
+        DoNotOptimize(r[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, InvSqrtFast)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    std::vector<Real> r(FAST_SET_SIZE);
+    state.setItemsPerIteration(FAST_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < FAST_SET_SIZE; ++k)
+            r[k] = FastInvSqrt(angles[k] * angles[k] + 1.0f);
+        DoNotOptimize(r[0]);
+    }
+}
+
+CN_BENCHMARK(FastMath, QuatSlerp)
+{
+    const std::vector<Quat> &quats = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = Quat::slerp(0.3f, quats[i % FAST_SET_SIZE], quats[(i + 1) % FAST_SET_SIZE], true);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(FastMath, QuatSlerpFast)
+{
+    const std::vector<Quat> &quats = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = Quat::slerpFast(0.3f, quats[i % FAST_SET_SIZE], quats[(i + 1) % FAST_SET_SIZE], true);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(FastMath, QuatSetAngleAxis)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    Vec3 axis(0.3f, 0.5f, 0.8f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r(angles[i % FAST_SET_SIZE], axis);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(FastMath, QuatSetAngleAxisFast)
+{
+    const std::vector<Real> &angles = GetAngleSet();
+    Vec3 axis(0.3f, 0.5f, 0.8f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r;
+        r.setFast(angles[i % FAST_SET_SIZE], axis);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(FastMath, Vec3RandomDeviat)
+{
+    Vec3 dir(0.0f, 1.0f, 0.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = dir.randomDeviat(0.2f);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(FastMath, Vec3RandomDeviatFast)
+{
+    Vec3 dir(0.0f, 1.0f, 0.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = dir.randomDeviatFast(0.2f);
+        DoNotOptimize(r);
+    }
+}
@@ -0,0 +1,268 @@
+#include "Benchmark.h"
+#include "Math/Random.h"
+#include "Scene/SceneObject.h"
+#include "Scene/Transform.h"
+
+using namespace Canaan;
+
+static const size_t HIERARCHY_NODE_COUNT = 100000;
+static const size_t HIERARCHY_BRANCHING = 4;
+
+// a complete 4-ary tree in breadth first order, node 0 is the root
+struct Hierarchy
+{
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    std::vector<Transform*> transforms;
+};
+
+static Hierarchy& GetHierarchy()
+{
+    static Hierarchy s_hierarchy;
+    if (s_hierarchy.objects.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(21);
+        for (size_t i = 0; i < HIERARCHY_NODE_COUNT; ++i)
+        {
+            std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+            Transform *transform = object->getTransform();
+            transform->setLocalPosition(random.nextUnitVector() * 2.0f);
+            transform->setLocalOrientation(Quat(random.nextRange(0.0f, TWO_PI), random.nextUnitVector()));
+            if (i > 0)
+                s_hierarchy.objects[(i - 1) / HIERARCHY_BRANCHING]->addChild(object);
+            s_hierarchy.objects.push_back(object);
+            s_hierarchy.transforms.push_back(transform);
+        }
+    }
+    return s_hierarchy;
+}
+
+static void ReadWorldAffines(Hierarchy &hierarchy)
+{
+    for (Transform *transform : hierarchy.transforms)
+        DoNotOptimize(transform->getWorldAffine());
+}
+
+// reading every world matrix of a scene where nothing moved
+CN_BENCHMARK(Hierarchy, ReadClean)
+{
+    Hierarchy &hierarchy = GetHierarchy();
+    ReadWorldAffines(hierarchy);
+    state.setItemsPerIteration(HIERARCHY_NODE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        ReadWorldAffines(hierarchy);
+}
+
+// one leaf moved, only its own matrices are recomputed
+CN_BENCHMARK(Hierarchy, ReadAfterLeafMove)
+{
+    Hierarchy &hierarchy = GetHierarchy();
+    Transform *leaf = hierarchy.transforms.back();
+    state.setItemsPerIteration(HIERARCHY_NODE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        leaf->setLocalPosition(Vec3(Real(i & 7), 0.0f, 0.0f));
+        ReadWorldAffines(hierarchy);
+    }
+}
+
+// the root moved, every world matrix is recomputed once
+CN_BENCHMARK(Hierarchy, ReadAfterRootMove)
+{
+    Hierarchy &hierarchy = GetHierarchy();
+    Transform *root = hierarchy.transforms.front();
+    state.setItemsPerIteration(HIERARCHY_NODE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        root->setLocalPosition(Vec3(Real(i & 7), 0.0f, 0.0f));
+        ReadWorldAffines(hierarchy);
+    }
+}
+
+// world position, orientation and scale of every transform of a still scene,
+// read from the caches kept with the world matrices
+CN_BENCHMARK(Hierarchy, ReadWorldTRS)
+{
+    Hierarchy &hierarchy = GetHierarchy();
+    state.setItemsPerIteration(HIERARCHY_NODE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (Transform *transform : hierarchy.transforms)
+        {
+            DoNotOptimize(transform->getWorldPosition());
+            DoNotOptimize(transform->getWorldOrientation());
+            DoNotOptimize(transform->getWorldScale());
+        }
+    }
+}
+
+// the same values composed by walking up the parents on every read, as the
+// getters did before the caches
+CN_BENCHMARK(Hierarchy, ReadWorldTRSRecursive)
+{
+    Hierarchy &hierarchy = GetHierarchy();
+    state.setItemsPerIteration(HIERARCHY_NODE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (const std::shared_ptr<SceneObject> &object : hierarchy.objects)
+        {
+            Transform *transform = object->getTransform();
+            SceneObject *parent = object->getParent();
+            Vec3 position = transform->getLocalAffine().getTranslation();
+            if (parent)
+                position = parent->getTransform()->getWorldAffine() * position;
+            Quat orientation = transform->getLocalOrientation();
+            Vec3 scale = transform->getLocalScale();
+            for (; parent; parent = parent->getParent())
+            {
+                orientation = parent->getTransform()->getLocalOrientation() * orientation;
+                scale = parent->getTransform()->getLocalScale() * scale;
+            }
+            DoNotOptimize(position);
+            DoNotOptimize(orientation);
+            DoNotOptimize(scale);
+        }
+    }
+}
+
+// the layout before TransformStore: one heap node per transform holding its
+// TRS, matrices and links, world matrices read lazily through the parent pointer
+struct LegacyNode
+{
+    Vec3 position;
+    Quat orientation;
+    Vec3 scale = Vec3::UNIT_SCALE;
+    Affine3 localMat;
+    Affine3 worldMat;
+    LegacyNode *parent = nullptr;
+    std::vector<LegacyNode*> children;
+    int dirtyFlag = 3;
+
+    const Affine3& getLocalAffine()
+    {
+        if (dirtyFlag & 1)
+        {
+            localMat = Affine3::transform(position, scale, orientation);
+            dirtyFlag &= ~1;
+        }
+        return localMat;
+    }
+
+    const Affine3& getWorldAffine()
+    {
+        if (dirtyFlag & 2)
+        {
+            worldMat = parent ? parent->getWorldAffine() * getLocalAffine() : getLocalAffine();
+            dirtyFlag &= ~2;
+        }
+        return worldMat;
+    }
+
+    void markWorldDirty()
+    {
+        if (dirtyFlag & 2)
+            return;
+        dirtyFlag |= 2;
+        for (LegacyNode *child : children)
+            child->markWorldDirty();
+    }
+};
+
+// the same 4-ary tree twice, as legacy nodes and in a TransformStore of its own
+struct FlatHierarchy
+{
+    std::vector<std::unique_ptr<LegacyNode>> nodes;
+    TransformStore store;
+    std::vector<std::unique_ptr<Transform>> transforms;
+};
+
+static FlatHierarchy* CreateFlatHierarchy(size_t count)
+{
+    FlatHierarchy *hierarchy = new FlatHierarchy();
+    Random &random = Random::getThreadLocal();
+    random.seed(22);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vec3 position = random.nextUnitVector() * 2.0f;
+        Quat orientation(random.nextRange(0.0f, TWO_PI), random.nextUnitVector());
+
+        LegacyNode *node = new LegacyNode();
+        node->position = position;
+        node->orientation = orientation;
+        if (i > 0)
+        {
+            node->parent = hierarchy->nodes[(i - 1) / HIERARCHY_BRANCHING].get();
+            node->parent->children.push_back(node);
+        }
+        hierarchy->nodes.emplace_back(node);
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        Transform *transform = new Transform(hierarchy->store);
+        transform->setLocalPosition(hierarchy->nodes[i]->position);
+        transform->setLocalOrientation(hierarchy->nodes[i]->orientation);
+        if (i > 0)
+            hierarchy->store.setParent(transform->getId(), hierarchy->transforms[(i - 1) / HIERARCHY_BRANCHING]->getId());
+        hierarchy->transforms.emplace_back(transform);
+    }
+    return hierarchy;
+}
+
+static FlatHierarchy& GetFlatHierarchy100k()
+{
+    static FlatHierarchy *s_hierarchy = CreateFlatHierarchy(100000);
+    return *s_hierarchy;
+}
+
+static FlatHierarchy& GetFlatHierarchy1M()
+{
+    static FlatHierarchy *s_hierarchy = CreateFlatHierarchy(1000000);
+    return *s_hierarchy;
+}
+
+// the root moved, every world matrix is brought up to date
+static void UpdateLegacy(BenchState &state, FlatHierarchy &hierarchy)
+{
+    LegacyNode *root = hierarchy.nodes.front().get();
+    state.setItemsPerIteration(hierarchy.nodes.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        root->position = Vec3(Real(i & 7), 0.0f, 0.0f);
+        root->dirtyFlag |= 1;
+        root->markWorldDirty();
+        for (auto &node : hierarchy.nodes)
+            DoNotOptimize(node->getWorldAffine());
+    }
+}
+
+static void UpdateStore(BenchState &state, FlatHierarchy &hierarchy)
+{
+    Transform *root = hierarchy.transforms.front().get();
+    state.setItemsPerIteration(hierarchy.transforms.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        root->setLocalPosition(Vec3(Real(i & 7), 0.0f, 0.0f));
+        hierarchy.store.updateWorldMatrices();
+        DoNotOptimize(hierarchy.store.getWorldAffines()[0]);
+    }
+}
+
+CN_BENCHMARK(Hierarchy, UpdateLegacy100k)
+{
+    UpdateLegacy(state, GetFlatHierarchy100k());
+}
+
+CN_BENCHMARK(Hierarchy, UpdateStore100k)
+{
+    UpdateStore(state, GetFlatHierarchy100k());
+}
+
+CN_BENCHMARK(Hierarchy, UpdateLegacy1M)
+{
+    UpdateLegacy(state, GetFlatHierarchy1M());
+}
+
+CN_BENCHMARK(Hierarchy, UpdateStore1M)
+{
+    UpdateStore(state, GetFlatHierarchy1M());
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+#include "Math/IK.h"
+#include "Math/Random.h"
+#include "Scene/SceneObject.h"
+#include "Scene/Transform.h"
+
+using namespace Canaan;
+
+static const size_t IK_CHAIN_COUNT = 1000;
+
+// IK_CHAIN_COUNT chains of count joints with their world poses packed, each
+// chain under its own rotated parent
+struct IKRig
+{
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    std::vector<Transform*> joints;
+    IKChainArray chains;
+    Vec3Array positions;
+    QuatArray orientations;
+};
+
+static IKRig* CreateRig(uint32_t count)
+{
+    IKRig *rig = new IKRig();
+    Random &random = Random::getThreadLocal();
+    random.seed(20 + count);
+    for (size_t c = 0; c < IK_CHAIN_COUNT; ++c)
+    {
+        IKChain chain;
+        chain.first = uint32_t(rig->joints.size());
+        chain.count = count;
+        std::shared_ptr<SceneObject> parent = std::make_shared<SceneObject>();
+        parent->getTransform()->setLocalPosition(random.nextUnitVector() * 10.0f);
+        parent->getTransform()->setLocalOrientation(Quat(random.nextRange(0.0f, TWO_PI), random.nextUnitVector()));
+        rig->objects.push_back(parent);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            std::shared_ptr<SceneObject> joint = std::make_shared<SceneObject>();
+            rig->objects.back()->addChild(joint);
+            joint->getTransform()->setLocalPosition(j == 0 ? Vec3::ZERO : Vec3::UNIT_Y + random.nextUnitVector() * 0.3f);
+            joint->getTransform()->setLocalOrientation(Quat(random.nextRange(0.0f, 1.0f), random.nextUnitVector()));
+            rig->objects.push_back(joint);
+            rig->joints.push_back(joint->getTransform());
+        }
+        rig->chains.push_back(chain);
+    }
+    rig->positions.resize(rig->joints.size());
+    rig->orientations.resize(rig->joints.size());
+    Transform::getWorldPoses(rig->joints.data(), rig->joints.size(), rig->positions.data(), rig->orientations.data());
+    for (IKChain &chain : rig->chains)
+        chain.target = rig->positions[chain.first] + random.nextUnitVector() * (Real(count - 1) * random.nextRange(0.4f, 0.9f));
+    return rig;
+}
+
+static IKRig& GetTwoBoneRig()
+{
+    static IKRig *s_rig = CreateRig(3);
+    return *s_rig;
+}
+
+static IKRig& GetLongRig()
+{
+    static IKRig *s_rig = CreateRig(8);
+    return *s_rig;
+}
+
+// every iteration restarts from the rest pose, the copy is part of the cost
+CN_BENCHMARK(IK, TwoBone)
+{
+    IKRig &rig = GetTwoBoneRig();
+    Vec3Array positions;
+    QuatArray orientations;
+    state.setItemsPerIteration(IK_CHAIN_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        positions = rig.positions;
+        orientations = rig.orientations;
+        IK::solveTwoBone(rig.chains.data(), rig.chains.size(), positions.data(), orientations.data());
+        DoNotOptimize(positions[0]);
+    }
+}
+
+CN_BENCHMARK(IK, CCD)
+{
+    IKRig &rig = GetLongRig();
+    Vec3Array positions;
+    QuatArray orientations;
+    state.setItemsPerIteration(IK_CHAIN_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        positions = rig.positions;
+        orientations = rig.orientations;
+        IK::solveCCD(rig.chains.data(), rig.chains.size(), positions.data(), orientations.data());
+        DoNotOptimize(positions[0]);
+    }
+}
+
+CN_BENCHMARK(IK, FABRIK)
+{
+    IKRig &rig = GetLongRig();
+    Vec3Array positions;
+    QuatArray orientations;
+    state.setItemsPerIteration(IK_CHAIN_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        positions = rig.positions;
+        orientations = rig.orientations;
+        IK::solveFABRIK(rig.chains.data(), rig.chains.size(), positions.data(), orientations.data());
+        DoNotOptimize(positions[0]);
+    }
+}
+
+// writing solved 8 joint chains back one setWorldOrientation at a time
+CN_BENCHMARK(IK, CommitLoop)
+{
+    IKRig &rig = GetLongRig();
+    state.setItemsPerIteration(IK_CHAIN_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t j = 0; j < rig.joints.size(); ++j)
+            rig.joints[j]->setWorldOrientation(rig.orientations[j]);
+        DoNotOptimize(rig.joints[0]);
+    }
+}
+
+CN_BENCHMARK(IK, CommitBatch)
+{
+    IKRig &rig = GetLongRig();
+    state.setItemsPerIteration(IK_CHAIN_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Transform::setWorldOrientations(rig.joints.data(), rig.orientations.data(), rig.joints.size());
+        DoNotOptimize(rig.joints[0]);
+    }
+}
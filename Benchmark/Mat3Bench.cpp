@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+#include "Math/Matrix3.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t MAT3_SET_SIZE = 1024;
+
+// rotation times scale, the upper 3x3 of a transform
+static const std::vector<Mat3>& GetMat3Set()
+{
+    static std::vector<Mat3> s_set;
+    if (s_set.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(2);
+        for (size_t i = 0; i < MAT3_SET_SIZE; ++i)
+        {
+            Vec3 x = random.nextUnitVector();
+            Vec3 y = x.crossProduct(random.nextUnitVector());
+            y.normalize();
+            Vec3 z = x.crossProduct(y);
+            Vec3 s(random.nextRange(0.5f, 2.0f), random.nextRange(0.5f, 2.0f), random.nextRange(0.5f, 2.0f));
+            s_set.push_back(Mat3(x.x * s.x, y.x * s.y, z.x * s.z,
+                                 x.y * s.x, y.y * s.y, z.y * s.z,
+                                 x.z * s.x, y.z * s.y, z.z * s.z));
+        }
+    }
+    return s_set;
+}
+
+CN_BENCHMARK(Mat3, Multiply)
+{
+    const std::vector<Mat3> &set = GetMat3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat3 r = set[i % MAT3_SET_SIZE] * set[(i + 1) % MAT3_SET_SIZE];
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat3, Inverse)
+{
+    const std::vector<Mat3> &set = GetMat3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat3 r = set[i % MAT3_SET_SIZE];
+        r.inverse();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat3, Transpose)
+{
+    const std::vector<Mat3> &set = GetMat3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat3 r = set[i % MAT3_SET_SIZE];
+        r.transpose();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat3, TransformVec3)
+{
+    const std::vector<Mat3> &set = GetMat3Set();
+    Vec3 v(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = set[i % MAT3_SET_SIZE] * v;
+        DoNotOptimize(r);
+    }
+}
+
+// one matrix over an array, the loop a bulk Mat3 path would replace
+CN_BENCHMARK(Mat3, TransformVec3Loop)
+{
+    const Mat3 &mat = GetMat3Set()[0];
+    Vec3Array v(4096, Vec3(1.0f, 2.0f, 3.0f));
+    state.setItemsPerIteration(v.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < v.size(); ++k)
+            v[k] = mat * v[k];
+        DoNotOptimize(v[0]);
+    }
+}
@@ -0,0 +1,236 @@
+#include "Benchmark.h"
+#include "Math/Matrix4.h"
+#include "Math/Matrix3.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t MAT4_SET_SIZE = 1024;
+
+static const std::vector<Mat4>& GetMat4Set()
+{
+    static std::vector<Mat4> s_set;
+    if (s_set.empty())
+    {
+        Random::getThreadLocal().seed(1);
+        for (size_t i = 0; i < MAT4_SET_SIZE; ++i)
+        {
+            Vec3 pos(RandomUnitization() * 100.0f, RandomUnitization() * 100.0f, RandomUnitization() * 100.0f);
+            Vec3 scl(0.5f + RandomUnitization(), 0.5f + RandomUnitization(), 0.5f + RandomUnitization());
+            Quat rot(RandomUnitization() * TWO_PI, Vec3(RandomUnitization() - 0.5f, RandomUnitization() - 0.5f, RandomUnitization() - 0.5f));
+            s_set.push_back(Mat4::transform(pos, scl, rot));
+        }
+    }
+    return s_set;
+}
+
+static const Real* Raw(const Mat4 &mat)
+{
+    return mat[0];
+}
+
+CN_BENCHMARK(Mat4, MultiplyScalar)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Real r[16];
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4MultiplyScalar(Raw(set[i % MAT4_SET_SIZE]), Raw(set[(i + 1) % MAT4_SET_SIZE]), r);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, MultiplySimd)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Real r[16];
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4Multiply(Raw(set[i % MAT4_SET_SIZE]), Raw(set[(i + 1) % MAT4_SET_SIZE]), r);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, Multiply)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4 r = set[i % MAT4_SET_SIZE] * set[(i + 1) % MAT4_SET_SIZE];
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, TransformVec4Scalar)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Real v[4] = { 1.0f, 2.0f, 3.0f, 1.0f };
+    Real r[4];
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4TransformVec4Scalar(Raw(set[i % MAT4_SET_SIZE]), v, r);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, TransformVec4)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Vec4 v(1.0f, 2.0f, 3.0f, 1.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec4 r = set[i % MAT4_SET_SIZE] * v;
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, TransformVec3Scalar)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Real v[3] = { 1.0f, 2.0f, 3.0f };
+    Real r[3];
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4TransformPointScalar(Raw(set[i % MAT4_SET_SIZE]), v, r);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, TransformVec3)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Vec3 v(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = set[i % MAT4_SET_SIZE] * v;
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, InverseScalar)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Real r[16];
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4InverseScalar(Raw(set[i % MAT4_SET_SIZE]), r);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, Inverse)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4 r = set[i % MAT4_SET_SIZE];
+        r.inverse();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, Transpose)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4 r = set[i % MAT4_SET_SIZE];
+        r.transpose();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, Determinant)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Real r = set[i % MAT4_SET_SIZE].determinant();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, MakeTransform)
+{
+    Vec3 pos(1.0f, 2.0f, 3.0f), scl(0.5f, 1.5f, 2.0f);
+    Quat rot(0.7f, Vec3(0.6f, 0.6f, 0.52915f));
+    Mat4 r;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        pos.x = Real(i & 255);
+        r.makeTransform(pos, scl, rot);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Mat4, Decomposition)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Vec3 pos, scl;
+    Quat rot;
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        set[i % MAT4_SET_SIZE].decomposition(&pos, &scl, &rot);
+        DoNotOptimize(pos);
+        DoNotOptimize(scl);
+        DoNotOptimize(rot);
+    }
+}
+
+static void DecompositionBatch(BenchState &state, bool handleShear)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    std::vector<Vec3> pos(MAT4_SET_SIZE), scl(MAT4_SET_SIZE);
+    std::vector<Quat> rot(MAT4_SET_SIZE);
+    state.setItemsPerIteration(MAT4_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4::decomposition(set.data(), pos.data(), scl.data(), rot.data(), MAT4_SET_SIZE, handleShear);
+        DoNotOptimize(rot[0]);
+    }
+}
+
+CN_BENCHMARK(Mat4, DecompositionBatch)
+{
+    DecompositionBatch(state, true);
+}
+
+CN_BENCHMARK(Mat4, DecompositionBatchTRS)
+{
+    DecompositionBatch(state, false);
+}
+
+CN_BENCHMARK(Mat4, NormalMatrix)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        const Mat4 &m = set[i % MAT4_SET_SIZE];
+        Mat3 r(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2]);
+        r.inverseTranspose();
+        DoNotOptimize(r);
+    }
+}
+
+static void NormalMatrixBatch(BenchState &state, bool uniformScale)
+{
+    const std::vector<Mat4> &set = GetMat4Set();
+    Mat3Array out(MAT4_SET_SIZE);
+    state.setItemsPerIteration(MAT4_SET_SIZE);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Mat4::normalMatrices(set.data(), out.data(), MAT4_SET_SIZE, uniformScale);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Mat4, NormalMatrixBatch)
+{
+    NormalMatrixBatch(state, false);
+}
+
+// the set has non-uniform scale, this only measures the shortcut's cost
+CN_BENCHMARK(Mat4, NormalMatrixBatchUniform)
+{
+    NormalMatrixBatch(state, true);
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+#include "Math/Quantization.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t QUANTIZE_COUNT = 65536;
+
+static const QuatArray& GetQuats()
+{
+    static QuatArray s_quats;
+    if (s_quats.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(13);
+        for (size_t i = 0; i < QUANTIZE_COUNT; ++i)
+            s_quats.push_back(Quat(random.nextRange(0.0f, 360.0f), random.nextUnitVector()));
+    }
+    return s_quats;
+}
+
+static const Vec3Array& GetPositions()
+{
+    static Vec3Array s_positions;
+    if (s_positions.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(14);
+        for (size_t i = 0; i < QUANTIZE_COUNT; ++i)
+            s_positions.push_back(Vec3(random.nextRange(-500.0f, 500.0f), random.nextRange(-10.0f, 50.0f), random.nextRange(-500.0f, 500.0f)));
+    }
+    return s_positions;
+}
+
+CN_BENCHMARK(Quantization, QuatEncode32)
+{
+    const QuatArray &quats = GetQuats();
+    std::vector<uint32_t> packed(QUANTIZE_COUNT);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatCodec::encode32(quats.data(), packed.data(), QUANTIZE_COUNT);
+        DoNotOptimize(packed[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, QuatDecode32)
+{
+    std::vector<uint32_t> packed(QUANTIZE_COUNT);
+    QuatCodec::encode32(GetQuats().data(), packed.data(), QUANTIZE_COUNT);
+    QuatArray quats(QUANTIZE_COUNT);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatCodec::decode32(packed.data(), quats.data(), QUANTIZE_COUNT);
+        DoNotOptimize(quats[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, QuatEncode48)
+{
+    const QuatArray &quats = GetQuats();
+    std::vector<uint16_t> packed(QUANTIZE_COUNT * 3);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatCodec::encode48(quats.data(), packed.data(), QUANTIZE_COUNT);
+        DoNotOptimize(packed[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, QuatDecode48)
+{
+    std::vector<uint16_t> packed(QUANTIZE_COUNT * 3);
+    QuatCodec::encode48(GetQuats().data(), packed.data(), QUANTIZE_COUNT);
+    QuatArray quats(QUANTIZE_COUNT);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatCodec::decode48(packed.data(), quats.data(), QUANTIZE_COUNT);
+        DoNotOptimize(quats[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, HalfEncodeVec3)
+{
+    const Vec3Array &positions = GetPositions();
+    std::vector<uint16_t> packed(QUANTIZE_COUNT * 3);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        HalfCodec::encode(positions.data(), packed.data(), QUANTIZE_COUNT);
+        DoNotOptimize(packed[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, HalfDecodeVec3)
+{
+    std::vector<uint16_t> packed(QUANTIZE_COUNT * 3);
+    HalfCodec::encode(GetPositions().data(), packed.data(), QUANTIZE_COUNT);
+    Vec3Array positions(QUANTIZE_COUNT);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        HalfCodec::decode(packed.data(), positions.data(), QUANTIZE_COUNT);
+        DoNotOptimize(positions[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, PositionEncode16)
+{
+    const Vec3Array &positions = GetPositions();
+    PositionCodec codec(AABB(Vec3(-500.0f, -10.0f, -500.0f), Vec3(500.0f, 50.0f, 500.0f)));
+    std::vector<uint16_t> packed(QUANTIZE_COUNT * 3);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        codec.encode(positions.data(), packed.data(), QUANTIZE_COUNT);
+        DoNotOptimize(packed[0]);
+    }
+}
+
+CN_BENCHMARK(Quantization, PositionDecode16)
+{
+    PositionCodec codec(AABB(Vec3(-500.0f, -10.0f, -500.0f), Vec3(500.0f, 50.0f, 500.0f)));
+    std::vector<uint16_t> packed(QUANTIZE_COUNT * 3);
+    codec.encode(GetPositions().data(), packed.data(), QUANTIZE_COUNT);
+    Vec3Array positions(QUANTIZE_COUNT);
+    state.setItemsPerIteration(QUANTIZE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        codec.decode(packed.data(), positions.data(), QUANTIZE_COUNT);
+        DoNotOptimize(positions[0]);
+    }
+}
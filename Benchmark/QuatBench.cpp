@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+#include "Math/Quaternion.h"
+#include "Math/Matrix3.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t QUAT_SET_SIZE = 1024;
+
+static const QuatArray& GetQuatSet()
+{
+    static QuatArray s_set;
+    if (s_set.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(4);
+        for (size_t i = 0; i < QUAT_SET_SIZE; ++i)
+            s_set.push_back(Quat(random.nextRange(0.0f, TWO_PI), random.nextUnitVector()));
+    }
+    return s_set;
+}
+
+CN_BENCHMARK(Quat, Multiply)
+{
+    const QuatArray &set = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = set[i % QUAT_SET_SIZE] * set[(i + 1) % QUAT_SET_SIZE];
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, RotateVec3)
+{
+    const QuatArray &set = GetQuatSet();
+    Vec3 v(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = set[i % QUAT_SET_SIZE] * v;
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, Normalize)
+{
+    const QuatArray &set = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = set[i % QUAT_SET_SIZE] * 1.5f;
+        r.normalize();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, NormalizeFast)
+{
+    const QuatArray &set = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = set[i % QUAT_SET_SIZE] * 1.5f;
+        r.normalizeFast();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, Inverse)
+{
+    const QuatArray &set = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = set[i % QUAT_SET_SIZE];
+        r.inverse();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, Slerp)
+{
+    const QuatArray &set = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = Quat::slerp(Real(i & 255) / 255.0f, set[i % QUAT_SET_SIZE], set[(i + 1) % QUAT_SET_SIZE], true);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, Nlerp)
+{
+    const QuatArray &set = GetQuatSet();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r = Quat::nlerp(Real(i & 255) / 255.0f, set[i % QUAT_SET_SIZE], set[(i + 1) % QUAT_SET_SIZE], true);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, FromMat3)
+{
+    const QuatArray &set = GetQuatSet();
+    std::vector<Mat3> mats;
+    for (size_t i = 0; i < QUAT_SET_SIZE; ++i)
+    {
+        const Quat &q = set[i];
+        // rotation matrix of q, Quat has no direct conversion to Mat3
+        mats.push_back(Mat3(
+            1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y - q.w * q.z), 2.0f * (q.x * q.z + q.w * q.y),
+            2.0f * (q.x * q.y + q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z - q.w * q.x),
+            2.0f * (q.x * q.z - q.w * q.y), 2.0f * (q.y * q.z + q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y)));
+    }
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r(mats[i % QUAT_SET_SIZE]);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Quat, FromAngleAxis)
+{
+    Vec3 axis(0.6f, 0.6f, 0.52915f);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Quat r(Real(i & 1023) * 0.01f, axis);
+        DoNotOptimize(r);
+    }
+}
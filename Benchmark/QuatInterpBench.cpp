@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+#include "Math/QuaternionStream.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+// one pose of a 256 bone character sampled between two keys
+static const size_t BONE_COUNT = 256;
+
+struct PoseKeys
+{
+    QuatArray p, a, b, q;
+    std::vector<Real> weights;
+};
+
+static const PoseKeys& GetPoseKeys()
+{
+    static PoseKeys s_keys;
+    if (s_keys.p.empty())
+    {
+        Random::getThreadLocal().seed(7);
+        for (size_t i = 0; i < BONE_COUNT; ++i)
+        {
+            Vec3 axis(RandomUnitization() - 0.5f, RandomUnitization() - 0.5f, RandomUnitization() - 0.5f);
+            Quat prev(RandomUnitization() * TWO_PI, axis);
+            Quat p(RandomUnitization() * TWO_PI, axis);
+            Quat q(RandomUnitization() * TWO_PI, axis);
+            Quat next(RandomUnitization() * TWO_PI, axis);
+            s_keys.p.push_back(p);
+            s_keys.q.push_back(q);
+            s_keys.a.push_back(Quat::squadTangent(prev, p, q));
+            s_keys.b.push_back(Quat::squadTangent(p, q, next));
+            s_keys.weights.push_back(RandomUnitization());
+        }
+    }
+    return s_keys;
+}
+
+CN_BENCHMARK(QuatInterp, NlerpLoop)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatArray out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < BONE_COUNT; ++k)
+            out[k] = Quat::nlerp(keys.weights[k], keys.p[k], keys.q[k], true);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(QuatInterp, NlerpStream)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatStream p(keys.p), q(keys.q), out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatStream::nlerp(keys.weights.data(), p, q, out, true);
+        DoNotOptimize(out.w()[0]);
+    }
+}
+
+CN_BENCHMARK(QuatInterp, SlerpLoop)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatArray out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < BONE_COUNT; ++k)
+            out[k] = Quat::slerp(keys.weights[k], keys.p[k], keys.q[k], true);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(QuatInterp, SlerpFastLoop)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatArray out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < BONE_COUNT; ++k)
+            out[k] = Quat::slerpFast(keys.weights[k], keys.p[k], keys.q[k], true);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(QuatInterp, SlerpStream)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatStream p(keys.p), q(keys.q), out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatStream::slerp(keys.weights.data(), p, q, out, true);
+        DoNotOptimize(out.w()[0]);
+    }
+}
+
+CN_BENCHMARK(QuatInterp, SquadLoop)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatArray out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < BONE_COUNT; ++k)
+            out[k] = Quat::squad(keys.weights[k], keys.p[k], keys.a[k], keys.b[k], keys.q[k], true);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(QuatInterp, SquadStream)
+{
+    const PoseKeys &keys = GetPoseKeys();
+    QuatStream p(keys.p), a(keys.a), b(keys.b), q(keys.q), out(BONE_COUNT);
+    state.setItemsPerIteration(BONE_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatStream::squad(keys.weights.data(), p, a, b, q, out, true);
+        DoNotOptimize(out.w()[0]);
+    }
+}
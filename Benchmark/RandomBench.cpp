@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+#include "Math/Matrix4.h"
+#include "Math/Random.h"
+#include <stdlib.h>
+#include <thread>
+
+using namespace Canaan;
+
+static const size_t RANDOM_COUNT = 16384;
+static const int RANDOM_THREADS = 4;
+
+// the generator RandomUnitization used before Random
+static inline Real RandUnit()
+{
+    return (Real)rand() / (Real)RAND_MAX;
+}
+
+// every thread of an emitter job fills its own RANDOM_COUNT directions
+template<typename Func> static void RunThreads(BenchState &state, int threads, Func func)
+{
+    state.setItemsPerIteration(RANDOM_COUNT * threads);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.push_back(std::thread([&func, t]() {
+                Vec3Array out(RANDOM_COUNT);
+                func(t, out);
+                DoNotOptimize(out[0]);
+            }));
+        }
+        for (auto &worker : workers)
+            worker.join();
+    }
+}
+
+static void DeviateRand(int, Vec3Array &out)
+{
+    Vec3 dir(0.0f, 1.0f, 0.0f);
+    for (size_t k = 0; k < out.size(); ++k)
+    {
+        // old randomDeviat: two Mat4 rotations per direction
+        Vec3 newUp = dir.perpendicular();
+        Mat4 mat = Mat4::rotation(Quat(RandUnit() * TWO_PI, dir));
+        newUp = mat * newUp;
+        mat = Mat4::rotation(Quat(0.2f, newUp));
+        out[k] = mat * dir;
+    }
+}
+
+static void DeviateScalar(int, Vec3Array &out)
+{
+    Vec3 dir(0.0f, 1.0f, 0.0f);
+    for (size_t k = 0; k < out.size(); ++k)
+        out[k] = dir.randomDeviat(0.2f);
+}
+
+static void DeviateBulk(int t, Vec3Array &out)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(1, t);
+    Vec3Array dirs(out.size(), Vec3(0.0f, 1.0f, 0.0f));
+    random.fillDeviations(dirs.data(), 0.2f, out.data(), out.size());
+}
+
+static void ConeBulk(int t, Vec3Array &out)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(1, t);
+    random.fillConeDirections(Vec3::UNIT_Y, 0.2f, out.data(), out.size());
+}
+
+CN_BENCHMARK(Random, UnitRand)
+{
+    std::vector<Real> out(RANDOM_COUNT);
+    state.setItemsPerIteration(RANDOM_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < RANDOM_COUNT; ++k)
+            out[k] = RandUnit();
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Random, Unit)
+{
+    std::vector<Real> out(RANDOM_COUNT);
+    state.setItemsPerIteration(RANDOM_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t k = 0; k < RANDOM_COUNT; ++k)
+            out[k] = RandomUnitization();
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Random, FillUnit)
+{
+    std::vector<Real> out(RANDOM_COUNT);
+    state.setItemsPerIteration(RANDOM_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Random::getThreadLocal().fillUnit(out.data(), RANDOM_COUNT);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Random, FillUnitVectors)
+{
+    Vec3Array out(RANDOM_COUNT);
+    state.setItemsPerIteration(RANDOM_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Random::getThreadLocal().fillUnitVectors(out.data(), RANDOM_COUNT);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Random, DeviateRand1Thread) { RunThreads(state, 1, DeviateRand); }
+CN_BENCHMARK(Random, DeviateRand4Threads) { RunThreads(state, RANDOM_THREADS, DeviateRand); }
+CN_BENCHMARK(Random, DeviateScalar1Thread) { RunThreads(state, 1, DeviateScalar); }
+CN_BENCHMARK(Random, DeviateScalar4Threads) { RunThreads(state, RANDOM_THREADS, DeviateScalar); }
+CN_BENCHMARK(Random, DeviateBulk1Thread) { RunThreads(state, 1, DeviateBulk); }
+CN_BENCHMARK(Random, DeviateBulk4Threads) { RunThreads(state, RANDOM_THREADS, DeviateBulk); }
+CN_BENCHMARK(Random, ConeBulk1Thread) { RunThreads(state, 1, ConeBulk); }
+CN_BENCHMARK(Random, ConeBulk4Threads) { RunThreads(state, RANDOM_THREADS, ConeBulk); }
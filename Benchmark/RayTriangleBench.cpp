@@ -0,0 +1,141 @@
+#include "Benchmark.h"
+#include "Math/RayStream.h"
+#include "Math/Matrix4.h"
+#include "Math/Quaternion.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+// a 4096 triangle mesh probed by 256 rays per iteration, items are ray/triangle tests
+static const size_t MESH_TRIANGLES = 4096;
+static const size_t PROBE_RAYS = 256;
+
+static const Vec3Array& GetMeshVertices()
+{
+    static Vec3Array s_vertices;
+    if (s_vertices.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(18);
+        for (size_t i = 0; i < MESH_TRIANGLES; ++i)
+        {
+            Vec3 center(random.nextRange(-50.0f, 50.0f), random.nextRange(-50.0f, 50.0f), random.nextRange(-50.0f, 50.0f));
+            for (int k = 0; k < 3; ++k)
+                s_vertices.push_back(center + random.nextUnitVector() * 2.0f);
+        }
+    }
+    return s_vertices;
+}
+
+static const TriangleStream& GetMesh()
+{
+    static TriangleStream s_mesh;
+    if (s_mesh.empty())
+        s_mesh.fromVertices(GetMeshVertices().data(), MESH_TRIANGLES);
+    return s_mesh;
+}
+
+static const RayArray& GetRays()
+{
+    static RayArray s_rays;
+    if (s_rays.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(19);
+        for (size_t i = 0; i < PROBE_RAYS; ++i)
+        {
+            Vec3 origin(random.nextRange(-60.0f, 60.0f), random.nextRange(-60.0f, 60.0f), -80.0f);
+            Vec3 direction = Vec3(random.nextRange(-0.2f, 0.2f), random.nextRange(-0.2f, 0.2f), 1.0f);
+            direction.normalize();
+            s_rays.push_back(Ray(origin, direction));
+        }
+    }
+    return s_rays;
+}
+
+CN_BENCHMARK(RayTriangle, NearestLoop)
+{
+    const Vec3Array &vertices = GetMeshVertices();
+    const RayArray &rays = GetRays();
+    state.setItemsPerIteration(PROBE_RAYS * MESH_TRIANGLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t hits = 0;
+        for (size_t r = 0; r < PROBE_RAYS; ++r)
+        {
+            Real best = FLOAT_MAX;
+            for (size_t t = 0; t < MESH_TRIANGLES; ++t)
+            {
+                Real distance;
+                if (rays[r].intersects(vertices[t * 3], vertices[t * 3 + 1], vertices[t * 3 + 2], &distance) && distance < best)
+                    best = distance;
+            }
+            hits += best < FLOAT_MAX;
+        }
+        DoNotOptimize(hits);
+    }
+}
+
+CN_BENCHMARK(RayTriangle, NearestRay)
+{
+    const TriangleStream &mesh = GetMesh();
+    const RayArray &rays = GetRays();
+    state.setItemsPerIteration(PROBE_RAYS * MESH_TRIANGLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t hits = 0;
+        TriangleHit hit;
+        for (size_t r = 0; r < PROBE_RAYS; ++r)
+            hits += rays[r].intersectNearest(mesh, hit);
+        DoNotOptimize(hits);
+    }
+}
+
+CN_BENCHMARK(RayTriangle, NearestPacket)
+{
+    const TriangleStream &mesh = GetMesh();
+    RayStream rays(GetRays());
+    std::vector<TriangleHit> hits(PROBE_RAYS);
+    state.setItemsPerIteration(PROBE_RAYS * MESH_TRIANGLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        DoNotOptimize(rays.intersectNearest(mesh, hits.data()));
+}
+
+CN_BENCHMARK(RayTriangle, AnyRay)
+{
+    const TriangleStream &mesh = GetMesh();
+    const RayArray &rays = GetRays();
+    state.setItemsPerIteration(PROBE_RAYS * MESH_TRIANGLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        size_t hits = 0;
+        for (size_t r = 0; r < PROBE_RAYS; ++r)
+            hits += rays[r].intersectsAny(mesh);
+        DoNotOptimize(hits);
+    }
+}
+
+CN_BENCHMARK(RayTriangle, AnyPacket)
+{
+    const TriangleStream &mesh = GetMesh();
+    RayStream rays(GetRays());
+    std::vector<uint8_t> hits(PROBE_RAYS);
+    state.setItemsPerIteration(PROBE_RAYS * MESH_TRIANGLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        DoNotOptimize(rays.intersectsAny(mesh, hits.data()));
+}
+
+CN_BENCHMARK(RayTriangle, TransformStream)
+{
+    RayStream rays(GetRays());
+    RayStream out;
+    Mat4 inverse;
+    inverse.makeTransform(Vec3(1.0f, 2.0f, 3.0f), Vec3(2.0f, 2.0f, 2.0f), Quat(0.5f, Vec3::UNIT_Y));
+    inverse.inverse();
+    state.setItemsPerIteration(PROBE_RAYS);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        rays.transform(inverse, out);
+        DoNotOptimize(out.originX()[0]);
+    }
+}
@@ -0,0 +1,163 @@
+#include "Benchmark.h"
+#include "Math/Skinning.h"
+#include "Math/DualQuaternion.h"
+#include "Math/Affine3.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t SKIN_VERTEX_COUNT = 65536;
+static const size_t SKIN_BONE_COUNT = 64;
+
+struct SkinSet
+{
+    std::vector<Affine3> matrices;
+    DualQuatArray dualQuats;
+    Vec3Stream positions;
+    Vec3Stream normals;
+    SkinWeightStream weights4{ 4 };
+    SkinWeightStream weights8{ 8 };
+};
+
+// a mesh with every vertex using all of its slots, bones spread at random
+static const SkinSet& GetSkinSet()
+{
+    static SkinSet s_set;
+    if (s_set.positions.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(12);
+        for (size_t b = 0; b < SKIN_BONE_COUNT; ++b)
+        {
+            Quat rotation(random.nextRange(0.0f, TWO_PI), random.nextUnitVector());
+            Vec3 translation(random.nextRange(-1.0f, 1.0f), random.nextRange(-1.0f, 1.0f), random.nextRange(-1.0f, 1.0f));
+            s_set.matrices.push_back(Affine3::transform(translation, Vec3(1.0f, 1.0f, 1.0f), rotation));
+            s_set.dualQuats.push_back(DualQuat(rotation, translation));
+        }
+        s_set.positions.resize(SKIN_VERTEX_COUNT);
+        s_set.normals.resize(SKIN_VERTEX_COUNT);
+        s_set.weights4.resize(SKIN_VERTEX_COUNT);
+        s_set.weights8.resize(SKIN_VERTEX_COUNT);
+        for (size_t i = 0; i < SKIN_VERTEX_COUNT; ++i)
+        {
+            s_set.positions.set(i, random.nextUnitVector() * random.nextRange(0.1f, 2.0f));
+            s_set.normals.set(i, random.nextUnitVector());
+            for (size_t s = 0; s < 8; ++s)
+            {
+                uint16_t bone = (uint16_t)(random.nextUInt() % SKIN_BONE_COUNT);
+                Real weight = random.nextRange(0.1f, 1.0f);
+                if (s < 4)
+                    s_set.weights4.set(i, s, bone, weight);
+                s_set.weights8.set(i, s, bone, weight);
+            }
+        }
+        s_set.weights4.normalizeWeights();
+        s_set.weights8.normalizeWeights();
+    }
+    return s_set;
+}
+
+// per vertex with the Affine3 and DualQuat operations, what callers did without the kernels
+static void LinearBlendReference(BenchState &state, const SkinWeightStream &weights)
+{
+    const SkinSet &set = GetSkinSet();
+    Vec3Stream positions(SKIN_VERTEX_COUNT), normals(SKIN_VERTEX_COUNT);
+    state.setItemsPerIteration(SKIN_VERTEX_COUNT);
+    for (size_t n = 0; n < state.iterations(); ++n)
+    {
+        for (size_t i = 0; i < SKIN_VERTEX_COUNT; ++i)
+        {
+            Affine3 m;
+            for (size_t e = 0; e < 12; ++e)
+            {
+                Real sum = 0.0f;
+                for (size_t s = 0; s < weights.influences(); ++s)
+                    sum += weights.getWeight(i, s) * set.matrices[weights.getBone(i, s)][0][e];
+                m[0][e] = sum;
+            }
+            positions.set(i, m * set.positions.get(i));
+            Vec3 normal = m.transformDirection(set.normals.get(i));
+            normal.normalize();
+            normals.set(i, normal);
+        }
+        DoNotOptimize(positions.x()[0]);
+    }
+}
+
+static void DualQuatReference(BenchState &state, const SkinWeightStream &weights)
+{
+    const SkinSet &set = GetSkinSet();
+    Vec3Stream positions(SKIN_VERTEX_COUNT), normals(SKIN_VERTEX_COUNT);
+    state.setItemsPerIteration(SKIN_VERTEX_COUNT);
+    for (size_t n = 0; n < state.iterations(); ++n)
+    {
+        for (size_t i = 0; i < SKIN_VERTEX_COUNT; ++i)
+        {
+            DualQuat dqs[SkinWeightStream::MAX_INFLUENCES];
+            Real w[SkinWeightStream::MAX_INFLUENCES];
+            for (size_t s = 0; s < weights.influences(); ++s)
+            {
+                dqs[s] = set.dualQuats[weights.getBone(i, s)];
+                w[s] = weights.getWeight(i, s);
+            }
+            DualQuat dq = DualQuat::blend(dqs, w, weights.influences());
+            positions.set(i, dq.transformPoint(set.positions.get(i)));
+            normals.set(i, dq.transformDirection(set.normals.get(i)));
+        }
+        DoNotOptimize(positions.x()[0]);
+    }
+}
+
+static void LinearBlend(BenchState &state, const SkinWeightStream &weights)
+{
+    const SkinSet &set = GetSkinSet();
+    Vec3Stream positions, normals;
+    state.setItemsPerIteration(SKIN_VERTEX_COUNT);
+    for (size_t n = 0; n < state.iterations(); ++n)
+    {
+        Skinning::linearBlend(set.matrices.data(), weights, set.positions, positions, &set.normals, &normals);
+        DoNotOptimize(positions.x()[0]);
+    }
+}
+
+static void DualQuaternion(BenchState &state, const SkinWeightStream &weights)
+{
+    const SkinSet &set = GetSkinSet();
+    Vec3Stream positions, normals;
+    state.setItemsPerIteration(SKIN_VERTEX_COUNT);
+    for (size_t n = 0; n < state.iterations(); ++n)
+    {
+        Skinning::dualQuaternion(set.dualQuats.data(), weights, set.positions, positions, &set.normals, &normals);
+        DoNotOptimize(positions.x()[0]);
+    }
+}
+
+CN_BENCHMARK(Skinning, LinearBlendReference4)
+{
+    LinearBlendReference(state, GetSkinSet().weights4);
+}
+
+CN_BENCHMARK(Skinning, LinearBlend4)
+{
+    LinearBlend(state, GetSkinSet().weights4);
+}
+
+CN_BENCHMARK(Skinning, LinearBlend8)
+{
+    LinearBlend(state, GetSkinSet().weights8);
+}
+
+CN_BENCHMARK(Skinning, DualQuatReference4)
+{
+    DualQuatReference(state, GetSkinSet().weights4);
+}
+
+CN_BENCHMARK(Skinning, DualQuat4)
+{
+    DualQuaternion(state, GetSkinSet().weights4);
+}
+
+CN_BENCHMARK(Skinning, DualQuat8)
+{
+    DualQuaternion(state, GetSkinSet().weights8);
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+#include "Math/Spline.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+// one camera rail of 64 points sampled at 4096 parameters per frame
+static const size_t RAIL_POINTS = 64;
+static const size_t RAIL_SAMPLES = 4096;
+
+static Spline& GetRail()
+{
+    static Spline s_rail(SPLINE_CATMULL_ROM);
+    if (s_rail.getPointCount() == 0)
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(15);
+        Vec3Array points;
+        for (size_t i = 0; i < RAIL_POINTS; ++i)
+            points.push_back(Vec3(Real(i) * 10.0f, random.nextRange(-5.0f, 5.0f), random.nextRange(-5.0f, 5.0f)));
+        s_rail.setPoints(points.data(), points.size());
+    }
+    return s_rail;
+}
+
+static QuatSpline& GetRailOrientation()
+{
+    static QuatSpline s_rail(SPLINE_CATMULL_ROM);
+    if (s_rail.getKeyCount() == 0)
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(16);
+        QuatArray keys;
+        for (size_t i = 0; i < RAIL_POINTS; ++i)
+            keys.push_back(Quat(random.nextRange(-1.0f, 1.0f), random.nextUnitVector()));
+        s_rail.setKeys(keys.data(), keys.size());
+    }
+    return s_rail;
+}
+
+static const std::vector<Real>& GetParameters()
+{
+    static std::vector<Real> s_t;
+    if (s_t.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(17);
+        for (size_t i = 0; i < RAIL_SAMPLES; ++i)
+            s_t.push_back(random.nextUnit());
+    }
+    return s_t;
+}
+
+CN_BENCHMARK(Spline, EvaluateLoop)
+{
+    const Spline &rail = GetRail();
+    const std::vector<Real> &t = GetParameters();
+    Vec3Array out(RAIL_SAMPLES);
+    state.setItemsPerIteration(RAIL_SAMPLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t s = 0; s < RAIL_SAMPLES; ++s)
+            out[s] = rail.evaluate(t[s]);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Spline, EvaluateBatch)
+{
+    const Spline &rail = GetRail();
+    const std::vector<Real> &t = GetParameters();
+    Vec3Array out(RAIL_SAMPLES);
+    state.setItemsPerIteration(RAIL_SAMPLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        rail.evaluate(t.data(), out.data(), RAIL_SAMPLES);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Spline, EvaluateAtDistanceBatch)
+{
+    Spline &rail = GetRail();
+    std::vector<Real> distances(GetParameters());
+    for (auto &d : distances)
+        d *= rail.getLength();
+    Vec3Array out(RAIL_SAMPLES);
+    state.setItemsPerIteration(RAIL_SAMPLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        rail.evaluateAtDistance(distances.data(), out.data(), RAIL_SAMPLES);
+        DoNotOptimize(out[0]);
+    }
+}
+
+// moves one point per frame, only the four segments around it are resampled
+CN_BENCHMARK(Spline, EditPointLength)
+{
+    Spline &rail = GetRail();
+    Vec3 point = rail.getPoint(RAIL_POINTS / 2);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        point.y = -point.y;
+        rail.setPoint(RAIL_POINTS / 2, point);
+        Real length = rail.getLength();
+        DoNotOptimize(length);
+    }
+}
+
+CN_BENCHMARK(Spline, QuatEvaluateLoop)
+{
+    const QuatSpline &rail = GetRailOrientation();
+    const std::vector<Real> &t = GetParameters();
+    QuatArray out(RAIL_SAMPLES);
+    state.setItemsPerIteration(RAIL_SAMPLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t s = 0; s < RAIL_SAMPLES; ++s)
+            out[s] = rail.evaluate(t[s]);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Spline, QuatEvaluateBatch)
+{
+    const QuatSpline &rail = GetRailOrientation();
+    const std::vector<Real> &t = GetParameters();
+    QuatArray out(RAIL_SAMPLES);
+    state.setItemsPerIteration(RAIL_SAMPLES);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        rail.evaluate(t.data(), out.data(), RAIL_SAMPLES);
+        DoNotOptimize(out[0]);
+    }
+}
@@ -0,0 +1,180 @@
+#include "Benchmark.h"
+#include "Math/QuaternionStream.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t STREAM_COUNT = 4096;
+
+static const Vec3Array& GetVectors(int seed)
+{
+    static Vec3Array s_vectors[2];
+    Vec3Array &vectors = s_vectors[seed & 1];
+    if (vectors.empty())
+    {
+        Random::getThreadLocal().seed(seed + 10);
+        for (size_t i = 0; i < STREAM_COUNT; ++i)
+            vectors.push_back(Vec3(RandomUnitization() - 0.5f, RandomUnitization() - 0.5f, RandomUnitization() - 0.5f));
+    }
+    return vectors;
+}
+
+static const QuatArray& GetQuats()
+{
+    static QuatArray s_quats;
+    if (s_quats.empty())
+    {
+        const Vec3Array &axes = GetVectors(0);
+        for (size_t i = 0; i < STREAM_COUNT; ++i)
+            s_quats.push_back(Quat(RandomUnitization() * TWO_PI, axes[i]));
+    }
+    return s_quats;
+}
+
+CN_BENCHMARK(Stream, DotAoS)
+{
+    const Vec3Array &a = GetVectors(0), &b = GetVectors(1);
+    std::vector<Real> out(a.size());
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t v = 0; v < a.size(); ++v)
+            out[v] = a[v].dotProduct(b[v]);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, DotSoA)
+{
+    Vec3Stream a(GetVectors(0)), b(GetVectors(1));
+    std::vector<Real> out(a.size());
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3Stream::dotProduct(a, b, out.data());
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, CrossAoS)
+{
+    const Vec3Array &a = GetVectors(0), &b = GetVectors(1);
+    Vec3Array out(a.size());
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t v = 0; v < a.size(); ++v)
+            out[v] = a[v].crossProduct(b[v]);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, CrossSoA)
+{
+    Vec3Stream a(GetVectors(0)), b(GetVectors(1)), out;
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3Stream::crossProduct(a, b, out);
+        DoNotOptimize(out.x()[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, NormalizeAoS)
+{
+    const Vec3Array &src = GetVectors(0);
+    Vec3Array a = src;
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t v = 0; v < a.size(); ++v)
+            a[v].normalize();
+        DoNotOptimize(a[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, NormalizeSoA)
+{
+    Vec3Stream a(GetVectors(0));
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        a.normalize();
+        DoNotOptimize(a.x()[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, LengthAoS)
+{
+    const Vec3Array &a = GetVectors(0);
+    std::vector<Real> out(a.size());
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t v = 0; v < a.size(); ++v)
+            out[v] = a[v].length();
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, LengthSoA)
+{
+    Vec3Stream a(GetVectors(0));
+    std::vector<Real> out(a.size());
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        a.length(out.data());
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, LerpAoS)
+{
+    const Vec3Array &a = GetVectors(0), &b = GetVectors(1);
+    Vec3Array out(a.size());
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t v = 0; v < a.size(); ++v)
+            out[v] = a[v] + (b[v] - a[v]) * 0.25f;
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, LerpSoA)
+{
+    Vec3Stream a(GetVectors(0)), b(GetVectors(1)), out;
+    state.setItemsPerIteration(a.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3Stream::lerp(0.25f, a, b, out);
+        DoNotOptimize(out.x()[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, RotateAoS)
+{
+    const QuatArray &q = GetQuats();
+    const Vec3Array &v = GetVectors(1);
+    Vec3Array out(v.size());
+    state.setItemsPerIteration(v.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t e = 0; e < v.size(); ++e)
+            out[e] = q[e] * v[e];
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Stream, RotateSoA)
+{
+    QuatStream q(GetQuats());
+    Vec3Stream v(GetVectors(1)), out;
+    state.setItemsPerIteration(v.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        QuatStream::rotate(q, v, out);
+        DoNotOptimize(out.x()[0]);
+    }
+}
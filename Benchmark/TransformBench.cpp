@@ -0,0 +1,122 @@
+#include "Benchmark.h"
+#include "Math/Matrix4.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t POINT_COUNT = 4096;
+
+static const Vec3Array& GetPoints()
+{
+    static Vec3Array s_points;
+    if (s_points.empty())
+    {
+        Random::getThreadLocal().seed(2);
+        for (size_t i = 0; i < POINT_COUNT; ++i)
+            s_points.push_back(Vec3(RandomUnitization() * 10.0f, RandomUnitization() * 10.0f, RandomUnitization() * 10.0f));
+    }
+    return s_points;
+}
+
+static Mat4 GetAffine()
+{
+    return Mat4::transform(Vec3(1.0f, 2.0f, 3.0f), Vec3(2.0f, 1.0f, 0.5f), Quat(0.7f, Vec3(1.0f, 1.0f, 0.0f)));
+}
+
+static Mat4 GetProjective()
+{
+    return Mat4::perspective(60.0f, 1.5f, 0.1f, 100.0f) * Mat4::lookAt(Vec3(0.0f, 0.0f, 30.0f), Vec3::ZERO, Vec3::UNIT_Y);
+}
+
+CN_BENCHMARK(Transform, PointsLoop)
+{
+    const Vec3Array &in = GetPoints();
+    Vec3Array out(in.size());
+    Mat4 mat = GetProjective();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t p = 0; p < in.size(); ++p)
+            out[p] = mat * in[p];
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Transform, PointsBatch)
+{
+    const Vec3Array &in = GetPoints();
+    Vec3Array out(in.size());
+    Mat4 mat = GetProjective();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        mat.transformPoints(in, out);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Transform, AffinePointsBatch)
+{
+    const Vec3Array &in = GetPoints();
+    Vec3Array out(in.size());
+    Mat4 mat = GetAffine();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        mat.transformAffinePoints(in, out);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Transform, DirectionsBatch)
+{
+    const Vec3Array &in = GetPoints();
+    Vec3Array out(in.size());
+    Mat4 mat = GetAffine();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        mat.transformDirections(in, out);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Transform, NormalsBatch)
+{
+    const Vec3Array &in = GetPoints();
+    Vec3Array out(in.size());
+    Mat4 mat = GetAffine();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        mat.transformNormals(in, out);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Transform, Vec4Loop)
+{
+    Vec4Array in(POINT_COUNT, Vec4(1.0f, 2.0f, 3.0f, 1.0f));
+    Vec4Array out(in.size());
+    Mat4 mat = GetProjective();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t p = 0; p < in.size(); ++p)
+            out[p] = mat * in[p];
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(Transform, Vec4Batch)
+{
+    Vec4Array in(POINT_COUNT, Vec4(1.0f, 2.0f, 3.0f, 1.0f));
+    Vec4Array out(in.size());
+    Mat4 mat = GetProjective();
+    state.setItemsPerIteration(in.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        mat.transform(in, out);
+        DoNotOptimize(out[0]);
+    }
+}
@@ -0,0 +1,84 @@
+#include "Benchmark.h"
+#include "Math/Vector3.h"
+#include "Math/SIMD.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t VEC3_SET_SIZE = 4096;
+
+static const Vec3Array& GetVec3Set()
+{
+    static Vec3Array s_set;
+    if (s_set.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(3);
+        for (size_t i = 0; i < VEC3_SET_SIZE; ++i)
+            s_set.push_back(Vec3(random.nextRange(-10.0f, 10.0f), random.nextRange(-10.0f, 10.0f), random.nextRange(-10.0f, 10.0f)));
+    }
+    return s_set;
+}
+
+CN_BENCHMARK(Vec3, Normalize)
+{
+    const Vec3Array &set = GetVec3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 v = set[i % VEC3_SET_SIZE];
+        v.normalize();
+        DoNotOptimize(v);
+    }
+}
+
+CN_BENCHMARK(Vec3, NormalizeFast)
+{
+    const Vec3Array &set = GetVec3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 v = set[i % VEC3_SET_SIZE];
+        v.normalizeFast();
+        DoNotOptimize(v);
+    }
+}
+
+CN_BENCHMARK(Vec3, NormalizeBatch)
+{
+    Vec3Array v(GetVec3Set());
+    state.setItemsPerIteration(v.size());
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3NormalizeBatch(&v[0].x, v.size());
+        DoNotOptimize(v[0]);
+    }
+}
+
+CN_BENCHMARK(Vec3, Length)
+{
+    const Vec3Array &set = GetVec3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Real r = set[i % VEC3_SET_SIZE].length();
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Vec3, DotProduct)
+{
+    const Vec3Array &set = GetVec3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Real r = set[i % VEC3_SET_SIZE].dotProduct(set[(i + 1) % VEC3_SET_SIZE]);
+        DoNotOptimize(r);
+    }
+}
+
+CN_BENCHMARK(Vec3, CrossProduct)
+{
+    const Vec3Array &set = GetVec3Set();
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Vec3 r = set[i % VEC3_SET_SIZE].crossProduct(set[(i + 1) % VEC3_SET_SIZE]);
+        DoNotOptimize(r);
+    }
+}
@@ -0,0 +1,104 @@
+#include "Benchmark.h"
+#include "Math/VectorExpression.h"
+#include "Math/Random.h"
+
+using namespace Canaan;
+
+static const size_t EXPRESSION_COUNT = 100000;
+
+struct ParticleSet
+{
+    Vec3Array positions;
+    Vec3Array velocities;
+    std::vector<Real> drag;
+    Vec3Stream positionStream;
+    Vec3Stream velocityStream;
+};
+
+static const ParticleSet& GetParticleSet()
+{
+    static ParticleSet s_set;
+    if (s_set.positions.empty())
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(19);
+        for (size_t i = 0; i < EXPRESSION_COUNT; ++i)
+        {
+            s_set.positions.push_back(random.nextUnitVector() * random.nextRange(0.0f, 100.0f));
+            s_set.velocities.push_back(random.nextUnitVector() * random.nextRange(0.0f, 10.0f));
+            s_set.drag.push_back(random.nextRange(0.0f, 0.1f));
+        }
+        s_set.positionStream = Vec3Stream(s_set.positions);
+        s_set.velocityStream = Vec3Stream(s_set.velocities);
+    }
+    return s_set;
+}
+
+static const Vec3 GRAVITY(0.0f, -9.8f, 0.0f);
+static const Real DT = 1.0f / 60.0f;
+
+// p + (v + g * dt) * dt - v * drag * dt, one temporary per operator
+CN_BENCHMARK(VectorExpression, IntegrateOperators)
+{
+    const ParticleSet &set = GetParticleSet();
+    Vec3Array out(EXPRESSION_COUNT);
+    state.setItemsPerIteration(EXPRESSION_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t p = 0; p < EXPRESSION_COUNT; ++p)
+            out[p] = set.positions[p] + (set.velocities[p] + GRAVITY * DT) * DT - set.velocities[p] * set.drag[p] * DT;
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(VectorExpression, IntegrateArrays)
+{
+    const ParticleSet &set = GetParticleSet();
+    Vec3Array out(EXPRESSION_COUNT);
+    state.setItemsPerIteration(EXPRESSION_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Assign(out, Lazy(set.positions) + (Lazy(set.velocities) + Lazy(GRAVITY) * DT) * DT
+            - Lazy(set.velocities) * Lazy(set.drag.data(), EXPRESSION_COUNT) * DT);
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(VectorExpression, IntegrateStreams)
+{
+    const ParticleSet &set = GetParticleSet();
+    Vec3Stream out(EXPRESSION_COUNT);
+    state.setItemsPerIteration(EXPRESSION_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Assign(out, Lazy(set.positionStream) + (Lazy(set.velocityStream) + Lazy(GRAVITY) * DT) * DT
+            - Lazy(set.velocityStream) * Lazy(set.drag.data(), EXPRESSION_COUNT) * DT);
+        DoNotOptimize(out.x()[0]);
+    }
+}
+
+// v - 2 * dot(v, n) * n against every normal
+CN_BENCHMARK(VectorExpression, ReflectOperators)
+{
+    const ParticleSet &set = GetParticleSet();
+    Vec3Array out(EXPRESSION_COUNT);
+    state.setItemsPerIteration(EXPRESSION_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        for (size_t p = 0; p < EXPRESSION_COUNT; ++p)
+            out[p] = set.velocities[p] - 2.0f * set.velocities[p].dotProduct(set.positions[p]) * set.positions[p];
+        DoNotOptimize(out[0]);
+    }
+}
+
+CN_BENCHMARK(VectorExpression, ReflectArrays)
+{
+    const ParticleSet &set = GetParticleSet();
+    Vec3Array out(EXPRESSION_COUNT);
+    state.setItemsPerIteration(EXPRESSION_COUNT);
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        Assign(out, Lazy(set.velocities) - 2.0f * DotProduct(Lazy(set.velocities), Lazy(set.positions)) * Lazy(set.positions));
+        DoNotOptimize(out[0]);
+    }
+}
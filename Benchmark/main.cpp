@@ -0,0 +1,160 @@
+#include "Benchmark.h"
+#include "Math/Mathematics.h"
+#include "Math/SIMD.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+/*
+    math_bench [filter] [--json[=path]]
+
+    Runs every case whose "Group/Name" contains filter. The text table goes
+    to stdout; --json writes the results as JSON instead, to path when given:
+
+    {
+      "backend": "sse2", "precision": "float", "compiler": "...",
+      "cases": [
+        { "name": "Mat4/Multiply", "iterations": 100000000,
+          "items_per_iteration": 1, "ns_per_iteration": 1.9, "ns_per_item": 1.9 },
+        ...
+      ]
+    }
+
+    Build once per backend (CN_DISABLE_SIMD, CN_ENABLE_AVX) and compare the
+    files by case name.
+*/
+
+namespace Canaan
+{
+    std::vector<BenchCase>& GetBenchCases()
+    {
+        static std::vector<BenchCase> s_cases;
+        return s_cases;
+    }
+}
+
+using namespace Canaan;
+
+struct BenchResult
+{
+    std::string name;
+    size_t iterations;
+    size_t items;
+    double nsPerIteration;
+};
+
+static double RunCase(const BenchCase &bc, size_t iterations, size_t *items)
+{
+    BenchState state(iterations);
+    auto start = std::chrono::high_resolution_clock::now();
+    bc.func(state);
+    auto end = std::chrono::high_resolution_clock::now();
+    *items = state.getItemsPerIteration();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static const char* CompilerName()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc";
+#else
+    return "unknown";
+#endif
+}
+
+static void WriteJsonString(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\') fputc('\\', file);
+        if ((unsigned char)*str >= 0x20) fputc(*str, file);
+    }
+    fputc('"', file);
+}
+
+static void WriteJson(FILE *file, const std::vector<BenchResult> &results)
+{
+    fprintf(file, "{\n  \"backend\": ");
+    WriteJsonString(file, SimdBackendName());
+    fprintf(file, ",\n  \"precision\": \"%s\",\n  \"compiler\": ", sizeof(Real) == sizeof(double) ? "double" : "float");
+    WriteJsonString(file, CompilerName());
+    fprintf(file, ",\n  \"cases\": [");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        fprintf(file, "%s\n    { \"name\": ", i ? "," : "");
+        WriteJsonString(file, r.name.c_str());
+        fprintf(file, ", \"iterations\": %zu, \"items_per_iteration\": %zu, \"ns_per_iteration\": %.6g, \"ns_per_item\": %.6g }",
+            r.iterations, r.items, r.nsPerIteration, r.nsPerIteration / double(r.items));
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = nullptr;
+    const char *jsonPath = nullptr;
+    bool json = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+            json = true;
+        else if (strncmp(argv[i], "--json=", 7) == 0){
+            json = true;
+            jsonPath = argv[i] + 7;
+        }
+        else
+            filter = argv[i];
+    }
+    // the table shares stdout with the JSON only when the JSON goes to a file
+    const bool table = !json || jsonPath;
+    const double targetNs = 2.0e8;
+
+    if (table){
+        printf("backend: %s\n", SimdBackendName());
+        printf("%-48s %14s %14s\n", "case", "ns/iter", "ns/item");
+    }
+    std::vector<BenchResult> results;
+    for (auto &bc : GetBenchCases())
+    {
+        std::string fullName = bc.group + "/" + bc.name;
+        if (filter && strstr(fullName.c_str(), filter) == nullptr)
+            continue;
+
+        // grow the iteration count until one run is long enough to time
+        size_t iterations = 1;
+        size_t items = 1;
+        double elapsed = RunCase(bc, iterations, &items);
+        while (elapsed < targetNs * 0.1 && iterations < (size_t(1) << 40))
+        {
+            iterations *= 2;
+            elapsed = RunCase(bc, iterations, &items);
+        }
+        iterations = Maximum<size_t>(1, size_t(iterations * (targetNs / Maximum(elapsed, 1.0))));
+        elapsed = RunCase(bc, iterations, &items);
+
+        double perIter = elapsed / double(iterations);
+        results.push_back({ fullName, iterations, items, perIter });
+        if (table){
+            printf("%-48s %14.3f %14.3f\n", fullName.c_str(), perIter, perIter / double(items));
+            fflush(stdout);
+        }
+    }
+
+    if (json){
+        FILE *file = jsonPath ? fopen(jsonPath, "w") : stdout;
+        if (!file){
+            fprintf(stderr, "cannot open %s\n", jsonPath);
+            return 1;
+        }
+        WriteJson(file, results);
+        if (file != stdout)
+            fclose(file);
+    }
+    return 0;
+}
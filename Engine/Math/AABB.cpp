@@ -0,0 +1,65 @@
+#include "AABB.h"
+#include "Matrix4.h"
+#include "Affine3.h"
+#include <float.h>
+#include <type_traits>
+
+namespace Canaan
+{
+    static_assert(std::is_trivially_copyable<AABB>::value, "AABB is copied freely by the bounds streams");
+
+    constexpr AABB AABB::EMPTY = AABB(Vec3(FLT_MAX), Vec3(-FLT_MAX));
+
+    void AABB::merge(const Vec3 &point)
+    {
+        min.x = Minimum(min.x, point.x);
+        min.y = Minimum(min.y, point.y);
+        min.z = Minimum(min.z, point.z);
+        max.x = Maximum(max.x, point.x);
+        max.y = Maximum(max.y, point.y);
+        max.z = Maximum(max.z, point.z);
+    }
+
+    void AABB::merge(const AABB &box)
+    {
+        min.x = Minimum(min.x, box.min.x);
+        min.y = Minimum(min.y, box.min.y);
+        min.z = Minimum(min.z, box.min.z);
+        max.x = Maximum(max.x, box.max.x);
+        max.y = Maximum(max.y, box.max.y);
+        max.z = Maximum(max.z, box.max.z);
+    }
+
+    // m is the top three rows of a row major matrix, row stride 4. Same
+    // operation order as the AABBStream kernel so both agree bit for bit.
+    static void ArvoTransform(const Real *m, AABB &box)
+    {
+        const Real *bMin = &box.min.x;
+        const Real *bMax = &box.max.x;
+        Real rMin[3], rMax[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            const Real *row = m + i * 4;
+            rMin[i] = rMax[i] = row[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                Real a = row[j] * bMin[j];
+                Real b = row[j] * bMax[j];
+                rMin[i] += Minimum(a, b);
+                rMax[i] += Maximum(a, b);
+            }
+        }
+        box.min = Vec3(rMin);
+        box.max = Vec3(rMax);
+    }
+
+    void AABB::transform(const Mat4 &mat)
+    {
+        ArvoTransform(mat[0], *this);
+    }
+
+    void AABB::transform(const Affine3 &mat)
+    {
+        ArvoTransform(mat[0], *this);
+    }
+}
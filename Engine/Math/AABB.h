@@ -0,0 +1,65 @@
+#ifndef _CN_AABB_
+#define _CN_AABB_
+#include "Prerequisites.h"
+#include "Vector3.h"
+
+namespace Canaan
+{
+    class Mat4;
+    class Affine3;
+    /*
+        Axis aligned box stored as its min and max corners. A box whose min
+        is greater than its max on any axis is empty; EMPTY is the identity
+        of merge.
+    */
+    class CN_EXPORT AABB
+    {
+    public:
+
+        static const AABB EMPTY;
+
+        constexpr AABB() : min(), max() {}
+        constexpr AABB(const Vec3 &min, const Vec3 &max) : min(min), max(max) {}
+
+        void set(const Vec3 &vMin, const Vec3 &vMax) { min = vMin; max = vMax; }
+        bool isEmpty() const { return max.x < min.x || max.y < min.y || max.z < min.z; }
+
+        Vec3 getCenter() const { return (min + max) * 0.5f; }
+        Vec3 getSize() const { return max - min; }
+        // half size
+        Vec3 getExtents() const { return (max - min) * 0.5f; }
+        // corner i has the max x when bit 0 of i is set, max y for bit 1 and max z for bit 2
+        Vec3 getCorner(size_t i) const { return Vec3(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z); }
+
+        void merge(const Vec3 &point);
+        void merge(const AABB &box);
+
+        bool contains(const Vec3 &point) const{
+            return min.x <= point.x && point.x <= max.x
+                && min.y <= point.y && point.y <= max.y
+                && min.z <= point.z && point.z <= max.z;
+        }
+
+        bool intersects(const AABB &box) const{
+            return min.x <= box.max.x && box.min.x <= max.x
+                && min.y <= box.max.y && box.min.y <= max.y
+                && min.z <= box.max.z && box.min.z <= max.z;
+        }
+
+        // Arvo's method: the tightest axis aligned box around the transformed box,
+        // computed from the matrix rows without transforming the eight corners.
+        // The Mat4 form ignores the bottom row, mat must be affine.
+        void transform(const Mat4 &mat);
+        void transform(const Affine3 &mat);
+
+        bool operator == (const AABB &rhs) const { return min == rhs.min && max == rhs.max; }
+        bool operator != (const AABB &rhs) const { return !(*this == rhs); }
+
+        Vec3 min;
+        Vec3 max;
+    };
+
+    typedef std::vector<AABB> AABBArray;
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "AABBStream.h"
+#include "Matrix4.h"
+#include "Affine3.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    // Arvo's method per lane, same operation order as AABB::transform
+    template<class S>
+    static size_t ArvoStreamKernel(const Real *m, const AABBStream &in, AABBStream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const Real *inMin[3] = { in.minX(), in.minY(), in.minZ() };
+        const Real *inMax[3] = { in.maxX(), in.maxY(), in.maxZ() };
+        Real *outMin[3] = { out.minX(), out.minY(), out.minZ() };
+        Real *outMax[3] = { out.maxX(), out.maxY(), out.maxZ() };
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V bMin[3], bMax[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                bMin[j] = S::load(inMin[j] + i);
+                bMax[j] = S::load(inMax[j] + i);
+            }
+            for (int r = 0; r < 3; ++r)
+            {
+                const Real *row = m + r * 4;
+                V rMin = S::set1(row[3]);
+                V rMax = rMin;
+                for (int j = 0; j < 3; ++j)
+                {
+                    V e = S::set1(row[j]);
+                    V a = S::mul(e, bMin[j]);
+                    V b = S::mul(e, bMax[j]);
+                    rMin = S::add(rMin, S::minimum(a, b));
+                    rMax = S::add(rMax, S::maximum(a, b));
+                }
+                S::store(outMin[r] + i, rMin);
+                S::store(outMax[r] + i, rMax);
+            }
+        }
+        return i;
+    }
+
+    static void ArvoStream(const Real *m, const AABBStream &in, AABBStream &out)
+    {
+        out.resize(in.size());
+        size_t i = ArvoStreamKernel<SimdOps>(m, in, out, 0, in.size());
+        ArvoStreamKernel<SimdOps1>(m, in, out, i, in.size());
+    }
+
+    AABBStream::AABBStream()
+    {
+
+    }
+
+    AABBStream::AABBStream(size_t count)
+    {
+        resize(count);
+    }
+
+    AABBStream::AABBStream(const AABBArray &array)
+    {
+        fromArray(array);
+    }
+
+    AABBStream::~AABBStream()
+    {
+
+    }
+
+    void AABBStream::resize(size_t count)
+    {
+        m_minX.resize(count);
+        m_minY.resize(count);
+        m_minZ.resize(count);
+        m_maxX.resize(count);
+        m_maxY.resize(count);
+        m_maxZ.resize(count);
+    }
+
+    void AABBStream::clear()
+    {
+        m_minX.clear();
+        m_minY.clear();
+        m_minZ.clear();
+        m_maxX.clear();
+        m_maxY.clear();
+        m_maxZ.clear();
+    }
+
+    void AABBStream::fromArray(const AABBArray &array)
+    {
+        resize(array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+            set(i, array[i]);
+    }
+
+    void AABBStream::toArray(AABBArray &array) const
+    {
+        array.resize(size());
+        for (size_t i = 0; i < array.size(); ++i)
+            array[i] = get(i);
+    }
+
+    void AABBStream::transform(const Mat4 &mat, AABBStream &out) const
+    {
+        ArvoStream(mat[0], *this, out);
+    }
+
+    void AABBStream::transform(const Affine3 &mat, AABBStream &out) const
+    {
+        ArvoStream(mat[0], *this, out);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef _CN_AABB_STREAM_
+#define _CN_AABB_STREAM_
+#include "Prerequisites.h"
+#include "AABB.h"
+
+namespace Canaan
+{
+    class Mat4;
+    class Affine3;
+    /*
+        Structure-of-arrays storage for AABB, one array per min and max
+        component, so Frustum and Ray can test a box per SIMD lane.
+    */
+    class CN_EXPORT AABBStream
+    {
+    public:
+
+        AABBStream();
+        explicit AABBStream(size_t count);
+        explicit AABBStream(const AABBArray &array);
+        ~AABBStream();
+
+        size_t size() const { return m_minX.size(); }
+        bool empty() const { return m_minX.empty(); }
+        void resize(size_t count);
+        void clear();
+
+        void fromArray(const AABBArray &array);
+        void toArray(AABBArray &array) const;
+
+        AABB get(size_t i) const { return AABB(Vec3(m_minX[i], m_minY[i], m_minZ[i]), Vec3(m_maxX[i], m_maxY[i], m_maxZ[i])); }
+        void set(size_t i, const AABB &box){
+            m_minX[i] = box.min.x; m_minY[i] = box.min.y; m_minZ[i] = box.min.z;
+            m_maxX[i] = box.max.x; m_maxY[i] = box.max.y; m_maxZ[i] = box.max.z;
+        }
+
+        Real* minX() { return m_minX.data(); }
+        Real* minY() { return m_minY.data(); }
+        Real* minZ() { return m_minZ.data(); }
+        Real* maxX() { return m_maxX.data(); }
+        Real* maxY() { return m_maxY.data(); }
+        Real* maxZ() { return m_maxZ.data(); }
+        const Real* minX() const { return m_minX.data(); }
+        const Real* minY() const { return m_minY.data(); }
+        const Real* minZ() const { return m_minZ.data(); }
+        const Real* maxX() const { return m_maxX.data(); }
+        const Real* maxY() const { return m_maxY.data(); }
+        const Real* maxZ() const { return m_maxZ.data(); }
+
+        // bulk AABB::transform, bit identical to it. out may be *this.
+        void transform(const Mat4 &mat, AABBStream &out) const;
+        void transform(const Affine3 &mat, AABBStream &out) const;
+
+    private:
+
+        std::vector<Real> m_minX;
+        std::vector<Real> m_minY;
+        std::vector<Real> m_minZ;
+        std::vector<Real> m_maxX;
+        std::vector<Real> m_maxY;
+        std::vector<Real> m_maxZ;
+    };
+}
+
+#endif
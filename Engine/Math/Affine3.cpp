@@ -0,0 +1,157 @@
+#include "Affine3.h"
+#include "Matrix4.h"
+#include "Matrix3.h"
+#include <type_traits>
+
+namespace Canaan
+{
+    static_assert(sizeof(Affine3) == 12 * sizeof(Real), "Affine3 must stay packed, bulk paths read it as 12 Reals");
+    static_assert(std::is_trivially_copyable<Affine3>::value, "Transform stores Affine3 by value and copies it freely");
+
+    constexpr Affine3 Affine3::IDENTITY = Affine3(1.0f, 0.0f, 0.0f, 0.0f
+                                             , 0.0f, 1.0f, 0.0f, 0.0f
+                                             , 0.0f, 0.0f, 1.0f, 0.0f);
+
+    Affine3::Affine3(const Mat4 &mat)
+    {
+        memcpy(m, mat[0], 4 * sizeof(Real));
+        memcpy(m[1], mat[1], 4 * sizeof(Real));
+        memcpy(m[2], mat[2], 4 * sizeof(Real));
+    }
+
+    void Affine3::identity()
+    {
+        *this = IDENTITY;
+    }
+
+    void Affine3::set(Real m00, Real m01, Real m02, Real m03
+        , Real m10, Real m11, Real m12, Real m13
+        , Real m20, Real m21, Real m22, Real m23)
+    {
+        m[0][0] = m00;
+        m[0][1] = m01;
+        m[0][2] = m02;
+        m[0][3] = m03;
+        m[1][0] = m10;
+        m[1][1] = m11;
+        m[1][2] = m12;
+        m[1][3] = m13;
+        m[2][0] = m20;
+        m[2][1] = m21;
+        m[2][2] = m22;
+        m[2][3] = m23;
+    }
+
+    void Affine3::makeTransform(const Vec3& position, const Vec3& scale, const Quat& orientation)
+    {
+        // same terms as Mat4::makeTransform so both produce identical matrices
+        Real fTx = orientation.x + orientation.x;
+        Real fTy = orientation.y + orientation.y;
+        Real fTz = orientation.z + orientation.z;
+        Real fTwx = fTx * orientation.w;
+        Real fTwy = fTy * orientation.w;
+        Real fTwz = fTz * orientation.w;
+        Real fTxx = fTx * orientation.x;
+        Real fTxy = fTy * orientation.x;
+        Real fTxz = fTz * orientation.x;
+        Real fTyy = fTy * orientation.y;
+        Real fTyz = fTz * orientation.y;
+        Real fTzz = fTz * orientation.z;
+
+        m[0][0] = scale.x * (1.0f - (fTyy + fTzz)); m[0][1] = scale.y * (fTxy - fTwz); m[0][2] = scale.z * (fTxz + fTwy); m[0][3] = position.x;
+        m[1][0] = scale.x * (fTxy + fTwz); m[1][1] = scale.y * (1.0f - (fTxx + fTzz)); m[1][2] = scale.z * (fTyz - fTwx); m[1][3] = position.y;
+        m[2][0] = scale.x * (fTxz - fTwy); m[2][1] = scale.y * (fTyz + fTwx); m[2][2] = scale.z * (1.0f - (fTxx + fTyy)); m[2][3] = position.z;
+    }
+
+    void Affine3::inverse()
+    {
+        Real m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+        Real m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+        Real m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+
+        Real c00 = m11 * m22 - m12 * m21;
+        Real c10 = m12 * m20 - m10 * m22;
+        Real c20 = m10 * m21 - m11 * m20;
+
+        Real invDet = 1.0f / (m00 * c00 + m01 * c10 + m02 * c20);
+
+        Real i00 = c00 * invDet;
+        Real i01 = (m02 * m21 - m01 * m22) * invDet;
+        Real i02 = (m01 * m12 - m02 * m11) * invDet;
+        Real i10 = c10 * invDet;
+        Real i11 = (m00 * m22 - m02 * m20) * invDet;
+        Real i12 = (m02 * m10 - m00 * m12) * invDet;
+        Real i20 = c20 * invDet;
+        Real i21 = (m01 * m20 - m00 * m21) * invDet;
+        Real i22 = (m00 * m11 - m01 * m10) * invDet;
+
+        Real tx = m[0][3], ty = m[1][3], tz = m[2][3];
+
+        m[0][0] = i00; m[0][1] = i01; m[0][2] = i02; m[0][3] = -(i00 * tx + i01 * ty + i02 * tz);
+        m[1][0] = i10; m[1][1] = i11; m[1][2] = i12; m[1][3] = -(i10 * tx + i11 * ty + i12 * tz);
+        m[2][0] = i20; m[2][1] = i21; m[2][2] = i22; m[2][3] = -(i20 * tx + i21 * ty + i22 * tz);
+    }
+
+    void Affine3::inverseTRS()
+    {
+        // columns of the 3x3 part are the scaled rotation axes, so
+        // (R * S)^-1 = S^-1 * R^T = transpose with each row divided by |col|^2
+        Real s0 = 1.0f / (m[0][0] * m[0][0] + m[1][0] * m[1][0] + m[2][0] * m[2][0]);
+        Real s1 = 1.0f / (m[0][1] * m[0][1] + m[1][1] * m[1][1] + m[2][1] * m[2][1]);
+        Real s2 = 1.0f / (m[0][2] * m[0][2] + m[1][2] * m[1][2] + m[2][2] * m[2][2]);
+
+        Real i00 = m[0][0] * s0, i01 = m[1][0] * s0, i02 = m[2][0] * s0;
+        Real i10 = m[0][1] * s1, i11 = m[1][1] * s1, i12 = m[2][1] * s1;
+        Real i20 = m[0][2] * s2, i21 = m[1][2] * s2, i22 = m[2][2] * s2;
+
+        Real tx = m[0][3], ty = m[1][3], tz = m[2][3];
+
+        m[0][0] = i00; m[0][1] = i01; m[0][2] = i02; m[0][3] = -(i00 * tx + i01 * ty + i02 * tz);
+        m[1][0] = i10; m[1][1] = i11; m[1][2] = i12; m[1][3] = -(i10 * tx + i11 * ty + i12 * tz);
+        m[2][0] = i20; m[2][1] = i21; m[2][2] = i22; m[2][3] = -(i20 * tx + i21 * ty + i22 * tz);
+    }
+
+    Real Affine3::determinant() const
+    {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+            - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+            + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+
+    Mat4 Affine3::toMat4() const
+    {
+        return Mat4(m[0][0], m[0][1], m[0][2], m[0][3]
+                    , m[1][0], m[1][1], m[1][2], m[1][3]
+                    , m[2][0], m[2][1], m[2][2], m[2][3]
+                    , 0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    Affine3 Affine3::transform(const Vec3& position, const Vec3& scale, const Quat& orientation)
+    {
+        Affine3 m;
+        m.makeTransform(position, scale, orientation);
+        return m;
+    }
+
+    void Affine3::decomposition(Vec3* position, Vec3* scale, Quat* orientation, bool handleShear) const
+    {
+        decomposition(this, position, scale, orientation, 1, handleShear);
+    }
+
+    void Affine3::decomposition(const Affine3* in, Vec3* positions, Vec3* scales, Quat* orientations, size_t count, bool handleShear)
+    {
+        AffineDecomposeBatch(reinterpret_cast<const Real*>(in), 12, reinterpret_cast<Real*>(positions), reinterpret_cast<Real*>(scales)
+            , reinterpret_cast<Real*>(orientations), count, handleShear);
+    }
+
+    void Affine3::normalMatrices(const Affine3* in, Mat3* out, size_t count, bool uniformScale)
+    {
+        NormalMatrixBatch(reinterpret_cast<const Real*>(in), 12, reinterpret_cast<Real*>(out), count, uniformScale);
+    }
+
+    void Affine3::transformPoints(const Vec3* in, Vec3* out, size_t count) const
+    {
+        // Mat4TransformAffinePoints only reads the top three rows
+        Mat4TransformAffinePoints(_m, reinterpret_cast<const Real*>(in), reinterpret_cast<Real*>(out), count);
+    }
+}
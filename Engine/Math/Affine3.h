@@ -0,0 +1,114 @@
+#ifndef _CN_AFFINE3_
+#define _CN_AFFINE3_
+#include "Prerequisites.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include "SIMD.h"
+
+/*
+	Affine transform stored as the top three rows of a Mat4, the bottom
+	row is implicitly (0, 0, 0, 1):
+	<pre>
+	[ m[0][0]  m[0][1]  m[0][2]  m[0][3] ]   {x}
+	| m[1][0]  m[1][1]  m[1][2]  m[1][3] | * {y}
+	| m[2][0]  m[2][1]  m[2][2]  m[2][3] |   {z}
+	[    0        0        0        1    ]   {1}
+	</pre>
+*/
+namespace Canaan
+{
+    class Mat4;
+    class Mat3;
+    class CN_EXPORT Affine3
+    {
+    public:
+
+        static const Affine3 IDENTITY;
+
+        Affine3() = default;
+        // drops the bottom row, mat must be affine
+        explicit Affine3(const Mat4 &mat);
+        constexpr Affine3(Real m00, Real m01, Real m02, Real m03,
+            Real m10, Real m11, Real m12, Real m13,
+            Real m20, Real m21, Real m22, Real m23)
+            : _m{ m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23 } {}
+
+        void identity();
+        void set(Real m00, Real m01, Real m02, Real m03,
+            Real m10, Real m11, Real m12, Real m13,
+            Real m20, Real m21, Real m22, Real m23);
+        void makeTransform(const Vec3& position, const Vec3& scale, const Quat& orientation);
+        // general affine inverse, handles shear
+        void inverse();
+        // inverse of a translate * rotate * scale matrix: the rotation is transposed and
+        // rescaled by the inverse squared column lengths instead of a full 3x3 inversion
+        void inverseTRS();
+        Real determinant() const;
+        Vec3 getTranslation() const { return Vec3(m[0][3], m[1][3], m[2][3]); }
+        Mat4 toMat4() const;
+
+        static Affine3 transform(const Vec3& position, const Vec3& scale, const Quat& orientation);
+
+        // see Mat4::decomposition(const Mat4*, ...), null outputs are skipped
+        void decomposition(Vec3* position, Vec3* scale, Quat* orientation, bool handleShear = true) const;
+        static void decomposition(const Affine3* in, Vec3* positions, Vec3* scales, Quat* orientations, size_t count, bool handleShear = true);
+        // see Mat4::normalMatrices
+        static void normalMatrices(const Affine3* in, Mat3* out, size_t count, bool uniformScale = false);
+
+        Vec3 transformDirection(const Vec3 &v) const{
+            return Vec3(
+                m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+        }
+
+        // bulk point transform, out may alias in
+        void transformPoints(const Vec3* in, Vec3* out, size_t count) const;
+
+        inline Affine3 operator * (const Affine3 &m2) const{
+            Affine3 r;
+            Affine3Multiply(_m, m2._m, r._m);
+            return r;
+        }
+
+        inline Vec3 operator * (const Vec3 &v) const{
+            return Vec3(
+                m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+                m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3],
+                m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3]);
+        }
+
+        inline Real* operator [] (size_t iRow){
+            cnAssert(iRow < 3);
+            return m[iRow];
+        }
+
+        inline const Real *operator [] (size_t iRow) const{
+            cnAssert(iRow < 3);
+            return m[iRow];
+        }
+
+        inline bool operator == (const Affine3& m2) const{
+            if (
+                m[0][0] != m2.m[0][0] || m[0][1] != m2.m[0][1] || m[0][2] != m2.m[0][2] || m[0][3] != m2.m[0][3] ||
+                m[1][0] != m2.m[1][0] || m[1][1] != m2.m[1][1] || m[1][2] != m2.m[1][2] || m[1][3] != m2.m[1][3] ||
+                m[2][0] != m2.m[2][0] || m[2][1] != m2.m[2][1] || m[2][2] != m2.m[2][2] || m[2][3] != m2.m[2][3])
+                return false;
+            return true;
+        }
+
+        inline bool operator != (const Affine3& m2) const{
+            return !operator==(m2);
+        }
+
+    private:
+
+        union {
+            Real m[3][4];
+            Real _m[12];
+        };
+    };
+    typedef std::vector<Affine3> Affine3Array;
+}
+
+#endif
@@ -0,0 +1,588 @@
+#include "Bounds.h"
+#include "Parallel.h"
+#include "SIMD.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+
+namespace Canaan
+{
+    // points per reduction block, partials are combined in block order
+    static const size_t BOUNDS_BLOCK = 4096;
+    // Ritter growth passes before the sphere settles for the farthest point distance
+    static const size_t SPHERE_MAX_PASSES = 16;
+    static const int MAX_DIRECTIONS = 7;
+
+    static const Real LANE_OFFSETS[8] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
+
+    // packed Vec3s
+    struct PackedPoints
+    {
+        const Real *xyz;
+
+        template<class S>
+        void load(size_t i, typename S::V &x, typename S::V &y, typename S::V &z) const { S::load3(xyz + i * 3, x, y, z); }
+        Vec3 get(size_t i) const { return Vec3(xyz + i * 3); }
+    };
+
+    struct StreamPoints
+    {
+        const Real *x, *y, *z;
+
+        template<class S>
+        void load(size_t i, typename S::V &vx, typename S::V &vy, typename S::V &vz) const { vx = S::load(x + i); vy = S::load(y + i); vz = S::load(z + i); }
+        Vec3 get(size_t i) const { return Vec3(x[i], y[i], z[i]); }
+    };
+
+    // EPOS-14: the axes and the four cube diagonals, unnormalized as only the
+    // order of the projections matters
+    struct EposDirections
+    {
+        enum { COUNT = 7 };
+
+        template<class S>
+        void project(typename S::V x, typename S::V y, typename S::V z, typename S::V *out) const
+        {
+            typename S::V sum = S::add(x, y), difference = S::sub(x, y);
+            out[0] = x;
+            out[1] = y;
+            out[2] = z;
+            out[3] = S::add(sum, z);
+            out[4] = S::sub(sum, z);
+            out[5] = S::add(difference, z);
+            out[6] = S::sub(difference, z);
+        }
+    };
+
+    struct AxisDirections
+    {
+        enum { COUNT = 3 };
+        Vec3 axis[3];
+
+        template<class S>
+        void project(typename S::V x, typename S::V y, typename S::V z, typename S::V *out) const
+        {
+            for (int k = 0; k < 3; ++k)
+                out[k] = S::add(S::add(S::mul(x, S::set1(axis[k].x)), S::mul(y, S::set1(axis[k].y))), S::mul(z, S::set1(axis[k].z)));
+        }
+    };
+
+    // smallest and largest projection on each direction with the lowest index reaching it
+    struct Extremes
+    {
+        Real minProjection[MAX_DIRECTIONS];
+        Real maxProjection[MAX_DIRECTIONS];
+        size_t minIndex[MAX_DIRECTIONS];
+        size_t maxIndex[MAX_DIRECTIONS];
+
+        void reset()
+        {
+            for (int k = 0; k < MAX_DIRECTIONS; ++k)
+            {
+                minProjection[k] = FLT_MAX;
+                maxProjection[k] = -FLT_MAX;
+                minIndex[k] = maxIndex[k] = SIZE_MAX;
+            }
+        }
+
+        void mergeMin(int k, Real projection, size_t index)
+        {
+            if (projection < minProjection[k] || (projection == minProjection[k] && index < minIndex[k]))
+            {
+                minProjection[k] = projection;
+                minIndex[k] = index;
+            }
+        }
+
+        void mergeMax(int k, Real projection, size_t index)
+        {
+            if (projection > maxProjection[k] || (projection == maxProjection[k] && index < maxIndex[k]))
+            {
+                maxProjection[k] = projection;
+                maxIndex[k] = index;
+            }
+        }
+    };
+
+    struct Farthest
+    {
+        Real sqDistance = -1.0f;
+        size_t index = SIZE_MAX;
+
+        void merge(Real d, size_t i)
+        {
+            if (d > sqDistance || (d == sqDistance && i < index))
+            {
+                sqDistance = d;
+                index = i;
+            }
+        }
+    };
+
+    // sums of d and of the products of d's components, d = point - shift
+    struct Moments
+    {
+        double sum[3];
+        // xx, xy, xz, yy, yz, zz
+        double products[6];
+    };
+
+    // func(begin, end, partial) per block of points, blocks spread over the workers
+    template<class T, class F>
+    static void ReduceBlocks(size_t count, std::vector<T> &partials, const F &func)
+    {
+        size_t blocks = (count + BOUNDS_BLOCK - 1) / BOUNDS_BLOCK;
+        partials.resize(blocks);
+        ParallelFor(blocks, 1, [&](size_t first, size_t last){
+            for (size_t b = first; b < last; ++b)
+                func(b * BOUNDS_BLOCK, Minimum((b + 1) * BOUNDS_BLOCK, count), partials[b]);
+        });
+    }
+
+    template<class S>
+    static inline typename S::V SquaredDistance(typename S::V dx, typename S::V dy, typename S::V dz)
+    {
+        return S::add(S::add(S::mul(dx, dx), S::mul(dy, dy)), S::mul(dz, dz));
+    }
+
+    // scalar form with the same operation order as the kernels
+    static Real SquaredDistance(const Vec3 &a, const Vec3 &b)
+    {
+        return SquaredDistance<SimdOps1>(a.x - b.x, a.y - b.y, a.z - b.z);
+    }
+
+    template<class S, class P>
+    static size_t AABBKernel(const P &points, size_t begin, size_t end, AABB &box)
+    {
+        typedef typename S::V V;
+        V lo[3] = { S::set1(box.min.x), S::set1(box.min.y), S::set1(box.min.z) };
+        V hi[3] = { S::set1(box.max.x), S::set1(box.max.y), S::set1(box.max.z) };
+        size_t i = begin;
+        for (; i + S::WIDTH <= end; i += S::WIDTH)
+        {
+            V p[3];
+            points.template load<S>(i, p[0], p[1], p[2]);
+            for (int k = 0; k < 3; ++k)
+            {
+                lo[k] = S::minimum(lo[k], p[k]);
+                hi[k] = S::maximum(hi[k], p[k]);
+            }
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            Real laneMin[S::WIDTH], laneMax[S::WIDTH];
+            S::store(laneMin, lo[k]);
+            S::store(laneMax, hi[k]);
+            for (int l = 0; l < S::WIDTH; ++l)
+            {
+                box.min[k] = Minimum(box.min[k], laneMin[l]);
+                box.max[k] = Maximum(box.max[k], laneMax[l]);
+            }
+        }
+        return i;
+    }
+
+    // lane indices are offsets from begin, exact in Real within a block
+    template<class S, class P, class D>
+    static size_t ExtremesKernel(const P &points, const D &directions, size_t begin, size_t end, Extremes &extremes)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        V lo[D::COUNT], hi[D::COUNT], loIndex[D::COUNT], hiIndex[D::COUNT];
+        for (int k = 0; k < D::COUNT; ++k)
+        {
+            lo[k] = S::set1(FLT_MAX);
+            hi[k] = S::set1(-FLT_MAX);
+            loIndex[k] = hiIndex[k] = S::set1(0.0f);
+        }
+        const V lanes = S::load(LANE_OFFSETS);
+        size_t i = begin;
+        for (; i + S::WIDTH <= end; i += S::WIDTH)
+        {
+            V x, y, z, projection[D::COUNT];
+            points.template load<S>(i, x, y, z);
+            directions.template project<S>(x, y, z, projection);
+            V index = S::add(S::set1(Real(i - begin)), lanes);
+            for (int k = 0; k < D::COUNT; ++k)
+            {
+                M below = S::cmpgt(lo[k], projection[k]);
+                M above = S::cmpgt(projection[k], hi[k]);
+                lo[k] = S::minimum(lo[k], projection[k]);
+                loIndex[k] = S::select(below, index, loIndex[k]);
+                hi[k] = S::maximum(hi[k], projection[k]);
+                hiIndex[k] = S::select(above, index, hiIndex[k]);
+            }
+        }
+        if (i == begin)
+            return i;
+        for (int k = 0; k < D::COUNT; ++k)
+        {
+            Real laneMin[S::WIDTH], laneMax[S::WIDTH], laneMinIndex[S::WIDTH], laneMaxIndex[S::WIDTH];
+            S::store(laneMin, lo[k]);
+            S::store(laneMax, hi[k]);
+            S::store(laneMinIndex, loIndex[k]);
+            S::store(laneMaxIndex, hiIndex[k]);
+            for (int l = 0; l < S::WIDTH; ++l)
+            {
+                extremes.mergeMin(k, laneMin[l], begin + size_t(laneMinIndex[l]));
+                extremes.mergeMax(k, laneMax[l], begin + size_t(laneMaxIndex[l]));
+            }
+        }
+        return i;
+    }
+
+    template<class S, class P>
+    static size_t FarthestKernel(const P &points, const Vec3 &center, size_t begin, size_t end, Farthest &farthest)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V cx = S::set1(center.x), cy = S::set1(center.y), cz = S::set1(center.z);
+        const V lanes = S::load(LANE_OFFSETS);
+        V best = S::set1(-1.0f), bestIndex = S::set1(0.0f);
+        size_t i = begin;
+        for (; i + S::WIDTH <= end; i += S::WIDTH)
+        {
+            V x, y, z;
+            points.template load<S>(i, x, y, z);
+            V d = SquaredDistance<S>(S::sub(x, cx), S::sub(y, cy), S::sub(z, cz));
+            M farther = S::cmpgt(d, best);
+            best = S::select(farther, d, best);
+            bestIndex = S::select(farther, S::add(S::set1(Real(i - begin)), lanes), bestIndex);
+        }
+        Real laneBest[S::WIDTH], laneIndex[S::WIDTH];
+        S::store(laneBest, best);
+        S::store(laneIndex, bestIndex);
+        for (int l = 0; l < S::WIDTH; ++l)
+        {
+            if (laneBest[l] >= 0.0f)
+                farthest.merge(laneBest[l], begin + size_t(laneIndex[l]));
+        }
+        return i;
+    }
+
+    template<class S, class P>
+    static size_t MomentsKernel(const P &points, const Vec3 &shift, size_t begin, size_t end, Moments &moments)
+    {
+        typedef typename S::V V;
+        const V sx = S::set1(shift.x), sy = S::set1(shift.y), sz = S::set1(shift.z);
+        V sum[3], products[6];
+        for (int k = 0; k < 3; ++k) sum[k] = S::set1(0.0f);
+        for (int k = 0; k < 6; ++k) products[k] = S::set1(0.0f);
+        size_t i = begin;
+        for (; i + S::WIDTH <= end; i += S::WIDTH)
+        {
+            V x, y, z;
+            points.template load<S>(i, x, y, z);
+            x = S::sub(x, sx);
+            y = S::sub(y, sy);
+            z = S::sub(z, sz);
+            sum[0] = S::add(sum[0], x);
+            sum[1] = S::add(sum[1], y);
+            sum[2] = S::add(sum[2], z);
+            products[0] = S::add(products[0], S::mul(x, x));
+            products[1] = S::add(products[1], S::mul(x, y));
+            products[2] = S::add(products[2], S::mul(x, z));
+            products[3] = S::add(products[3], S::mul(y, y));
+            products[4] = S::add(products[4], S::mul(y, z));
+            products[5] = S::add(products[5], S::mul(z, z));
+        }
+        Real lane[S::WIDTH];
+        for (int k = 0; k < 3; ++k)
+        {
+            S::store(lane, sum[k]);
+            for (int l = 0; l < S::WIDTH; ++l)
+                moments.sum[k] += lane[l];
+        }
+        for (int k = 0; k < 6; ++k)
+        {
+            S::store(lane, products[k]);
+            for (int l = 0; l < S::WIDTH; ++l)
+                moments.products[k] += lane[l];
+        }
+        return i;
+    }
+
+    template<class P>
+    static AABB ComputeAABB(const P &points, size_t count)
+    {
+        std::vector<AABB> partials;
+        ReduceBlocks(count, partials, [&](size_t begin, size_t end, AABB &box){
+            box = AABB::EMPTY;
+            size_t i = AABBKernel<SimdOps>(points, begin, end, box);
+            AABBKernel<SimdOps1>(points, i, end, box);
+        });
+        AABB box = AABB::EMPTY;
+        for (const AABB &partial : partials)
+            box.merge(partial);
+        return box;
+    }
+
+    template<class P, class D>
+    static Extremes FindExtremes(const P &points, size_t count, const D &directions)
+    {
+        std::vector<Extremes> partials;
+        ReduceBlocks(count, partials, [&](size_t begin, size_t end, Extremes &extremes){
+            extremes.reset();
+            size_t i = ExtremesKernel<SimdOps>(points, directions, begin, end, extremes);
+            ExtremesKernel<SimdOps1>(points, directions, i, end, extremes);
+        });
+        Extremes extremes;
+        extremes.reset();
+        for (const Extremes &partial : partials)
+        {
+            for (int k = 0; k < D::COUNT; ++k)
+            {
+                extremes.mergeMin(k, partial.minProjection[k], partial.minIndex[k]);
+                extremes.mergeMax(k, partial.maxProjection[k], partial.maxIndex[k]);
+            }
+        }
+        return extremes;
+    }
+
+    // partials keeps the farthest point of each block
+    template<class P>
+    static Farthest FindFarthest(const P &points, size_t count, const Vec3 &center, std::vector<Farthest> &partials)
+    {
+        ReduceBlocks(count, partials, [&](size_t begin, size_t end, Farthest &farthest){
+            farthest = Farthest();
+            size_t i = FarthestKernel<SimdOps>(points, center, begin, end, farthest);
+            FarthestKernel<SimdOps1>(points, center, i, end, farthest);
+        });
+        Farthest farthest;
+        for (const Farthest &partial : partials)
+            farthest.merge(partial.sqDistance, partial.index);
+        return farthest;
+    }
+
+    // Ritter step: moves the center towards point just enough to reach it.
+    // radiusSq is kept >= the kernel's squared distance of point so the next
+    // pass does not pick it again over a rounding difference.
+    static void GrowSphere(const Vec3 &point, Vec3 &center, Real &radius, Real &radiusSq)
+    {
+        Real sqDistance = SquaredDistance(point, center);
+        if (sqDistance <= radiusSq)
+            return;
+        Real distance = sqrt(sqDistance);
+        Real newRadius = (radius + distance) * 0.5f;
+        center += (point - center) * ((newRadius - radius) / distance);
+        radius = newRadius;
+        radiusSq = Maximum(radius * radius, SquaredDistance(point, center));
+    }
+
+    template<class P>
+    static Sphere ComputeSphere(const P &points, size_t count)
+    {
+        if (count == 0)
+            return Sphere();
+
+        Extremes extremes = FindExtremes(points, count, EposDirections());
+        Vec3 candidates[EposDirections::COUNT * 2];
+        for (int k = 0; k < EposDirections::COUNT; ++k)
+        {
+            candidates[k * 2] = points.get(extremes.minIndex[k]);
+            candidates[k * 2 + 1] = points.get(extremes.maxIndex[k]);
+        }
+
+        // farthest pair of extreme points as the initial diameter
+        int first = 0, second = 1;
+        Real widest = -1.0f;
+        for (int a = 0; a < EposDirections::COUNT * 2; ++a)
+        {
+            for (int b = a + 1; b < EposDirections::COUNT * 2; ++b)
+            {
+                Real d = SquaredDistance(candidates[a], candidates[b]);
+                if (d > widest)
+                {
+                    widest = d;
+                    first = a;
+                    second = b;
+                }
+            }
+        }
+        Vec3 center = (candidates[first] + candidates[second]) * 0.5f;
+        Real radiusSq = Maximum(SquaredDistance(candidates[first], center), SquaredDistance(candidates[second], center));
+        Real radius = sqrt(radiusSq);
+        for (int k = 0; k < EposDirections::COUNT * 2; ++k)
+            GrowSphere(candidates[k], center, radius, radiusSq);
+
+        // each pass grows towards the farthest point of every block in turn
+        std::vector<Farthest> partials;
+        Farthest farthest = FindFarthest(points, count, center, partials);
+        for (size_t pass = 0; pass < SPHERE_MAX_PASSES && farthest.sqDistance > radiusSq; ++pass)
+        {
+            GrowSphere(points.get(farthest.index), center, radius, radiusSq);
+            for (const Farthest &partial : partials)
+                GrowSphere(points.get(partial.index), center, radius, radiusSq);
+            farthest = FindFarthest(points, count, center, partials);
+        }
+
+        // the distance to the farthest point, rounded up so contains() holds for it
+        radius = sqrt(farthest.sqDistance);
+        if (radius * radius < farthest.sqDistance)
+            radius = nextafter(radius, Real(FLT_MAX));
+        return Sphere(center, radius);
+    }
+
+    // cyclic Jacobi rotations on the symmetric a, the columns of v become the eigenvectors
+    static void SymmetricEigen(double a[3][3], double v[3][3])
+    {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                v[i][j] = i == j ? 1.0 : 0.0;
+
+        for (int sweep = 0; sweep < 16; ++sweep)
+        {
+            double offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+            if (offDiagonal < 1e-30)
+                break;
+            for (int p = 0; p < 2; ++p)
+            {
+                for (int q = p + 1; q < 3; ++q)
+                {
+                    if (a[p][q] == 0.0)
+                        continue;
+                    double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                    double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                    double c = 1.0 / sqrt(t * t + 1.0);
+                    double s = t * c;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        double akp = a[k][p], akq = a[k][q];
+                        a[k][p] = c * akp - s * akq;
+                        a[k][q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        double apk = a[p][k], aqk = a[q][k];
+                        a[p][k] = c * apk - s * aqk;
+                        a[q][k] = s * apk + c * aqk;
+                    }
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        double vkp = v[k][p], vkq = v[k][q];
+                        v[k][p] = c * vkp - s * vkq;
+                        v[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    template<class P>
+    static OBB ComputeOBB(const P &points, size_t count)
+    {
+        if (count == 0)
+            return OBB();
+
+        // moments about the first point keep the covariance sums small
+        Vec3 shift = points.get(0);
+        std::vector<Moments> partials;
+        ReduceBlocks(count, partials, [&](size_t begin, size_t end, Moments &moments){
+            moments = Moments();
+            size_t i = MomentsKernel<SimdOps>(points, shift, begin, end, moments);
+            MomentsKernel<SimdOps1>(points, shift, i, end, moments);
+        });
+        Moments total = Moments();
+        for (const Moments &partial : partials)
+        {
+            for (int k = 0; k < 3; ++k) total.sum[k] += partial.sum[k];
+            for (int k = 0; k < 6; ++k) total.products[k] += partial.products[k];
+        }
+
+        double n = double(count);
+        double mean[3] = { total.sum[0] / n, total.sum[1] / n, total.sum[2] / n };
+        const int PRODUCT[3][3] = { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+        double covariance[3][3], eigenvectors[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                covariance[i][j] = total.products[PRODUCT[i][j]] / n - mean[i] * mean[j];
+        SymmetricEigen(covariance, eigenvectors);
+
+        // major axis first, the third is the cross product for a right handed frame
+        int order[3] = { 0, 1, 2 };
+        for (int i = 0; i < 2; ++i)
+            for (int j = i + 1; j < 3; ++j)
+                if (covariance[order[j]][order[j]] > covariance[order[i]][order[i]])
+                    std::swap(order[i], order[j]);
+        Vec3 axis[3];
+        for (int i = 0; i < 2; ++i)
+            axis[i] = Vec3(Real(eigenvectors[0][order[i]]), Real(eigenvectors[1][order[i]]), Real(eigenvectors[2][order[i]]));
+        axis[0].normalize();
+        axis[2] = axis[0].crossProduct(axis[1]);
+        axis[2].normalize();
+        axis[1] = axis[2].crossProduct(axis[0]);
+
+        AxisDirections directions = { { axis[0], axis[1], axis[2] } };
+        Extremes extremes = FindExtremes(points, count, directions);
+
+        OBB box;
+        box.center = Vec3::ZERO;
+        for (int i = 0; i < 3; ++i)
+        {
+            box.axis[i] = axis[i];
+            box.center += axis[i] * ((extremes.minProjection[i] + extremes.maxProjection[i]) * 0.5f);
+            box.extents[i] = (extremes.maxProjection[i] - extremes.minProjection[i]) * 0.5f;
+        }
+        return box;
+    }
+
+    AABB Bounds::computeAABB(const Vec3 *points, size_t count)
+    {
+        return ComputeAABB(PackedPoints{ reinterpret_cast<const Real*>(points) }, count);
+    }
+
+    AABB Bounds::computeAABB(const Vec3Stream &points)
+    {
+        return ComputeAABB(StreamPoints{ points.x(), points.y(), points.z() }, points.size());
+    }
+
+    Sphere Bounds::computeSphere(const Vec3 *points, size_t count)
+    {
+        return ComputeSphere(PackedPoints{ reinterpret_cast<const Real*>(points) }, count);
+    }
+
+    Sphere Bounds::computeSphere(const Vec3Stream &points)
+    {
+        return ComputeSphere(StreamPoints{ points.x(), points.y(), points.z() }, points.size());
+    }
+
+    OBB Bounds::computeOBB(const Vec3 *points, size_t count)
+    {
+        return ComputeOBB(PackedPoints{ reinterpret_cast<const Real*>(points) }, count);
+    }
+
+    OBB Bounds::computeOBB(const Vec3Stream &points)
+    {
+        return ComputeOBB(StreamPoints{ points.x(), points.y(), points.z() }, points.size());
+    }
+
+    AABB Bounds::merge(const AABB *boxes, size_t count)
+    {
+        std::vector<AABB> partials;
+        ReduceBlocks(count, partials, [&](size_t begin, size_t end, AABB &box){
+            box = AABB::EMPTY;
+            for (size_t i = begin; i < end; ++i)
+                box.merge(boxes[i]);
+        });
+        AABB box = AABB::EMPTY;
+        for (const AABB &partial : partials)
+            box.merge(partial);
+        return box;
+    }
+
+    Sphere Bounds::merge(const Sphere *spheres, size_t count)
+    {
+        if (count == 0)
+            return Sphere();
+        std::vector<Sphere> partials;
+        ReduceBlocks(count, partials, [&](size_t begin, size_t end, Sphere &sphere){
+            sphere = spheres[begin];
+            for (size_t i = begin + 1; i < end; ++i)
+                sphere.merge(spheres[i]);
+        });
+        Sphere sphere = partials[0];
+        for (size_t i = 1; i < partials.size(); ++i)
+            sphere.merge(partials[i]);
+        return sphere;
+    }
+}
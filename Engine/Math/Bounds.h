@@ -0,0 +1,51 @@
+#ifndef _CN_BOUNDS_
+#define _CN_BOUNDS_
+#include "Prerequisites.h"
+#include "AABB.h"
+#include "Sphere.h"
+#include "OBB.h"
+#include "Vector3Stream.h"
+
+namespace Canaan
+{
+    /*
+        Bounding volumes fitted to point sets and merged from other bounds,
+        vectorized across points and split over the worker threads
+        (Parallel.h) for large inputs. Points are reduced in fixed blocks
+        whose partials are combined in order, so the results do not depend
+        on the number of threads.
+
+        - computeAABB: the exact box.
+        - computeSphere: EPOS-14, the farthest pair among the extreme points
+          along the axes and the cube diagonals starts the sphere, then
+          Ritter growth towards the farthest point until every point is
+          inside. The radius is the distance to the farthest point from the
+          final center, so the sphere always encloses the points; it is
+          typically within a few percent of the minimal one.
+        - computeOBB: axes from the eigenvectors of the point covariance,
+          major axis first, extents from the projections on those axes
+          (exact up to the rounding of the center).
+
+        Empty inputs give AABB::EMPTY, Sphere() and OBB().
+    */
+    class CN_EXPORT Bounds
+    {
+    public:
+
+        static AABB computeAABB(const Vec3 *points, size_t count);
+        static AABB computeAABB(const Vec3Stream &points);
+
+        static Sphere computeSphere(const Vec3 *points, size_t count);
+        static Sphere computeSphere(const Vec3Stream &points);
+
+        static OBB computeOBB(const Vec3 *points, size_t count);
+        static OBB computeOBB(const Vec3Stream &points);
+
+        // empty boxes are the identity
+        static AABB merge(const AABB *boxes, size_t count);
+        // pairwise Sphere::merge, in order within each block
+        static Sphere merge(const Sphere *spheres, size_t count);
+    };
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "DualQuaternion.h"
+#include "Matrix4.h"
+#include "Affine3.h"
+#include <type_traits>
+
+namespace Canaan
+{
+    static_assert(std::is_trivially_copyable<DualQuat>::value, "DualQuat palettes are read as packed Reals by the skinning kernels");
+    static_assert(sizeof(DualQuat) == 8 * sizeof(Real), "DualQuat is (real w, x, y, z, dual w, x, y, z)");
+
+    constexpr DualQuat DualQuat::ZERO = DualQuat(Quat(0.0f, 0.0f, 0.0f, 0.0f), Quat(0.0f, 0.0f, 0.0f, 0.0f));
+    constexpr DualQuat DualQuat::IDENTITY = DualQuat();
+
+    DualQuat::DualQuat(const Quat &rotation, const Vec3 &translation)
+    {
+        set(rotation, translation);
+    }
+
+    DualQuat::DualQuat(const Mat4 &mat)
+    {
+        fromMatrices(&mat, this, 1);
+    }
+
+    DualQuat::DualQuat(const Affine3 &mat)
+    {
+        fromMatrices(&mat, this, 1);
+    }
+
+    void DualQuat::set(const Quat &rotation, const Vec3 &translation)
+    {
+        real = rotation;
+        dual = Quat(0.0f, 0.5f * translation.x, 0.5f * translation.y, 0.5f * translation.z) * rotation;
+    }
+
+    Vec3 DualQuat::getTranslation() const
+    {
+        // vector part of 2 * dual * conjugate(real)
+        Vec3 r(real.x, real.y, real.z);
+        Vec3 d(dual.x, dual.y, dual.z);
+        return (d * real.w - r * dual.w + r.crossProduct(d)) * 2.0f;
+    }
+
+    Real DualQuat::normalize()
+    {
+        Real len = real.normLength();
+        Real factor = 1.0f / sqrt(len);
+        real = real * factor;
+        dual = dual * factor;
+        return len;
+    }
+
+    void DualQuat::unitInverse()
+    {
+        real.unitInverse();
+        dual.unitInverse();
+    }
+
+    Vec3 DualQuat::transformPoint(const Vec3 &v) const
+    {
+        return real * v + getTranslation();
+    }
+
+    DualQuat DualQuat::blend(const DualQuat *dqs, const Real *weights, size_t count)
+    {
+        if (count == 0)
+            return IDENTITY;
+        DualQuat sum = ZERO;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Real weight = dqs[i].dot(dqs[0]) < 0.0f ? -weights[i] : weights[i];
+            sum = sum + dqs[i] * weight;
+        }
+        sum.normalize();
+        return sum;
+    }
+
+    static void FromDecomposition(const Vec3 *positions, const Quat *orientations, DualQuat *out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i].set(orientations[i], positions[i]);
+    }
+
+    void DualQuat::fromMatrices(const Mat4 *in, DualQuat *out, size_t count)
+    {
+        Vec3Array positions(count);
+        QuatArray orientations(count);
+        Mat4::decomposition(in, positions.data(), nullptr, orientations.data(), count, false);
+        FromDecomposition(positions.data(), orientations.data(), out, count);
+    }
+
+    void DualQuat::fromMatrices(const Affine3 *in, DualQuat *out, size_t count)
+    {
+        Vec3Array positions(count);
+        QuatArray orientations(count);
+        Affine3::decomposition(in, positions.data(), nullptr, orientations.data(), count, false);
+        FromDecomposition(positions.data(), orientations.data(), out, count);
+    }
+}
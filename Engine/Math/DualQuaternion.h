@@ -0,0 +1,88 @@
+#ifndef _CN_DUAL_QUATERNION_
+#define _CN_DUAL_QUATERNION_
+#include "Prerequisites.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+namespace Canaan
+{
+    class Mat4;
+    class Affine3;
+
+    /*
+        Rigid transform as a unit dual quaternion real + eps * dual, with
+        real the rotation and dual = 0.5 * (0, t) * real for translation t.
+        Eight Reals against twelve for an Affine3, and blends of several
+        of them (blend, the skinning kernels) stay rigid, which is what
+        dual quaternion skinning relies on.
+
+        Scale and shear are not representable: conversions from matrices
+        keep only the rotation and translation.
+    */
+    class CN_EXPORT DualQuat
+    {
+    public:
+
+        static const DualQuat ZERO;
+        static const DualQuat IDENTITY;
+
+        constexpr DualQuat() : real(), dual(0.0f, 0.0f, 0.0f, 0.0f) {}
+        constexpr DualQuat(const Quat &real, const Quat &dual) : real(real), dual(dual) {}
+        // rotation then translation, rotation must be unit length
+        DualQuat(const Quat &rotation, const Vec3 &translation);
+        explicit DualQuat(const Mat4 &mat);
+        explicit DualQuat(const Affine3 &mat);
+
+        void set(const Quat &rotation, const Vec3 &translation);
+        Quat getRotation() const { return real; }
+        Vec3 getTranslation() const;
+
+        // scales both parts by 1 / |real| and returns |real|^2, as Quat::normalize
+        Real normalize();
+        // inverse of a unit dual quaternion
+        void unitInverse();
+        Real dot(const DualQuat &dq) const { return real.dot(dq.real); }
+
+        Vec3 transformPoint(const Vec3 &v) const;
+        Vec3 transformDirection(const Vec3 &v) const { return real * v; }
+
+        // dual quaternion linear blending: the weighted sum of dqs, each
+        // flipped to the hemisphere of dqs[0], normalized
+        static DualQuat blend(const DualQuat *dqs, const Real *weights, size_t count);
+        // bulk conversion, rotation and translation of each matrix (Mat4::decomposition
+        // with handleShear = false)
+        static void fromMatrices(const Mat4 *in, DualQuat *out, size_t count);
+        static void fromMatrices(const Affine3 *in, DualQuat *out, size_t count);
+
+        // a * b applies b first, like Mat4 and Quat
+        DualQuat operator* (const DualQuat &dq) const{
+            return DualQuat(real * dq.real, real * dq.dual + dual * dq.real);
+        }
+
+        DualQuat operator+ (const DualQuat &dq) const{
+            return DualQuat(real + dq.real, dual + dq.dual);
+        }
+
+        DualQuat operator* (Real fScalar) const{
+            return DualQuat(real * fScalar, dual * fScalar);
+        }
+
+        DualQuat operator- () const{
+            return DualQuat(-real, -dual);
+        }
+
+        inline bool operator== (const DualQuat &rhs) const{
+            return real == rhs.real && dual == rhs.dual;
+        }
+
+        inline bool operator!= (const DualQuat &rhs) const{
+            return !operator==(rhs);
+        }
+
+        Quat real;
+        Quat dual;
+    };
+
+    typedef std::vector<DualQuat> DualQuatArray;
+}
+#endif
@@ -0,0 +1,166 @@
+#include "Frustum.h"
+#include "Matrix4.h"
+#include "AABBStream.h"
+#include "SphereStream.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    // Per lane forms of intersects(AABB) and intersects(Sphere), same operation
+    // order as the scalar tests so both agree on boundary cases.
+    template<class S>
+    static size_t FrustumAABBKernel(const Vec4 *planes, const AABBStream &boxes, uint8_t *out, size_t begin, size_t count, size_t &hits)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V zero = S::set1(0.0f);
+        const V half = S::set1(0.5f);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V minX = S::load(boxes.minX() + i), minY = S::load(boxes.minY() + i), minZ = S::load(boxes.minZ() + i);
+            V maxX = S::load(boxes.maxX() + i), maxY = S::load(boxes.maxY() + i), maxZ = S::load(boxes.maxZ() + i);
+            V cx = S::mul(S::add(minX, maxX), half), cy = S::mul(S::add(minY, maxY), half), cz = S::mul(S::add(minZ, maxZ), half);
+            V ex = S::mul(S::sub(maxX, minX), half), ey = S::mul(S::sub(maxY, minY), half), ez = S::mul(S::sub(maxZ, minZ), half);
+
+            M inside = S::cmpge(zero, zero);
+            for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+            {
+                const Vec4 &pl = planes[p];
+                V dist = S::add(S::add(S::add(S::mul(S::set1(pl.x), cx), S::mul(S::set1(pl.y), cy)), S::mul(S::set1(pl.z), cz)), S::set1(pl.w));
+                V radius = S::add(S::add(S::mul(S::set1(fabs(pl.x)), ex), S::mul(S::set1(fabs(pl.y)), ey)), S::mul(S::set1(fabs(pl.z)), ez));
+                inside = S::maskAnd(inside, S::cmpge(S::add(dist, radius), zero));
+            }
+            hits += SimdStoreMask<S>(inside, out + i);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t FrustumSphereKernel(const Vec4 *planes, const SphereStream &spheres, uint8_t *out, size_t begin, size_t count, size_t &hits)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V zero = S::set1(0.0f);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V cx = S::load(spheres.x() + i), cy = S::load(spheres.y() + i), cz = S::load(spheres.z() + i);
+            V r = S::load(spheres.radius() + i);
+
+            M inside = S::cmpge(zero, zero);
+            for (int p = 0; p < Frustum::PLANE_COUNT; ++p)
+            {
+                const Vec4 &pl = planes[p];
+                V dist = S::add(S::add(S::add(S::mul(S::set1(pl.x), cx), S::mul(S::set1(pl.y), cy)), S::mul(S::set1(pl.z), cz)), S::set1(pl.w));
+                inside = S::maskAnd(inside, S::cmpge(S::add(dist, r), zero));
+            }
+            hits += SimdStoreMask<S>(inside, out + i);
+        }
+        return i;
+    }
+
+    static inline Real PlaneDistance(const Vec4 &plane, const Vec3 &p)
+    {
+        return plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w;
+    }
+
+    Frustum::Frustum(const Mat4 &viewProj)
+    {
+        set(viewProj);
+    }
+
+    void Frustum::set(const Mat4 &viewProj)
+    {
+        const Real *r0 = viewProj[0];
+        const Real *r1 = viewProj[1];
+        const Real *r2 = viewProj[2];
+        const Real *r3 = viewProj[3];
+        m_planes[PLANE_LEFT]   = Vec4(r3[0] + r0[0], r3[1] + r0[1], r3[2] + r0[2], r3[3] + r0[3]);
+        m_planes[PLANE_RIGHT]  = Vec4(r3[0] - r0[0], r3[1] - r0[1], r3[2] - r0[2], r3[3] - r0[3]);
+        m_planes[PLANE_BOTTOM] = Vec4(r3[0] + r1[0], r3[1] + r1[1], r3[2] + r1[2], r3[3] + r1[3]);
+        m_planes[PLANE_TOP]    = Vec4(r3[0] - r1[0], r3[1] - r1[1], r3[2] - r1[2], r3[3] - r1[3]);
+        m_planes[PLANE_NEAR]   = Vec4(r3[0] + r2[0], r3[1] + r2[1], r3[2] + r2[2], r3[3] + r2[3]);
+        m_planes[PLANE_FAR]    = Vec4(r3[0] - r2[0], r3[1] - r2[1], r3[2] - r2[2], r3[3] - r2[3]);
+
+        for (int i = 0; i < PLANE_COUNT; ++i)
+        {
+            Vec4 &p = m_planes[i];
+            Real len = sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+            if (len > 0.0f){
+                Real fInvLength = 1.0f / len;
+                p.x *= fInvLength;
+                p.y *= fInvLength;
+                p.z *= fInvLength;
+                p.w *= fInvLength;
+            }
+        }
+    }
+
+    bool Frustum::contains(const Vec3 &point) const
+    {
+        for (int i = 0; i < PLANE_COUNT; ++i)
+        {
+            if (PlaneDistance(m_planes[i], point) < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersects(const AABB &box) const
+    {
+        Vec3 c((box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, (box.min.z + box.max.z) * 0.5f);
+        Vec3 e((box.max.x - box.min.x) * 0.5f, (box.max.y - box.min.y) * 0.5f, (box.max.z - box.min.z) * 0.5f);
+        for (int i = 0; i < PLANE_COUNT; ++i)
+        {
+            const Vec4 &p = m_planes[i];
+            Real radius = fabs(p.x) * e.x + fabs(p.y) * e.y + fabs(p.z) * e.z;
+            if (!(PlaneDistance(p, c) + radius >= 0.0f))
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersects(const Sphere &sphere) const
+    {
+        for (int i = 0; i < PLANE_COUNT; ++i)
+        {
+            if (!(PlaneDistance(m_planes[i], sphere.center) + sphere.radius >= 0.0f))
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersects(const OBB &box) const
+    {
+        for (int i = 0; i < PLANE_COUNT; ++i)
+        {
+            const Vec4 &p = m_planes[i];
+            Vec3 n(p.x, p.y, p.z);
+            Real radius = fabs(n.dotProduct(box.axis[0])) * box.extents.x
+                        + fabs(n.dotProduct(box.axis[1])) * box.extents.y
+                        + fabs(n.dotProduct(box.axis[2])) * box.extents.z;
+            if (!(PlaneDistance(p, box.center) + radius >= 0.0f))
+                return false;
+        }
+        return true;
+    }
+
+    size_t Frustum::intersects(const AABBStream &boxes, uint8_t *out) const
+    {
+        size_t hits = 0;
+        size_t i = FrustumAABBKernel<SimdOps>(m_planes, boxes, out, 0, boxes.size(), hits);
+        FrustumAABBKernel<SimdOps1>(m_planes, boxes, out, i, boxes.size(), hits);
+        return hits;
+    }
+
+    size_t Frustum::intersects(const SphereStream &spheres, uint8_t *out) const
+    {
+        size_t hits = 0;
+        size_t i = FrustumSphereKernel<SimdOps>(m_planes, spheres, out, 0, spheres.size(), hits);
+        FrustumSphereKernel<SimdOps1>(m_planes, spheres, out, i, spheres.size(), hits);
+        return hits;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef _CN_FRUSTUM_
+#define _CN_FRUSTUM_
+#include "Prerequisites.h"
+#include "Vector4.h"
+#include "AABB.h"
+#include "Sphere.h"
+#include "OBB.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    class Mat4;
+    class AABBStream;
+    class SphereStream;
+    /*
+        Six planes extracted from a view projection matrix (Gribb and
+        Hartmann). Each plane is stored as (normal, d), normalized, with the
+        normal pointing inside: a point p is inside when
+        normal.dotProduct(p) + d >= 0 for every plane.
+
+        The matrix is projection * view in the M * V convention of Mat4 and
+        the OpenGL clip volume -w <= x, y, z <= w, e.g.
+
+            Mat4 view = Mat4::lookAt(eye, center, up);
+            view.inverse(); // lookAt builds the camera's world matrix
+            Frustum frustum(Mat4::perspective(fovy, aspect, zNear, zFar) * view);
+
+        The box and sphere tests are conservative: a volume reported as
+        intersecting may lie just outside near the frustum corners, a volume
+        reported as outside never touches the frustum.
+    */
+    class CN_EXPORT Frustum
+    {
+    public:
+
+        enum Plane
+        {
+            PLANE_LEFT,
+            PLANE_RIGHT,
+            PLANE_BOTTOM,
+            PLANE_TOP,
+            PLANE_NEAR,
+            PLANE_FAR,
+            PLANE_COUNT,
+        };
+
+        Frustum() = default;
+        explicit Frustum(const Mat4 &viewProj);
+
+        void set(const Mat4 &viewProj);
+        const Vec4& getPlane(Plane plane) const { return m_planes[plane]; }
+
+        bool contains(const Vec3 &point) const;
+        bool intersects(const AABB &box) const;
+        bool intersects(const Sphere &sphere) const;
+        bool intersects(const OBB &box) const;
+
+        // Bulk forms of intersects, one box or sphere per SIMD lane. out[i] is
+        // set to 1 when element i intersects and 0 otherwise, the results equal
+        // the single element tests. Returns the number of intersecting elements.
+        size_t intersects(const AABBStream &boxes, uint8_t *out) const;
+        size_t intersects(const SphereStream &spheres, uint8_t *out) const;
+
+    private:
+
+        Vec4 m_planes[PLANE_COUNT];
+    };
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "IK.h"
+#include "Parallel.h"
+
+namespace Canaan
+{
+    // smallest chain range handed to a worker thread
+    static const size_t IK_GRAIN = 64;
+    static const Real IK_EPSILON = 1e-6f;
+
+    // shortest arc taking direction from onto direction to, opposite
+    // directions turn half way about flipAxis
+    static Quat RotationBetween(Vec3 from, Vec3 to, const Vec3 &flipAxis)
+    {
+        if (from.normalize() <= IK_EPSILON || to.normalize() <= IK_EPSILON)
+            return Quat::IDENTITY;
+        // half way quaternion, unnormalized
+        Vec3 c = from.crossProduct(to);
+        Quat rot(1.0f + from.dotProduct(to), c.x, c.y, c.z);
+        if (rot.normLength() <= IK_EPSILON * IK_EPSILON)
+            return Quat(PI, flipAxis);
+        rot.normalize();
+        return rot;
+    }
+
+    static Quat RotationBetween(const Vec3 &from, const Vec3 &to)
+    {
+        Vec3 axis(from);
+        return RotationBetween(from, to, axis.perpendicular());
+    }
+
+    // turns joints [begin, end) by rot about pivot, orientations included
+    static void RotateJoints(const Quat &rot, Vec3 pivot, Vec3 *positions, Quat *orientations, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            positions[i] = pivot + rot * (positions[i] - pivot);
+            orientations[i] = rot * orientations[i];
+        }
+    }
+
+    static void SolveTwoBone(const IKChain &chain, Vec3 *positions, Quat *orientations)
+    {
+        cnAssert(chain.count == 3);
+        Vec3 &a = positions[0], &b = positions[1], &c = positions[2];
+        Real lab = a.distance(b), lbc = b.distance(c);
+        Vec3 u = chain.target - a;
+        Real lat = u.normalize();
+        if (lab <= IK_EPSILON || lbc <= IK_EPSILON || lat <= IK_EPSILON)
+            return;
+        lat = std::min(std::max(lat, std::abs(lab - lbc)), lab + lbc);
+
+        // bend direction, perpendicular to the root-target line
+        Vec3 w = chain.pole == Vec3::ZERO ? b - a : chain.pole;
+        w -= u * u.dotProduct(w);
+        if (w.normalize() <= IK_EPSILON)
+        {
+            w = b - a;
+            w -= u * u.dotProduct(w);
+            if (w.normalize() <= IK_EPSILON)
+                w = u.perpendicular();
+        }
+
+        Real cosA = std::min(std::max((lab * lab + lat * lat - lbc * lbc) / (2.0f * lab * lat), Real(-1.0f)), Real(1.0f));
+        Real sinA = sqrt(std::max(1.0f - cosA * cosA, Real(0.0f)));
+        Vec3 newB = a + (u * cosA + w * sinA) * lab;
+        Vec3 newC = a + u * lat;
+
+        // swing the upper bone onto the new one, then twist it about itself
+        // so the old bend plane lands on the new one
+        Vec3 boneDir = newB - a;
+        boneDir.normalize();
+        Quat rootRot = RotationBetween(b - a, newB - a);
+        Vec3 oldNormal = rootRot * (b - a).crossProduct(c - b);
+        Vec3 newNormal = (newB - a).crossProduct(newC - newB);
+        Real minNormal = IK_EPSILON * lab * lab * lbc * lbc;
+        if (oldNormal.squaredLength() > minNormal && newNormal.squaredLength() > minNormal)
+            rootRot = RotationBetween(oldNormal, newNormal, boneDir) * rootRot;
+        RotateJoints(rootRot, a, positions, orientations, 0, 3);
+
+        // the lower bone now lies in the bend plane and only hinges
+        Vec3 hingeAxis = newNormal.squaredLength() > 0.0f ? newNormal : boneDir.perpendicular();
+        Quat midRot = RotationBetween(c - b, newC - b, hingeAxis);
+        RotateJoints(midRot, b, positions, orientations, 1, 3);
+
+        b = newB;
+        c = newC;
+        for (size_t i = 0; i < 3; ++i)
+            orientations[i].normalize();
+    }
+
+    static void SolveCCD(const IKChain &chain, Vec3 *positions, Quat *orientations, int maxIterations, Real tolerance)
+    {
+        size_t count = chain.count;
+        if (count < 2)
+            return;
+        Vec3 &effector = positions[count - 1];
+        for (int iteration = 0; iteration < maxIterations; ++iteration)
+        {
+            if (effector.squaredDistance(chain.target) <= tolerance * tolerance)
+                break;
+            for (size_t j = count - 1; j-- > 0;)
+            {
+                Quat rot = RotationBetween(effector - positions[j], chain.target - positions[j]);
+                RotateJoints(rot, positions[j], positions, orientations, j, count);
+            }
+        }
+        for (size_t i = 0; i < count; ++i)
+            orientations[i].normalize();
+    }
+
+    static void SolveFABRIK(const IKChain &chain, Vec3 *positions, Quat *orientations, int maxIterations, Real tolerance,
+        std::vector<Vec3> &original, std::vector<Real> &lengths)
+    {
+        size_t count = chain.count;
+        if (count < 2)
+            return;
+        original.assign(positions, positions + count);
+        lengths.resize(count - 1);
+        Real total = 0.0f;
+        for (size_t i = 0; i + 1 < count; ++i)
+        {
+            lengths[i] = positions[i].distance(positions[i + 1]);
+            total += lengths[i];
+        }
+
+        const Vec3 root = positions[0];
+        if (root.squaredDistance(chain.target) >= total * total)
+        {
+            // out of reach, straighten towards the target
+            for (size_t i = 0; i + 1 < count; ++i)
+            {
+                Vec3 dir = chain.target - positions[i];
+                dir.normalize();
+                positions[i + 1] = positions[i] + dir * lengths[i];
+            }
+        }
+        else
+        {
+            for (int iteration = 0; iteration < maxIterations; ++iteration)
+            {
+                if (positions[count - 1].squaredDistance(chain.target) <= tolerance * tolerance)
+                    break;
+                positions[count - 1] = chain.target;
+                for (size_t i = count - 1; i-- > 0;)
+                {
+                    Vec3 dir = positions[i] - positions[i + 1];
+                    dir.normalize();
+                    positions[i] = positions[i + 1] + dir * lengths[i];
+                }
+                positions[0] = root;
+                for (size_t i = 0; i + 1 < count; ++i)
+                {
+                    Vec3 dir = positions[i + 1] - positions[i];
+                    dir.normalize();
+                    positions[i + 1] = positions[i] + dir * lengths[i];
+                }
+            }
+        }
+
+        // each joint turns with its parent, then swings its bone onto the new one
+        Quat rot = Quat::IDENTITY;
+        for (size_t i = 0; i + 1 < count; ++i)
+        {
+            rot = RotationBetween(rot * (original[i + 1] - original[i]), positions[i + 1] - positions[i]) * rot;
+            rot.normalize();
+            orientations[i] = rot * orientations[i];
+            orientations[i].normalize();
+        }
+        orientations[count - 1] = rot * orientations[count - 1];
+        orientations[count - 1].normalize();
+    }
+
+    void IK::solveTwoBone(const IKChain *chains, size_t chainCount, Vec3 *positions, Quat *orientations)
+    {
+        ParallelFor(chainCount, IK_GRAIN, [&](size_t begin, size_t end){
+            for (size_t i = begin; i < end; ++i)
+                SolveTwoBone(chains[i], positions + chains[i].first, orientations + chains[i].first);
+        });
+    }
+
+    void IK::solveCCD(const IKChain *chains, size_t chainCount, Vec3 *positions, Quat *orientations, int maxIterations, Real tolerance)
+    {
+        ParallelFor(chainCount, IK_GRAIN, [&](size_t begin, size_t end){
+            for (size_t i = begin; i < end; ++i)
+                SolveCCD(chains[i], positions + chains[i].first, orientations + chains[i].first, maxIterations, tolerance);
+        });
+    }
+
+    void IK::solveFABRIK(const IKChain *chains, size_t chainCount, Vec3 *positions, Quat *orientations, int maxIterations, Real tolerance)
+    {
+        ParallelFor(chainCount, IK_GRAIN, [&](size_t begin, size_t end){
+            std::vector<Vec3> original;
+            std::vector<Real> lengths;
+            for (size_t i = begin; i < end; ++i)
+                SolveFABRIK(chains[i], positions + chains[i].first, orientations + chains[i].first, maxIterations, tolerance, original, lengths);
+        });
+    }
+}
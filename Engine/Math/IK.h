@@ -0,0 +1,55 @@
+#ifndef _CN_IK_
+#define _CN_IK_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    // joints [first, first + count) of the packed joint arrays, root first,
+    // the last joint is the end effector
+    struct IKChain
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+        Vec3 target;
+        // two bone chains bend the middle joint towards this direction,
+        // Vec3::ZERO keeps the current bend plane
+        Vec3 pole;
+    };
+    typedef std::vector<IKChain> IKChainArray;
+
+    /*
+        Inverse kinematics on packed joint arrays: world positions and world
+        orientations of every joint of many chains, e.g. from
+        Transform::getWorldPoses. The solvers move the joints in place, bone
+        lengths are kept and each joint's orientation turns with its bone,
+        so the results go back to the hierarchy with one
+        Transform::setWorldOrientations call.
+
+        - solveTwoBone: chains of 3 joints, solved analytically. The middle
+          joint only hinges about the bend plane normal; unreachable targets
+          straighten the chain towards them.
+        - solveCCD: cyclic coordinate descent, each sweep turns the joints
+          from the end effector up so the effector points at the target.
+        - solveFABRIK: forward and backward reaching on the positions, then
+          the orientations follow the swing of each bone.
+
+        CCD and FABRIK stop once the end effector is within tolerance of the
+        target or after maxIterations sweeps. Chains are independent and are
+        split over the worker threads (Parallel.h); they must not share joints.
+    */
+    class CN_EXPORT IK
+    {
+    public:
+
+        static void solveTwoBone(const IKChain *chains, size_t chainCount, Vec3 *positions, Quat *orientations);
+        static void solveCCD(const IKChain *chains, size_t chainCount, Vec3 *positions, Quat *orientations,
+            int maxIterations = 16, Real tolerance = 1e-3f);
+        static void solveFABRIK(const IKChain *chains, size_t chainCount, Vec3 *positions, Quat *orientations,
+            int maxIterations = 16, Real tolerance = 1e-3f);
+    };
+}
+
+#endif
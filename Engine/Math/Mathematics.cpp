@@ -10,5 +10,54 @@
 
 namespace Canaan
 {
+    template<class S> static size_t FastSinCosKernel(const Real* angles, Real* sinOut, Real* cosOut, size_t count)
+    {
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            typename S::V s, c;
+            FastSinCos<S>(S::load(angles + i), s, c);
+            S::store(sinOut + i, s);
+            S::store(cosOut + i, c);
+        }
+        return i;
+    }
 
+    template<class S> static size_t FastAtan2Kernel(const Real* y, const Real* x, Real* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            S::store(out + i, FastAtan2<S>(S::load(y + i), S::load(x + i)));
+        }
+        return i;
+    }
+
+    template<class S> static size_t FastInvSqrtKernel(const Real* in, Real* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            S::store(out + i, FastInvSqrt<S>(S::load(in + i)));
+        }
+        return i;
+    }
+
+    void FastSinCos(const Real* angles, Real* sinOut, Real* cosOut, size_t count)
+    {
+        size_t i = FastSinCosKernel<SimdOps>(angles, sinOut, cosOut, count);
+        FastSinCosKernel<SimdOps1>(angles + i, sinOut + i, cosOut + i, count - i);
+    }
+
+    void FastAtan2(const Real* y, const Real* x, Real* out, size_t count)
+    {
+        size_t i = FastAtan2Kernel<SimdOps>(y, x, out, count);
+        FastAtan2Kernel<SimdOps1>(y + i, x + i, out + i, count - i);
+    }
+
+    void FastInvSqrt(const Real* in, Real* out, size_t count)
+    {
+        size_t i = FastInvSqrtKernel<SimdOps>(in, out, count);
+        FastInvSqrtKernel<SimdOps1>(in + i, out + i, count - i);
+    }
 }
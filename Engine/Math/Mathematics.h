@@ -1,6 +1,7 @@
 #ifndef _CN_MATHEMATICS_
 #define _CN_MATHEMATICS_
 #include "Prerequisites.h"
+#include "SIMD.h"
 #include <math.h>
 
 namespace Canaan
@@ -13,19 +14,131 @@ namespace Canaan
     static const Real DEGREE_TO_RADIAN = PI / 180.0f;
     static const Real RADIAN_TO_DEGREE = 180.0f / PI;
 
-    inline Real RandomUnitization() {
-    #if (CN_PLATFORM == CN_PLATFORM_ANDROID)
-            return Real(drand48());
-    #else
-            return (Real)rand() / (Real)RAND_MAX;
-    #endif
-    }
+    // uniform in [0, 1) from the calling thread's generator, see Random.h
+    CN_EXPORT Real RandomUnitization();
 
     inline bool IsNaN(Real val) { return val != val; }
 
     template<typename T> T Minimum(const T& lVal, const T& rVal) { return lVal < rVal ? lVal : rVal; }
     template<typename T> T Maximum(const T& lVal, const T& rVal) { return lVal < rVal ? rVal : lVal; }
-    
+
+    /*
+        Fast approximate tier, opt in per call site (Quat::slerpFast,
+        Vec3::normalizeFast, ...) where throughput matters more than the last
+        bits. Each function is written once over the SimdOps lane operations:
+        FastSin<S>(V) works on S::V registers, FastSin(Real) is the SimdOps1
+        instance, so SIMD kernels and their scalar tails agree.
+
+        Maximum error in float, measured against double precision libm:
+        - FastSin, FastCos, FastSinCos: 2.5e-7 absolute for |x| <= 2 PI and
+          2.5e-7 + 1e-7 * |x| / (2 PI) beyond, from range reduction.
+          Inputs must satisfy |x| < 1e9.
+        - FastAtan2: 2e-6 radians. FastAtan2(0, 0) is 0.
+        - FastInvSqrt: 3e-7 relative on x86 and NEON (hardware estimate plus
+          Newton steps), exact elsewhere. Returns inf for 0 and NaN for
+          negative x.
+    */
+
+    // reduces x to [-PI, PI], 2 PI is split in two parts so the reduction
+    // stays accurate for large |x|
+    template<class S> inline typename S::V FastReduceAngle(typename S::V x)
+    {
+        typename S::V k = S::round(S::mul(x, S::set1(Real(0.15915494309189533577))));
+        x = S::sub(x, S::mul(k, S::set1(Real(6.28125))));
+        return S::sub(x, S::mul(k, S::set1(Real(1.9353071795864769253e-3))));
+    }
+
+    // minimax polynomial for sin on [-PI/2, PI/2]
+    template<class S> inline typename S::V FastSinPoly(typename S::V x)
+    {
+        typedef typename S::V V;
+        V x2 = S::mul(x, x);
+        V p = S::set1(Real(2.612538035415576e-6));
+        p = S::add(S::mul(p, x2), S::set1(Real(-1.9813423871231916e-4)));
+        p = S::add(S::mul(p, x2), S::set1(Real(8.33313077821447e-3)));
+        p = S::add(S::mul(p, x2), S::set1(Real(-0.16666662483617703)));
+        p = S::add(S::mul(p, x2), S::set1(Real(0.9999999991582449)));
+        return S::mul(p, x);
+    }
+
+    template<class S> inline typename S::V FastSin(typename S::V x)
+    {
+        typedef typename S::V V;
+        V r = FastReduceAngle<S>(x);
+        // mirror (PI/2, PI] and [-PI, -PI/2) into the polynomial range
+        V hi = S::set1(HALF_PI);
+        V lo = S::set1(-HALF_PI);
+        r = S::select(S::cmpgt(r, hi), S::sub(S::set1(PI), r), r);
+        r = S::select(S::cmpgt(lo, r), S::sub(S::set1(-PI), r), r);
+        return FastSinPoly<S>(r);
+    }
+
+    template<class S> inline typename S::V FastCos(typename S::V x)
+    {
+        // cos(r) = sin(PI/2 - |r|)
+        typename S::V r = FastReduceAngle<S>(x);
+        return FastSinPoly<S>(S::sub(S::set1(HALF_PI), S::abs(r)));
+    }
+
+    template<class S> inline void FastSinCos(typename S::V x, typename S::V &s, typename S::V &c)
+    {
+        typedef typename S::V V;
+        V r = FastReduceAngle<S>(x);
+        c = FastSinPoly<S>(S::sub(S::set1(HALF_PI), S::abs(r)));
+        V hi = S::set1(HALF_PI);
+        V lo = S::set1(-HALF_PI);
+        r = S::select(S::cmpgt(r, hi), S::sub(S::set1(PI), r), r);
+        r = S::select(S::cmpgt(lo, r), S::sub(S::set1(-PI), r), r);
+        s = FastSinPoly<S>(r);
+    }
+
+    template<class S> inline typename S::V FastAtan2(typename S::V y, typename S::V x)
+    {
+        typedef typename S::V V;
+        V ax = S::abs(x);
+        V ay = S::abs(y);
+        V zero = S::set1(0.0f);
+        // atan of min / max in [0, 1], the max is clamped so atan2(0, 0) is 0
+        V a = S::div(S::minimum(ax, ay), S::maximum(S::maximum(ax, ay), S::set1(Real(1e-30))));
+        V a2 = S::mul(a, a);
+        V p = S::set1(Real(-0.011719135734256725));
+        p = S::add(S::mul(p, a2), S::set1(Real(0.05264735146589641)));
+        p = S::add(S::mul(p, a2), S::set1(Real(-0.11642648196997651)));
+        p = S::add(S::mul(p, a2), S::set1(Real(0.19354037608393043)));
+        p = S::add(S::mul(p, a2), S::set1(Real(-0.3326228278902576)));
+        p = S::add(S::mul(p, a2), S::set1(Real(0.9999772190822532)));
+        V r = S::mul(p, a);
+        r = S::select(S::cmpgt(ay, ax), S::sub(S::set1(HALF_PI), r), r);
+        r = S::select(S::cmpgt(zero, x), S::sub(S::set1(PI), r), r);
+        return S::select(S::cmpgt(zero, y), S::sub(zero, r), r);
+    }
+
+    template<class S> inline typename S::V FastInvSqrt(typename S::V x)
+    {
+        typedef typename S::V V;
+        V estimate = S::rsqrt(x);
+        V r = estimate;
+        for (int i = 0; i < S::RSQRT_STEPS; ++i)
+        {
+            // r' = r * (1.5 - 0.5 * x * r * r)
+            V hx = S::mul(S::set1(0.5f), x);
+            r = S::mul(r, S::sub(S::set1(1.5f), S::mul(hx, S::mul(r, r))));
+        }
+        // the step turns the inf estimate for 0 into 0 * inf = NaN, keep the
+        // estimate there
+        return S::select(S::cmpgt(x, S::set1(0.0f)), r, estimate);
+    }
+
+    inline Real FastSin(Real x) { return FastSin<SimdOps1>(x); }
+    inline Real FastCos(Real x) { return FastCos<SimdOps1>(x); }
+    inline void FastSinCos(Real x, Real &s, Real &c) { FastSinCos<SimdOps1>(x, s, c); }
+    inline Real FastAtan2(Real y, Real x) { return FastAtan2<SimdOps1>(y, x); }
+    inline Real FastInvSqrt(Real x) { return FastInvSqrt<SimdOps1>(x); }
+
+    // Bulk forms over arrays, vectorized across elements. Outputs may alias inputs.
+    CN_EXPORT void FastSinCos(const Real* angles, Real* sinOut, Real* cosOut, size_t count);
+    CN_EXPORT void FastAtan2(const Real* y, const Real* x, Real* out, size_t count);
+    CN_EXPORT void FastInvSqrt(const Real* in, Real* out, size_t count);
 }
 
 
@@ -1,35 +1,15 @@
 #include "Matrix3.h"
+#include <type_traits>
 
 namespace Canaan
 {
-    const Mat3 Mat3::IDENTITY = Mat3(1.0f, 0.0f, 0.0f
+    static_assert(std::is_trivially_copyable<Mat3>::value, "Mat3 must be copyable with memcpy");
+    static_assert(sizeof(Mat3) == 9 * sizeof(Real), "batched normal matrices write Mat3 arrays as packed Reals");
+
+    constexpr Mat3 Mat3::IDENTITY = Mat3(1.0f, 0.0f, 0.0f
                                          , 0.0f, 1.0f, 0.0f
                                          , 0.0f, 0.0f, 1.0f);
 
-    Mat3::Mat3()
-    {
-
-    }
-
-    Mat3::Mat3(const Mat3 &copy)
-    {
-
-    }
-
-    Mat3::Mat3(Real m00, Real m01, Real m02
-        , Real m10, Real m11, Real m12
-        , Real m20, Real m21, Real m22)
-    {
-        set(m00, m01, m02
-            , m10, m11, m12
-            , m20, m21, m22);
-    }
-
-    Mat3::~Mat3()
-    {
-
-    }
-
     void Mat3::identity()
     {
         m[0][0] = 1.0f;
@@ -86,4 +66,10 @@ namespace Canaan
             , d10 * fInvDet, d11 * fInvDet, d12 * fInvDet
             , d20 * fInvDet, d21 * fInvDet, d22 * fInvDet);
     }
+
+    void Mat3::inverseTranspose()
+    {
+        inverse();
+        transpose();
+    }
 }
@@ -20,12 +20,11 @@ namespace Canaan
     public:
         static const Mat3 IDENTITY;
 
-        Mat3();
-        Mat3(const Mat3 &copy);
-        Mat3(Real m00, Real m01, Real m02,
+        Mat3() = default;
+        constexpr Mat3(Real m00, Real m01, Real m02,
             Real m10, Real m11, Real m12,
-            Real m20, Real m21, Real m22);
-        ~Mat3();
+            Real m20, Real m21, Real m22)
+            : _m{ m00, m01, m02, m10, m11, m12, m20, m21, m22 } {}
 
         void identity();
         void set(Real m00, Real m01, Real m02,
@@ -33,6 +32,8 @@ namespace Canaan
             Real m20, Real m21, Real m22);
         void transpose();
         void inverse();
+        // the normal matrix of this one, see Mat4::normalMatrices for the batched form
+        void inverseTranspose();
 
         inline Real* operator [] (size_t iRow){
             cnAssert(iRow < 3);
@@ -44,12 +45,6 @@ namespace Canaan
             return m[iRow];
         }
 
-        inline Mat3& operator= (const Mat3& rkMatrix)
-        {
-            memcpy(m, rkMatrix.m, 9 * sizeof(Real));
-            return *this;
-        }
-
         inline bool operator== (const Mat3& rkMatrix) const{
             if (
                 m[0][0] != rkMatrix.m[0][0] || m[0][1] != rkMatrix.m[0][1] || m[0][2] != rkMatrix.m[0][2] ||
@@ -163,6 +158,8 @@ namespace Canaan
         };
     };
 
+    typedef std::vector<Mat3> Mat3Array;
+
     /*Mat3 operator* (const Real scalar, const Mat3& m){
         Mat3 r;
         r.m[0][0] = m[0][0] * scalar;
@@ -1,8 +1,15 @@
 #include "Matrix4.h"
 #include "Matrix3.h"
+#include <type_traits>
 
 namespace Canaan
 {
+    static_assert(sizeof(Mat4) == 16 * sizeof(Real), "batched decomposition reads Mat4 arrays as packed Reals");
+    static_assert(std::is_trivially_copyable<Mat4>::value, "Mat4 arrays are copied with memcpy and passed to the SIMD kernels as raw Reals");
+    static_assert(sizeof(Vec3) == 3 * sizeof(Real), "bulk transforms treat Vec3 arrays as packed Reals");
+    static_assert(sizeof(Vec4) == 4 * sizeof(Real), "bulk transforms treat Vec4 arrays as packed Reals");
+    static_assert(sizeof(Quat) == 4 * sizeof(Real), "batched decomposition treats Quat arrays as packed (w, x, y, z) Reals");
+
     static Real MINOR(const Mat4& m, const size_t r0, const size_t r1, const size_t r2,
                     const size_t c0, const size_t c1, const size_t c2)
     {
@@ -11,37 +18,16 @@ namespace Canaan
             m[r0][c2] * (m[r1][c0] * m[r2][c1] - m[r2][c0] * m[r1][c1]);
     }
 
-    const Mat4 Mat4::IDENTITY = Mat4(1.0f, 0.0f, 0.0f, 0.0f
+    constexpr Mat4 Mat4::IDENTITY = Mat4(1.0f, 0.0f, 0.0f, 0.0f
                                          , 0.0f, 1.0f, 0.0f, 0.0f
                                          , 0.0f, 0.0f, 1.0f, 0.0f
                                          , 0.0f, 0.0f, 0.0f, 1.0f);
 
-    const Mat4 Mat4::ZERO = Mat4(0.0f, 0.0f, 0.0f, 0.0f
+    constexpr Mat4 Mat4::ZERO = Mat4(0.0f, 0.0f, 0.0f, 0.0f
                                      , 0.0f, 0.0f, 0.0f, 0.0f
                                      , 0.0f, 0.0f, 0.0f, 0.0f
                                      , 0.0f, 0.0f, 0.0f, 0.0f);
 
-    Mat4::Mat4()
-    {
-
-    }
-
-    Mat4::Mat4(const Mat4 &copy)
-    {
-        memcpy(m, copy.m, 16 * sizeof(Real));
-    }
-
-    Mat4::Mat4(Real m00, Real m01, Real m02, Real m03
-        , Real m10, Real m11, Real m12, Real m13
-        , Real m20, Real m21, Real m22, Real m23
-        , Real m30, Real m31, Real m32, Real m33)
-    {
-        set(m00, m01, m02, m03
-            , m10, m11, m12, m13
-            , m20, m21, m22, m23
-            , m30, m31, m32, m33);
-    }
-
     Mat4::Mat4(const Quat &rot)
     {
         makeRotation(rot);
@@ -52,11 +38,6 @@ namespace Canaan
         makeTranslation(trans);
     }
 
-    Mat4::~Mat4()
-    {
-
-    }
-
     void Mat4::identity()
     {
         m[0][0] = 1.0f;
@@ -322,63 +303,7 @@ namespace Canaan
 
     void Mat4::inverse()
     {
-        Real m00 = m[0][0], m01 = m[0][1], m02 = m[0][2], m03 = m[0][3];
-        Real m10 = m[1][0], m11 = m[1][1], m12 = m[1][2], m13 = m[1][3];
-        Real m20 = m[2][0], m21 = m[2][1], m22 = m[2][2], m23 = m[2][3];
-        Real m30 = m[3][0], m31 = m[3][1], m32 = m[3][2], m33 = m[3][3];
-
-        Real v0 = m20 * m31 - m21 * m30;
-        Real v1 = m20 * m32 - m22 * m30;
-        Real v2 = m20 * m33 - m23 * m30;
-        Real v3 = m21 * m32 - m22 * m31;
-        Real v4 = m21 * m33 - m23 * m31;
-        Real v5 = m22 * m33 - m23 * m32;
-
-        Real t00 = +(v5 * m11 - v4 * m12 + v3 * m13);
-        Real t10 = -(v5 * m10 - v2 * m12 + v1 * m13);
-        Real t20 = +(v4 * m10 - v2 * m11 + v0 * m13);
-        Real t30 = -(v3 * m10 - v1 * m11 + v0 * m12);
-
-        Real invDet = 1 / (t00 * m00 + t10 * m01 + t20 * m02 + t30 * m03);
-
-        Real d00 = t00 * invDet;
-        Real d10 = t10 * invDet;
-        Real d20 = t20 * invDet;
-        Real d30 = t30 * invDet;
-
-        Real d01 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-        Real d11 = +(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-        Real d21 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-        Real d31 = +(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-        v0 = m10 * m31 - m11 * m30;
-        v1 = m10 * m32 - m12 * m30;
-        v2 = m10 * m33 - m13 * m30;
-        v3 = m11 * m32 - m12 * m31;
-        v4 = m11 * m33 - m13 * m31;
-        v5 = m12 * m33 - m13 * m32;
-
-        Real d02 = +(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-        Real d12 = -(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-        Real d22 = +(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-        Real d32 = -(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-        v0 = m21 * m10 - m20 * m11;
-        v1 = m22 * m10 - m20 * m12;
-        v2 = m23 * m10 - m20 * m13;
-        v3 = m22 * m11 - m21 * m12;
-        v4 = m23 * m11 - m21 * m13;
-        v5 = m23 * m12 - m22 * m13;
-
-        Real d03 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-        Real d13 = +(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-        Real d23 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-        Real d33 = +(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-        set(d00, d01, d02, d03,
-            d10, d11, d12, d13,
-            d20, d21, d22, d23,
-            d30, d31, d32, d33);
+        Mat4Inverse(_m, _m);
     }
 
     Real Mat4::determinant() const
@@ -417,6 +342,17 @@ namespace Canaan
         return m;
     }
 
+    void Mat4::decomposition(const Mat4* in, Vec3* positions, Vec3* scales, Quat* orientations, size_t count, bool handleShear)
+    {
+        AffineDecomposeBatch(reinterpret_cast<const Real*>(in), 16, reinterpret_cast<Real*>(positions), reinterpret_cast<Real*>(scales)
+            , reinterpret_cast<Real*>(orientations), count, handleShear);
+    }
+
+    void Mat4::normalMatrices(const Mat4* in, Mat3* out, size_t count, bool uniformScale)
+    {
+        NormalMatrixBatch(reinterpret_cast<const Real*>(in), 16, reinterpret_cast<Real*>(out), count, uniformScale);
+    }
+
     Mat4 Mat4::lookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up)
     {
         Mat4 m;
@@ -437,4 +373,69 @@ namespace Canaan
         m.makePerspective(fovy, aspectRatio, zNear, zFar);
         return m;
     }
+
+    void Mat4::transformPoints(const Vec3* in, Vec3* out, size_t count) const
+    {
+        Mat4TransformPoints(_m, reinterpret_cast<const Real*>(in), reinterpret_cast<Real*>(out), count);
+    }
+
+    void Mat4::transformAffinePoints(const Vec3* in, Vec3* out, size_t count) const
+    {
+        Mat4TransformAffinePoints(_m, reinterpret_cast<const Real*>(in), reinterpret_cast<Real*>(out), count);
+    }
+
+    void Mat4::transformDirections(const Vec3* in, Vec3* out, size_t count) const
+    {
+        Mat4TransformDirections(_m, reinterpret_cast<const Real*>(in), reinterpret_cast<Real*>(out), count);
+    }
+
+    void Mat4::transformNormals(const Vec3* in, Vec3* out, size_t count) const
+    {
+        Mat3 normalMat(m[0][0], m[0][1], m[0][2]
+                       , m[1][0], m[1][1], m[1][2]
+                       , m[2][0], m[2][1], m[2][2]);
+        normalMat.inverse();
+        normalMat.transpose();
+        Real n[16] = { normalMat[0][0], normalMat[0][1], normalMat[0][2], 0.0f
+                     , normalMat[1][0], normalMat[1][1], normalMat[1][2], 0.0f
+                     , normalMat[2][0], normalMat[2][1], normalMat[2][2], 0.0f
+                     , 0.0f, 0.0f, 0.0f, 1.0f };
+        Mat4TransformAffinePoints(n, reinterpret_cast<const Real*>(in), reinterpret_cast<Real*>(out), count);
+        Vec3NormalizeBatch(reinterpret_cast<Real*>(out), count);
+    }
+
+    void Mat4::transform(const Vec4* in, Vec4* out, size_t count) const
+    {
+        Mat4TransformVec4s(_m, reinterpret_cast<const Real*>(in), reinterpret_cast<Real*>(out), count);
+    }
+
+    void Mat4::transformPoints(const Vec3Array& in, Vec3Array& out) const
+    {
+        out.resize(in.size());
+        transformPoints(in.data(), out.data(), in.size());
+    }
+
+    void Mat4::transformAffinePoints(const Vec3Array& in, Vec3Array& out) const
+    {
+        out.resize(in.size());
+        transformAffinePoints(in.data(), out.data(), in.size());
+    }
+
+    void Mat4::transformDirections(const Vec3Array& in, Vec3Array& out) const
+    {
+        out.resize(in.size());
+        transformDirections(in.data(), out.data(), in.size());
+    }
+
+    void Mat4::transformNormals(const Vec3Array& in, Vec3Array& out) const
+    {
+        out.resize(in.size());
+        transformNormals(in.data(), out.data(), in.size());
+    }
+
+    void Mat4::transform(const Vec4Array& in, Vec4Array& out) const
+    {
+        out.resize(in.size());
+        transform(in.data(), out.data(), in.size());
+    }
 }
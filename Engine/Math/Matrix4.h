@@ -4,6 +4,7 @@
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "SIMD.h"
 
 /*
 	The generic form M * V which shows the layout of the matrix
@@ -17,6 +18,7 @@
 */
 namespace Canaan
 {
+    class Mat3;
     class CN_EXPORT Mat4
     {
     public:
@@ -24,15 +26,14 @@ namespace Canaan
         static const Mat4 IDENTITY;
         static const Mat4 ZERO;
 
-        Mat4();
-        Mat4(const Mat4 &copy);
+        Mat4() = default;
         Mat4(const Quat &rot);
         Mat4(const Vec3 &trans);
-        Mat4(Real m00, Real m01, Real m02, Real m03,
+        constexpr Mat4(Real m00, Real m01, Real m02, Real m03,
             Real m10, Real m11, Real m12, Real m13,
             Real m20, Real m21, Real m22, Real m23,
-            Real m30, Real m31, Real m32, Real m33);
-        ~Mat4();
+            Real m30, Real m31, Real m32, Real m33)
+            : _m{ m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33 } {}
 
         inline void identity();
         void set(Real m00, Real m01, Real m02, Real m03,
@@ -58,29 +59,44 @@ namespace Canaan
         static Mat4 lookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up);
         static Mat4 ortho(float left, float right, float bottom, float top, float zNear, float zFar);
         static Mat4 perspective(float fovy, float aspectRatio, float zNear, float zFar);
+
+        // Batched decomposition of count affine matrices, vectorized across matrices.
+        // Null outputs are skipped. The orientation is the rotation of the polar
+        // decomposition of the upper 3x3, the closest rotation to it, found by a
+        // scaled Newton iteration; the scale is the diagonal of the remaining
+        // stretch. handleShear = false takes the rotation from the normalized
+        // columns instead, which is exact and cheaper when the caller guarantees
+        // translate * rotate * scale input. For TRS input both modes match
+        // decomposition() to float rounding (orientations within 1e-6, up to
+        // sign); sheared input decomposes differently, decomposition() keeps the
+        // first column's direction where the polar rotation spreads the shear.
+        static void decomposition(const Mat4* in, Vec3* positions, Vec3* scales, Quat* orientations, size_t count, bool handleShear = true);
+
+        // Batched normal matrices, the inverse transpose of the upper 3x3 of each
+        // matrix, vectorized across matrices. uniformScale is a promise that every
+        // matrix is rotation * uniform scale (plus translation); the result is then
+        // M / |column 0|^2 without the inversion. The matrices must be invertible.
+        static void normalMatrices(const Mat4* in, Mat3* out, size_t count, bool uniformScale = false);
+
+        // Bulk transforms of count elements, vectorized across elements. out may alias in.
+        // transformPoints matches operator * (const Vec3&) including the divide by w,
+        // transformAffinePoints skips the bottom row, transformDirections uses the upper
+        // 3x3 only and transformNormals uses its inverse transpose and renormalizes.
+        void transformPoints(const Vec3* in, Vec3* out, size_t count) const;
+        void transformAffinePoints(const Vec3* in, Vec3* out, size_t count) const;
+        void transformDirections(const Vec3* in, Vec3* out, size_t count) const;
+        void transformNormals(const Vec3* in, Vec3* out, size_t count) const;
+        void transform(const Vec4* in, Vec4* out, size_t count) const;
+
+        void transformPoints(const Vec3Array& in, Vec3Array& out) const;
+        void transformAffinePoints(const Vec3Array& in, Vec3Array& out) const;
+        void transformDirections(const Vec3Array& in, Vec3Array& out) const;
+        void transformNormals(const Vec3Array& in, Vec3Array& out) const;
+        void transform(const Vec4Array& in, Vec4Array& out) const;
         
         inline Mat4 operator * (const Mat4 &m2) const{
             Mat4 r;
-            r.m[0][0] = m[0][0] * m2.m[0][0] + m[0][1] * m2.m[1][0] + m[0][2] * m2.m[2][0] + m[0][3] * m2.m[3][0];
-            r.m[0][1] = m[0][0] * m2.m[0][1] + m[0][1] * m2.m[1][1] + m[0][2] * m2.m[2][1] + m[0][3] * m2.m[3][1];
-            r.m[0][2] = m[0][0] * m2.m[0][2] + m[0][1] * m2.m[1][2] + m[0][2] * m2.m[2][2] + m[0][3] * m2.m[3][2];
-            r.m[0][3] = m[0][0] * m2.m[0][3] + m[0][1] * m2.m[1][3] + m[0][2] * m2.m[2][3] + m[0][3] * m2.m[3][3];
-
-            r.m[1][0] = m[1][0] * m2.m[0][0] + m[1][1] * m2.m[1][0] + m[1][2] * m2.m[2][0] + m[1][3] * m2.m[3][0];
-            r.m[1][1] = m[1][0] * m2.m[0][1] + m[1][1] * m2.m[1][1] + m[1][2] * m2.m[2][1] + m[1][3] * m2.m[3][1];
-            r.m[1][2] = m[1][0] * m2.m[0][2] + m[1][1] * m2.m[1][2] + m[1][2] * m2.m[2][2] + m[1][3] * m2.m[3][2];
-            r.m[1][3] = m[1][0] * m2.m[0][3] + m[1][1] * m2.m[1][3] + m[1][2] * m2.m[2][3] + m[1][3] * m2.m[3][3];
-
-            r.m[2][0] = m[2][0] * m2.m[0][0] + m[2][1] * m2.m[1][0] + m[2][2] * m2.m[2][0] + m[2][3] * m2.m[3][0];
-            r.m[2][1] = m[2][0] * m2.m[0][1] + m[2][1] * m2.m[1][1] + m[2][2] * m2.m[2][1] + m[2][3] * m2.m[3][1];
-            r.m[2][2] = m[2][0] * m2.m[0][2] + m[2][1] * m2.m[1][2] + m[2][2] * m2.m[2][2] + m[2][3] * m2.m[3][2];
-            r.m[2][3] = m[2][0] * m2.m[0][3] + m[2][1] * m2.m[1][3] + m[2][2] * m2.m[2][3] + m[2][3] * m2.m[3][3];
-
-            r.m[3][0] = m[3][0] * m2.m[0][0] + m[3][1] * m2.m[1][0] + m[3][2] * m2.m[2][0] + m[3][3] * m2.m[3][0];
-            r.m[3][1] = m[3][0] * m2.m[0][1] + m[3][1] * m2.m[1][1] + m[3][2] * m2.m[2][1] + m[3][3] * m2.m[3][1];
-            r.m[3][2] = m[3][0] * m2.m[0][2] + m[3][1] * m2.m[1][2] + m[3][2] * m2.m[2][2] + m[3][3] * m2.m[3][2];
-            r.m[3][3] = m[3][0] * m2.m[0][3] + m[3][1] * m2.m[1][3] + m[3][2] * m2.m[2][3] + m[3][3] * m2.m[3][3];
-
+            Mat4Multiply(_m, m2._m, r._m);
             return r;
         }
 
@@ -94,28 +110,16 @@ namespace Canaan
             return m[iRow];
         }
 
-        inline Mat4& operator = (const Mat4& rkMatrix){
-            memcpy(m, rkMatrix.m, 16 * sizeof(Real));
-            return *this;
-        }
-
         inline Vec3 operator * (const Vec3 &v) const{
             Vec3 r;
-            Real fInvW = 1.0f / (m[3][0] * v.x + m[3][1] * v.y + m[3][2] * v.z + m[3][3]);
-            r.x = (m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3]) * fInvW;
-            r.y = (m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3]) * fInvW;
-            r.z = (m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3]) * fInvW;
-
+            Mat4TransformPoint(_m, &v.x, &r.x);
             return r;
         }
 
         inline Vec4 operator * (const Vec4& v) const{
-            return Vec4(
-                m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3] * v.w,
-                m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3] * v.w,
-                m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3] * v.w,
-                m[3][0] * v.x + m[3][1] * v.y + m[3][2] * v.z + m[3][3] * v.w
-                );
+            Vec4 r;
+            Mat4TransformVec4(_m, &v.x, &r.x);
+            return r;
         }
 
         inline Mat4 operator * (const Real& scaler) const {
@@ -0,0 +1,132 @@
+#include "OBB.h"
+#include "Matrix4.h"
+#include "Affine3.h"
+#include <type_traits>
+
+namespace Canaan
+{
+    static_assert(std::is_trivially_copyable<OBB>::value, "OBB is copied freely by the bounds streams");
+
+    // m is the top three rows of a row major matrix, row stride 4
+    static void TransformToOBB(const Real *m, const AABB &box, OBB &obb)
+    {
+        Vec3 c = box.getCenter();
+        Vec3 e = box.getExtents();
+        obb.center = Vec3(
+            m[0] * c.x + m[1] * c.y + m[2] * c.z + m[3],
+            m[4] * c.x + m[5] * c.y + m[6] * c.z + m[7],
+            m[8] * c.x + m[9] * c.y + m[10] * c.z + m[11]);
+        for (int i = 0; i < 3; ++i)
+        {
+            Vec3 col(m[i], m[4 + i], m[8 + i]);
+            Real scl = col.normalize();
+            obb.axis[i] = col;
+            obb.extents[i] = e[i] * scl;
+        }
+    }
+
+    OBB::OBB(const AABB &box, const Mat4 &mat)
+    {
+        TransformToOBB(mat[0], box, *this);
+    }
+
+    OBB::OBB(const AABB &box, const Affine3 &mat)
+    {
+        TransformToOBB(mat[0], box, *this);
+    }
+
+    Vec3 OBB::getCorner(size_t i) const
+    {
+        return center
+            + axis[0] * (i & 1 ? extents.x : -extents.x)
+            + axis[1] * (i & 2 ? extents.y : -extents.y)
+            + axis[2] * (i & 4 ? extents.z : -extents.z);
+    }
+
+    AABB OBB::getAABB() const
+    {
+        Vec3 half;
+        for (int i = 0; i < 3; ++i)
+            half[i] = fabs(axis[0][i]) * extents.x + fabs(axis[1][i]) * extents.y + fabs(axis[2][i]) * extents.z;
+        return AABB(center - half, center + half);
+    }
+
+    bool OBB::contains(const Vec3 &point) const
+    {
+        Vec3 d = point - center;
+        return fabs(d.dotProduct(axis[0])) <= extents.x
+            && fabs(d.dotProduct(axis[1])) <= extents.y
+            && fabs(d.dotProduct(axis[2])) <= extents.z;
+    }
+
+    bool OBB::intersects(const Sphere &sphere) const
+    {
+        // closest point of the box to the center, in box space
+        Vec3 d = sphere.center - center;
+        Real sqDist = 0.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            Real dist = d.dotProduct(axis[i]);
+            Real excess = fabs(dist) - extents[i];
+            if (excess > 0.0f) sqDist += excess * excess;
+        }
+        return sqDist <= sphere.radius * sphere.radius;
+    }
+
+    bool OBB::intersects(const OBB &box) const
+    {
+        // Gottschalk's separating axis test in the frame of this box
+        const Real EPSILON = 1e-6f;
+        Real R[3][3], absR[3][3];
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                R[i][j] = axis[i].dotProduct(box.axis[j]);
+                // epsilon keeps near parallel edge pairs from producing a null cross product axis
+                absR[i][j] = fabs(R[i][j]) + EPSILON;
+            }
+        }
+
+        Vec3 d = box.center - center;
+        Real t[3] = { d.dotProduct(axis[0]), d.dotProduct(axis[1]), d.dotProduct(axis[2]) };
+        const Vec3 &a = extents;
+        const Vec3 &b = box.extents;
+        Real ra, rb;
+
+        // axes of this box
+        for (int i = 0; i < 3; ++i)
+        {
+            ra = a[i];
+            rb = b.x * absR[i][0] + b.y * absR[i][1] + b.z * absR[i][2];
+            if (fabs(t[i]) > ra + rb) return false;
+        }
+
+        // axes of the other box
+        for (int j = 0; j < 3; ++j)
+        {
+            ra = a.x * absR[0][j] + a.y * absR[1][j] + a.z * absR[2][j];
+            rb = b[j];
+            if (fabs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + rb) return false;
+        }
+
+        // cross products of an axis of each box
+        for (int i = 0; i < 3; ++i)
+        {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            for (int j = 0; j < 3; ++j)
+            {
+                int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+                rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+                if (fabs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) return false;
+            }
+        }
+        return true;
+    }
+
+    bool OBB::intersects(const AABB &box) const
+    {
+        return intersects(OBB(box.getCenter(), Vec3::UNIT_X, Vec3::UNIT_Y, Vec3::UNIT_Z, box.getExtents()));
+    }
+}
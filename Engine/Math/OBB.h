@@ -0,0 +1,45 @@
+#ifndef _CN_OBB_
+#define _CN_OBB_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include "AABB.h"
+#include "Sphere.h"
+
+namespace Canaan
+{
+    class Mat4;
+    class Affine3;
+    /*
+        Oriented box: a center, three orthonormal axes and the half size
+        along each axis.
+    */
+    class CN_EXPORT OBB
+    {
+    public:
+
+        constexpr OBB() : center(), axis{ Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f) }, extents() {}
+        constexpr OBB(const Vec3 &center, const Vec3 &axisX, const Vec3 &axisY, const Vec3 &axisZ, const Vec3 &extents)
+            : center(center), axis{ axisX, axisY, axisZ }, extents(extents) {}
+        // box transformed by mat, the scale of mat goes into the extents.
+        // mat must be translate * rotate * scale, shear is dropped.
+        OBB(const AABB &box, const Mat4 &mat);
+        OBB(const AABB &box, const Affine3 &mat);
+
+        // corner i is on the positive side of axis[0] when bit 0 of i is set,
+        // axis[1] for bit 1 and axis[2] for bit 2, matching AABB::getCorner
+        Vec3 getCorner(size_t i) const;
+        AABB getAABB() const;
+
+        bool contains(const Vec3 &point) const;
+        bool intersects(const Sphere &sphere) const;
+        // separating axis test over the 15 candidate axes
+        bool intersects(const OBB &box) const;
+        bool intersects(const AABB &box) const;
+
+        Vec3 center;
+        Vec3 axis[3];
+        Vec3 extents;
+    };
+}
+
+#endif
@@ -0,0 +1,240 @@
+#include "Parallel.h"
+#include "Mathematics.h"
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Canaan
+{
+    // chunks per thread, enough slack for ranges of uneven cost
+    static const size_t PARALLEL_CHUNKS_PER_THREAD = 4;
+
+    static thread_local bool s_insideParallelFor = false;
+
+    class WorkerPool
+    {
+    public:
+
+        WorkerPool()
+        {
+            unsigned hardware = std::thread::hardware_concurrency();
+            startWorkers(hardware > 1 ? hardware - 1 : 0);
+        }
+
+        ~WorkerPool()
+        {
+            stopWorkers();
+        }
+
+        size_t workerCount() const { return m_workers.size(); }
+
+        void setWorkerCount(size_t count)
+        {
+            std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+            stopWorkers();
+            startWorkers(count);
+        }
+
+        // calls job(thread) once on every worker and on the caller, thread 0.
+        // false when another thread is dispatching, the caller then runs inline
+        bool run(const std::function<void(size_t)> &job)
+        {
+            std::unique_lock<std::mutex> dispatch(m_dispatchMutex, std::try_to_lock);
+            if (!dispatch.owns_lock())
+                return false;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_func = &job;
+                m_busy = m_workers.size();
+                ++m_generation;
+            }
+            m_wake.notify_all();
+            runJob(0);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this]{ return m_busy == 0; });
+            m_func = nullptr;
+            return true;
+        }
+
+    private:
+
+        // with no dispatch running, the workers wait for the next generation
+        void startWorkers(size_t count)
+        {
+            m_quit = false;
+            for (size_t i = 0; i < count; ++i)
+                m_workers.push_back(std::thread(&WorkerPool::workerLoop, this, i + 1, m_generation));
+        }
+
+        void stopWorkers()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_quit = true;
+            }
+            m_wake.notify_all();
+            for (auto &worker : m_workers)
+                worker.join();
+            m_workers.clear();
+        }
+
+        void runJob(size_t thread)
+        {
+            s_insideParallelFor = true;
+            (*m_func)(thread);
+            s_insideParallelFor = false;
+        }
+
+        void workerLoop(size_t thread, size_t seen)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                m_wake.wait(lock, [&]{ return m_quit || m_generation != seen; });
+                if (m_quit)
+                    return;
+                seen = m_generation;
+                lock.unlock();
+                runJob(thread);
+                lock.lock();
+                if (--m_busy == 0)
+                    m_done.notify_one();
+            }
+        }
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_dispatchMutex;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        const std::function<void(size_t)> *m_func = nullptr;
+        size_t m_busy = 0;
+        size_t m_generation = 0;
+        bool m_quit = false;
+    };
+
+    static WorkerPool& GetWorkerPool()
+    {
+        static WorkerPool s_pool;
+        return s_pool;
+    }
+
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &func)
+    {
+        if (count == 0)
+            return;
+        grain = Maximum<size_t>(grain, 1);
+        if (count <= grain || s_insideParallelFor || GetWorkerPool().workerCount() == 0){
+            func(0, count);
+            return;
+        }
+
+        WorkerPool &pool = GetWorkerPool();
+        size_t threads = pool.workerCount() + 1;
+        size_t chunk = Maximum(grain, (count + threads * PARALLEL_CHUNKS_PER_THREAD - 1) / (threads * PARALLEL_CHUNKS_PER_THREAD));
+        std::atomic<size_t> next(0);
+        bool dispatched = pool.run([&](size_t){
+            for (;;)
+            {
+                size_t begin = next.fetch_add(chunk);
+                if (begin >= count)
+                    break;
+                func(begin, Minimum(begin + chunk, count));
+            }
+        });
+        if (!dispatched)
+            func(0, count);
+    }
+
+    // the tasks [begin, end) a thread has left, thieves take them from the back
+    struct TaskShare
+    {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    void ParallelTasks(size_t count, const std::function<void(size_t)> &func)
+    {
+        if (count == 0)
+            return;
+        if (count == 1 || s_insideParallelFor || GetWorkerPool().workerCount() == 0){
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+            return;
+        }
+
+        WorkerPool &pool = GetWorkerPool();
+        size_t threads = pool.workerCount() + 1;
+        std::unique_ptr<TaskShare[]> shares(new TaskShare[threads]);
+        for (size_t t = 0; t < threads; ++t)
+        {
+            shares[t].begin = count * t / threads;
+            shares[t].end = count * (t + 1) / threads;
+        }
+
+        bool dispatched = pool.run([&](size_t thread){
+            TaskShare &own = shares[thread];
+            for (;;)
+            {
+                size_t task = count;
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (own.begin < own.end)
+                        task = own.begin++;
+                }
+                if (task < count)
+                {
+                    func(task);
+                    continue;
+                }
+
+                // out of work, steal the back half of the largest share left
+                size_t victim = threads, most = 0;
+                for (size_t t = 0; t < threads; ++t)
+                {
+                    std::lock_guard<std::mutex> lock(shares[t].mutex);
+                    if (shares[t].end - shares[t].begin > most)
+                    {
+                        most = shares[t].end - shares[t].begin;
+                        victim = t;
+                    }
+                }
+                if (victim == threads)
+                    return;
+                size_t begin, end;
+                {
+                    std::lock_guard<std::mutex> lock(shares[victim].mutex);
+                    size_t left = shares[victim].end - shares[victim].begin;
+                    if (left == 0)
+                        continue;
+                    end = shares[victim].end;
+                    begin = end - (left + 1) / 2;
+                    shares[victim].end = begin;
+                }
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin;
+                own.end = end;
+            }
+        });
+        if (!dispatched)
+        {
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+        }
+    }
+
+    size_t ParallelWorkerCount()
+    {
+        return GetWorkerPool().workerCount();
+    }
+
+    void SetParallelWorkerCount(size_t count)
+    {
+        GetWorkerPool().setWorkerCount(count);
+    }
+}
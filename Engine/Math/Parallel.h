@@ -0,0 +1,39 @@
+#ifndef _CN_PARALLEL_
+#define _CN_PARALLEL_
+#include "Prerequisites.h"
+#include <functional>
+
+namespace Canaan
+{
+    /*
+        Fork-join helper for the bulk kernels. A pool of
+        hardware_concurrency() - 1 worker threads is started on first use
+        (SetParallelWorkerCount changes it); the calling thread works
+        alongside them. Chunks are handed out from a shared counter, so
+        uneven chunks balance themselves; ParallelTasks balances coarser
+        tasks by work stealing.
+
+        Kernels passed to ParallelFor must only write to the range they are
+        given, results are then independent of the number of threads.
+    */
+
+    // calls func(begin, end) over [0, count) in chunks of at least grain
+    // elements and returns when every chunk is done. Runs func(0, count)
+    // inline when count <= grain, when there are no workers, or when called
+    // from inside another ParallelFor.
+    CN_EXPORT void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &func);
+    // calls func(task) for every task in [0, count) and returns when they are
+    // done, for few tasks of uneven cost such as the subtrees of a hierarchy.
+    // Every thread starts on its own contiguous share of the tasks and, once
+    // out of work, steals the back half of the largest share left. Runs the
+    // tasks in order inline in the same cases as ParallelFor.
+    CN_EXPORT void ParallelTasks(size_t count, const std::function<void(size_t)> &func);
+    // number of worker threads, not counting the caller
+    CN_EXPORT size_t ParallelWorkerCount();
+    // replaces the pool with count workers, e.g. 0 to keep every kernel on
+    // the calling thread, or a few to run the parallel paths in tests on any
+    // machine. Only while no thread is inside ParallelFor or ParallelTasks.
+    CN_EXPORT void SetParallelWorkerCount(size_t count);
+}
+
+#endif
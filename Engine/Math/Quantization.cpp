@@ -0,0 +1,394 @@
+#include "Quantization.h"
+#include "SIMD.h"
+#include <string.h>
+#if CN_SIMD_X86 && defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace Canaan
+{
+    // elements converted per block between the integer packing and the vectorized float math
+    static const size_t QUANTIZE_BLOCK_SIZE = 256;
+
+    // range of the three smallest components of a unit quaternion is +-1/sqrt(2)
+    static const Real SMALLEST_THREE_SCALE = 1.41421356f;
+    static const Real SMALLEST_THREE_INV_SCALE = 0.70710678f;
+    static const Real QUAT32_MAX = 1023.0f;
+    static const Real QUAT48_MAX = 32767.0f;
+
+    // Smallest-three encode of S::WIDTH quaternions at q, outputs the dropped
+    // index and the three quantized components as integral Reals in [0, max]
+    template<class S>
+    static size_t SmallestThreeEncodeKernel(const Real *q, Real max, Real *index, Real *a, Real *b, Real *c, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        const V two = S::set1(2.0f);
+        const V three = S::set1(3.0f);
+        const V vMax = S::set1(max);
+        const V halfMax = S::set1(0.5f * max);
+        const V scale = S::set1(SMALLEST_THREE_SCALE);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V w, x, y, z;
+            S::load4(q + i * 4, w, x, y, z);
+            // first largest magnitude wins ties
+            V idx = zero, largest = S::abs(w), dropped = w;
+            M m = S::cmpgt(S::abs(x), largest);
+            idx = S::select(m, one, idx); largest = S::select(m, S::abs(x), largest); dropped = S::select(m, x, dropped);
+            m = S::cmpgt(S::abs(y), largest);
+            idx = S::select(m, two, idx); largest = S::select(m, S::abs(y), largest); dropped = S::select(m, y, dropped);
+            m = S::cmpgt(S::abs(z), largest);
+            idx = S::select(m, three, idx); dropped = S::select(m, z, dropped);
+
+            // q and -q are the same rotation, flip so the dropped component is positive
+            V sign = S::select(S::cmpgt(zero, dropped), S::set1(-1.0f), one);
+            V ca = S::select(S::cmpge(idx, one), w, x);
+            V cb = S::select(S::cmpge(idx, two), x, y);
+            V cc = S::select(S::cmpge(idx, three), y, z);
+            V vs = S::mul(sign, scale);
+            S::store(index + i, idx);
+            S::store(a + i, S::minimum(S::maximum(S::round(S::mul(S::add(S::mul(ca, vs), one), halfMax)), zero), vMax));
+            S::store(b + i, S::minimum(S::maximum(S::round(S::mul(S::add(S::mul(cb, vs), one), halfMax)), zero), vMax));
+            S::store(c + i, S::minimum(S::maximum(S::round(S::mul(S::add(S::mul(cc, vs), one), halfMax)), zero), vMax));
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t SmallestThreeDecodeKernel(const Real *index, const Real *a, const Real *b, const Real *c, Real max, Real *q, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        const V two = S::set1(2.0f);
+        const V three = S::set1(3.0f);
+        const V step = S::set1(2.0f / max);
+        const V invScale = S::set1(SMALLEST_THREE_INV_SCALE);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V idx = S::load(index + i);
+            V va = S::mul(S::sub(S::mul(S::load(a + i), step), one), invScale);
+            V vb = S::mul(S::sub(S::mul(S::load(b + i), step), one), invScale);
+            V vc = S::mul(S::sub(S::mul(S::load(c + i), step), one), invScale);
+            V sum = S::add(S::add(S::mul(va, va), S::mul(vb, vb)), S::mul(vc, vc));
+            V dropped = S::sqrt(S::maximum(S::sub(one, sum), zero));
+
+            V w = S::select(S::cmpge(idx, one), va, dropped);
+            V x = S::select(S::cmpge(idx, two), vb, S::select(S::cmpge(idx, one), dropped, va));
+            V y = S::select(S::cmpge(idx, three), vc, S::select(S::cmpge(idx, two), dropped, vb));
+            V z = S::select(S::cmpge(idx, three), dropped, vc);
+            S::store4(q + i * 4, w, x, y, z);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t PositionEncodeKernel(const Real *v, const Vec3 &min, const Vec3 &scale, Real max, Real *out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V vMax = S::set1(max);
+        const V vMin[3] = { S::set1(min.x), S::set1(min.y), S::set1(min.z) };
+        const V vScale[3] = { S::set1(scale.x), S::set1(scale.y), S::set1(scale.z) };
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V p[3];
+            S::load3(v + i * 3, p[0], p[1], p[2]);
+            for (int k = 0; k < 3; ++k)
+                p[k] = S::minimum(S::maximum(S::round(S::mul(S::sub(p[k], vMin[k]), vScale[k])), zero), vMax);
+            S::store3(out + i * 3, p[0], p[1], p[2]);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t PositionDecodeKernel(const Real *in, const Vec3 &min, const Vec3 &step, Real *v, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V vMin[3] = { S::set1(min.x), S::set1(min.y), S::set1(min.z) };
+        const V vStep[3] = { S::set1(step.x), S::set1(step.y), S::set1(step.z) };
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V p[3];
+            S::load3(in + i * 3, p[0], p[1], p[2]);
+            for (int k = 0; k < 3; ++k)
+                p[k] = S::add(vMin[k], S::mul(p[k], vStep[k]));
+            S::store3(v + i * 3, p[0], p[1], p[2]);
+        }
+        return i;
+    }
+
+    static void EncodeSmallestThree(const Quat *in, Real max, Real *index, Real *a, Real *b, Real *c, size_t count)
+    {
+        const Real *q = reinterpret_cast<const Real*>(in);
+        size_t i = SmallestThreeEncodeKernel<SimdOps>(q, max, index, a, b, c, 0, count);
+        SmallestThreeEncodeKernel<SimdOps1>(q, max, index, a, b, c, i, count);
+    }
+
+    static void DecodeSmallestThree(const Real *index, const Real *a, const Real *b, const Real *c, Real max, Quat *out, size_t count)
+    {
+        Real *q = reinterpret_cast<Real*>(out);
+        size_t i = SmallestThreeDecodeKernel<SimdOps>(index, a, b, c, max, q, 0, count);
+        SmallestThreeDecodeKernel<SimdOps1>(index, a, b, c, max, q, i, count);
+    }
+
+    uint32_t QuatCodec::encode32(const Quat &q)
+    {
+        uint32_t v;
+        encode32(&q, &v, 1);
+        return v;
+    }
+
+    Quat QuatCodec::decode32(uint32_t v)
+    {
+        Quat q;
+        decode32(&v, &q, 1);
+        return q;
+    }
+
+    void QuatCodec::encode48(const Quat &q, uint16_t *out)
+    {
+        encode48(&q, out, 1);
+    }
+
+    Quat QuatCodec::decode48(const uint16_t *in)
+    {
+        Quat q;
+        decode48(in, &q, 1);
+        return q;
+    }
+
+    void QuatCodec::encode32(const Quat *in, uint32_t *out, size_t count)
+    {
+        Real index[QUANTIZE_BLOCK_SIZE], a[QUANTIZE_BLOCK_SIZE], b[QUANTIZE_BLOCK_SIZE], c[QUANTIZE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += QUANTIZE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(QUANTIZE_BLOCK_SIZE, count - begin);
+            EncodeSmallestThree(in + begin, QUAT32_MAX, index, a, b, c, n);
+            for (size_t i = 0; i < n; ++i)
+                out[begin + i] = uint32_t(index[i]) << 30 | uint32_t(a[i]) << 20 | uint32_t(b[i]) << 10 | uint32_t(c[i]);
+        }
+    }
+
+    void QuatCodec::decode32(const uint32_t *in, Quat *out, size_t count)
+    {
+        Real index[QUANTIZE_BLOCK_SIZE], a[QUANTIZE_BLOCK_SIZE], b[QUANTIZE_BLOCK_SIZE], c[QUANTIZE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += QUANTIZE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(QUANTIZE_BLOCK_SIZE, count - begin);
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint32_t v = in[begin + i];
+                index[i] = Real(v >> 30);
+                a[i] = Real((v >> 20) & 0x3ff);
+                b[i] = Real((v >> 10) & 0x3ff);
+                c[i] = Real(v & 0x3ff);
+            }
+            DecodeSmallestThree(index, a, b, c, QUAT32_MAX, out + begin, n);
+        }
+    }
+
+    void QuatCodec::encode48(const Quat *in, uint16_t *out, size_t count)
+    {
+        Real index[QUANTIZE_BLOCK_SIZE], a[QUANTIZE_BLOCK_SIZE], b[QUANTIZE_BLOCK_SIZE], c[QUANTIZE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += QUANTIZE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(QUANTIZE_BLOCK_SIZE, count - begin);
+            EncodeSmallestThree(in + begin, QUAT48_MAX, index, a, b, c, n);
+            uint16_t *o = out + begin * 3;
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint32_t idx = uint32_t(index[i]);
+                o[i * 3] = uint16_t((idx >> 1) << 15 | uint32_t(a[i]));
+                o[i * 3 + 1] = uint16_t((idx & 1) << 15 | uint32_t(b[i]));
+                o[i * 3 + 2] = uint16_t(c[i]);
+            }
+        }
+    }
+
+    void QuatCodec::decode48(const uint16_t *in, Quat *out, size_t count)
+    {
+        Real index[QUANTIZE_BLOCK_SIZE], a[QUANTIZE_BLOCK_SIZE], b[QUANTIZE_BLOCK_SIZE], c[QUANTIZE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += QUANTIZE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(QUANTIZE_BLOCK_SIZE, count - begin);
+            const uint16_t *p = in + begin * 3;
+            for (size_t i = 0; i < n; ++i)
+            {
+                index[i] = Real((p[i * 3] >> 15) << 1 | p[i * 3 + 1] >> 15);
+                a[i] = Real(p[i * 3] & 0x7fff);
+                b[i] = Real(p[i * 3 + 1] & 0x7fff);
+                c[i] = Real(p[i * 3 + 2] & 0x7fff);
+            }
+            DecodeSmallestThree(index, a, b, c, QUAT48_MAX, out + begin, n);
+        }
+    }
+
+    static inline uint32_t FloatBits(float f)
+    {
+        uint32_t u;
+        memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+
+    static inline float BitsFloat(uint32_t u)
+    {
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+
+    // round to nearest even, denormals included; the rounding of the denormal
+    // range is done by the float adder (after F. Giesen, "float_to_half_fast3_rtne")
+    static inline uint16_t FloatToHalf(float f)
+    {
+        const uint32_t f32Infinity = 255u << 23;
+        const uint32_t f16Max = (127u + 16u) << 23;
+        const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        uint32_t x = FloatBits(f);
+        uint32_t sign = x & 0x80000000u;
+        x ^= sign;
+
+        uint16_t h;
+        if (x >= f16Max)
+            h = x > f32Infinity ? 0x7e00 : 0x7c00;
+        else if (x < (113u << 23))
+            h = uint16_t(FloatBits(BitsFloat(x) + BitsFloat(denormMagic)) - denormMagic);
+        else
+        {
+            uint32_t mantissaOdd = (x >> 13) & 1;
+            x += ((15u - 127u) << 23) + 0xfff + mantissaOdd;
+            h = uint16_t(x >> 13);
+        }
+        return uint16_t(h | (sign >> 16));
+    }
+
+    static inline float HalfToFloat(uint16_t h)
+    {
+        const uint32_t shiftedExponent = 0x7c00u << 13;
+        uint32_t x = (h & 0x7fffu) << 13;
+        uint32_t exponent = x & shiftedExponent;
+        x += (127u - 15u) << 23;
+        if (exponent == shiftedExponent)
+            x += (128u - 16u) << 23;
+        else if (exponent == 0)
+            x = FloatBits(BitsFloat(x + (1u << 23)) - BitsFloat(113u << 23));
+        return BitsFloat(x | (uint32_t(h & 0x8000u) << 16));
+    }
+
+    uint16_t HalfCodec::encode(Real v)
+    {
+        return FloatToHalf(float(v));
+    }
+
+    Real HalfCodec::decode(uint16_t h)
+    {
+        return Real(HalfToFloat(h));
+    }
+
+    void HalfCodec::encode(const Real *in, uint16_t *out, size_t count)
+    {
+        size_t i = 0;
+#if CN_SIMD_X86 && defined(__F16C__)
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#elif CN_SIMD == CN_SIMD_NEON && defined(__aarch64__)
+        for (; i + 4 <= count; i += 4)
+            vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+#endif
+        for (; i < count; ++i)
+            out[i] = FloatToHalf(float(in[i]));
+    }
+
+    void HalfCodec::decode(const uint16_t *in, Real *out, size_t count)
+    {
+        size_t i = 0;
+#if CN_SIMD_X86 && defined(__F16C__)
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+#elif CN_SIMD == CN_SIMD_NEON && defined(__aarch64__)
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+#endif
+        for (; i < count; ++i)
+            out[i] = Real(HalfToFloat(in[i]));
+    }
+
+    void HalfCodec::encode(const Vec3 *in, uint16_t *out, size_t count)
+    {
+        encode(reinterpret_cast<const Real*>(in), out, count * 3);
+    }
+
+    void HalfCodec::decode(const uint16_t *in, Vec3 *out, size_t count)
+    {
+        decode(in, reinterpret_cast<Real*>(out), count * 3);
+    }
+
+    PositionCodec::PositionCodec(const AABB &bounds, unsigned bits)
+        : m_bounds(bounds)
+        , m_bits(bits)
+    {
+        cnAssert(1 <= bits && bits <= 16);
+        Real max = Real((1u << bits) - 1);
+        Vec3 size = bounds.getSize();
+        for (int k = 0; k < 3; ++k)
+        {
+            m_scale[k] = size[k] > 0.0f ? max / size[k] : 0.0f;
+            m_step[k] = size[k] > 0.0f ? size[k] / max : 0.0f;
+        }
+    }
+
+    void PositionCodec::encode(const Vec3 &v, uint16_t *out) const
+    {
+        encode(&v, out, 1);
+    }
+
+    Vec3 PositionCodec::decode(const uint16_t *in) const
+    {
+        Vec3 v;
+        decode(in, &v, 1);
+        return v;
+    }
+
+    void PositionCodec::encode(const Vec3 *in, uint16_t *out, size_t count) const
+    {
+        const Real max = Real((1u << m_bits) - 1);
+        Real q[QUANTIZE_BLOCK_SIZE * 3];
+        for (size_t begin = 0; begin < count; begin += QUANTIZE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(QUANTIZE_BLOCK_SIZE, count - begin);
+            const Real *v = reinterpret_cast<const Real*>(in + begin);
+            size_t i = PositionEncodeKernel<SimdOps>(v, m_bounds.min, m_scale, max, q, 0, n);
+            PositionEncodeKernel<SimdOps1>(v, m_bounds.min, m_scale, max, q, i, n);
+            uint16_t *o = out + begin * 3;
+            for (size_t k = 0; k < n * 3; ++k)
+                o[k] = uint16_t(q[k]);
+        }
+    }
+
+    void PositionCodec::decode(const uint16_t *in, Vec3 *out, size_t count) const
+    {
+        Real q[QUANTIZE_BLOCK_SIZE * 3];
+        for (size_t begin = 0; begin < count; begin += QUANTIZE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(QUANTIZE_BLOCK_SIZE, count - begin);
+            const uint16_t *p = in + begin * 3;
+            for (size_t k = 0; k < n * 3; ++k)
+                q[k] = Real(p[k]);
+            Real *v = reinterpret_cast<Real*>(out + begin);
+            size_t i = PositionDecodeKernel<SimdOps>(q, m_bounds.min, m_step, v, 0, n);
+            PositionDecodeKernel<SimdOps1>(q, m_bounds.min, m_step, v, i, n);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef _CN_QUANTIZATION_
+#define _CN_QUANTIZATION_
+#include "Prerequisites.h"
+#include "Quaternion.h"
+#include "AABB.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    /*
+        Compact encodings of Quat and Vec3 for snapshots, replays and
+        transform history buffers. The bulk functions encode and decode whole
+        arrays, the float math vectorized (SIMD.h); the single element forms
+        give identical results.
+
+        Round-trip error bounds, decode(encode(v)) against v:
+
+        QuatCodec, smallest three: the largest component of a unit quaternion
+        is dropped and rebuilt from the other three, which lie in
+        [-1/sqrt(2), 1/sqrt(2)] and are stored in 10 bits (32 bit form) or 15
+        bits (48 bit form) each. The sign is chosen so the dropped component
+        is positive, q and -q being the same rotation. The three stored
+        components are within half a step; the rebuilt one within three half
+        steps, reached when all four components are near 1/2.
+        - 32 bits: stored components within 7e-4, the rebuilt one within
+          2.1e-3, rotation angle within 4.8e-3 rad (0.28 degrees) of the
+          input.
+        - 48 bits: stored components within 2.2e-5, the rebuilt one within
+          6.5e-5, rotation angle within 1.5e-4 rad.
+        Inputs must be unit length; decoded quaternions are unit length to
+        float rounding.
+
+        HalfCodec, IEEE 754 binary16 with round to nearest even: relative
+        error 2^-11 (4.9e-4) for magnitudes in [6.1e-5, 65504], absolute
+        error 2^-25 (3e-8) below. Larger magnitudes become infinity, NaN
+        stays NaN. Uses the F16C or NEON conversion instructions when
+        compiled for them, bit identical to the portable path.
+
+        PositionCodec, uniform quantization of each axis of a bounding box
+        to bits bits: within getMaxError() (half a step, size / (2^bits - 1)
+        / 2 per axis) plus the float rounding of the decoded coordinate, for
+        points inside the box. Points outside are clamped to the box first.
+    */
+    class CN_EXPORT QuatCodec
+    {
+    public:
+
+        // bits 31-30 index of the dropped component (w, x, y, z), then the other three
+        // in that order, 10 bits each
+        static uint32_t encode32(const Quat &q);
+        static Quat decode32(uint32_t v);
+        // out[0] bit 15 and out[1] bit 15 index of the dropped component, then the
+        // other three in the low 15 bits of out[0], out[1], out[2]
+        static void encode48(const Quat &q, uint16_t *out);
+        static Quat decode48(const uint16_t *in);
+
+        static void encode32(const Quat *in, uint32_t *out, size_t count);
+        static void decode32(const uint32_t *in, Quat *out, size_t count);
+        // three uint16_t per quaternion
+        static void encode48(const Quat *in, uint16_t *out, size_t count);
+        static void decode48(const uint16_t *in, Quat *out, size_t count);
+    };
+
+    class CN_EXPORT HalfCodec
+    {
+    public:
+
+        static uint16_t encode(Real v);
+        static Real decode(uint16_t h);
+
+        static void encode(const Real *in, uint16_t *out, size_t count);
+        static void decode(const uint16_t *in, Real *out, size_t count);
+        // x, y, z, three uint16_t per vector
+        static void encode(const Vec3 *in, uint16_t *out, size_t count);
+        static void decode(const uint16_t *in, Vec3 *out, size_t count);
+    };
+
+    class CN_EXPORT PositionCodec
+    {
+    public:
+
+        // bits per axis, 1 to 16
+        explicit PositionCodec(const AABB &bounds, unsigned bits = 16);
+
+        const AABB& getBounds() const { return m_bounds; }
+        unsigned getBits() const { return m_bits; }
+        // per axis bound of |decode(encode(v)) - v| for v inside the bounds
+        Vec3 getMaxError() const { return m_step * 0.5f; }
+
+        // x, y, z, three uint16_t per position
+        void encode(const Vec3 &v, uint16_t *out) const;
+        Vec3 decode(const uint16_t *in) const;
+
+        void encode(const Vec3 *in, uint16_t *out, size_t count) const;
+        void decode(const uint16_t *in, Vec3 *out, size_t count) const;
+
+    private:
+
+        AABB m_bounds;
+        unsigned m_bits;
+        // quantization steps per unit, and units per step
+        Vec3 m_scale;
+        Vec3 m_step;
+    };
+}
+
+#endif
@@ -1,57 +1,41 @@
 #include "Quaternion.h"
 #include "Matrix3.h"
+#include <type_traits>
 
 namespace Canaan
 {
-    const Quat Quat::ZERO = Quat(0.0f, 0.0f, 0.0f, 0.0f);
-    const Quat Quat::IDENTITY = Quat();
-    static const Real msEpsilon = 1e-03f;
-
-    Quat::Quat()
-        : w(1.0f)
-        , x(0.0f)
-        , y(0.0f)
-        , z(0.0f)
-    {
+    static_assert(std::is_trivially_copyable<Quat>::value, "QuatArray copies rely on a trivial Quat");
 
-    }
-
-    Quat::Quat(const Real w, const Real x, const Real y, const Real z)
-        : w(w)
-        , x(x)
-        , y(y)
-        , z(z)
-    {
-
-    }
+    constexpr Quat Quat::ZERO = Quat(0.0f, 0.0f, 0.0f, 0.0f);
+    constexpr Quat Quat::IDENTITY = Quat();
+    static_assert(Quat::IDENTITY.w == 1.0f, "Quat constants are compile-time");
+    static const Real msEpsilon = 1e-03f;
 
     Quat::Quat(const Real angle, const Vec3 &axes)
     {
         this->fromAngleAxis(angle, axes);
     }
 
-    Quat::Quat(const Quat &copy)
-        : w(copy.w)
-        , x(copy.x)
-        , y(copy.y)
-        , z(copy.z)
-    {
-
-    }
-
     Quat::Quat(const Mat3 &rotMat)
     {
         this->fromMat3(rotMat);
     }
 
-    Quat::~Quat()
+    void Quat::set(const Real angle, const Vec3 &axes)
     {
-
+        this->fromAngleAxis(angle, axes);
     }
 
-    void Quat::set(const Real angle, const Vec3 &axes)
+    void Quat::setFast(const Real angle, const Vec3 &axes)
     {
-        this->fromAngleAxis(angle, axes);
+        Real fSin, fCos;
+        FastSinCos(0.5f * angle, fSin, fCos);
+        Vec3 normal(axes);
+        normal.normalizeFast();
+        w = fCos;
+        x = fSin * normal.x;
+        y = fSin * normal.y;
+        z = fSin * normal.z;
     }
 
     void Quat::set(const Mat3 &rotMat)
@@ -72,6 +56,13 @@ namespace Canaan
         return len;
     }
 
+    Real Quat::normalizeFast()
+    {
+        Real len = normLength();
+        *this = *this * FastInvSqrt(len);
+        return len;
+    }
+
     void Quat::inverse()
     {
         Real fNorm = normLength();
@@ -224,6 +215,55 @@ namespace Canaan
         return result;
     }
 
+    Quat Quat::slerpFast(Real fT, const Quat& rkP, const Quat& rkQ, bool shortestPath /*= false*/)
+    {
+        Real fCos = rkP.dot(rkQ);
+        Quat rkT;
+
+        if (fCos < 0.0f && shortestPath)
+        {
+            fCos = -fCos;
+            rkT = -rkQ;
+        }
+        else
+        {
+            rkT = rkQ;
+        }
+
+        if (abs(fCos) < 1 - msEpsilon)
+        {
+            // same as slerp, sin^2 > 0 here so the reciprocal square root is safe
+            Real fSinSq = 1 - fCos * fCos;
+            Real fInvSin = FastInvSqrt(fSinSq);
+            Real fAngle = FastAtan2(fSinSq * fInvSin, fCos);
+            Real fCoeff0 = FastSin((1.0f - fT) * fAngle) * fInvSin;
+            Real fCoeff1 = FastSin(fT * fAngle) * fInvSin;
+            return fCoeff0 * rkP + fCoeff1 * rkT;
+        }
+        else
+        {
+            Quat t = (1.0f - fT) * rkP + fT * rkT;
+            t.normalizeFast();
+            return t;
+        }
+    }
+
+    Quat Quat::nlerpFast(Real fT, const Quat& rkP, const Quat& rkQ, bool shortestPath /*= false*/)
+    {
+        Quat result;
+        Real fCos = rkP.dot(rkQ);
+        if (fCos < 0.0f && shortestPath)
+        {
+            result = rkP + fT * ((-rkQ) - rkP);
+        }
+        else
+        {
+            result = rkP + fT * (rkQ - rkP);
+        }
+        result.normalizeFast();
+        return result;
+    }
+
     Quat Quat::squad(Real fT, const Quat& rkP, const Quat& rkA, const Quat& rkB, const Quat& rkQ, bool shortestPath /*= false*/)
     {
         Real fSlerpT = 2.0f*fT*(1.0f - fT);
@@ -232,6 +272,60 @@ namespace Canaan
         return slerp(fSlerpT, kSlerpP, kSlerpQ);
     }
 
+    Quat Quat::squadFast(Real fT, const Quat& rkP, const Quat& rkA, const Quat& rkB, const Quat& rkQ, bool shortestPath /*= false*/)
+    {
+        Real fSlerpT = 2.0f*fT*(1.0f - fT);
+        Quat kSlerpP = slerpFast(fT, rkP, rkQ, shortestPath);
+        Quat kSlerpQ = slerpFast(fT, rkA, rkB);
+        return slerpFast(fSlerpT, kSlerpP, kSlerpQ);
+    }
+
+    Quat Quat::squadTangent(const Quat& rkPrev, const Quat& rkQ, const Quat& rkNext)
+    {
+        // keep the neighbours in the hemisphere of rkQ so the tangent follows the short arcs
+        Quat kPrev = rkQ.dot(rkPrev) < 0.0f ? -rkPrev : rkPrev;
+        Quat kNext = rkQ.dot(rkNext) < 0.0f ? -rkNext : rkNext;
+        Quat kInv = rkQ;
+        kInv.unitInverse();
+        Quat kLog = (kInv * kNext).log() + (kInv * kPrev).log();
+        return rkQ * (-0.25f * kLog).exp();
+    }
+
+    Quat Quat::log() const
+    {
+        // q = (cos(A), sin(A) * V) => log(q) = (0, A * V)
+        Quat kResult(0.0f, x, y, z);
+        if (abs(w) < 1.0f)
+        {
+            Real fAngle = acos(w);
+            Real fSin = sin(fAngle);
+            if (abs(fSin) >= msEpsilon)
+            {
+                Real fCoeff = fAngle / fSin;
+                kResult.x = fCoeff * x;
+                kResult.y = fCoeff * y;
+                kResult.z = fCoeff * z;
+            }
+        }
+        return kResult;
+    }
+
+    Quat Quat::exp() const
+    {
+        // q = (0, A * V) => exp(q) = (cos(A), sin(A) * V)
+        Real fAngle = sqrt(x * x + y * y + z * z);
+        Real fSin = sin(fAngle);
+        Quat kResult(cos(fAngle), x, y, z);
+        if (abs(fSin) >= msEpsilon)
+        {
+            Real fCoeff = fSin / fAngle;
+            kResult.x = fCoeff * x;
+            kResult.y = fCoeff * y;
+            kResult.z = fCoeff * z;
+        }
+        return kResult;
+    }
+
     void Quat::fromAngleAxis(const Real angle, const Vec3 &axes)
     {
         Real fHalfAngle(0.5f*angle);
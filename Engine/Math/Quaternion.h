@@ -13,17 +13,19 @@ namespace Canaan
         static const Quat ZERO;
         static const Quat IDENTITY;
 
-        Quat();
-        Quat(const Quat &copy);
+        constexpr Quat() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
         Quat(const Mat3 &rotMat);
-        Quat(const Real w, const Real x, const Real y, const Real z);
+        constexpr Quat(const Real w, const Real x, const Real y, const Real z) : w(w), x(x), y(y), z(z) {}
         Quat(const Real angle, const Vec3 &axes);
-        ~Quat();
 
         void set(const Mat3 &rotMat);
         void set(const Real angle, const Vec3 &axes);
+        // set() using FastSinCos, see Mathematics.h for the error bounds
+        void setFast(const Real angle, const Vec3 &axes);
         Real dot(const Quat &rkQ) const;
         Real normalize();
+        // normalize() using FastInvSqrt
+        Real normalizeFast();
         void inverse();
         void unitInverse();
         Real roll(bool reprojectAxis = true) const;
@@ -39,9 +41,24 @@ namespace Canaan
         static Quat slerp(Real fT, const Quat& rkP, const Quat& rkQ, bool shortestPath = false);
         //nlerp is faster than Slerp.
         static Quat nlerp(Real fT, const Quat& rkP, const Quat& rkQ, bool shortestPath = false);
+        // slerp and nlerp on the fast approximate tier (Mathematics.h), for animation
+        // and particles that trade accuracy for throughput. Components stay within
+        // 3e-5 of slerp and 5e-7 of nlerp.
+        static Quat slerpFast(Real fT, const Quat& rkP, const Quat& rkQ, bool shortestPath = false);
+        static Quat nlerpFast(Real fT, const Quat& rkP, const Quat& rkQ, bool shortestPath = false);
+        static Quat squadFast(Real fT, const Quat& rkP,
+            const Quat& rkA, const Quat& rkB,
+            const Quat& rkQ, bool shortestPath = false);
         static Quat squad(Real fT, const Quat& rkP,
             const Quat& rkA, const Quat& rkB,
             const Quat& rkQ, bool shortestPath = false);
+        // inner control point of key rkQ for squad, from its neighbouring keys.
+        // Compute once per key: squad(t, q[i], tangent[i], tangent[i + 1], q[i + 1])
+        static Quat squadTangent(const Quat& rkPrev, const Quat& rkQ, const Quat& rkNext);
+
+        // logarithm and exponent of unit quaternions, log has w = 0
+        Quat log() const;
+        Quat exp() const;
 
         inline Real operator [] (const size_t i) const{
             cnAssert(i < 4);
@@ -56,14 +73,6 @@ namespace Canaan
             return *(&w + i);
         }
 
-        inline Quat& operator= (const Quat& rkQ){
-            w = rkQ.w;
-            x = rkQ.x;
-            y = rkQ.y;
-            z = rkQ.z;
-            return *this;
-        }
-
         Quat operator+ (const Quat& rkQ) const{
             return Quat(w + rkQ.w, x + rkQ.x, y + rkQ.y, z + rkQ.z);
         }
@@ -126,7 +135,7 @@ namespace Canaan
         }
 
         friend Quat operator * (const Real fScalar, const Quat& rkQ){
-            return Quat(fScalar * rkQ.w, fScalar * rkQ.y, fScalar * rkQ.z, fScalar * rkQ.z);
+            return Quat(fScalar * rkQ.w, fScalar * rkQ.x, fScalar * rkQ.y, fScalar * rkQ.z);
         }
         friend Vec3 operator * (const Vec3& v, const Quat& rkQ){
             // nVidia SDK implementation
@@ -166,5 +175,7 @@ namespace Canaan
 
         return v + uv + uuv;
     }*/
+
+    typedef std::vector<Quat> QuatArray;
 }
 #endif
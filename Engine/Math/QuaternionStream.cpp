@@ -0,0 +1,368 @@
+#include "QuaternionStream.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    // same threshold as Quat::slerp for falling back to a normalized lerp
+    static const Real msSlerpEpsilon = 1e-03f;
+
+    template<class S>
+    static inline void LoadQuatLanes(const QuatStream &q, size_t i, typename S::V r[4])
+    {
+        r[0] = S::load(q.w() + i);
+        r[1] = S::load(q.x() + i);
+        r[2] = S::load(q.y() + i);
+        r[3] = S::load(q.z() + i);
+    }
+
+    template<class S>
+    static inline void StoreQuatLanes(QuatStream &q, size_t i, const typename S::V r[4])
+    {
+        S::store(q.w() + i, r[0]);
+        S::store(q.x() + i, r[1]);
+        S::store(q.y() + i, r[2]);
+        S::store(q.z() + i, r[3]);
+    }
+
+    template<class S>
+    static inline typename S::V DotQuatLanes(const typename S::V a[4], const typename S::V b[4])
+    {
+        return S::add(S::add(S::add(S::mul(a[0], b[0]), S::mul(a[1], b[1])), S::mul(a[2], b[2])), S::mul(a[3], b[3]));
+    }
+
+    // Quat::slerpFast on S::WIDTH lanes. Both the slerp and the lerp results are
+    // computed and selected per lane, lerp lanes get renormalized.
+    template<class S, bool SHORTEST>
+    static inline void SlerpQuatLanes(typename S::V t, const typename S::V p[4], const typename S::V q[4], typename S::V r[4])
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        V c = DotQuatLanes<S>(p, q);
+        V qs[4] = { q[0], q[1], q[2], q[3] };
+        if (SHORTEST)
+        {
+            typename S::M flip = S::cmpgt(zero, c);
+            c = S::select(flip, S::sub(zero, c), c);
+            for (int k = 0; k < 4; ++k)
+                qs[k] = S::select(flip, S::sub(zero, q[k]), q[k]);
+        }
+
+        typename S::M linear = S::cmpge(S::abs(c), S::set1(1.0f - msSlerpEpsilon));
+        V sinSq = S::sub(one, S::mul(c, c));
+        V invSin = FastInvSqrt<S>(sinSq);
+        V angle = FastAtan2<S>(S::mul(sinSq, invSin), c);
+        V omt = S::sub(one, t);
+        V c0 = S::select(linear, omt, S::mul(FastSin<S>(S::mul(omt, angle)), invSin));
+        V c1 = S::select(linear, t, S::mul(FastSin<S>(S::mul(t, angle)), invSin));
+        for (int k = 0; k < 4; ++k)
+            r[k] = S::add(S::mul(c0, p[k]), S::mul(c1, qs[k]));
+
+        V factor = S::select(linear, FastInvSqrt<S>(DotQuatLanes<S>(r, r)), one);
+        for (int k = 0; k < 4; ++k)
+            r[k] = S::mul(r[k], factor);
+    }
+
+    template<class S, bool SHORTEST>
+    static size_t NlerpQuatKernel(const Real *fT, const QuatStream &p, const QuatStream &q, QuatStream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V t = S::load(fT + i);
+            V pl[4], ql[4], r[4];
+            LoadQuatLanes<S>(p, i, pl);
+            LoadQuatLanes<S>(q, i, ql);
+            if (SHORTEST)
+            {
+                typename S::M flip = S::cmpgt(zero, DotQuatLanes<S>(pl, ql));
+                for (int k = 0; k < 4; ++k)
+                    ql[k] = S::select(flip, S::sub(zero, ql[k]), ql[k]);
+            }
+            for (int k = 0; k < 4; ++k)
+                r[k] = S::add(pl[k], S::mul(t, S::sub(ql[k], pl[k])));
+            V factor = S::div(one, S::sqrt(DotQuatLanes<S>(r, r)));
+            for (int k = 0; k < 4; ++k)
+                r[k] = S::mul(r[k], factor);
+            StoreQuatLanes<S>(out, i, r);
+        }
+        return i;
+    }
+
+    template<class S, bool SHORTEST>
+    static size_t SlerpQuatKernel(const Real *fT, const QuatStream &p, const QuatStream &q, QuatStream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V pl[4], ql[4], r[4];
+            LoadQuatLanes<S>(p, i, pl);
+            LoadQuatLanes<S>(q, i, ql);
+            SlerpQuatLanes<S, SHORTEST>(S::load(fT + i), pl, ql, r);
+            StoreQuatLanes<S>(out, i, r);
+        }
+        return i;
+    }
+
+    template<class S, bool SHORTEST>
+    static size_t SquadQuatKernel(const Real *fT, const QuatStream &p, const QuatStream &a, const QuatStream &b,
+        const QuatStream &q, QuatStream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V one = S::set1(1.0f);
+        const V two = S::set1(2.0f);
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V t = S::load(fT + i);
+            V pl[4], al[4], bl[4], ql[4], slerpP[4], slerpQ[4], r[4];
+            LoadQuatLanes<S>(p, i, pl);
+            LoadQuatLanes<S>(a, i, al);
+            LoadQuatLanes<S>(b, i, bl);
+            LoadQuatLanes<S>(q, i, ql);
+            SlerpQuatLanes<S, SHORTEST>(t, pl, ql, slerpP);
+            SlerpQuatLanes<S, false>(t, al, bl, slerpQ);
+            V slerpT = S::mul(S::mul(two, t), S::sub(one, t));
+            SlerpQuatLanes<S, false>(slerpT, slerpP, slerpQ, r);
+            StoreQuatLanes<S>(out, i, r);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t NormalizeQuatKernel(QuatStream &q, size_t count)
+    {
+        typedef typename S::V V;
+        const V one = S::set1(1.0f);
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V w = S::load(q.w() + i), x = S::load(q.x() + i), y = S::load(q.y() + i), z = S::load(q.z() + i);
+            V len = S::add(S::add(S::add(S::mul(w, w), S::mul(x, x)), S::mul(y, y)), S::mul(z, z));
+            V factor = S::div(one, S::sqrt(len));
+            S::store(q.w() + i, S::mul(factor, w));
+            S::store(q.x() + i, S::mul(factor, x));
+            S::store(q.y() + i, S::mul(factor, y));
+            S::store(q.z() + i, S::mul(factor, z));
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t DotQuatKernel(const QuatStream &a, const QuatStream &b, Real* out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V d = S::mul(S::load(a.w() + i), S::load(b.w() + i));
+            d = S::add(d, S::mul(S::load(a.x() + i), S::load(b.x() + i)));
+            d = S::add(d, S::mul(S::load(a.y() + i), S::load(b.y() + i)));
+            d = S::add(d, S::mul(S::load(a.z() + i), S::load(b.z() + i)));
+            S::store(out + i, d);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t MultiplyQuatKernel(const QuatStream &a, const QuatStream &b, QuatStream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V aw = S::load(a.w() + i), ax = S::load(a.x() + i), ay = S::load(a.y() + i), az = S::load(a.z() + i);
+            V bw = S::load(b.w() + i), bx = S::load(b.x() + i), by = S::load(b.y() + i), bz = S::load(b.z() + i);
+            S::store(out.w() + i, S::sub(S::sub(S::sub(S::mul(aw, bw), S::mul(ax, bx)), S::mul(ay, by)), S::mul(az, bz)));
+            S::store(out.x() + i, S::sub(S::add(S::add(S::mul(aw, bx), S::mul(ax, bw)), S::mul(ay, bz)), S::mul(az, by)));
+            S::store(out.y() + i, S::sub(S::add(S::add(S::mul(aw, by), S::mul(ay, bw)), S::mul(az, bx)), S::mul(ax, bz)));
+            S::store(out.z() + i, S::sub(S::add(S::add(S::mul(aw, bz), S::mul(az, bw)), S::mul(ax, by)), S::mul(ay, bx)));
+        }
+        return i;
+    }
+
+    // nVidia SDK formulation, the same as Quat::operator* (const Vec3&)
+    template<class S, bool UNIFORM>
+    static size_t RotateKernel(const QuatStream *qs, const Quat &q, const Vec3Stream &v, Vec3Stream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V two = S::set1(2.0f);
+        V qw = S::set1(q.w), qx = S::set1(q.x), qy = S::set1(q.y), qz = S::set1(q.z);
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            if (!UNIFORM)
+            {
+                qw = S::load(qs->w() + i);
+                qx = S::load(qs->x() + i);
+                qy = S::load(qs->y() + i);
+                qz = S::load(qs->z() + i);
+            }
+            V vx = S::load(v.x() + i), vy = S::load(v.y() + i), vz = S::load(v.z() + i);
+            V uvx = S::sub(S::mul(qy, vz), S::mul(qz, vy));
+            V uvy = S::sub(S::mul(qz, vx), S::mul(qx, vz));
+            V uvz = S::sub(S::mul(qx, vy), S::mul(qy, vx));
+            V uuvx = S::sub(S::mul(qy, uvz), S::mul(qz, uvy));
+            V uuvy = S::sub(S::mul(qz, uvx), S::mul(qx, uvz));
+            V uuvz = S::sub(S::mul(qx, uvy), S::mul(qy, uvx));
+            V w2 = S::mul(two, qw);
+            S::store(out.x() + i, S::add(S::add(vx, S::mul(uvx, w2)), S::mul(uuvx, two)));
+            S::store(out.y() + i, S::add(S::add(vy, S::mul(uvy, w2)), S::mul(uuvy, two)));
+            S::store(out.z() + i, S::add(S::add(vz, S::mul(uvz, w2)), S::mul(uuvz, two)));
+        }
+        return i;
+    }
+
+    QuatStream::QuatStream()
+    {
+
+    }
+
+    QuatStream::QuatStream(size_t count)
+    {
+        resize(count);
+    }
+
+    QuatStream::QuatStream(const QuatArray &array)
+    {
+        fromArray(array);
+    }
+
+    QuatStream::~QuatStream()
+    {
+
+    }
+
+    void QuatStream::resize(size_t count)
+    {
+        m_w.resize(count, 1.0f);
+        m_x.resize(count);
+        m_y.resize(count);
+        m_z.resize(count);
+    }
+
+    void QuatStream::clear()
+    {
+        m_w.clear();
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+    }
+
+    void QuatStream::fromArray(const QuatArray &array)
+    {
+        resize(array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+            set(i, array[i]);
+    }
+
+    void QuatStream::toArray(QuatArray &array) const
+    {
+        array.resize(size());
+        for (size_t i = 0; i < array.size(); ++i)
+            array[i] = get(i);
+    }
+
+    void QuatStream::normalize()
+    {
+        size_t i = NormalizeQuatKernel<SimdOps>(*this, size());
+        for (; i < size(); ++i)
+        {
+            Quat q = get(i);
+            q.normalize();
+            set(i, q);
+        }
+    }
+
+    void QuatStream::dot(const QuatStream &a, const QuatStream &b, Real *out)
+    {
+        cnAssert(a.size() == b.size());
+        size_t i = DotQuatKernel<SimdOps>(a, b, out, 0, a.size());
+        DotQuatKernel<SimdOps1>(a, b, out, i, a.size());
+    }
+
+    void QuatStream::multiply(const QuatStream &a, const QuatStream &b, QuatStream &out)
+    {
+        cnAssert(a.size() == b.size());
+        out.resize(a.size());
+        size_t i = MultiplyQuatKernel<SimdOps>(a, b, out, 0, a.size());
+        MultiplyQuatKernel<SimdOps1>(a, b, out, i, a.size());
+    }
+
+    void QuatStream::rotate(const QuatStream &q, const Vec3Stream &v, Vec3Stream &out)
+    {
+        cnAssert(q.size() == v.size());
+        out.resize(v.size());
+        size_t i = RotateKernel<SimdOps, false>(&q, Quat::IDENTITY, v, out, 0, v.size());
+        RotateKernel<SimdOps1, false>(&q, Quat::IDENTITY, v, out, i, v.size());
+    }
+
+    void QuatStream::rotate(const Quat &q, const Vec3Stream &v, Vec3Stream &out)
+    {
+        out.resize(v.size());
+        size_t i = RotateKernel<SimdOps, true>(nullptr, q, v, out, 0, v.size());
+        RotateKernel<SimdOps1, true>(nullptr, q, v, out, i, v.size());
+    }
+
+    void QuatStream::nlerp(const Real *fT, const QuatStream &p, const QuatStream &q, QuatStream &out, bool shortestPath)
+    {
+        cnAssert(p.size() == q.size());
+        out.resize(p.size());
+        if (shortestPath)
+        {
+            size_t i = NlerpQuatKernel<SimdOps, true>(fT, p, q, out, 0, p.size());
+            NlerpQuatKernel<SimdOps1, true>(fT, p, q, out, i, p.size());
+        }
+        else
+        {
+            size_t i = NlerpQuatKernel<SimdOps, false>(fT, p, q, out, 0, p.size());
+            NlerpQuatKernel<SimdOps1, false>(fT, p, q, out, i, p.size());
+        }
+    }
+
+    void QuatStream::slerp(const Real *fT, const QuatStream &p, const QuatStream &q, QuatStream &out, bool shortestPath)
+    {
+        cnAssert(p.size() == q.size());
+        out.resize(p.size());
+        if (shortestPath)
+        {
+            size_t i = SlerpQuatKernel<SimdOps, true>(fT, p, q, out, 0, p.size());
+            SlerpQuatKernel<SimdOps1, true>(fT, p, q, out, i, p.size());
+        }
+        else
+        {
+            size_t i = SlerpQuatKernel<SimdOps, false>(fT, p, q, out, 0, p.size());
+            SlerpQuatKernel<SimdOps1, false>(fT, p, q, out, i, p.size());
+        }
+    }
+
+    void QuatStream::squad(const Real *fT, const QuatStream &p, const QuatStream &a, const QuatStream &b,
+        const QuatStream &q, QuatStream &out, bool shortestPath)
+    {
+        cnAssert(p.size() == q.size() && a.size() == p.size() && b.size() == p.size());
+        out.resize(p.size());
+        if (shortestPath)
+        {
+            size_t i = SquadQuatKernel<SimdOps, true>(fT, p, a, b, q, out, 0, p.size());
+            SquadQuatKernel<SimdOps1, true>(fT, p, a, b, q, out, i, p.size());
+        }
+        else
+        {
+            size_t i = SquadQuatKernel<SimdOps, false>(fT, p, a, b, q, out, 0, p.size());
+            SquadQuatKernel<SimdOps1, false>(fT, p, a, b, q, out, i, p.size());
+        }
+    }
+
+    void QuatStream::squadTangents(const QuatStream &prev, const QuatStream &key, const QuatStream &next, QuatStream &out)
+    {
+        // evaluated once per key, not per sample, so this stays scalar
+        cnAssert(prev.size() == key.size() && next.size() == key.size());
+        out.resize(key.size());
+        for (size_t i = 0; i < key.size(); ++i)
+            out.set(i, Quat::squadTangent(prev.get(i), key.get(i), next.get(i)));
+    }
+}
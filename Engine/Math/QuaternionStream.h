@@ -0,0 +1,74 @@
+#ifndef _CN_QUATERNION_STREAM_
+#define _CN_QUATERNION_STREAM_
+#include "Prerequisites.h"
+#include "Quaternion.h"
+#include "Vector3Stream.h"
+
+namespace Canaan
+{
+    /*
+        Structure-of-arrays storage for Quat, the counterpart of Vec3Stream.
+        Results of the static operations may be written to one of the
+        operand streams.
+    */
+    class CN_EXPORT QuatStream
+    {
+    public:
+
+        QuatStream();
+        explicit QuatStream(size_t count);
+        explicit QuatStream(const QuatArray &array);
+        ~QuatStream();
+
+        size_t size() const { return m_w.size(); }
+        bool empty() const { return m_w.empty(); }
+        void resize(size_t count);
+        void clear();
+
+        void fromArray(const QuatArray &array);
+        void toArray(QuatArray &array) const;
+
+        Quat get(size_t i) const { return Quat(m_w[i], m_x[i], m_y[i], m_z[i]); }
+        void set(size_t i, const Quat &q) { m_w[i] = q.w; m_x[i] = q.x; m_y[i] = q.y; m_z[i] = q.z; }
+
+        Real* w() { return m_w.data(); }
+        Real* x() { return m_x.data(); }
+        Real* y() { return m_y.data(); }
+        Real* z() { return m_z.data(); }
+        const Real* w() const { return m_w.data(); }
+        const Real* x() const { return m_x.data(); }
+        const Real* y() const { return m_y.data(); }
+        const Real* z() const { return m_z.data(); }
+
+        // in place, same as Quat::normalize on every element
+        void normalize();
+
+        static void dot(const QuatStream &a, const QuatStream &b, Real *out);
+        static void multiply(const QuatStream &a, const QuatStream &b, QuatStream &out);
+        // out[i] = q[i] * v[i], same as Quat::operator* (const Vec3&)
+        static void rotate(const QuatStream &q, const Vec3Stream &v, Vec3Stream &out);
+        // rotates every vector of v by the same q
+        static void rotate(const Quat &q, const Vec3Stream &v, Vec3Stream &out);
+
+        // Branch-free interpolation of key pairs with per-element weights fT,
+        // vectorized across elements. out may be one of the operands.
+        // nlerp matches Quat::nlerp per element, slerp and squad match Quat::slerpFast
+        // and Quat::squadFast (fast tier, Mathematics.h).
+        // a and b are the precomputed inner control points, see squadTangents.
+        static void nlerp(const Real *fT, const QuatStream &p, const QuatStream &q, QuatStream &out, bool shortestPath = false);
+        static void slerp(const Real *fT, const QuatStream &p, const QuatStream &q, QuatStream &out, bool shortestPath = false);
+        static void squad(const Real *fT, const QuatStream &p, const QuatStream &a, const QuatStream &b,
+            const QuatStream &q, QuatStream &out, bool shortestPath = false);
+        // out[i] = Quat::squadTangent(prev[i], key[i], next[i])
+        static void squadTangents(const QuatStream &prev, const QuatStream &key, const QuatStream &next, QuatStream &out);
+
+    private:
+
+        std::vector<Real> m_w;
+        std::vector<Real> m_x;
+        std::vector<Real> m_y;
+        std::vector<Real> m_z;
+    };
+}
+
+#endif
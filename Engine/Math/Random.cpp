@@ -0,0 +1,261 @@
+#include "Random.h"
+#include "Quaternion.h"
+#include "SIMD.h"
+#include <atomic>
+#include <cstring>
+
+namespace Canaan
+{
+    // uniforms drawn per block before the vectorized part of the fill functions
+    static const size_t RANDOM_BLOCK_SIZE = 256;
+
+    static inline uint64_t SplitMix64(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static inline uint32_t Rotl(uint32_t x, int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    static inline uint32_t NextXoshiro128(uint32_t *s)
+    {
+        uint32_t result = Rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 11);
+        return result;
+    }
+
+    // top 24 bits, exactly representable in a float
+    static inline Real ToUnit(uint32_t x)
+    {
+        return Real(x >> 8) * Real(1.0 / 16777216.0);
+    }
+
+    // rotation taking UNIT_Z to the unit vector axis
+    static Quat RotationFromUnitZ(const Vec3 &axis)
+    {
+        Real d = axis.z;
+        if (d < -1.0f + 1e-6f)
+            return Quat(0.0f, 1.0f, 0.0f, 0.0f);
+        Quat q(1.0f + d, -axis.y, axis.x, 0.0f);
+        q.normalize();
+        return q;
+    }
+
+    // q * v for S::WIDTH vectors, same formulation as Quat::operator* (const Vec3&)
+    template<class S>
+    static inline void RotateLanes(const Quat &q, typename S::V &x, typename S::V &y, typename S::V &z)
+    {
+        typedef typename S::V V;
+        const V two = S::set1(2.0f);
+        V qw = S::set1(q.w), qx = S::set1(q.x), qy = S::set1(q.y), qz = S::set1(q.z);
+        V uvx = S::sub(S::mul(qy, z), S::mul(qz, y));
+        V uvy = S::sub(S::mul(qz, x), S::mul(qx, z));
+        V uvz = S::sub(S::mul(qx, y), S::mul(qy, x));
+        V uuvx = S::sub(S::mul(qy, uvz), S::mul(qz, uvy));
+        V uuvy = S::sub(S::mul(qz, uvx), S::mul(qx, uvz));
+        V uuvz = S::sub(S::mul(qx, uvy), S::mul(qy, uvx));
+        V w2 = S::mul(two, qw);
+        x = S::add(S::add(x, S::mul(uvx, w2)), S::mul(uuvx, two));
+        y = S::add(S::add(y, S::mul(uvy, w2)), S::mul(uuvy, two));
+        z = S::add(S::add(z, S::mul(uvz, w2)), S::mul(uuvz, two));
+    }
+
+    // u in [0, 1) picks cos(theta) in [cosMax, 1], v the azimuth. cosMax = -1 covers
+    // the whole sphere.
+    template<class S, bool ROTATE>
+    static size_t ConeKernel(const Real *u, const Real *v, Real cosMax, const Quat &q, Real *out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V one = S::set1(1.0f);
+        const V zero = S::set1(0.0f);
+        const V range = S::set1(1.0f - cosMax);
+        const V twoPi = S::set1(TWO_PI);
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V cosT = S::sub(one, S::mul(S::load(u + i), range));
+            V sinT = S::sqrt(S::maximum(zero, S::sub(one, S::mul(cosT, cosT))));
+            V s, c;
+            FastSinCos<S>(S::mul(S::load(v + i), twoPi), s, c);
+            V x = S::mul(sinT, c), y = S::mul(sinT, s), z = cosT;
+            if (ROTATE)
+                RotateLanes<S>(q, x, y, z);
+            S::store3(out + i * 3, x, y, z);
+        }
+        return i;
+    }
+
+    // rotates d about newUp = cos(phi) * e1 + sin(phi) * e2 by angle, with e1 the
+    // Vec3::perpendicular of d and e2 completing the frame
+    template<class S>
+    static size_t DeviationKernel(const Real *dirs, const Real *u, Real cosA, Real sinA, Real *out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        const V tiny = S::set1(Real(1e-06 * 1e-06));
+        const V vCos = S::set1(cosA), vSin = S::set1(sinA);
+        const V twoPi = S::set1(TWO_PI);
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V dx, dy, dz;
+            S::load3(dirs + i * 3, dx, dy, dz);
+            // d x UNIT_X, or d x UNIT_Y when d is along x
+            V ex = zero, ey = dz, ez = S::sub(zero, dy);
+            typename S::M alongX = S::cmpgt(tiny, S::add(S::mul(ey, ey), S::mul(ez, ez)));
+            ex = S::select(alongX, S::sub(zero, dz), ex);
+            ey = S::select(alongX, zero, ey);
+            ez = S::select(alongX, dx, ez);
+            V inv = S::div(one, S::sqrt(S::add(S::add(S::mul(ex, ex), S::mul(ey, ey)), S::mul(ez, ez))));
+            ex = S::mul(ex, inv); ey = S::mul(ey, inv); ez = S::mul(ez, inv);
+            // e2 = normalize(d x e1), |d x e1| = |d|
+            V fx = S::sub(S::mul(dy, ez), S::mul(dz, ey));
+            V fy = S::sub(S::mul(dz, ex), S::mul(dx, ez));
+            V fz = S::sub(S::mul(dx, ey), S::mul(dy, ex));
+            inv = S::div(one, S::sqrt(S::add(S::add(S::mul(dx, dx), S::mul(dy, dy)), S::mul(dz, dz))));
+            V s, c;
+            FastSinCos<S>(S::mul(S::load(u + i), twoPi), s, c);
+            V ux = S::add(S::mul(c, ex), S::mul(S::mul(s, inv), fx));
+            V uy = S::add(S::mul(c, ey), S::mul(S::mul(s, inv), fy));
+            V uz = S::add(S::mul(c, ez), S::mul(S::mul(s, inv), fz));
+            // rotation about a unit axis perpendicular to d: d cos + (up x d) sin
+            V rx = S::add(S::mul(dx, vCos), S::mul(S::sub(S::mul(uy, dz), S::mul(uz, dy)), vSin));
+            V ry = S::add(S::mul(dy, vCos), S::mul(S::sub(S::mul(uz, dx), S::mul(ux, dz)), vSin));
+            V rz = S::add(S::mul(dz, vCos), S::mul(S::sub(S::mul(ux, dy), S::mul(uy, dx)), vSin));
+            S::store3(out + i * 3, rx, ry, rz);
+        }
+        return i;
+    }
+
+    Random::Random(uint64_t seed, uint64_t stream)
+    {
+        this->seed(seed, stream);
+    }
+
+    void Random::seed(uint64_t seed, uint64_t stream)
+    {
+        uint64_t x = seed ^ SplitMix64(stream);
+        uint64_t a = SplitMix64(x);
+        uint64_t b = SplitMix64(x);
+        m_state[0] = uint32_t(a);
+        m_state[1] = uint32_t(a >> 32);
+        m_state[2] = uint32_t(b);
+        m_state[3] = uint32_t(b >> 32);
+        // the all zero state is the one state xoshiro cannot leave
+        if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0)
+            m_state[0] = 1;
+    }
+
+    uint32_t Random::nextUInt()
+    {
+        return NextXoshiro128(m_state);
+    }
+
+    Real Random::nextUnit()
+    {
+        return ToUnit(NextXoshiro128(m_state));
+    }
+
+    Vec3 Random::nextUnitVector()
+    {
+        Real z = 1.0f - 2.0f * nextUnit();
+        Real r = sqrt(Maximum(Real(0.0f), 1.0f - z * z));
+        Real phi = TWO_PI * nextUnit();
+        return Vec3(r * cos(phi), r * sin(phi), z);
+    }
+
+    Vec3 Random::nextConeDirection(const Vec3 &axis, Real angle)
+    {
+        Real cosT = 1.0f - nextUnit() * (1.0f - cos(angle));
+        Real sinT = sqrt(Maximum(Real(0.0f), 1.0f - cosT * cosT));
+        Real phi = TWO_PI * nextUnit();
+        return RotationFromUnitZ(axis) * Vec3(sinT * cos(phi), sinT * sin(phi), cosT);
+    }
+
+    void Random::fillUnit(Real *out, size_t count)
+    {
+        // local copy so the stores to out don't force the state back to memory
+        uint32_t s[4] = { m_state[0], m_state[1], m_state[2], m_state[3] };
+        for (size_t i = 0; i < count; ++i)
+            out[i] = ToUnit(NextXoshiro128(s));
+        memcpy(m_state, s, sizeof(s));
+    }
+
+    void Random::fillRange(Real min, Real max, Real *out, size_t count)
+    {
+        uint32_t s[4] = { m_state[0], m_state[1], m_state[2], m_state[3] };
+        Real range = max - min;
+        for (size_t i = 0; i < count; ++i)
+            out[i] = min + range * ToUnit(NextXoshiro128(s));
+        memcpy(m_state, s, sizeof(s));
+    }
+
+    void Random::fillUnitVectors(Vec3 *out, size_t count)
+    {
+        Real u[RANDOM_BLOCK_SIZE], v[RANDOM_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += RANDOM_BLOCK_SIZE)
+        {
+            size_t n = Minimum(RANDOM_BLOCK_SIZE, count - begin);
+            fillUnit(u, n);
+            fillUnit(v, n);
+            Real *o = reinterpret_cast<Real*>(out + begin);
+            size_t i = ConeKernel<SimdOps, false>(u, v, -1.0f, Quat::IDENTITY, o, 0, n);
+            ConeKernel<SimdOps1, false>(u, v, -1.0f, Quat::IDENTITY, o, i, n);
+        }
+    }
+
+    void Random::fillConeDirections(const Vec3 &axis, Real angle, Vec3 *out, size_t count)
+    {
+        Quat q = RotationFromUnitZ(axis);
+        Real cosMax = cos(angle);
+        Real u[RANDOM_BLOCK_SIZE], v[RANDOM_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += RANDOM_BLOCK_SIZE)
+        {
+            size_t n = Minimum(RANDOM_BLOCK_SIZE, count - begin);
+            fillUnit(u, n);
+            fillUnit(v, n);
+            Real *o = reinterpret_cast<Real*>(out + begin);
+            size_t i = ConeKernel<SimdOps, true>(u, v, cosMax, q, o, 0, n);
+            ConeKernel<SimdOps1, true>(u, v, cosMax, q, o, i, n);
+        }
+    }
+
+    void Random::fillDeviations(const Vec3 *dirs, Real angle, Vec3 *out, size_t count)
+    {
+        Real cosA = cos(angle), sinA = sin(angle);
+        Real u[RANDOM_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += RANDOM_BLOCK_SIZE)
+        {
+            size_t n = Minimum(RANDOM_BLOCK_SIZE, count - begin);
+            fillUnit(u, n);
+            const Real *d = reinterpret_cast<const Real*>(dirs + begin);
+            Real *o = reinterpret_cast<Real*>(out + begin);
+            size_t i = DeviationKernel<SimdOps>(d, u, cosA, sinA, o, 0, n);
+            DeviationKernel<SimdOps1>(d, u, cosA, sinA, o, i, n);
+        }
+    }
+
+    Random& Random::getThreadLocal()
+    {
+        static std::atomic<uint64_t> s_nextStream(0);
+        thread_local Random s_random(DEFAULT_SEED, s_nextStream.fetch_add(1));
+        return s_random;
+    }
+
+    Real RandomUnitization()
+    {
+        return Random::getThreadLocal().nextUnit();
+    }
+}
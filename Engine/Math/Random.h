@@ -0,0 +1,63 @@
+#ifndef _CN_RANDOM_
+#define _CN_RANDOM_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    /*
+        xoshiro128** generator. Small, fast and lock free: every thread owns
+        its generator (getThreadLocal), so emitters running on several threads
+        never contend.
+
+        (seed, stream) pairs are expanded through splitmix64, so each pair is
+        a reproducible sequence and distinct streams are independent. Worker
+        threads that need reproducible results seed their own generator with
+        a fixed seed and their worker index:
+
+            Random::getThreadLocal().seed(levelSeed, workerIndex);
+
+        Unseeded thread-local generators use DEFAULT_SEED and a stream per
+        thread in order of first use.
+
+        The fill functions generate whole arrays; the math after drawing the
+        uniforms is vectorized (SIMD.h) and uses the fast tier (Mathematics.h)
+        for the azimuth sin/cos.
+    */
+    class CN_EXPORT Random
+    {
+    public:
+
+        static const uint64_t DEFAULT_SEED = 0x853c49e6748fea9bULL;
+
+        explicit Random(uint64_t seed = DEFAULT_SEED, uint64_t stream = 0);
+
+        void seed(uint64_t seed, uint64_t stream = 0);
+
+        uint32_t nextUInt();
+        // uniform in [0, 1)
+        Real nextUnit();
+        Real nextRange(Real min, Real max) { return min + (max - min) * nextUnit(); }
+        // uniform on the unit sphere
+        Vec3 nextUnitVector();
+        // uniform over the cone of half angle angle around the unit vector axis
+        Vec3 nextConeDirection(const Vec3 &axis, Real angle);
+
+        void fillUnit(Real *out, size_t count);
+        void fillRange(Real min, Real max, Real *out, size_t count);
+        void fillUnitVectors(Vec3 *out, size_t count);
+        void fillConeDirections(const Vec3 &axis, Real angle, Vec3 *out, size_t count);
+        // out[i] is dirs[i] rotated by exactly angle towards a random azimuth,
+        // the bulk form of Vec3::randomDeviat with the default up. out may alias dirs.
+        void fillDeviations(const Vec3 *dirs, Real angle, Vec3 *out, size_t count);
+
+        static Random& getThreadLocal();
+
+    private:
+
+        uint32_t m_state[4];
+    };
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "Ray.h"
+#include "AABBStream.h"
+#include "SphereStream.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    // Slab test shared by the single and bulk paths: the SimdOps1 instance is
+    // the scalar test, so both agree bit for bit. tNear is the entry distance
+    // clamped to 0.
+    template<class S>
+    static inline typename S::M SlabTest(const typename S::V *o, const typename S::V *invD
+        , const typename S::V *bMin, const typename S::V *bMax, typename S::V &tNear)
+    {
+        typedef typename S::V V;
+        V tFar;
+        for (int j = 0; j < 3; ++j)
+        {
+            V t1 = S::mul(S::sub(bMin[j], o[j]), invD[j]);
+            V t2 = S::mul(S::sub(bMax[j], o[j]), invD[j]);
+            V tMin = S::minimum(t1, t2);
+            V tMax = S::maximum(t1, t2);
+            tNear = j == 0 ? tMin : S::maximum(tNear, tMin);
+            tFar = j == 0 ? tMax : S::minimum(tFar, tMax);
+        }
+        tNear = S::maximum(tNear, S::set1(0.0f));
+        return S::cmpge(tFar, tNear);
+    }
+
+    // a is direction.dotProduct(direction) and invA its inverse, o the ray
+    // origin relative to the sphere center. The discriminant is taken from the
+    // distance between the center and the line and the entry distance from
+    // c / (sqrt(disc) - b), which avoids the cancellation of the textbook
+    // quadratic for small spheres far from the origin.
+    template<class S>
+    static inline typename S::M SphereTest(const typename S::V *o, const typename S::V *d, typename S::V a
+        , typename S::V invA, typename S::V radius, typename S::V &t)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V zero = S::set1(0.0f);
+        V b = S::add(S::add(S::mul(o[0], d[0]), S::mul(o[1], d[1])), S::mul(o[2], d[2]));
+        V rr = S::mul(radius, radius);
+        V c = S::sub(S::add(S::add(S::mul(o[0], o[0]), S::mul(o[1], o[1])), S::mul(o[2], o[2])), rr);
+        V s = S::mul(b, invA);
+        V px = S::sub(o[0], S::mul(d[0], s)), py = S::sub(o[1], S::mul(d[1], s)), pz = S::sub(o[2], S::mul(d[2], s));
+        V h = S::sub(rr, S::add(S::add(S::mul(px, px), S::mul(py, py)), S::mul(pz, pz)));
+        M inside = S::cmpge(zero, c);
+        M hit = S::maskOr(inside, S::maskAnd(S::cmpge(h, zero), S::cmpge(zero, b)));
+        V disc = S::mul(a, S::maximum(h, zero));
+        t = S::select(inside, zero, S::div(c, S::sub(S::sqrt(disc), b)));
+        return hit;
+    }
+
+    static inline void InverseDirection(const Vec3 &direction, Real *invD)
+    {
+        for (int j = 0; j < 3; ++j)
+            invD[j] = 1.0f / direction[j];
+    }
+
+    template<class S>
+    static size_t RayAABBKernel(const Ray &ray, const AABBStream &boxes, uint8_t *hits, Real *distances
+        , size_t begin, size_t count, size_t &hitCount)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        Real invDir[3];
+        InverseDirection(ray.direction, invDir);
+        V o[3] = { S::set1(ray.origin.x), S::set1(ray.origin.y), S::set1(ray.origin.z) };
+        V invD[3] = { S::set1(invDir[0]), S::set1(invDir[1]), S::set1(invDir[2]) };
+        const V miss = S::set1(FLOAT_MAX);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V bMin[3] = { S::load(boxes.minX() + i), S::load(boxes.minY() + i), S::load(boxes.minZ() + i) };
+            V bMax[3] = { S::load(boxes.maxX() + i), S::load(boxes.maxY() + i), S::load(boxes.maxZ() + i) };
+            V tNear;
+            M hit = SlabTest<S>(o, invD, bMin, bMax, tNear);
+            hitCount += SimdStoreMask<S>(hit, hits + i);
+            if (distances)
+                S::store(distances + i, S::select(hit, tNear, miss));
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t RaySphereKernel(const Ray &ray, const SphereStream &spheres, uint8_t *hits, Real *distances
+        , size_t begin, size_t count, size_t &hitCount)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        V origin[3] = { S::set1(ray.origin.x), S::set1(ray.origin.y), S::set1(ray.origin.z) };
+        V d[3] = { S::set1(ray.direction.x), S::set1(ray.direction.y), S::set1(ray.direction.z) };
+        Real dd = ray.direction.dotProduct(ray.direction);
+        V a = S::set1(dd);
+        V invA = S::set1(1.0f / dd);
+        const V miss = S::set1(FLOAT_MAX);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V o[3] = { S::sub(origin[0], S::load(spheres.x() + i)), S::sub(origin[1], S::load(spheres.y() + i)), S::sub(origin[2], S::load(spheres.z() + i)) };
+            V t;
+            M hit = SphereTest<S>(o, d, a, invA, S::load(spheres.radius() + i), t);
+            hitCount += SimdStoreMask<S>(hit, hits + i);
+            if (distances)
+                S::store(distances + i, S::select(hit, t, miss));
+        }
+        return i;
+    }
+
+    bool Ray::intersects(const AABB &box, Real *distance) const
+    {
+        Real invD[3];
+        InverseDirection(direction, invD);
+        Real tNear;
+        bool hit = SlabTest<SimdOps1>(&origin.x, invD, &box.min.x, &box.max.x, tNear);
+        if (hit && distance) *distance = tNear;
+        return hit;
+    }
+
+    bool Ray::intersects(const Sphere &sphere, Real *distance) const
+    {
+        Vec3 o = origin - sphere.center;
+        Real t;
+        Real dd = direction.dotProduct(direction);
+        bool hit = SphereTest<SimdOps1>(&o.x, &direction.x, dd, 1.0f / dd, sphere.radius, t);
+        if (hit && distance) *distance = t;
+        return hit;
+    }
+
+    bool Ray::intersects(const OBB &box, Real *distance) const
+    {
+        // slab test in the frame of the box, the axes are orthonormal so
+        // distances carry over
+        Vec3 rel = origin - box.center;
+        Real o[3], invD[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            o[j] = rel.dotProduct(box.axis[j]);
+            invD[j] = 1.0f / direction.dotProduct(box.axis[j]);
+        }
+        Vec3 bMin = -box.extents;
+        Real tNear;
+        bool hit = SlabTest<SimdOps1>(o, invD, &bMin.x, &box.extents.x, tNear);
+        if (hit && distance) *distance = tNear;
+        return hit;
+    }
+
+    size_t Ray::intersects(const AABBStream &boxes, uint8_t *hits, Real *distances) const
+    {
+        size_t hitCount = 0;
+        size_t i = RayAABBKernel<SimdOps>(*this, boxes, hits, distances, 0, boxes.size(), hitCount);
+        RayAABBKernel<SimdOps1>(*this, boxes, hits, distances, i, boxes.size(), hitCount);
+        return hitCount;
+    }
+
+    size_t Ray::intersects(const SphereStream &spheres, uint8_t *hits, Real *distances) const
+    {
+        size_t hitCount = 0;
+        size_t i = RaySphereKernel<SimdOps>(*this, spheres, hits, distances, 0, spheres.size(), hitCount);
+        RaySphereKernel<SimdOps1>(*this, spheres, hits, distances, i, spheres.size(), hitCount);
+        return hitCount;
+    }
+}
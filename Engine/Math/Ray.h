@@ -0,0 +1,72 @@
+#ifndef _CN_RAY_
+#define _CN_RAY_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include "AABB.h"
+#include "Sphere.h"
+#include "OBB.h"
+#include "TriangleStream.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    class AABBStream;
+    class SphereStream;
+    class Mat4;
+    class Affine3;
+    /*
+        Half line origin + direction * t, t >= 0. direction need not be unit
+        length; hit distances are in units of direction.
+
+        The intersects functions return whether the ray hits the volume and
+        write the entry distance to distance when it is not null, 0 when the
+        origin is inside. A direction component of exactly zero is handled
+        except when the origin also lies exactly on a slab plane of the box
+        on that axis, which may report either result.
+
+        Triangles are tested with Moller-Trumbore, two sided. Hits on an
+        edge shared by two triangles may be reported for either of them.
+    */
+    class CN_EXPORT Ray
+    {
+    public:
+
+        constexpr Ray() : origin(), direction(0.0f, 0.0f, -1.0f) {}
+        constexpr Ray(const Vec3 &origin, const Vec3 &direction) : origin(origin), direction(direction) {}
+
+        Vec3 getPoint(Real t) const { return origin + direction * t; }
+
+        // origin as a point and direction as a vector, mat must be affine
+        void transform(const Mat4 &mat);
+        void transform(const Affine3 &mat);
+
+        bool intersects(const AABB &box, Real *distance = nullptr) const;
+        bool intersects(const Sphere &sphere, Real *distance = nullptr) const;
+        bool intersects(const OBB &box, Real *distance = nullptr) const;
+
+        // Bulk forms of intersects, one box or sphere per SIMD lane. hits[i]
+        // is set to 1 on a hit and 0 otherwise; distances, when not null,
+        // receives the entry distance of hits and FLOAT_MAX for misses. The
+        // results equal the single element tests. Returns the number of hits.
+        size_t intersects(const AABBStream &boxes, uint8_t *hits, Real *distances = nullptr) const;
+        size_t intersects(const SphereStream &spheres, uint8_t *hits, Real *distances = nullptr) const;
+
+        // u and v are the barycentric coordinates of the hit point along v1 - v0 and v2 - v0
+        bool intersects(const Vec3 &v0, const Vec3 &v1, const Vec3 &v2, Real *distance = nullptr, Real *u = nullptr, Real *v = nullptr) const;
+        size_t intersects(const TriangleStream &triangles, uint8_t *hits, Real *distances = nullptr) const;
+        // Nearest triangle within maxDistance, one triangle per SIMD lane. Of hits at
+        // the same distance the lowest index wins. Triangle indices must stay below
+        // 2^24 with float Real.
+        bool intersectNearest(const TriangleStream &triangles, TriangleHit &hit, Real maxDistance = FLOAT_MAX) const;
+        // whether any triangle is hit within maxDistance, stops at the first SIMD
+        // group with a hit, for line of sight and shadow tests
+        bool intersectsAny(const TriangleStream &triangles, Real maxDistance = FLOAT_MAX) const;
+
+        Vec3 origin;
+        Vec3 direction;
+    };
+
+    typedef std::vector<Ray> RayArray;
+}
+
+#endif
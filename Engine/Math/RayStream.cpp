@@ -0,0 +1,408 @@
+#include "RayStream.h"
+#include "Matrix4.h"
+#include "Affine3.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    // Ray's transform and triangle tests live here with the packet kernels, so the
+    // single ray, one ray against a SIMD group of triangles and a SIMD group of
+    // rays against one triangle all run the same lane operations
+
+    static const Real LANE_OFFSETS[8] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
+
+    template<class S>
+    static inline void Cross(const typename S::V *a, const typename S::V *b, typename S::V *out)
+    {
+        out[0] = S::sub(S::mul(a[1], b[2]), S::mul(a[2], b[1]));
+        out[1] = S::sub(S::mul(a[2], b[0]), S::mul(a[0], b[2]));
+        out[2] = S::sub(S::mul(a[0], b[1]), S::mul(a[1], b[0]));
+    }
+
+    template<class S>
+    static inline typename S::V Dot(const typename S::V *a, const typename S::V *b)
+    {
+        return S::add(S::add(S::mul(a[0], b[0]), S::mul(a[1], b[1])), S::mul(a[2], b[2]));
+    }
+
+    // Moller-Trumbore, two sided. A hit needs 0 <= t < tMax; a ray parallel to
+    // the triangle plane (det == 0) never hits.
+    template<class S>
+    static inline typename S::M MollerTrumbore(const typename S::V *o, const typename S::V *d, const typename S::V *v0
+        , const typename S::V *e1, const typename S::V *e2, typename S::V tMax
+        , typename S::V &t, typename S::V &u, typename S::V &v)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        V p[3], q[3];
+        Cross<S>(d, e2, p);
+        V det = Dot<S>(e1, p);
+        V invDet = S::div(one, det);
+        V s[3] = { S::sub(o[0], v0[0]), S::sub(o[1], v0[1]), S::sub(o[2], v0[2]) };
+        u = S::mul(Dot<S>(s, p), invDet);
+        Cross<S>(s, e1, q);
+        v = S::mul(Dot<S>(d, q), invDet);
+        t = S::mul(Dot<S>(e2, q), invDet);
+        M hit = S::maskAnd(S::cmpgt(S::abs(det), zero), S::maskAnd(S::cmpge(u, zero), S::cmpge(v, zero)));
+        hit = S::maskAnd(hit, S::cmpge(one, S::add(u, v)));
+        return S::maskAnd(hit, S::maskAnd(S::cmpge(t, zero), S::cmpgt(tMax, t)));
+    }
+
+    template<class S>
+    static inline void LoadTriangles(const TriangleStream &triangles, size_t i, typename S::V *v0, typename S::V *e1, typename S::V *e2)
+    {
+        v0[0] = S::load(triangles.v0X() + i); v0[1] = S::load(triangles.v0Y() + i); v0[2] = S::load(triangles.v0Z() + i);
+        e1[0] = S::load(triangles.e1X() + i); e1[1] = S::load(triangles.e1Y() + i); e1[2] = S::load(triangles.e1Z() + i);
+        e2[0] = S::load(triangles.e2X() + i); e2[1] = S::load(triangles.e2Y() + i); e2[2] = S::load(triangles.e2Z() + i);
+    }
+
+    template<class S>
+    static inline void BroadcastTriangle(const TriangleStream &triangles, size_t i, typename S::V *v0, typename S::V *e1, typename S::V *e2)
+    {
+        v0[0] = S::set1(triangles.v0X()[i]); v0[1] = S::set1(triangles.v0Y()[i]); v0[2] = S::set1(triangles.v0Z()[i]);
+        e1[0] = S::set1(triangles.e1X()[i]); e1[1] = S::set1(triangles.e1Y()[i]); e1[2] = S::set1(triangles.e1Z()[i]);
+        e2[0] = S::set1(triangles.e2X()[i]); e2[1] = S::set1(triangles.e2Y()[i]); e2[2] = S::set1(triangles.e2Z()[i]);
+    }
+
+    // out = mat * in for the origins (points) and the directions (vectors), six
+    // component arrays each: origin x, y, z then direction x, y, z
+    template<class S>
+    static size_t TransformRayKernel(const Real *m, const Real* const *in, Real* const *out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V o[3] = { S::load(in[0] + i), S::load(in[1] + i), S::load(in[2] + i) };
+            V d[3] = { S::load(in[3] + i), S::load(in[4] + i), S::load(in[5] + i) };
+            for (int r = 0; r < 3; ++r)
+            {
+                const Real *row = m + r * 4;
+                V m0 = S::set1(row[0]), m1 = S::set1(row[1]), m2 = S::set1(row[2]);
+                S::store(out[r] + i, S::add(S::add(S::add(S::mul(m0, o[0]), S::mul(m1, o[1])), S::mul(m2, o[2])), S::set1(row[3])));
+                S::store(out[3 + r] + i, S::add(S::add(S::mul(m0, d[0]), S::mul(m1, d[1])), S::mul(m2, d[2])));
+            }
+        }
+        return i;
+    }
+
+    static void TransformRay(const Real *m, Ray &ray)
+    {
+        Real in[6] = { ray.origin.x, ray.origin.y, ray.origin.z, ray.direction.x, ray.direction.y, ray.direction.z };
+        const Real *src[6] = { in, in + 1, in + 2, in + 3, in + 4, in + 5 };
+        Real *dst[6] = { &ray.origin.x, &ray.origin.y, &ray.origin.z, &ray.direction.x, &ray.direction.y, &ray.direction.z };
+        TransformRayKernel<SimdOps1>(m, src, dst, 0, 1);
+    }
+
+    static void TransformRays(const Real *m, const RayStream &in, RayStream &out)
+    {
+        out.resize(in.size());
+        const Real *src[6] = { in.originX(), in.originY(), in.originZ(), in.directionX(), in.directionY(), in.directionZ() };
+        Real *dst[6] = { out.originX(), out.originY(), out.originZ(), out.directionX(), out.directionY(), out.directionZ() };
+        size_t i = TransformRayKernel<SimdOps>(m, src, dst, 0, in.size());
+        TransformRayKernel<SimdOps1>(m, src, dst, i, in.size());
+    }
+
+    template<class S>
+    static size_t RayTriangleKernel(const Ray &ray, const TriangleStream &triangles, uint8_t *hits, Real *distances
+        , size_t begin, size_t count, size_t &hitCount)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        V o[3] = { S::set1(ray.origin.x), S::set1(ray.origin.y), S::set1(ray.origin.z) };
+        V d[3] = { S::set1(ray.direction.x), S::set1(ray.direction.y), S::set1(ray.direction.z) };
+        const V miss = S::set1(FLOAT_MAX);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V v0[3], e1[3], e2[3], t, u, v;
+            LoadTriangles<S>(triangles, i, v0, e1, e2);
+            M hit = MollerTrumbore<S>(o, d, v0, e1, e2, miss, t, u, v);
+            hitCount += SimdStoreMask<S>(hit, hits + i);
+            if (distances)
+                S::store(distances + i, S::select(hit, t, miss));
+        }
+        return i;
+    }
+
+    // lane wise nearest hit, strictly closer hits replace so each lane keeps
+    // the lowest index among equal distances
+    template<class S>
+    static size_t NearestTriangleKernel(const Ray &ray, const TriangleStream &triangles, size_t begin, size_t count
+        , typename S::V &best, typename S::V &bestIndex, typename S::V &bestU, typename S::V &bestV)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        V o[3] = { S::set1(ray.origin.x), S::set1(ray.origin.y), S::set1(ray.origin.z) };
+        V d[3] = { S::set1(ray.direction.x), S::set1(ray.direction.y), S::set1(ray.direction.z) };
+        const V lanes = S::load(LANE_OFFSETS);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V v0[3], e1[3], e2[3], t, u, v;
+            LoadTriangles<S>(triangles, i, v0, e1, e2);
+            M hit = MollerTrumbore<S>(o, d, v0, e1, e2, best, t, u, v);
+            best = S::select(hit, t, best);
+            bestIndex = S::select(hit, S::add(S::set1(Real(i)), lanes), bestIndex);
+            bestU = S::select(hit, u, bestU);
+            bestV = S::select(hit, v, bestV);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t AnyTriangleKernel(const Ray &ray, const TriangleStream &triangles, Real maxDistance, size_t begin, size_t count, bool &any)
+    {
+        typedef typename S::V V;
+        V o[3] = { S::set1(ray.origin.x), S::set1(ray.origin.y), S::set1(ray.origin.z) };
+        V d[3] = { S::set1(ray.direction.x), S::set1(ray.direction.y), S::set1(ray.direction.z) };
+        const V tMax = S::set1(maxDistance);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V v0[3], e1[3], e2[3], t, u, v;
+            LoadTriangles<S>(triangles, i, v0, e1, e2);
+            if (S::maskBits(MollerTrumbore<S>(o, d, v0, e1, e2, tMax, t, u, v)))
+            {
+                any = true;
+                return count;
+            }
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t PacketNearestKernel(const RayStream &rays, const TriangleStream &triangles, TriangleHit *hits, const Real *maxDistances
+        , size_t begin, size_t count, size_t &hitCount)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V miss = S::set1(FLOAT_MAX);
+        const V noHit = S::set1(-1.0f);
+        const V zero = S::set1(0.0f);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V o[3] = { S::load(rays.originX() + i), S::load(rays.originY() + i), S::load(rays.originZ() + i) };
+            V d[3] = { S::load(rays.directionX() + i), S::load(rays.directionY() + i), S::load(rays.directionZ() + i) };
+            V best = maxDistances ? S::load(maxDistances + i) : miss;
+            V bestIndex = noHit, bestU = zero, bestV = zero;
+            for (size_t j = 0; j < triangles.size(); ++j)
+            {
+                V v0[3], e1[3], e2[3], t, u, v;
+                BroadcastTriangle<S>(triangles, j, v0, e1, e2);
+                M hit = MollerTrumbore<S>(o, d, v0, e1, e2, best, t, u, v);
+                best = S::select(hit, t, best);
+                bestIndex = S::select(hit, S::set1(Real(j)), bestIndex);
+                bestU = S::select(hit, u, bestU);
+                bestV = S::select(hit, v, bestV);
+            }
+            Real distance[S::WIDTH], index[S::WIDTH], u[S::WIDTH], v[S::WIDTH];
+            S::store(distance, best);
+            S::store(index, bestIndex);
+            S::store(u, bestU);
+            S::store(v, bestV);
+            for (int l = 0; l < S::WIDTH; ++l)
+            {
+                TriangleHit &hit = hits[i + l];
+                if (index[l] < 0.0f)
+                {
+                    hit = { FLOAT_MAX, 0.0f, 0.0f, TriangleHit::NO_HIT };
+                    continue;
+                }
+                hit = { distance[l], u[l], v[l], uint32_t(index[l]) };
+                ++hitCount;
+            }
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t PacketAnyKernel(const RayStream &rays, const TriangleStream &triangles, uint8_t *hits, const Real *maxDistances
+        , size_t begin, size_t count, size_t &hitCount)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const int allLanes = (1 << S::WIDTH) - 1;
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V o[3] = { S::load(rays.originX() + i), S::load(rays.originY() + i), S::load(rays.originZ() + i) };
+            V d[3] = { S::load(rays.directionX() + i), S::load(rays.directionY() + i), S::load(rays.directionZ() + i) };
+            V tMax = maxDistances ? S::load(maxDistances + i) : S::set1(FLOAT_MAX);
+            M any = S::cmpgt(tMax, tMax);
+            for (size_t j = 0; j < triangles.size() && S::maskBits(any) != allLanes; ++j)
+            {
+                V v0[3], e1[3], e2[3], t, u, v;
+                BroadcastTriangle<S>(triangles, j, v0, e1, e2);
+                any = S::maskOr(any, MollerTrumbore<S>(o, d, v0, e1, e2, tMax, t, u, v));
+            }
+            hitCount += SimdStoreMask<S>(any, hits + i);
+        }
+        return i;
+    }
+
+    void Ray::transform(const Mat4 &mat)
+    {
+        TransformRay(mat[0], *this);
+    }
+
+    void Ray::transform(const Affine3 &mat)
+    {
+        TransformRay(mat[0], *this);
+    }
+
+    bool Ray::intersects(const Vec3 &v0, const Vec3 &v1, const Vec3 &v2, Real *distance, Real *u, Real *v) const
+    {
+        Vec3 e1 = v1 - v0;
+        Vec3 e2 = v2 - v0;
+        Real t, hitU, hitV;
+        bool hit = MollerTrumbore<SimdOps1>(&origin.x, &direction.x, &v0.x, &e1.x, &e2.x, FLOAT_MAX, t, hitU, hitV);
+        if (hit && distance) *distance = t;
+        if (hit && u) *u = hitU;
+        if (hit && v) *v = hitV;
+        return hit;
+    }
+
+    size_t Ray::intersects(const TriangleStream &triangles, uint8_t *hits, Real *distances) const
+    {
+        size_t hitCount = 0;
+        size_t i = RayTriangleKernel<SimdOps>(*this, triangles, hits, distances, 0, triangles.size(), hitCount);
+        RayTriangleKernel<SimdOps1>(*this, triangles, hits, distances, i, triangles.size(), hitCount);
+        return hitCount;
+    }
+
+    bool Ray::intersectNearest(const TriangleStream &triangles, TriangleHit &hit, Real maxDistance) const
+    {
+        cnAssert(sizeof(Real) == sizeof(double) || triangles.size() <= (size_t(1) << 24));
+        typedef SimdOps::V V;
+        V best = SimdOps::set1(maxDistance), bestIndex = SimdOps::set1(-1.0f);
+        V bestU = SimdOps::set1(0.0f), bestV = SimdOps::set1(0.0f);
+        size_t i = NearestTriangleKernel<SimdOps>(*this, triangles, 0, triangles.size(), best, bestIndex, bestU, bestV);
+
+        // reduce the lanes, lowest index on equal distances, then the tail
+        Real distance[SimdOps::WIDTH], index[SimdOps::WIDTH], u[SimdOps::WIDTH], v[SimdOps::WIDTH];
+        SimdOps::store(distance, best);
+        SimdOps::store(index, bestIndex);
+        SimdOps::store(u, bestU);
+        SimdOps::store(v, bestV);
+        Real scalarBest = maxDistance, scalarIndex = -1.0f, scalarU = 0.0f, scalarV = 0.0f;
+        for (int l = 0; l < SimdOps::WIDTH; ++l)
+        {
+            if (index[l] < 0.0f)
+                continue;
+            if (distance[l] < scalarBest || (distance[l] == scalarBest && index[l] < scalarIndex))
+            {
+                scalarBest = distance[l];
+                scalarIndex = index[l];
+                scalarU = u[l];
+                scalarV = v[l];
+            }
+        }
+        NearestTriangleKernel<SimdOps1>(*this, triangles, i, triangles.size(), scalarBest, scalarIndex, scalarU, scalarV);
+
+        if (scalarIndex < 0.0f)
+        {
+            hit = { FLOAT_MAX, 0.0f, 0.0f, TriangleHit::NO_HIT };
+            return false;
+        }
+        hit = { scalarBest, scalarU, scalarV, uint32_t(scalarIndex) };
+        return true;
+    }
+
+    bool Ray::intersectsAny(const TriangleStream &triangles, Real maxDistance) const
+    {
+        bool any = false;
+        size_t i = AnyTriangleKernel<SimdOps>(*this, triangles, maxDistance, 0, triangles.size(), any);
+        AnyTriangleKernel<SimdOps1>(*this, triangles, maxDistance, i, triangles.size(), any);
+        return any;
+    }
+
+    RayStream::RayStream()
+    {
+
+    }
+
+    RayStream::RayStream(size_t count)
+    {
+        resize(count);
+    }
+
+    RayStream::RayStream(const RayArray &array)
+    {
+        fromArray(array);
+    }
+
+    RayStream::~RayStream()
+    {
+
+    }
+
+    void RayStream::resize(size_t count)
+    {
+        m_originX.resize(count);
+        m_originY.resize(count);
+        m_originZ.resize(count);
+        m_directionX.resize(count);
+        m_directionY.resize(count);
+        m_directionZ.resize(count);
+    }
+
+    void RayStream::clear()
+    {
+        m_originX.clear();
+        m_originY.clear();
+        m_originZ.clear();
+        m_directionX.clear();
+        m_directionY.clear();
+        m_directionZ.clear();
+    }
+
+    void RayStream::fromArray(const RayArray &array)
+    {
+        resize(array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+            set(i, array[i]);
+    }
+
+    void RayStream::toArray(RayArray &array) const
+    {
+        array.resize(size());
+        for (size_t i = 0; i < array.size(); ++i)
+            array[i] = get(i);
+    }
+
+    void RayStream::transform(const Mat4 &mat, RayStream &out) const
+    {
+        TransformRays(mat[0], *this, out);
+    }
+
+    void RayStream::transform(const Affine3 &mat, RayStream &out) const
+    {
+        TransformRays(mat[0], *this, out);
+    }
+
+    size_t RayStream::intersectNearest(const TriangleStream &triangles, TriangleHit *hits, const Real *maxDistances) const
+    {
+        cnAssert(sizeof(Real) == sizeof(double) || triangles.size() <= (size_t(1) << 24));
+        size_t hitCount = 0;
+        size_t i = PacketNearestKernel<SimdOps>(*this, triangles, hits, maxDistances, 0, size(), hitCount);
+        PacketNearestKernel<SimdOps1>(*this, triangles, hits, maxDistances, i, size(), hitCount);
+        return hitCount;
+    }
+
+    size_t RayStream::intersectsAny(const TriangleStream &triangles, uint8_t *hits, const Real *maxDistances) const
+    {
+        size_t hitCount = 0;
+        size_t i = PacketAnyKernel<SimdOps>(*this, triangles, hits, maxDistances, 0, size(), hitCount);
+        PacketAnyKernel<SimdOps1>(*this, triangles, hits, maxDistances, i, size(), hitCount);
+        return hitCount;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef _CN_RAY_STREAM_
+#define _CN_RAY_STREAM_
+#include "Prerequisites.h"
+#include "Ray.h"
+#include "TriangleStream.h"
+
+namespace Canaan
+{
+    class Mat4;
+    class Affine3;
+    /*
+        Structure-of-arrays storage for Ray, for packets of coherent rays
+        (picking, line of sight, shadow probes) tested one SIMD lane per ray.
+
+        Mesh space rays come from the world inverse of the mesh in bulk:
+            Mat4 inv = transform->getWorldMatrix();
+            inv.inverse();
+            worldRays.transform(inv, meshRays);
+        Distances carry over unchanged since the directions are transformed
+        with the rays and need not stay unit length.
+    */
+    class CN_EXPORT RayStream
+    {
+    public:
+
+        RayStream();
+        explicit RayStream(size_t count);
+        explicit RayStream(const RayArray &array);
+        ~RayStream();
+
+        size_t size() const { return m_originX.size(); }
+        bool empty() const { return m_originX.empty(); }
+        void resize(size_t count);
+        void clear();
+
+        void fromArray(const RayArray &array);
+        void toArray(RayArray &array) const;
+
+        Ray get(size_t i) const { return Ray(Vec3(m_originX[i], m_originY[i], m_originZ[i]), Vec3(m_directionX[i], m_directionY[i], m_directionZ[i])); }
+        void set(size_t i, const Ray &ray){
+            m_originX[i] = ray.origin.x; m_originY[i] = ray.origin.y; m_originZ[i] = ray.origin.z;
+            m_directionX[i] = ray.direction.x; m_directionY[i] = ray.direction.y; m_directionZ[i] = ray.direction.z;
+        }
+
+        Real* originX() { return m_originX.data(); }
+        Real* originY() { return m_originY.data(); }
+        Real* originZ() { return m_originZ.data(); }
+        Real* directionX() { return m_directionX.data(); }
+        Real* directionY() { return m_directionY.data(); }
+        Real* directionZ() { return m_directionZ.data(); }
+        const Real* originX() const { return m_originX.data(); }
+        const Real* originY() const { return m_originY.data(); }
+        const Real* originZ() const { return m_originZ.data(); }
+        const Real* directionX() const { return m_directionX.data(); }
+        const Real* directionY() const { return m_directionY.data(); }
+        const Real* directionZ() const { return m_directionZ.data(); }
+
+        // bulk Ray::transform, bit identical to it. out may be *this.
+        void transform(const Mat4 &mat, RayStream &out) const;
+        void transform(const Affine3 &mat, RayStream &out) const;
+
+        // Packet forms of Ray::intersectNearest and Ray::intersectsAny, one ray per
+        // SIMD lane against every triangle in turn. maxDistances, when not null,
+        // bounds each ray. The results equal the single ray calls. Return the
+        // number of rays that hit.
+        size_t intersectNearest(const TriangleStream &triangles, TriangleHit *hits, const Real *maxDistances = nullptr) const;
+        size_t intersectsAny(const TriangleStream &triangles, uint8_t *hits, const Real *maxDistances = nullptr) const;
+
+    private:
+
+        std::vector<Real> m_originX;
+        std::vector<Real> m_originY;
+        std::vector<Real> m_originZ;
+        std::vector<Real> m_directionX;
+        std::vector<Real> m_directionY;
+        std::vector<Real> m_directionZ;
+    };
+}
+
+#endif
@@ -0,0 +1,610 @@
+#include "SIMD.h"
+
+namespace Canaan
+{
+#if CN_SIMD_X86
+    #define CN_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+    #define CN_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, CN_SHUFFLE_MASK(x, y, z, w))
+    #define CN_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, CN_SHUFFLE_MASK(x, y, z, w))
+
+    // 2x2 blocks are packed row-major as (m00, m01, m10, m11)
+
+    // A * B
+    static inline __m128 Mat2Mul(__m128 a, __m128 b)
+    {
+        return _mm_add_ps(_mm_mul_ps(a, CN_SWIZZLE(b, 0, 3, 0, 3)),
+                          _mm_mul_ps(CN_SWIZZLE(a, 1, 0, 3, 2), CN_SWIZZLE(b, 2, 1, 2, 1)));
+    }
+
+    // adj(A) * B
+    static inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+    {
+        return _mm_sub_ps(_mm_mul_ps(CN_SWIZZLE(a, 3, 3, 0, 0), b),
+                          _mm_mul_ps(CN_SWIZZLE(a, 1, 1, 2, 2), CN_SWIZZLE(b, 2, 3, 0, 1)));
+    }
+
+    // A * adj(B)
+    static inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+    {
+        return _mm_sub_ps(_mm_mul_ps(a, CN_SWIZZLE(b, 3, 0, 3, 0)),
+                          _mm_mul_ps(CN_SWIZZLE(a, 1, 0, 3, 2), CN_SWIZZLE(b, 2, 1, 2, 1)));
+    }
+#endif
+
+    void Mat4InverseScalar(const Real* m, Real* r)
+    {
+        Real m00 = m[0],  m01 = m[1],  m02 = m[2],  m03 = m[3];
+        Real m10 = m[4],  m11 = m[5],  m12 = m[6],  m13 = m[7];
+        Real m20 = m[8],  m21 = m[9],  m22 = m[10], m23 = m[11];
+        Real m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
+
+        Real v0 = m20 * m31 - m21 * m30;
+        Real v1 = m20 * m32 - m22 * m30;
+        Real v2 = m20 * m33 - m23 * m30;
+        Real v3 = m21 * m32 - m22 * m31;
+        Real v4 = m21 * m33 - m23 * m31;
+        Real v5 = m22 * m33 - m23 * m32;
+
+        Real t00 = +(v5 * m11 - v4 * m12 + v3 * m13);
+        Real t10 = -(v5 * m10 - v2 * m12 + v1 * m13);
+        Real t20 = +(v4 * m10 - v2 * m11 + v0 * m13);
+        Real t30 = -(v3 * m10 - v1 * m11 + v0 * m12);
+
+        Real invDet = 1 / (t00 * m00 + t10 * m01 + t20 * m02 + t30 * m03);
+
+        Real d00 = t00 * invDet;
+        Real d10 = t10 * invDet;
+        Real d20 = t20 * invDet;
+        Real d30 = t30 * invDet;
+
+        Real d01 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+        Real d11 = +(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+        Real d21 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+        Real d31 = +(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+        v0 = m10 * m31 - m11 * m30;
+        v1 = m10 * m32 - m12 * m30;
+        v2 = m10 * m33 - m13 * m30;
+        v3 = m11 * m32 - m12 * m31;
+        v4 = m11 * m33 - m13 * m31;
+        v5 = m12 * m33 - m13 * m32;
+
+        Real d02 = +(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+        Real d12 = -(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+        Real d22 = +(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+        Real d32 = -(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+        v0 = m21 * m10 - m20 * m11;
+        v1 = m22 * m10 - m20 * m12;
+        v2 = m23 * m10 - m20 * m13;
+        v3 = m22 * m11 - m21 * m12;
+        v4 = m23 * m11 - m21 * m13;
+        v5 = m23 * m12 - m22 * m13;
+
+        Real d03 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+        Real d13 = +(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+        Real d23 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+        Real d33 = +(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+        r[0]  = d00; r[1]  = d01; r[2]  = d02; r[3]  = d03;
+        r[4]  = d10; r[5]  = d11; r[6]  = d12; r[7]  = d13;
+        r[8]  = d20; r[9]  = d21; r[10] = d22; r[11] = d23;
+        r[12] = d30; r[13] = d31; r[14] = d32; r[15] = d33;
+    }
+
+    void Mat4Inverse(const Real* m, Real* r)
+    {
+    #if CN_SIMD_X86
+        // Block inversion of M = | A B |
+        //                        | C D |
+        // see "Fast 4x4 Matrix Inverse with SSE SIMD" (Eric Zhang).
+        __m128 row0 = _mm_loadu_ps(m + 0);
+        __m128 row1 = _mm_loadu_ps(m + 4);
+        __m128 row2 = _mm_loadu_ps(m + 8);
+        __m128 row3 = _mm_loadu_ps(m + 12);
+
+        __m128 A = _mm_movelh_ps(row0, row1);
+        __m128 B = _mm_movehl_ps(row1, row0);
+        __m128 C = _mm_movelh_ps(row2, row3);
+        __m128 D = _mm_movehl_ps(row3, row2);
+
+        // (|A|, |B|, |C|, |D|)
+        __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(CN_SHUFFLE(row0, row2, 0, 2, 0, 2), CN_SHUFFLE(row1, row3, 1, 3, 1, 3)),
+            _mm_mul_ps(CN_SHUFFLE(row0, row2, 1, 3, 1, 3), CN_SHUFFLE(row1, row3, 0, 2, 0, 2)));
+        __m128 detA = CN_SWIZZLE(detSub, 0, 0, 0, 0);
+        __m128 detB = CN_SWIZZLE(detSub, 1, 1, 1, 1);
+        __m128 detC = CN_SWIZZLE(detSub, 2, 2, 2, 2);
+        __m128 detD = CN_SWIZZLE(detSub, 3, 3, 3, 3);
+
+        __m128 D_C = Mat2AdjMul(D, C);
+        __m128 A_B = Mat2AdjMul(A, B);
+        __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+        __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+        __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+        __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+        __m128 tr = _mm_mul_ps(A_B, CN_SWIZZLE(D_C, 0, 2, 1, 3));
+        tr = _mm_add_ps(tr, CN_SWIZZLE(tr, 2, 3, 0, 1));
+        tr = _mm_add_ps(tr, CN_SWIZZLE(tr, 1, 0, 3, 2));
+        detM = _mm_sub_ps(detM, tr);
+
+        __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+        X_ = _mm_mul_ps(X_, rDetM);
+        Y_ = _mm_mul_ps(Y_, rDetM);
+        Z_ = _mm_mul_ps(Z_, rDetM);
+        W_ = _mm_mul_ps(W_, rDetM);
+
+        // the adjugate swizzle is folded into the store shuffle
+        _mm_storeu_ps(r + 0,  CN_SHUFFLE(X_, Y_, 3, 1, 3, 1));
+        _mm_storeu_ps(r + 4,  CN_SHUFFLE(X_, Y_, 2, 0, 2, 0));
+        _mm_storeu_ps(r + 8,  CN_SHUFFLE(Z_, W_, 3, 1, 3, 1));
+        _mm_storeu_ps(r + 12, CN_SHUFFLE(Z_, W_, 2, 0, 2, 0));
+    #elif CN_SIMD == CN_SIMD_NEON && defined(__aarch64__)
+        // Same block inversion as the SSE path, with vqtbl lookups standing
+        // in for the arbitrary shuffles NEON lacks.
+        #define CN_LANE_BYTES(l) (uint8_t)((l) * 4), (uint8_t)((l) * 4 + 1), (uint8_t)((l) * 4 + 2), (uint8_t)((l) * 4 + 3)
+        #define CN_TBL(x, y, z, w) { CN_LANE_BYTES(x), CN_LANE_BYTES(y), CN_LANE_BYTES(z), CN_LANE_BYTES(w) }
+        #define CN_SWZ(v, idx) vreinterpretq_f32_u8(vqtbl1q_u8(vreinterpretq_u8_f32(v), idx))
+
+        static const uint8_t k0303[16] = CN_TBL(0, 3, 0, 3);
+        static const uint8_t k1032[16] = CN_TBL(1, 0, 3, 2);
+        static const uint8_t k2121[16] = CN_TBL(2, 1, 2, 1);
+        static const uint8_t k3300[16] = CN_TBL(3, 3, 0, 0);
+        static const uint8_t k1122[16] = CN_TBL(1, 1, 2, 2);
+        static const uint8_t k2301[16] = CN_TBL(2, 3, 0, 1);
+        static const uint8_t k3030[16] = CN_TBL(3, 0, 3, 0);
+        static const uint8_t k0213[16] = CN_TBL(0, 2, 1, 3);
+        const uint8x16_t t0303 = vld1q_u8(k0303), t1032 = vld1q_u8(k1032), t2121 = vld1q_u8(k2121);
+        const uint8x16_t t3300 = vld1q_u8(k3300), t1122 = vld1q_u8(k1122), t2301 = vld1q_u8(k2301);
+        const uint8x16_t t3030 = vld1q_u8(k3030), t0213 = vld1q_u8(k0213);
+
+        float32x4_t row0 = vld1q_f32(m + 0);
+        float32x4_t row1 = vld1q_f32(m + 4);
+        float32x4_t row2 = vld1q_f32(m + 8);
+        float32x4_t row3 = vld1q_f32(m + 12);
+
+        float32x4_t A = vcombine_f32(vget_low_f32(row0), vget_low_f32(row1));
+        float32x4_t B = vcombine_f32(vget_high_f32(row0), vget_high_f32(row1));
+        float32x4_t C = vcombine_f32(vget_low_f32(row2), vget_low_f32(row3));
+        float32x4_t D = vcombine_f32(vget_high_f32(row2), vget_high_f32(row3));
+
+        // (|A|, |B|, |C|, |D|)
+        float32x4_t e02 = vuzp1q_f32(row0, row2), o02 = vuzp2q_f32(row0, row2);
+        float32x4_t e13 = vuzp1q_f32(row1, row3), o13 = vuzp2q_f32(row1, row3);
+        float32x4_t detSub = vsubq_f32(vmulq_f32(e02, o13), vmulq_f32(o02, e13));
+        float32x4_t detA = vdupq_laneq_f32(detSub, 0);
+        float32x4_t detB = vdupq_laneq_f32(detSub, 1);
+        float32x4_t detC = vdupq_laneq_f32(detSub, 2);
+        float32x4_t detD = vdupq_laneq_f32(detSub, 3);
+
+        float32x4_t D_C = vsubq_f32(vmulq_f32(CN_SWZ(D, t3300), C), vmulq_f32(CN_SWZ(D, t1122), CN_SWZ(C, t2301)));
+        float32x4_t A_B = vsubq_f32(vmulq_f32(CN_SWZ(A, t3300), B), vmulq_f32(CN_SWZ(A, t1122), CN_SWZ(B, t2301)));
+        float32x4_t B_DC = vaddq_f32(vmulq_f32(B, CN_SWZ(D_C, t0303)), vmulq_f32(CN_SWZ(B, t1032), CN_SWZ(D_C, t2121)));
+        float32x4_t C_AB = vaddq_f32(vmulq_f32(C, CN_SWZ(A_B, t0303)), vmulq_f32(CN_SWZ(C, t1032), CN_SWZ(A_B, t2121)));
+        float32x4_t D_AB = vsubq_f32(vmulq_f32(D, CN_SWZ(A_B, t3030)), vmulq_f32(CN_SWZ(D, t1032), CN_SWZ(A_B, t2121)));
+        float32x4_t A_DC = vsubq_f32(vmulq_f32(A, CN_SWZ(D_C, t3030)), vmulq_f32(CN_SWZ(A, t1032), CN_SWZ(D_C, t2121)));
+        float32x4_t X_ = vsubq_f32(vmulq_f32(detD, A), B_DC);
+        float32x4_t W_ = vsubq_f32(vmulq_f32(detA, D), C_AB);
+        float32x4_t Y_ = vsubq_f32(vmulq_f32(detB, C), D_AB);
+        float32x4_t Z_ = vsubq_f32(vmulq_f32(detC, B), A_DC);
+
+        float32x4_t detM = vaddq_f32(vmulq_f32(detA, detD), vmulq_f32(detB, detC));
+        float32x4_t tr = vmulq_f32(A_B, CN_SWZ(D_C, t0213));
+        detM = vsubq_f32(detM, vdupq_n_f32(vaddvq_f32(tr)));
+
+        static const float kSign[4] = { 1.0f, -1.0f, -1.0f, 1.0f };
+        float32x4_t rDetM = vdivq_f32(vld1q_f32(kSign), detM);
+        X_ = vmulq_f32(X_, rDetM);
+        Y_ = vmulq_f32(Y_, rDetM);
+        Z_ = vmulq_f32(Z_, rDetM);
+        W_ = vmulq_f32(W_, rDetM);
+
+        // (a3, a1, b3, b1) and (a2, a0, b2, b0)
+        float32x4_t XY31 = vcombine_f32(vrev64_f32(vget_low_f32(vuzp2q_f32(X_, X_))), vrev64_f32(vget_low_f32(vuzp2q_f32(Y_, Y_))));
+        float32x4_t XY20 = vcombine_f32(vrev64_f32(vget_low_f32(vuzp1q_f32(X_, X_))), vrev64_f32(vget_low_f32(vuzp1q_f32(Y_, Y_))));
+        float32x4_t ZW31 = vcombine_f32(vrev64_f32(vget_low_f32(vuzp2q_f32(Z_, Z_))), vrev64_f32(vget_low_f32(vuzp2q_f32(W_, W_))));
+        float32x4_t ZW20 = vcombine_f32(vrev64_f32(vget_low_f32(vuzp1q_f32(Z_, Z_))), vrev64_f32(vget_low_f32(vuzp1q_f32(W_, W_))));
+        vst1q_f32(r + 0,  XY31);
+        vst1q_f32(r + 4,  XY20);
+        vst1q_f32(r + 8,  ZW31);
+        vst1q_f32(r + 12, ZW20);
+
+        #undef CN_SWZ
+        #undef CN_TBL
+        #undef CN_LANE_BYTES
+    #else
+        Mat4InverseScalar(m, r);
+    #endif
+    }
+
+    template<class S, bool PROJECTIVE>
+    static size_t TransformPointsKernel(const Real* m, const Real* in, Real* out, size_t count)
+    {
+        typedef typename S::V V;
+        const V m00 = S::set1(m[0]),  m01 = S::set1(m[1]),  m02 = S::set1(m[2]),  m03 = S::set1(m[3]);
+        const V m10 = S::set1(m[4]),  m11 = S::set1(m[5]),  m12 = S::set1(m[6]),  m13 = S::set1(m[7]);
+        const V m20 = S::set1(m[8]),  m21 = S::set1(m[9]),  m22 = S::set1(m[10]), m23 = S::set1(m[11]);
+        const V m30 = S::set1(m[12]), m31 = S::set1(m[13]), m32 = S::set1(m[14]), m33 = S::set1(m[15]);
+        const V one = S::set1(1.0f);
+
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V x, y, z;
+            S::load3(in + i * 3, x, y, z);
+            V rx = S::add(S::add(S::add(S::mul(m00, x), S::mul(m01, y)), S::mul(m02, z)), m03);
+            V ry = S::add(S::add(S::add(S::mul(m10, x), S::mul(m11, y)), S::mul(m12, z)), m13);
+            V rz = S::add(S::add(S::add(S::mul(m20, x), S::mul(m21, y)), S::mul(m22, z)), m23);
+            if (PROJECTIVE)
+            {
+                V invW = S::div(one, S::add(S::add(S::add(S::mul(m30, x), S::mul(m31, y)), S::mul(m32, z)), m33));
+                rx = S::mul(rx, invW);
+                ry = S::mul(ry, invW);
+                rz = S::mul(rz, invW);
+            }
+            S::store3(out + i * 3, rx, ry, rz);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t TransformVec4sKernel(const Real* m, const Real* in, Real* out, size_t count)
+    {
+        typedef typename S::V V;
+        const V m00 = S::set1(m[0]),  m01 = S::set1(m[1]),  m02 = S::set1(m[2]),  m03 = S::set1(m[3]);
+        const V m10 = S::set1(m[4]),  m11 = S::set1(m[5]),  m12 = S::set1(m[6]),  m13 = S::set1(m[7]);
+        const V m20 = S::set1(m[8]),  m21 = S::set1(m[9]),  m22 = S::set1(m[10]), m23 = S::set1(m[11]);
+        const V m30 = S::set1(m[12]), m31 = S::set1(m[13]), m32 = S::set1(m[14]), m33 = S::set1(m[15]);
+
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V x, y, z, w;
+            S::load4(in + i * 4, x, y, z, w);
+            V rx = S::add(S::add(S::add(S::mul(m00, x), S::mul(m01, y)), S::mul(m02, z)), S::mul(m03, w));
+            V ry = S::add(S::add(S::add(S::mul(m10, x), S::mul(m11, y)), S::mul(m12, z)), S::mul(m13, w));
+            V rz = S::add(S::add(S::add(S::mul(m20, x), S::mul(m21, y)), S::mul(m22, z)), S::mul(m23, w));
+            V rw = S::add(S::add(S::add(S::mul(m30, x), S::mul(m31, y)), S::mul(m32, z)), S::mul(m33, w));
+            S::store4(out + i * 4, rx, ry, rz, rw);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t NormalizeKernel(Real* v, size_t count)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V x, y, z;
+            S::load3(v + i * 3, x, y, z);
+            V len = S::sqrt(S::add(S::add(S::mul(x, x), S::mul(y, y)), S::mul(z, z)));
+            V invLen = S::select(S::cmpgt(len, zero), S::div(one, len), one);
+            S::store3(v + i * 3, S::mul(x, invLen), S::mul(y, invLen), S::mul(z, invLen));
+        }
+        return i;
+    }
+
+    enum { POLAR_MAX_ITERATIONS = 12 };
+    // sum of the absolute element changes of one Newton step, quadratic
+    // convergence takes the error of the next iterate below float precision
+    static const Real POLAR_TOLERANCE = 1e-3f;
+    // |det| below this fraction of the product of the column lengths is
+    // treated as singular and decomposed from the columns
+    static const Real POLAR_SINGULAR = 1e-6f;
+
+    // Shoemake's matrix to quaternion (Quat::fromMat3) with the branches
+    // turned into per lane selects. r is row major, q is (w, x, y, z).
+    template<class S>
+    static inline void RotationToQuatLanes(const typename S::V r[3][3], typename S::V q[4])
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V one = S::set1(1.0f);
+        const V zero = S::set1(0.0f);
+
+        M traceCase = S::cmpgt(S::add(S::add(r[0][0], r[1][1]), r[2][2]), zero);
+        M yCase = S::cmpgt(r[1][1], r[0][0]);
+        M zCase = S::cmpgt(r[2][2], S::select(yCase, r[1][1], r[0][0]));
+
+        // numerators of each case, the diagonal term is the squared root
+        V tW = S::add(S::add(S::add(r[0][0], r[1][1]), r[2][2]), one);
+        V tX = S::add(S::sub(S::sub(r[0][0], r[1][1]), r[2][2]), one);
+        V tY = S::add(S::sub(S::sub(r[1][1], r[2][2]), r[0][0]), one);
+        V tZ = S::add(S::sub(S::sub(r[2][2], r[0][0]), r[1][1]), one);
+        V a = S::sub(r[2][1], r[1][2]), b = S::sub(r[0][2], r[2][0]), c = S::sub(r[1][0], r[0][1]);
+        V d = S::add(r[1][0], r[0][1]), e = S::add(r[2][0], r[0][2]), f = S::add(r[2][1], r[1][2]);
+
+        // i = 0, 1 or 2 as in fromMat3, then the trace case on top
+        V t = S::select(zCase, tZ, S::select(yCase, tY, tX));
+        V w = S::select(zCase, c, S::select(yCase, b, a));
+        V x = S::select(zCase, e, S::select(yCase, d, tX));
+        V y = S::select(zCase, f, S::select(yCase, tY, d));
+        V z = S::select(zCase, tZ, S::select(yCase, f, e));
+        t = S::select(traceCase, tW, t);
+        w = S::select(traceCase, tW, w);
+        x = S::select(traceCase, a, x);
+        y = S::select(traceCase, b, y);
+        z = S::select(traceCase, c, z);
+
+        V scale = S::div(S::set1(0.5f), S::sqrt(t));
+        q[0] = S::mul(w, scale);
+        q[1] = S::mul(x, scale);
+        q[2] = S::mul(y, scale);
+        q[3] = S::mul(z, scale);
+    }
+
+    // Decomposes S::WIDTH matrices per iteration. The upper 3x3 of each lane is
+    // gathered from its stride spaced matrix, so Mat4 and Affine3 share the kernel.
+    template<class S, bool SHEAR>
+    static size_t DecomposeKernel(const Real* m, size_t stride, Real* scales, Real* orientations, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        typedef typename S::M M;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+        const V half = S::set1(0.5f);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            Real gathered[9][S::WIDTH];
+            for (int l = 0; l < S::WIDTH; ++l)
+            {
+                const Real *src = m + (i + l) * stride;
+                for (int e = 0; e < 9; ++e)
+                    gathered[e][l] = src[(e / 3) * 4 + e % 3];
+            }
+            V a[3][3];
+            for (int e = 0; e < 9; ++e)
+                a[e / 3][e % 3] = S::load(gathered[e]);
+
+            V det = S::add(S::add(
+                S::mul(a[0][0], S::sub(S::mul(a[1][1], a[2][2]), S::mul(a[1][2], a[2][1]))),
+                S::mul(a[0][1], S::sub(S::mul(a[1][2], a[2][0]), S::mul(a[1][0], a[2][2])))),
+                S::mul(a[0][2], S::sub(S::mul(a[1][0], a[2][1]), S::mul(a[1][1], a[2][0]))));
+            // reflections flip the sign of every scale, as decomposition() does
+            V sign = S::select(S::cmpgt(zero, det), S::set1(-1.0f), one);
+
+            // columns normalized: the rotation of a TRS matrix
+            V len[3], r[3][3];
+            for (int j = 0; j < 3; ++j)
+            {
+                len[j] = S::sqrt(S::add(S::add(S::mul(a[0][j], a[0][j]), S::mul(a[1][j], a[1][j])), S::mul(a[2][j], a[2][j])));
+                V inv = S::select(S::cmpgt(len[j], zero), S::div(sign, len[j]), zero);
+                for (int k = 0; k < 3; ++k)
+                    r[k][j] = S::mul(a[k][j], inv);
+            }
+
+            V scl[3];
+            if (SHEAR)
+            {
+                // Higham's scaled Newton iteration X = (g X + X^-T / g) / 2 towards the
+                // orthogonal polar factor, with the Frobenius norm scaling g
+                M singular = S::cmpge(S::mul(S::set1(POLAR_SINGULAR), S::mul(S::mul(len[0], len[1]), len[2])), S::abs(det));
+                V x[3][3];
+                for (int k = 0; k < 3; ++k)
+                    for (int j = 0; j < 3; ++j)
+                        x[k][j] = a[k][j];
+
+                for (int iter = 0; iter < POLAR_MAX_ITERATIONS; ++iter)
+                {
+                    V cof[3][3];
+                    cof[0][0] = S::sub(S::mul(x[1][1], x[2][2]), S::mul(x[1][2], x[2][1]));
+                    cof[0][1] = S::sub(S::mul(x[1][2], x[2][0]), S::mul(x[1][0], x[2][2]));
+                    cof[0][2] = S::sub(S::mul(x[1][0], x[2][1]), S::mul(x[1][1], x[2][0]));
+                    cof[1][0] = S::sub(S::mul(x[0][2], x[2][1]), S::mul(x[0][1], x[2][2]));
+                    cof[1][1] = S::sub(S::mul(x[0][0], x[2][2]), S::mul(x[0][2], x[2][0]));
+                    cof[1][2] = S::sub(S::mul(x[0][1], x[2][0]), S::mul(x[0][0], x[2][1]));
+                    cof[2][0] = S::sub(S::mul(x[0][1], x[1][2]), S::mul(x[0][2], x[1][1]));
+                    cof[2][1] = S::sub(S::mul(x[0][2], x[1][0]), S::mul(x[0][0], x[1][2]));
+                    cof[2][2] = S::sub(S::mul(x[0][0], x[1][1]), S::mul(x[0][1], x[1][0]));
+                    V xDet = S::add(S::add(S::mul(x[0][0], cof[0][0]), S::mul(x[0][1], cof[0][1])), S::mul(x[0][2], cof[0][2]));
+
+                    V normX = zero, normCof = zero;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            normX = S::add(normX, S::mul(x[k][j], x[k][j]));
+                            normCof = S::add(normCof, S::mul(cof[k][j], cof[k][j]));
+                        }
+                    }
+                    // g = sqrt(|X^-1| / |X|), |X^-1| = |cof| / |det|
+                    V g = S::sqrt(S::sqrt(S::div(normCof, S::mul(normX, S::mul(xDet, xDet)))));
+                    V gx = S::mul(half, g);
+                    V gc = S::div(half, S::mul(g, xDet));
+
+                    V delta = zero;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            V next = S::add(S::mul(gx, x[k][j]), S::mul(gc, cof[k][j]));
+                            delta = S::add(delta, S::abs(S::sub(next, x[k][j])));
+                            x[k][j] = next;
+                        }
+                    }
+                    // singular lanes produce NaN here and are replaced below
+                    M done = S::maskOr(S::cmpge(S::set1(POLAR_TOLERANCE), delta), singular);
+                    if (S::maskBits(done) == (1 << S::WIDTH) - 1)
+                        break;
+                }
+
+                // X keeps the sign of det, the rotation is sign * X. The scale is the
+                // diagonal of the stretch R^T M.
+                for (int j = 0; j < 3; ++j)
+                {
+                    for (int k = 0; k < 3; ++k)
+                        r[k][j] = S::select(singular, r[k][j], S::mul(sign, x[k][j]));
+                    scl[j] = S::add(S::add(S::mul(r[0][j], a[0][j]), S::mul(r[1][j], a[1][j])), S::mul(r[2][j], a[2][j]));
+                }
+            }
+            else
+            {
+                for (int j = 0; j < 3; ++j)
+                    scl[j] = S::mul(sign, len[j]);
+            }
+
+            if (scales)
+            {
+                Real out[3][S::WIDTH];
+                for (int j = 0; j < 3; ++j)
+                    S::store(out[j], scl[j]);
+                for (int l = 0; l < S::WIDTH; ++l)
+                    for (int j = 0; j < 3; ++j)
+                        scales[(i + l) * 3 + j] = out[j][l];
+            }
+            if (orientations)
+            {
+                V q[4];
+                RotationToQuatLanes<S>(r, q);
+                Real out[4][S::WIDTH];
+                for (int j = 0; j < 4; ++j)
+                    S::store(out[j], q[j]);
+                for (int l = 0; l < S::WIDTH; ++l)
+                    for (int j = 0; j < 4; ++j)
+                        orientations[(i + l) * 4 + j] = out[j][l];
+            }
+        }
+        return i;
+    }
+
+    // Inverse transpose of the upper 3x3 of S::WIDTH matrices per iteration, as
+    // the cofactor matrix over the determinant. UNIFORM takes the rotation *
+    // uniform scale shortcut M / |column 0|^2 instead.
+    template<class S, bool UNIFORM>
+    static size_t NormalMatrixKernel(const Real* m, size_t stride, Real* out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            Real gathered[9][S::WIDTH];
+            for (int l = 0; l < S::WIDTH; ++l)
+            {
+                const Real *src = m + (i + l) * stride;
+                for (int e = 0; e < 9; ++e)
+                    gathered[e][l] = src[(e / 3) * 4 + e % 3];
+            }
+            V a[3][3];
+            for (int e = 0; e < 9; ++e)
+                a[e / 3][e % 3] = S::load(gathered[e]);
+
+            V n[3][3];
+            if (UNIFORM)
+            {
+                V invScaleSq = S::div(S::set1(1.0f), S::add(S::add(S::mul(a[0][0], a[0][0]), S::mul(a[1][0], a[1][0])), S::mul(a[2][0], a[2][0])));
+                for (int k = 0; k < 3; ++k)
+                    for (int j = 0; j < 3; ++j)
+                        n[k][j] = S::mul(a[k][j], invScaleSq);
+            }
+            else
+            {
+                n[0][0] = S::sub(S::mul(a[1][1], a[2][2]), S::mul(a[1][2], a[2][1]));
+                n[0][1] = S::sub(S::mul(a[1][2], a[2][0]), S::mul(a[1][0], a[2][2]));
+                n[0][2] = S::sub(S::mul(a[1][0], a[2][1]), S::mul(a[1][1], a[2][0]));
+                n[1][0] = S::sub(S::mul(a[0][2], a[2][1]), S::mul(a[0][1], a[2][2]));
+                n[1][1] = S::sub(S::mul(a[0][0], a[2][2]), S::mul(a[0][2], a[2][0]));
+                n[1][2] = S::sub(S::mul(a[0][1], a[2][0]), S::mul(a[0][0], a[2][1]));
+                n[2][0] = S::sub(S::mul(a[0][1], a[1][2]), S::mul(a[0][2], a[1][1]));
+                n[2][1] = S::sub(S::mul(a[0][2], a[1][0]), S::mul(a[0][0], a[1][2]));
+                n[2][2] = S::sub(S::mul(a[0][0], a[1][1]), S::mul(a[0][1], a[1][0]));
+                V det = S::add(S::add(S::mul(a[0][0], n[0][0]), S::mul(a[0][1], n[0][1])), S::mul(a[0][2], n[0][2]));
+                V invDet = S::div(S::set1(1.0f), det);
+                for (int k = 0; k < 3; ++k)
+                    for (int j = 0; j < 3; ++j)
+                        n[k][j] = S::mul(n[k][j], invDet);
+            }
+
+            Real scattered[9][S::WIDTH];
+            for (int e = 0; e < 9; ++e)
+                S::store(scattered[e], n[e / 3][e % 3]);
+            for (int l = 0; l < S::WIDTH; ++l)
+                for (int e = 0; e < 9; ++e)
+                    out[(i + l) * 9 + e] = scattered[e][l];
+        }
+        return i;
+    }
+
+    void Mat4TransformPoints(const Real* m, const Real* in, Real* out, size_t count)
+    {
+        size_t i = TransformPointsKernel<SimdOps, true>(m, in, out, count);
+        TransformPointsKernel<SimdOps1, true>(m, in + i * 3, out + i * 3, count - i);
+    }
+
+    void Mat4TransformAffinePoints(const Real* m, const Real* in, Real* out, size_t count)
+    {
+        size_t i = TransformPointsKernel<SimdOps, false>(m, in, out, count);
+        TransformPointsKernel<SimdOps1, false>(m, in + i * 3, out + i * 3, count - i);
+    }
+
+    void Mat4TransformDirections(const Real* m, const Real* in, Real* out, size_t count)
+    {
+        Real linear[16];
+        memcpy(linear, m, 16 * sizeof(Real));
+        linear[3] = linear[7] = linear[11] = 0.0f;
+        Mat4TransformAffinePoints(linear, in, out, count);
+    }
+
+    void Mat4TransformVec4s(const Real* m, const Real* in, Real* out, size_t count)
+    {
+        size_t i = TransformVec4sKernel<SimdOps>(m, in, out, count);
+        TransformVec4sKernel<SimdOps1>(m, in + i * 4, out + i * 4, count - i);
+    }
+
+    void Vec3NormalizeBatch(Real* v, size_t count)
+    {
+        size_t i = NormalizeKernel<SimdOps>(v, count);
+        NormalizeKernel<SimdOps1>(v + i * 3, count - i);
+    }
+
+    void AffineDecomposeBatch(const Real* m, size_t stride, Real* positions, Real* scales, Real* orientations, size_t count, bool handleShear)
+    {
+        if (positions)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Real *src = m + i * stride;
+                positions[i * 3 + 0] = src[3];
+                positions[i * 3 + 1] = src[7];
+                positions[i * 3 + 2] = src[11];
+            }
+        }
+        if (!scales && !orientations)
+            return;
+
+        if (handleShear)
+        {
+            size_t i = DecomposeKernel<SimdOps, true>(m, stride, scales, orientations, 0, count);
+            DecomposeKernel<SimdOps1, true>(m, stride, scales, orientations, i, count);
+        }
+        else
+        {
+            size_t i = DecomposeKernel<SimdOps, false>(m, stride, scales, orientations, 0, count);
+            DecomposeKernel<SimdOps1, false>(m, stride, scales, orientations, i, count);
+        }
+    }
+
+    void NormalMatrixBatch(const Real* m, size_t stride, Real* out, size_t count, bool uniformScale)
+    {
+        if (uniformScale)
+        {
+            size_t i = NormalMatrixKernel<SimdOps, true>(m, stride, out, 0, count);
+            NormalMatrixKernel<SimdOps1, true>(m, stride, out, i, count);
+        }
+        else
+        {
+            size_t i = NormalMatrixKernel<SimdOps, false>(m, stride, out, 0, count);
+            NormalMatrixKernel<SimdOps1, false>(m, stride, out, i, count);
+        }
+    }
+}
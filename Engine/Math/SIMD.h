@@ -0,0 +1,613 @@
+#ifndef _CN_SIMD_
+#define _CN_SIMD_
+#include "Prerequisites.h"
+#include <math.h>
+#include <stdint.h>
+
+/*
+	Compile-time selected SIMD backend for the math module.
+
+	CN_SIMD is set to one of the CN_SIMD_* values below from the compiler's
+	target macros. Define CN_DISABLE_SIMD to force the scalar path; double
+	precision builds always use the scalar path.
+
+	Accuracy of the SIMD kernels against the scalar reference:
+	- Mat4 * Mat4, Mat4 * Vec4, Mat4 * Vec3: every lane is evaluated in the
+	  same order as the scalar code, so results are bit identical (0 ULP)
+	  unless the compiler contracts the scalar path into FMA instructions,
+	  in which case they differ by at most 1 ULP per output element.
+	- Mat4 inverse: uses 2x2 block elimination instead of the scalar cofactor
+	  expansion, so the rounding differs. Measured relative to the ULP of the
+	  largest magnitude element of the inverse, both paths stay within 8 ULP
+	  of the exact inverse of a TRS matrix and within 24 ULP of each other.
+	  Ill-conditioned input (e.g. projections) loses accuracy equally on
+	  both paths.
+*/
+
+#define CN_SIMD_NONE    0
+#define CN_SIMD_SSE2    1
+#define CN_SIMD_AVX     2
+#define CN_SIMD_NEON    3
+
+#if defined(CN_DISABLE_SIMD) || CN_DOUBLE_PRECISION == 1
+    #define CN_SIMD     CN_SIMD_NONE
+#elif defined(__AVX__)
+    #define CN_SIMD     CN_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CN_SIMD     CN_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define CN_SIMD     CN_SIMD_NEON
+#else
+    #define CN_SIMD     CN_SIMD_NONE
+#endif
+
+#if CN_SIMD == CN_SIMD_SSE2 || CN_SIMD == CN_SIMD_AVX
+    #define CN_SIMD_X86 1
+    #include <immintrin.h>
+#else
+    #define CN_SIMD_X86 0
+#endif
+
+#if CN_SIMD == CN_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace Canaan
+{
+    inline const char* SimdBackendName()
+    {
+    #if CN_SIMD == CN_SIMD_AVX
+        return "avx";
+    #elif CN_SIMD == CN_SIMD_SSE2
+        return "sse2";
+    #elif CN_SIMD == CN_SIMD_NEON
+        return "neon";
+    #else
+        return "scalar";
+    #endif
+    }
+
+    // Scalar reference kernels. Matrices are 16 Reals in row-major order and
+    // vectors are multiplied as columns (see Matrix4.h).
+
+    inline void Mat4MultiplyScalar(const Real* a, const Real* b, Real* r)
+    {
+        Real t[16];
+        for (int i = 0; i < 4; ++i)
+        {
+            const Real* ai = a + i * 4;
+            t[i * 4 + 0] = ai[0] * b[0] + ai[1] * b[4] + ai[2] * b[8]  + ai[3] * b[12];
+            t[i * 4 + 1] = ai[0] * b[1] + ai[1] * b[5] + ai[2] * b[9]  + ai[3] * b[13];
+            t[i * 4 + 2] = ai[0] * b[2] + ai[1] * b[6] + ai[2] * b[10] + ai[3] * b[14];
+            t[i * 4 + 3] = ai[0] * b[3] + ai[1] * b[7] + ai[2] * b[11] + ai[3] * b[15];
+        }
+        memcpy(r, t, 16 * sizeof(Real));
+    }
+
+    inline void Mat4TransformVec4Scalar(const Real* m, const Real* v, Real* r)
+    {
+        Real x = m[0]  * v[0] + m[1]  * v[1] + m[2]  * v[2] + m[3]  * v[3];
+        Real y = m[4]  * v[0] + m[5]  * v[1] + m[6]  * v[2] + m[7]  * v[3];
+        Real z = m[8]  * v[0] + m[9]  * v[1] + m[10] * v[2] + m[11] * v[3];
+        Real w = m[12] * v[0] + m[13] * v[1] + m[14] * v[2] + m[15] * v[3];
+        r[0] = x; r[1] = y; r[2] = z; r[3] = w;
+    }
+
+    inline void Mat4TransformPointScalar(const Real* m, const Real* v, Real* r)
+    {
+        Real fInvW = 1.0f / (m[12] * v[0] + m[13] * v[1] + m[14] * v[2] + m[15]);
+        Real x = (m[0] * v[0] + m[1] * v[1] + m[2]  * v[2] + m[3])  * fInvW;
+        Real y = (m[4] * v[0] + m[5] * v[1] + m[6]  * v[2] + m[7])  * fInvW;
+        Real z = (m[8] * v[0] + m[9] * v[1] + m[10] * v[2] + m[11]) * fInvW;
+        r[0] = x; r[1] = y; r[2] = z;
+    }
+
+    // Backend kernels. a, b, m and r may alias.
+
+    inline void Mat4Multiply(const Real* a, const Real* b, Real* r)
+    {
+    #if CN_SIMD == CN_SIMD_AVX
+        __m256 b0 = _mm256_broadcast_ps((const __m128*)(b + 0));
+        __m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+        __m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+        __m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+        __m256 a01 = _mm256_loadu_ps(a);
+        __m256 a23 = _mm256_loadu_ps(a + 8);
+
+        __m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3));
+
+        __m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3));
+
+        _mm256_storeu_ps(r, r01);
+        _mm256_storeu_ps(r + 8, r23);
+    #elif CN_SIMD == CN_SIMD_SSE2
+        __m128 b0 = _mm_loadu_ps(b + 0);
+        __m128 b1 = _mm_loadu_ps(b + 4);
+        __m128 b2 = _mm_loadu_ps(b + 8);
+        __m128 b3 = _mm_loadu_ps(b + 12);
+        __m128 rows[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            __m128 ai = _mm_loadu_ps(a + i * 4);
+            __m128 ri = _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0x00), b0);
+            ri = _mm_add_ps(ri, _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0x55), b1));
+            ri = _mm_add_ps(ri, _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0xAA), b2));
+            ri = _mm_add_ps(ri, _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0xFF), b3));
+            rows[i] = ri;
+        }
+        _mm_storeu_ps(r + 0, rows[0]);
+        _mm_storeu_ps(r + 4, rows[1]);
+        _mm_storeu_ps(r + 8, rows[2]);
+        _mm_storeu_ps(r + 12, rows[3]);
+    #elif CN_SIMD == CN_SIMD_NEON
+        float32x4_t b0 = vld1q_f32(b + 0);
+        float32x4_t b1 = vld1q_f32(b + 4);
+        float32x4_t b2 = vld1q_f32(b + 8);
+        float32x4_t b3 = vld1q_f32(b + 12);
+        float32x4_t rows[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            // vmul + vadd rather than vmla/vfma to keep the scalar rounding
+            float32x4_t ri = vmulq_n_f32(b0, a[i * 4 + 0]);
+            ri = vaddq_f32(ri, vmulq_n_f32(b1, a[i * 4 + 1]));
+            ri = vaddq_f32(ri, vmulq_n_f32(b2, a[i * 4 + 2]));
+            ri = vaddq_f32(ri, vmulq_n_f32(b3, a[i * 4 + 3]));
+            rows[i] = ri;
+        }
+        vst1q_f32(r + 0, rows[0]);
+        vst1q_f32(r + 4, rows[1]);
+        vst1q_f32(r + 8, rows[2]);
+        vst1q_f32(r + 12, rows[3]);
+    #else
+        Mat4MultiplyScalar(a, b, r);
+    #endif
+    }
+
+    inline void Mat4TransformVec4(const Real* m, const Real* v, Real* r)
+    {
+    #if CN_SIMD_X86
+        __m128 c0 = _mm_loadu_ps(m + 0);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_loadu_ps(m + 12);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        __m128 res = _mm_mul_ps(c0, _mm_set1_ps(v[0]));
+        res = _mm_add_ps(res, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+        res = _mm_add_ps(res, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+        res = _mm_add_ps(res, _mm_mul_ps(c3, _mm_set1_ps(v[3])));
+        _mm_storeu_ps(r, res);
+    #elif CN_SIMD == CN_SIMD_NEON
+        float32x4x4_t c = vld4q_f32(m);
+        float32x4_t res = vmulq_n_f32(c.val[0], v[0]);
+        res = vaddq_f32(res, vmulq_n_f32(c.val[1], v[1]));
+        res = vaddq_f32(res, vmulq_n_f32(c.val[2], v[2]));
+        res = vaddq_f32(res, vmulq_n_f32(c.val[3], v[3]));
+        vst1q_f32(r, res);
+    #else
+        Mat4TransformVec4Scalar(m, v, r);
+    #endif
+    }
+
+    inline void Mat4TransformPoint(const Real* m, const Real* v, Real* r)
+    {
+    #if CN_SIMD_X86
+        __m128 c0 = _mm_loadu_ps(m + 0);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_loadu_ps(m + 12);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        __m128 res = _mm_mul_ps(c0, _mm_set1_ps(v[0]));
+        res = _mm_add_ps(res, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+        res = _mm_add_ps(res, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+        res = _mm_add_ps(res, c3);
+        __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), _mm_shuffle_ps(res, res, 0xFF));
+        res = _mm_mul_ps(res, invW);
+        float out[4];
+        _mm_storeu_ps(out, res);
+        r[0] = out[0]; r[1] = out[1]; r[2] = out[2];
+    #elif CN_SIMD == CN_SIMD_NEON
+        float32x4x4_t c = vld4q_f32(m);
+        float32x4_t res = vmulq_n_f32(c.val[0], v[0]);
+        res = vaddq_f32(res, vmulq_n_f32(c.val[1], v[1]));
+        res = vaddq_f32(res, vmulq_n_f32(c.val[2], v[2]));
+        res = vaddq_f32(res, c.val[3]);
+        float fInvW = 1.0f / vgetq_lane_f32(res, 3);
+        res = vmulq_n_f32(res, fInvW);
+        r[0] = vgetq_lane_f32(res, 0);
+        r[1] = vgetq_lane_f32(res, 1);
+        r[2] = vgetq_lane_f32(res, 2);
+    #else
+        Mat4TransformPointScalar(m, v, r);
+    #endif
+    }
+
+    CN_EXPORT void Mat4InverseScalar(const Real* m, Real* r);
+    CN_EXPORT void Mat4Inverse(const Real* m, Real* r);
+
+    // Affine 3x4 product with an implicit (0, 0, 0, 1) bottom row on both
+    // operands (see Affine3.h), evaluated in the scalar reference order.
+    inline void Affine3MultiplyScalar(const Real* a, const Real* b, Real* r)
+    {
+        Real t[12];
+        for (int i = 0; i < 3; ++i)
+        {
+            const Real* ai = a + i * 4;
+            t[i * 4 + 0] = ai[0] * b[0] + ai[1] * b[4] + ai[2] * b[8];
+            t[i * 4 + 1] = ai[0] * b[1] + ai[1] * b[5] + ai[2] * b[9];
+            t[i * 4 + 2] = ai[0] * b[2] + ai[1] * b[6] + ai[2] * b[10];
+            t[i * 4 + 3] = ai[0] * b[3] + ai[1] * b[7] + ai[2] * b[11] + ai[3];
+        }
+        memcpy(r, t, 12 * sizeof(Real));
+    }
+
+    inline void Affine3Multiply(const Real* a, const Real* b, Real* r)
+    {
+    #if CN_SIMD_X86
+        const __m128 maskW = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+        __m128 b0 = _mm_loadu_ps(b + 0);
+        __m128 b1 = _mm_loadu_ps(b + 4);
+        __m128 b2 = _mm_loadu_ps(b + 8);
+        __m128 rows[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 ai = _mm_loadu_ps(a + i * 4);
+            __m128 ri = _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0x00), b0);
+            ri = _mm_add_ps(ri, _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0x55), b1));
+            ri = _mm_add_ps(ri, _mm_mul_ps(_mm_shuffle_ps(ai, ai, 0xAA), b2));
+            rows[i] = _mm_add_ps(ri, _mm_and_ps(ai, maskW));
+        }
+        _mm_storeu_ps(r + 0, rows[0]);
+        _mm_storeu_ps(r + 4, rows[1]);
+        _mm_storeu_ps(r + 8, rows[2]);
+    #elif CN_SIMD == CN_SIMD_NEON
+        float32x4_t b0 = vld1q_f32(b + 0);
+        float32x4_t b1 = vld1q_f32(b + 4);
+        float32x4_t b2 = vld1q_f32(b + 8);
+        float32x4_t rows[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            float32x4_t ri = vmulq_n_f32(b0, a[i * 4 + 0]);
+            ri = vaddq_f32(ri, vmulq_n_f32(b1, a[i * 4 + 1]));
+            ri = vaddq_f32(ri, vmulq_n_f32(b2, a[i * 4 + 2]));
+            rows[i] = vaddq_f32(ri, vsetq_lane_f32(a[i * 4 + 3], vdupq_n_f32(0.0f), 3));
+        }
+        vst1q_f32(r + 0, rows[0]);
+        vst1q_f32(r + 4, rows[1]);
+        vst1q_f32(r + 8, rows[2]);
+    #else
+        Affine3MultiplyScalar(a, b, r);
+    #endif
+    }
+
+    /*
+        Width-generic lane operations used to write bulk kernels once and
+        instantiate them for every backend. SimdOps is the widest set the
+        target supports; SimdOps1 runs the same kernel on plain Reals.
+
+        load3/store3 convert WIDTH packed Vec3s (x y z x y z ...) to and from
+        one register per component, load4/store4 do the same for Vec4s.
+
+        rsqrt is the hardware reciprocal square root estimate and needs
+        RSQRT_STEPS Newton iterations to reach ~float precision (the scalar
+        fallback is exact and needs none). round is round-to-nearest-even.
+    */
+    // Newton steps after the hardware estimate: x86 rsqrt gives 12 bits,
+    // NEON vrsqrte only 8
+#if CN_SIMD == CN_SIMD_NEON
+    static const int SimdOpsRsqrtSteps = 2;
+#else
+    static const int SimdOpsRsqrtSteps = 1;
+#endif
+
+    struct SimdOps1
+    {
+        typedef Real V;
+        typedef bool M;
+    #if CN_SIMD_X86 || (CN_SIMD == CN_SIMD_NEON && defined(__aarch64__))
+        enum { WIDTH = 1, RSQRT_STEPS = SimdOpsRsqrtSteps };
+    #else
+        enum { WIDTH = 1, RSQRT_STEPS = 0 };
+    #endif
+
+        static inline V set1(Real a) { return a; }
+        static inline V load(const Real* p) { return *p; }
+        static inline void store(Real* p, V a) { *p = a; }
+        static inline V add(V a, V b) { return a + b; }
+        static inline V sub(V a, V b) { return a - b; }
+        static inline V mul(V a, V b) { return a * b; }
+        static inline V div(V a, V b) { return a / b; }
+        static inline V sqrt(V a) { return ::sqrt(a); }
+        static inline V abs(V a) { return ::fabs(a); }
+    #if CN_SIMD_X86
+        // same conversion as the SSE lanes, avoids the libm call
+        static inline V round(V a) { return (V)_mm_cvtss_si32(_mm_set_ss(a)); }
+        static inline V rsqrt(V a) { return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a))); }
+    #elif CN_SIMD == CN_SIMD_NEON && defined(__aarch64__)
+        static inline V round(V a) { return vrndns_f32(a); }
+        static inline V rsqrt(V a) { return vrsqrtes_f32(a); }
+    #else
+        static inline V round(V a) { return ::nearbyint(a); }
+        static inline V rsqrt(V a) { return 1.0f / ::sqrt(a); }
+    #endif
+        static inline V minimum(V a, V b) { return a < b ? a : b; }
+        static inline V maximum(V a, V b) { return a < b ? b : a; }
+        static inline M cmpgt(V a, V b) { return a > b; }
+        static inline M cmpge(V a, V b) { return a >= b; }
+        static inline M maskAnd(M a, M b) { return a && b; }
+        static inline M maskOr(M a, M b) { return a || b; }
+        static inline V select(M m, V a, V b) { return m ? a : b; }
+        static inline int maskBits(M m) { return m ? 1 : 0; }
+
+        static inline void load3(const Real* p, V &x, V &y, V &z) { x = p[0]; y = p[1]; z = p[2]; }
+        static inline void store3(Real* p, V x, V y, V z) { p[0] = x; p[1] = y; p[2] = z; }
+        static inline void load4(const Real* p, V &x, V &y, V &z, V &w) { x = p[0]; y = p[1]; z = p[2]; w = p[3]; }
+        static inline void store4(Real* p, V x, V y, V z, V w) { p[0] = x; p[1] = y; p[2] = z; p[3] = w; }
+        // four consecutive Reals from p[k] for every lane k: x holds the first of each
+        static inline void gather4(const Real* const* p, V &x, V &y, V &z, V &w) { load4(p[0], x, y, z, w); }
+    };
+
+#if CN_SIMD_X86
+    struct SimdOps4
+    {
+        typedef __m128 V;
+        typedef __m128 M;
+        enum { WIDTH = 4, RSQRT_STEPS = SimdOpsRsqrtSteps };
+
+        template<int X, int Y, int Z, int W>
+        static inline V shuffle(V a, V b) { return _mm_shuffle_ps(a, b, X | (Y << 2) | (Z << 4) | (W << 6)); }
+
+        static inline V set1(Real a) { return _mm_set1_ps(a); }
+        static inline V load(const Real* p) { return _mm_loadu_ps(p); }
+        static inline void store(Real* p, V a) { _mm_storeu_ps(p, a); }
+        static inline V add(V a, V b) { return _mm_add_ps(a, b); }
+        static inline V sub(V a, V b) { return _mm_sub_ps(a, b); }
+        static inline V mul(V a, V b) { return _mm_mul_ps(a, b); }
+        static inline V div(V a, V b) { return _mm_div_ps(a, b); }
+        static inline V sqrt(V a) { return _mm_sqrt_ps(a); }
+        static inline V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        // valid for |a| < 2^31
+        static inline V round(V a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+        static inline V rsqrt(V a) { return _mm_rsqrt_ps(a); }
+        static inline V minimum(V a, V b) { return _mm_min_ps(a, b); }
+        static inline V maximum(V a, V b) { return _mm_max_ps(a, b); }
+        static inline M cmpgt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+        static inline M cmpge(V a, V b) { return _mm_cmpge_ps(a, b); }
+        static inline M maskAnd(M a, M b) { return _mm_and_ps(a, b); }
+        static inline M maskOr(M a, M b) { return _mm_or_ps(a, b); }
+        static inline V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        static inline int maskBits(M m) { return _mm_movemask_ps(m); }
+
+        // (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3) <-> (x0 x1 x2 x3) (y0 ..) (z0 ..)
+        static inline void deinterleave3(V a, V b, V c, V &x, V &y, V &z)
+        {
+            x = shuffle<0, 3, 0, 2>(a, shuffle<2, 2, 1, 1>(b, c));
+            y = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(a, b), shuffle<3, 3, 2, 2>(b, c));
+            z = shuffle<0, 2, 0, 3>(shuffle<2, 2, 1, 1>(a, b), c);
+        }
+        static inline void interleave3(V x, V y, V z, V &a, V &b, V &c)
+        {
+            a = shuffle<0, 2, 0, 2>(shuffle<0, 0, 0, 0>(x, y), shuffle<0, 0, 1, 1>(z, x));
+            b = shuffle<0, 2, 0, 2>(shuffle<1, 1, 1, 1>(y, z), shuffle<2, 2, 2, 2>(x, y));
+            c = shuffle<0, 2, 0, 2>(shuffle<2, 2, 3, 3>(z, x), shuffle<3, 3, 3, 3>(y, z));
+        }
+        static inline void load3(const Real* p, V &x, V &y, V &z)
+        {
+            deinterleave3(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), x, y, z);
+        }
+        static inline void store3(Real* p, V x, V y, V z)
+        {
+            V a, b, c;
+            interleave3(x, y, z, a, b, c);
+            _mm_storeu_ps(p, a);
+            _mm_storeu_ps(p + 4, b);
+            _mm_storeu_ps(p + 8, c);
+        }
+        static inline void load4(const Real* p, V &x, V &y, V &z, V &w)
+        {
+            x = _mm_loadu_ps(p); y = _mm_loadu_ps(p + 4); z = _mm_loadu_ps(p + 8); w = _mm_loadu_ps(p + 12);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+        }
+        static inline void store4(Real* p, V x, V y, V z, V w)
+        {
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps(p, x); _mm_storeu_ps(p + 4, y); _mm_storeu_ps(p + 8, z); _mm_storeu_ps(p + 12, w);
+        }
+        static inline void gather4(const Real* const* p, V &x, V &y, V &z, V &w)
+        {
+            x = _mm_loadu_ps(p[0]); y = _mm_loadu_ps(p[1]); z = _mm_loadu_ps(p[2]); w = _mm_loadu_ps(p[3]);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+        }
+    };
+#elif CN_SIMD == CN_SIMD_NEON && defined(__aarch64__)
+    struct SimdOps4
+    {
+        typedef float32x4_t V;
+        typedef uint32x4_t M;
+        enum { WIDTH = 4, RSQRT_STEPS = SimdOpsRsqrtSteps };
+
+        static inline V set1(Real a) { return vdupq_n_f32(a); }
+        static inline V load(const Real* p) { return vld1q_f32(p); }
+        static inline void store(Real* p, V a) { vst1q_f32(p, a); }
+        static inline V add(V a, V b) { return vaddq_f32(a, b); }
+        static inline V sub(V a, V b) { return vsubq_f32(a, b); }
+        static inline V mul(V a, V b) { return vmulq_f32(a, b); }
+        static inline V div(V a, V b) { return vdivq_f32(a, b); }
+        static inline V sqrt(V a) { return vsqrtq_f32(a); }
+        static inline V abs(V a) { return vabsq_f32(a); }
+        static inline V round(V a) { return vrndnq_f32(a); }
+        static inline V rsqrt(V a) { return vrsqrteq_f32(a); }
+        static inline V minimum(V a, V b) { return vminq_f32(a, b); }
+        static inline V maximum(V a, V b) { return vmaxq_f32(a, b); }
+        static inline M cmpgt(V a, V b) { return vcgtq_f32(a, b); }
+        static inline M cmpge(V a, V b) { return vcgeq_f32(a, b); }
+        static inline M maskAnd(M a, M b) { return vandq_u32(a, b); }
+        static inline M maskOr(M a, M b) { return vorrq_u32(a, b); }
+        static inline V select(M m, V a, V b) { return vbslq_f32(m, a, b); }
+        static inline int maskBits(M m)
+        {
+            static const uint32_t kBits[4] = { 1, 2, 4, 8 };
+            return (int)vaddvq_u32(vandq_u32(m, vld1q_u32(kBits)));
+        }
+
+        static inline void load3(const Real* p, V &x, V &y, V &z)
+        {
+            float32x4x3_t v = vld3q_f32(p);
+            x = v.val[0]; y = v.val[1]; z = v.val[2];
+        }
+        static inline void store3(Real* p, V x, V y, V z)
+        {
+            float32x4x3_t v = { { x, y, z } };
+            vst3q_f32(p, v);
+        }
+        static inline void load4(const Real* p, V &x, V &y, V &z, V &w)
+        {
+            float32x4x4_t v = vld4q_f32(p);
+            x = v.val[0]; y = v.val[1]; z = v.val[2]; w = v.val[3];
+        }
+        static inline void store4(Real* p, V x, V y, V z, V w)
+        {
+            float32x4x4_t v = { { x, y, z, w } };
+            vst4q_f32(p, v);
+        }
+        static inline void gather4(const Real* const* p, V &x, V &y, V &z, V &w)
+        {
+            float32x4x2_t a = vzipq_f32(vld1q_f32(p[0]), vld1q_f32(p[2]));
+            float32x4x2_t b = vzipq_f32(vld1q_f32(p[1]), vld1q_f32(p[3]));
+            float32x4x2_t lo = vzipq_f32(a.val[0], b.val[0]);
+            float32x4x2_t hi = vzipq_f32(a.val[1], b.val[1]);
+            x = lo.val[0]; y = lo.val[1]; z = hi.val[0]; w = hi.val[1];
+        }
+    };
+#endif
+
+#if CN_SIMD == CN_SIMD_AVX
+    struct SimdOps8
+    {
+        typedef __m256 V;
+        typedef __m256 M;
+        enum { WIDTH = 8, RSQRT_STEPS = SimdOpsRsqrtSteps };
+
+        template<int X, int Y, int Z, int W>
+        static inline V shuffle(V a, V b) { return _mm256_shuffle_ps(a, b, X | (Y << 2) | (Z << 4) | (W << 6)); }
+
+        static inline V set1(Real a) { return _mm256_set1_ps(a); }
+        static inline V load(const Real* p) { return _mm256_loadu_ps(p); }
+        static inline void store(Real* p, V a) { _mm256_storeu_ps(p, a); }
+        static inline V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static inline V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static inline V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static inline V div(V a, V b) { return _mm256_div_ps(a, b); }
+        static inline V sqrt(V a) { return _mm256_sqrt_ps(a); }
+        static inline V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static inline V round(V a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static inline V rsqrt(V a) { return _mm256_rsqrt_ps(a); }
+        static inline V minimum(V a, V b) { return _mm256_min_ps(a, b); }
+        static inline V maximum(V a, V b) { return _mm256_max_ps(a, b); }
+        static inline M cmpgt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static inline M cmpge(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static inline M maskAnd(M a, M b) { return _mm256_and_ps(a, b); }
+        static inline M maskOr(M a, M b) { return _mm256_or_ps(a, b); }
+        static inline V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+        static inline int maskBits(M m) { return _mm256_movemask_ps(m); }
+
+        // lanes 0-3 hold elements 0-3, lanes 4-7 hold elements 4-7, so the
+        // 128-bit shuffles of SimdOps4 apply unchanged within each half
+        static inline V pair(const Real* lo, const Real* hi)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+        }
+        static inline void unpair(Real* lo, Real* hi, V a)
+        {
+            _mm_storeu_ps(lo, _mm256_castps256_ps128(a));
+            _mm_storeu_ps(hi, _mm256_extractf128_ps(a, 1));
+        }
+        static inline void load3(const Real* p, V &x, V &y, V &z)
+        {
+            V a = pair(p, p + 12), b = pair(p + 4, p + 16), c = pair(p + 8, p + 20);
+            x = shuffle<0, 3, 0, 2>(a, shuffle<2, 2, 1, 1>(b, c));
+            y = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(a, b), shuffle<3, 3, 2, 2>(b, c));
+            z = shuffle<0, 2, 0, 3>(shuffle<2, 2, 1, 1>(a, b), c);
+        }
+        static inline void store3(Real* p, V x, V y, V z)
+        {
+            V a = shuffle<0, 2, 0, 2>(shuffle<0, 0, 0, 0>(x, y), shuffle<0, 0, 1, 1>(z, x));
+            V b = shuffle<0, 2, 0, 2>(shuffle<1, 1, 1, 1>(y, z), shuffle<2, 2, 2, 2>(x, y));
+            V c = shuffle<0, 2, 0, 2>(shuffle<2, 2, 3, 3>(z, x), shuffle<3, 3, 3, 3>(y, z));
+            unpair(p, p + 12, a);
+            unpair(p + 4, p + 16, b);
+            unpair(p + 8, p + 20, c);
+        }
+        static inline void transpose4(V &x, V &y, V &z, V &w)
+        {
+            V t0 = _mm256_unpacklo_ps(x, y), t1 = _mm256_unpacklo_ps(z, w);
+            V t2 = _mm256_unpackhi_ps(x, y), t3 = _mm256_unpackhi_ps(z, w);
+            x = shuffle<0, 1, 0, 1>(t0, t1);
+            y = shuffle<2, 3, 2, 3>(t0, t1);
+            z = shuffle<0, 1, 0, 1>(t2, t3);
+            w = shuffle<2, 3, 2, 3>(t2, t3);
+        }
+        static inline void load4(const Real* p, V &x, V &y, V &z, V &w)
+        {
+            x = pair(p, p + 16); y = pair(p + 4, p + 20); z = pair(p + 8, p + 24); w = pair(p + 12, p + 28);
+            transpose4(x, y, z, w);
+        }
+        static inline void store4(Real* p, V x, V y, V z, V w)
+        {
+            transpose4(x, y, z, w);
+            unpair(p, p + 16, x); unpair(p + 4, p + 20, y); unpair(p + 8, p + 24, z); unpair(p + 12, p + 28, w);
+        }
+        static inline void gather4(const Real* const* p, V &x, V &y, V &z, V &w)
+        {
+            x = pair(p[0], p[4]); y = pair(p[1], p[5]); z = pair(p[2], p[6]); w = pair(p[3], p[7]);
+            transpose4(x, y, z, w);
+        }
+    };
+    typedef SimdOps8 SimdOps;
+#elif CN_SIMD_X86 || (CN_SIMD == CN_SIMD_NEON && defined(__aarch64__))
+    typedef SimdOps4 SimdOps;
+#else
+    typedef SimdOps1 SimdOps;
+#endif
+
+    // one byte per lane, 1 where m is set, returns the number of set lanes
+    template<class S>
+    inline size_t SimdStoreMask(typename S::M m, uint8_t* out)
+    {
+        int bits = S::maskBits(m);
+        size_t n = 0;
+        for (int k = 0; k < S::WIDTH; ++k)
+        {
+            out[k] = (uint8_t)((bits >> k) & 1);
+            n += out[k];
+        }
+        return n;
+    }
+
+    // Bulk kernels over packed Vec3 (stride 3) and Vec4 (stride 4) arrays.
+    // out may alias in. Each SIMD iteration handles SimdOps::WIDTH elements.
+
+    // full 4x4 transform with the divide by w, equal to Mat4 * Vec3 per point
+    CN_EXPORT void Mat4TransformPoints(const Real* m, const Real* in, Real* out, size_t count);
+    // ignores the bottom row of m, for affine matrices
+    CN_EXPORT void Mat4TransformAffinePoints(const Real* m, const Real* in, Real* out, size_t count);
+    // upper 3x3 only
+    CN_EXPORT void Mat4TransformDirections(const Real* m, const Real* in, Real* out, size_t count);
+    CN_EXPORT void Mat4TransformVec4s(const Real* m, const Real* in, Real* out, size_t count);
+    // in place, zero length vectors are left untouched
+    CN_EXPORT void Vec3NormalizeBatch(Real* v, size_t count);
+    // splits count affine matrices spaced stride Reals apart (16 for Mat4, 12 for
+    // Affine3) into positions (Vec3), scales (Vec3) and orientations (Quat as
+    // w, x, y, z). Null outputs are skipped. See Mat4::decomposition.
+    CN_EXPORT void AffineDecomposeBatch(const Real* m, size_t stride, Real* positions, Real* scales, Real* orientations, size_t count, bool handleShear);
+    // inverse transpose of the upper 3x3 of count matrices spaced stride Reals
+    // apart, written as row major 3x3s. See Mat4::normalMatrices.
+    CN_EXPORT void NormalMatrixBatch(const Real* m, size_t stride, Real* out, size_t count, bool uniformScale);
+}
+
+#endif
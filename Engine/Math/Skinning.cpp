@@ -0,0 +1,342 @@
+#include "Skinning.h"
+#include "Affine3.h"
+#include "DualQuaternion.h"
+#include "Parallel.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    // smallest vertex range handed to a worker thread
+    static const size_t SKINNING_GRAIN = 1024;
+
+    enum { AFFINE3_REALS = 12, DUAL_QUAT_REALS = 8 };
+    static_assert(sizeof(Affine3) == AFFINE3_REALS * sizeof(Real), "linear blend palettes are read as packed rows");
+
+    // raw pointers of the streams of one skinning call, normals are null when not skinned
+    struct SkinTarget
+    {
+        SkinTarget(const Vec3Stream &positions, Vec3Stream &outPositions, const Vec3Stream *normals, Vec3Stream *outNormals)
+            : px(positions.x()), py(positions.y()), pz(positions.z())
+            , opx(outPositions.x()), opy(outPositions.y()), opz(outPositions.z())
+            , nx(nullptr), ny(nullptr), nz(nullptr), onx(nullptr), ony(nullptr), onz(nullptr)
+        {
+            if (normals && outNormals){
+                nx = normals->x(); ny = normals->y(); nz = normals->z();
+                onx = outNormals->x(); ony = outNormals->y(); onz = outNormals->z();
+            }
+        }
+
+        const Real *px, *py, *pz;
+        Real *opx, *opy, *opz;
+        const Real *nx, *ny, *nz;
+        Real *onx, *ony, *onz;
+    };
+
+    SkinWeightStream::SkinWeightStream(size_t influences, size_t count)
+        : m_influences(influences <= 4 ? 4 : MAX_INFLUENCES)
+    {
+        cnAssert(influences <= MAX_INFLUENCES);
+        resize(count);
+    }
+
+    SkinWeightStream::~SkinWeightStream()
+    {
+
+    }
+
+    void SkinWeightStream::resize(size_t count)
+    {
+        for (size_t s = 0; s < m_influences; ++s)
+        {
+            m_bones[s].resize(count, 0);
+            m_weights[s].resize(count, 0.0f);
+        }
+    }
+
+    void SkinWeightStream::clear()
+    {
+        for (size_t s = 0; s < m_influences; ++s)
+        {
+            m_bones[s].clear();
+            m_weights[s].clear();
+        }
+    }
+
+    void SkinWeightStream::normalizeWeights()
+    {
+        for (size_t i = 0; i < size(); ++i)
+        {
+            Real sum = 0.0f;
+            for (size_t s = 0; s < m_influences; ++s)
+                sum += m_weights[s][i];
+            if (sum <= 0.0f)
+                continue;
+            Real inv = 1.0f / sum;
+            for (size_t s = 0; s < m_influences; ++s)
+                m_weights[s][i] *= inv;
+        }
+    }
+
+#if CN_SIMD_X86 || (CN_SIMD == CN_SIMD_NEON && defined(__aarch64__))
+    typedef SimdOps4 EntryOps;
+#else
+    typedef SimdOps1 EntryOps;
+#endif
+
+    // Palette entries are blended per vertex, EntryOps::WIDTH Reals at a time,
+    // into N Reals at out; the kernels then transpose the blended entries of
+    // S::WIDTH vertices into lanes. Blending across lanes instead would need
+    // a transpose per influence, which costs more shuffles than the blend.
+    // Every Real is summed in slot order on all backends. The weight of slot
+    // s is slotWeights[s * weightStride].
+    template<int N, int INFLUENCES>
+    static inline void BlendEntries(const Real *palette, const SkinWeightStream &weights, size_t i,
+        const Real *slotWeights, size_t weightStride, Real *out)
+    {
+        typedef EntryOps E;
+        typedef typename E::V V;
+        V acc[N / E::WIDTH];
+        const Real *entry = palette + weights.bones(0)[i] * N;
+        V w = E::set1(slotWeights[0]);
+        for (int c = 0; c < N / E::WIDTH; ++c)
+            acc[c] = E::mul(w, E::load(entry + c * E::WIDTH));
+        for (int s = 1; s < INFLUENCES; ++s)
+        {
+            entry = palette + weights.bones(s)[i] * N;
+            w = E::set1(slotWeights[s * weightStride]);
+            for (int c = 0; c < N / E::WIDTH; ++c)
+                acc[c] = E::add(acc[c], E::mul(w, E::load(entry + c * E::WIDTH)));
+        }
+        for (int c = 0; c < N / E::WIDTH; ++c)
+            E::store(out + c * E::WIDTH, acc[c]);
+    }
+
+    // Weights of S::WIDTH vertices for dual quaternion linear blending, slot
+    // major: an influence whose rotation lies in the other hemisphere from
+    // the rotation of the first influence is negated. Done across lanes, a
+    // per vertex comparison compiles to a branch that mispredicts half the time.
+    template<class S, int INFLUENCES>
+    static inline void DualQuatWeights(const Real *palette, const SkinWeightStream &weights, size_t i, Real *out)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        V pivot[4];
+        for (int s = 0; s < INFLUENCES; ++s)
+        {
+            const uint16_t *bones = weights.bones(s) + i;
+            const Real *entries[S::WIDTH];
+            for (int k = 0; k < S::WIDTH; ++k)
+                entries[k] = palette + bones[k] * DUAL_QUAT_REALS;
+            V w = S::load(weights.weights(s) + i);
+            if (s == 0)
+                S::gather4(entries, pivot[0], pivot[1], pivot[2], pivot[3]);
+            else
+            {
+                V r[4];
+                S::gather4(entries, r[0], r[1], r[2], r[3]);
+                V dot = S::add(S::add(S::add(S::mul(r[0], pivot[0]), S::mul(r[1], pivot[1])), S::mul(r[2], pivot[2])), S::mul(r[3], pivot[3]));
+                w = S::select(S::cmpgt(zero, dot), S::sub(zero, w), w);
+            }
+            S::store(out + s * S::WIDTH, w);
+        }
+    }
+
+    // four consecutive Reals at offset of the blended entries of S::WIDTH vertices, N Reals apart
+    template<class S, int N>
+    static inline void GatherBlended(const Real *blended, size_t offset, typename S::V *out)
+    {
+        const Real *p[S::WIDTH];
+        for (int k = 0; k < S::WIDTH; ++k)
+            p[k] = blended + k * N + offset;
+        S::gather4(p, out[0], out[1], out[2], out[3]);
+    }
+
+    template<class S>
+    static inline void NormalizeLanes(typename S::V &x, typename S::V &y, typename S::V &z)
+    {
+        typedef typename S::V V;
+        V len = S::sqrt(S::add(S::add(S::mul(x, x), S::mul(y, y)), S::mul(z, z)));
+        V invLen = S::select(S::cmpgt(len, S::set1(0.0f)), S::div(S::set1(1.0f), len), S::set1(1.0f));
+        x = S::mul(x, invLen);
+        y = S::mul(y, invLen);
+        z = S::mul(z, invLen);
+    }
+
+    template<class S, int INFLUENCES>
+    static size_t LinearBlendKernel(const Real *palette, const SkinWeightStream &weights, const SkinTarget &t, size_t begin, size_t end)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= end; i += S::WIDTH)
+        {
+            // blended matrix, rows of the Affine3
+            Real slotWeights[INFLUENCES * S::WIDTH];
+            for (int s = 0; s < INFLUENCES; ++s)
+                S::store(slotWeights + s * S::WIDTH, S::load(weights.weights(s) + i));
+            Real blended[S::WIDTH * AFFINE3_REALS];
+            for (int k = 0; k < S::WIDTH; ++k)
+                BlendEntries<AFFINE3_REALS, INFLUENCES>(palette, weights, i + k, slotWeights + k, S::WIDTH, blended + k * AFFINE3_REALS);
+            V m[12];
+            GatherBlended<S, AFFINE3_REALS>(blended, 0, m);
+            GatherBlended<S, AFFINE3_REALS>(blended, 4, m + 4);
+            GatherBlended<S, AFFINE3_REALS>(blended, 8, m + 8);
+
+            V x = S::load(t.px + i), y = S::load(t.py + i), z = S::load(t.pz + i);
+            S::store(t.opx + i, S::add(S::add(S::add(S::mul(m[0], x), S::mul(m[1], y)), S::mul(m[2], z)), m[3]));
+            S::store(t.opy + i, S::add(S::add(S::add(S::mul(m[4], x), S::mul(m[5], y)), S::mul(m[6], z)), m[7]));
+            S::store(t.opz + i, S::add(S::add(S::add(S::mul(m[8], x), S::mul(m[9], y)), S::mul(m[10], z)), m[11]));
+            if (t.nx)
+            {
+                x = S::load(t.nx + i); y = S::load(t.ny + i); z = S::load(t.nz + i);
+                V nx = S::add(S::add(S::mul(m[0], x), S::mul(m[1], y)), S::mul(m[2], z));
+                V ny = S::add(S::add(S::mul(m[4], x), S::mul(m[5], y)), S::mul(m[6], z));
+                V nz = S::add(S::add(S::mul(m[8], x), S::mul(m[9], y)), S::mul(m[10], z));
+                NormalizeLanes<S>(nx, ny, nz);
+                S::store(t.onx + i, nx);
+                S::store(t.ony + i, ny);
+                S::store(t.onz + i, nz);
+            }
+        }
+        return i;
+    }
+
+    // v + 2 r x (r x v + w v), Quat::operator* (const Vec3&) on lanes
+    template<class S>
+    static inline void RotateLanes(const typename S::V *q, typename S::V &x, typename S::V &y, typename S::V &z)
+    {
+        typedef typename S::V V;
+        V ux = S::add(S::sub(S::mul(q[2], z), S::mul(q[3], y)), S::mul(q[0], x));
+        V uy = S::add(S::sub(S::mul(q[3], x), S::mul(q[1], z)), S::mul(q[0], y));
+        V uz = S::add(S::sub(S::mul(q[1], y), S::mul(q[2], x)), S::mul(q[0], z));
+        const V two = S::set1(2.0f);
+        V rx = S::sub(S::mul(q[2], uz), S::mul(q[3], uy));
+        V ry = S::sub(S::mul(q[3], ux), S::mul(q[1], uz));
+        V rz = S::sub(S::mul(q[1], uy), S::mul(q[2], ux));
+        x = S::add(x, S::mul(two, rx));
+        y = S::add(y, S::mul(two, ry));
+        z = S::add(z, S::mul(two, rz));
+    }
+
+    template<class S, int INFLUENCES>
+    static size_t DualQuatKernel(const Real *palette, const SkinWeightStream &weights, const SkinTarget &t, size_t begin, size_t end)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        size_t i = begin;
+        for (; i + S::WIDTH <= end; i += S::WIDTH)
+        {
+            // b[0..3] real, b[4..7] dual
+            Real slotWeights[INFLUENCES * S::WIDTH];
+            DualQuatWeights<S, INFLUENCES>(palette, weights, i, slotWeights);
+            Real blended[S::WIDTH * DUAL_QUAT_REALS];
+            for (int k = 0; k < S::WIDTH; ++k)
+                BlendEntries<DUAL_QUAT_REALS, INFLUENCES>(palette, weights, i + k, slotWeights + k, S::WIDTH, blended + k * DUAL_QUAT_REALS);
+            V b[8];
+            GatherBlended<S, DUAL_QUAT_REALS>(blended, 0, b);
+            GatherBlended<S, DUAL_QUAT_REALS>(blended, 4, b + 4);
+
+            V len = S::sqrt(S::add(S::add(S::add(S::mul(b[0], b[0]), S::mul(b[1], b[1])), S::mul(b[2], b[2])), S::mul(b[3], b[3])));
+            V invLen = S::select(S::cmpgt(len, zero), S::div(S::set1(1.0f), len), zero);
+            for (int k = 0; k < 8; ++k)
+                b[k] = S::mul(b[k], invLen);
+
+            // translation, vector part of 2 * dual * conjugate(real)
+            const V two = S::set1(2.0f);
+            V tx = S::mul(two, S::add(S::sub(S::mul(b[0], b[5]), S::mul(b[4], b[1])), S::sub(S::mul(b[2], b[7]), S::mul(b[3], b[6]))));
+            V ty = S::mul(two, S::add(S::sub(S::mul(b[0], b[6]), S::mul(b[4], b[2])), S::sub(S::mul(b[3], b[5]), S::mul(b[1], b[7]))));
+            V tz = S::mul(two, S::add(S::sub(S::mul(b[0], b[7]), S::mul(b[4], b[3])), S::sub(S::mul(b[1], b[6]), S::mul(b[2], b[5]))));
+
+            V x = S::load(t.px + i), y = S::load(t.py + i), z = S::load(t.pz + i);
+            RotateLanes<S>(b, x, y, z);
+            S::store(t.opx + i, S::add(x, tx));
+            S::store(t.opy + i, S::add(y, ty));
+            S::store(t.opz + i, S::add(z, tz));
+            if (t.nx)
+            {
+                x = S::load(t.nx + i); y = S::load(t.ny + i); z = S::load(t.nz + i);
+                RotateLanes<S>(b, x, y, z);
+                S::store(t.onx + i, x);
+                S::store(t.ony + i, y);
+                S::store(t.onz + i, z);
+            }
+        }
+        return i;
+    }
+
+    template<int INFLUENCES>
+    static void LinearBlendRange(const Real *palette, const SkinWeightStream &weights, const SkinTarget &t, size_t begin, size_t end)
+    {
+        size_t i = LinearBlendKernel<SimdOps, INFLUENCES>(palette, weights, t, begin, end);
+        LinearBlendKernel<SimdOps1, INFLUENCES>(palette, weights, t, i, end);
+    }
+
+    template<int INFLUENCES>
+    static void DualQuatRange(const Real *palette, const SkinWeightStream &weights, const SkinTarget &t, size_t begin, size_t end)
+    {
+        size_t i = DualQuatKernel<SimdOps, INFLUENCES>(palette, weights, t, begin, end);
+        DualQuatKernel<SimdOps1, INFLUENCES>(palette, weights, t, i, end);
+    }
+
+    void Skinning::linearBlend(const Affine3 *palette, const SkinWeightStream &weights,
+        const Vec3Stream &positions, Vec3Stream &outPositions,
+        const Vec3Stream *normals, Vec3Stream *outNormals)
+    {
+        cnAssert(positions.size() == weights.size());
+        outPositions.resize(positions.size());
+        if (normals && outNormals)
+        {
+            cnAssert(normals->size() == positions.size());
+            outNormals->resize(positions.size());
+        }
+        ParallelFor(positions.size(), SKINNING_GRAIN, [&](size_t begin, size_t end){
+            linearBlend(palette, weights, positions, outPositions, normals, outNormals, begin, end);
+        });
+    }
+
+    void Skinning::linearBlend(const Affine3 *palette, const SkinWeightStream &weights,
+        const Vec3Stream &positions, Vec3Stream &outPositions,
+        const Vec3Stream *normals, Vec3Stream *outNormals, size_t begin, size_t end)
+    {
+        cnAssert(end <= positions.size() && end <= outPositions.size());
+        cnAssert(!normals || !outNormals || (end <= normals->size() && end <= outNormals->size()));
+        if (begin == end)
+            return;
+        SkinTarget target(positions, outPositions, normals, outNormals);
+        if (weights.influences() == 4)
+            LinearBlendRange<4>(palette[0][0], weights, target, begin, end);
+        else
+            LinearBlendRange<SkinWeightStream::MAX_INFLUENCES>(palette[0][0], weights, target, begin, end);
+    }
+
+    void Skinning::dualQuaternion(const DualQuat *palette, const SkinWeightStream &weights,
+        const Vec3Stream &positions, Vec3Stream &outPositions,
+        const Vec3Stream *normals, Vec3Stream *outNormals)
+    {
+        cnAssert(positions.size() == weights.size());
+        outPositions.resize(positions.size());
+        if (normals && outNormals)
+        {
+            cnAssert(normals->size() == positions.size());
+            outNormals->resize(positions.size());
+        }
+        ParallelFor(positions.size(), SKINNING_GRAIN, [&](size_t begin, size_t end){
+            dualQuaternion(palette, weights, positions, outPositions, normals, outNormals, begin, end);
+        });
+    }
+
+    void Skinning::dualQuaternion(const DualQuat *palette, const SkinWeightStream &weights,
+        const Vec3Stream &positions, Vec3Stream &outPositions,
+        const Vec3Stream *normals, Vec3Stream *outNormals, size_t begin, size_t end)
+    {
+        cnAssert(end <= positions.size() && end <= outPositions.size());
+        cnAssert(!normals || !outNormals || (end <= normals->size() && end <= outNormals->size()));
+        if (begin == end)
+            return;
+        SkinTarget target(positions, outPositions, normals, outNormals);
+        const Real *entries = &palette[0].real.w;
+        if (weights.influences() == 4)
+            DualQuatRange<4>(entries, weights, target, begin, end);
+        else
+            DualQuatRange<SkinWeightStream::MAX_INFLUENCES>(entries, weights, target, begin, end);
+    }
+}
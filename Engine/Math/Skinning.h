@@ -0,0 +1,93 @@
+#ifndef _CN_SKINNING_
+#define _CN_SKINNING_
+#include "Prerequisites.h"
+#include "Vector3Stream.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    class Affine3;
+    class DualQuat;
+
+    /*
+        Per-vertex bone influences in structure-of-arrays form: slot s of
+        every vertex lives in bones(s) and weights(s), so the skinning
+        kernels read one slot of several vertices with plain vector loads.
+        A stream holds 4 or 8 slots per vertex; vertices with fewer
+        influences leave the remaining weights at 0.
+    */
+    class CN_EXPORT SkinWeightStream
+    {
+    public:
+
+        enum { MAX_INFLUENCES = 8 };
+
+        explicit SkinWeightStream(size_t influences = 4, size_t count = 0);
+        ~SkinWeightStream();
+
+        size_t size() const { return m_weights[0].size(); }
+        bool empty() const { return m_weights[0].empty(); }
+        size_t influences() const { return m_influences; }
+        // new slots start as bone 0 with weight 0
+        void resize(size_t count);
+        void clear();
+
+        void set(size_t vertex, size_t slot, uint16_t bone, Real weight) { m_bones[slot][vertex] = bone; m_weights[slot][vertex] = weight; }
+        uint16_t getBone(size_t vertex, size_t slot) const { return m_bones[slot][vertex]; }
+        Real getWeight(size_t vertex, size_t slot) const { return m_weights[slot][vertex]; }
+
+        uint16_t* bones(size_t slot) { return m_bones[slot].data(); }
+        Real* weights(size_t slot) { return m_weights[slot].data(); }
+        const uint16_t* bones(size_t slot) const { return m_bones[slot].data(); }
+        const Real* weights(size_t slot) const { return m_weights[slot].data(); }
+
+        // rescales the weights of every vertex to sum to 1, vertices without weight are left untouched
+        void normalizeWeights();
+
+    private:
+
+        size_t m_influences;
+        std::vector<uint16_t> m_bones[MAX_INFLUENCES];
+        std::vector<Real> m_weights[MAX_INFLUENCES];
+    };
+
+    /*
+        CPU skinning of structure-of-arrays vertex streams, vectorized across
+        vertices. The palette holds one transform per bone, bone world
+        transform * inverse bind pose, indexed by the bones of the weight
+        stream.
+
+        linearBlend sums the weighted bone matrices, dualQuaternion the
+        weighted dual quaternions, flipped to the hemisphere of the first
+        influence, and normalizes the sum; it keeps volume at twisting joints
+        but ignores bone scale. Normals go through the same blended rotation,
+        linearBlend renormalizes them; the normal stream has one normal per
+        position.
+
+        The whole-stream forms resize the outputs and split the vertices
+        over the worker threads (Parallel.h); the range forms skin vertices
+        [begin, end) on the calling thread for callers with their own job
+        system, the outputs must already be sized. Outputs may be the input
+        streams. Every vertex is skinned identically whatever the split.
+    */
+    class CN_EXPORT Skinning
+    {
+    public:
+
+        static void linearBlend(const Affine3 *palette, const SkinWeightStream &weights,
+            const Vec3Stream &positions, Vec3Stream &outPositions,
+            const Vec3Stream *normals = nullptr, Vec3Stream *outNormals = nullptr);
+        static void linearBlend(const Affine3 *palette, const SkinWeightStream &weights,
+            const Vec3Stream &positions, Vec3Stream &outPositions,
+            const Vec3Stream *normals, Vec3Stream *outNormals, size_t begin, size_t end);
+
+        static void dualQuaternion(const DualQuat *palette, const SkinWeightStream &weights,
+            const Vec3Stream &positions, Vec3Stream &outPositions,
+            const Vec3Stream *normals = nullptr, Vec3Stream *outNormals = nullptr);
+        static void dualQuaternion(const DualQuat *palette, const SkinWeightStream &weights,
+            const Vec3Stream &positions, Vec3Stream &outPositions,
+            const Vec3Stream *normals, Vec3Stream *outNormals, size_t begin, size_t end);
+    };
+}
+
+#endif
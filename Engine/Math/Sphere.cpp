@@ -0,0 +1,37 @@
+#include "Sphere.h"
+#include <type_traits>
+
+namespace Canaan
+{
+    static_assert(std::is_trivially_copyable<Sphere>::value, "Sphere is copied freely by the bounds streams");
+
+    void Sphere::merge(const Sphere &sphere)
+    {
+        Vec3 diff = sphere.center - center;
+        Real dist = diff.length();
+        // one contains the other
+        if (dist + sphere.radius <= radius)
+            return;
+        if (dist + radius <= sphere.radius){
+            *this = sphere;
+            return;
+        }
+
+        Real newRadius = (dist + radius + sphere.radius) * 0.5f;
+        center += diff * ((newRadius - radius) / dist);
+        radius = newRadius;
+    }
+
+    bool Sphere::intersects(const AABB &box) const
+    {
+        // squared distance from the center to the closest point of the box
+        Real sqDist = 0.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            Real c = center[i];
+            if (c < box.min[i]) sqDist += (box.min[i] - c) * (box.min[i] - c);
+            else if (c > box.max[i]) sqDist += (c - box.max[i]) * (c - box.max[i]);
+        }
+        return sqDist <= radius * radius;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef _CN_SPHERE_
+#define _CN_SPHERE_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include "AABB.h"
+
+namespace Canaan
+{
+    class CN_EXPORT Sphere
+    {
+    public:
+
+        constexpr Sphere() : center(), radius(0.0f) {}
+        constexpr Sphere(const Vec3 &center, Real radius) : center(center), radius(radius) {}
+
+        void set(const Vec3 &vCenter, Real fRadius) { center = vCenter; radius = fRadius; }
+        AABB getAABB() const { return AABB(center - radius, center + radius); }
+
+        // smallest sphere enclosing both
+        void merge(const Sphere &sphere);
+
+        bool contains(const Vec3 &point) const { return center.squaredDistance(point) <= radius * radius; }
+        bool intersects(const Sphere &sphere) const{
+            Real r = radius + sphere.radius;
+            return center.squaredDistance(sphere.center) <= r * r;
+        }
+        bool intersects(const AABB &box) const;
+
+        bool operator == (const Sphere &rhs) const { return center == rhs.center && radius == rhs.radius; }
+        bool operator != (const Sphere &rhs) const { return !(*this == rhs); }
+
+        Vec3 center;
+        Real radius;
+    };
+
+    typedef std::vector<Sphere> SphereArray;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "SphereStream.h"
+
+namespace Canaan
+{
+    SphereStream::SphereStream()
+    {
+
+    }
+
+    SphereStream::SphereStream(size_t count)
+    {
+        resize(count);
+    }
+
+    SphereStream::SphereStream(const SphereArray &array)
+    {
+        fromArray(array);
+    }
+
+    SphereStream::~SphereStream()
+    {
+
+    }
+
+    void SphereStream::resize(size_t count)
+    {
+        m_x.resize(count);
+        m_y.resize(count);
+        m_z.resize(count);
+        m_radius.resize(count);
+    }
+
+    void SphereStream::clear()
+    {
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+        m_radius.clear();
+    }
+
+    void SphereStream::fromArray(const SphereArray &array)
+    {
+        resize(array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+            set(i, array[i]);
+    }
+
+    void SphereStream::toArray(SphereArray &array) const
+    {
+        array.resize(size());
+        for (size_t i = 0; i < array.size(); ++i)
+            array[i] = get(i);
+    }
+}
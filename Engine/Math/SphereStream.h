@@ -0,0 +1,52 @@
+#ifndef _CN_SPHERE_STREAM_
+#define _CN_SPHERE_STREAM_
+#include "Prerequisites.h"
+#include "Sphere.h"
+
+namespace Canaan
+{
+    /*
+        Structure-of-arrays storage for Sphere, the counterpart of AABBStream.
+    */
+    class CN_EXPORT SphereStream
+    {
+    public:
+
+        SphereStream();
+        explicit SphereStream(size_t count);
+        explicit SphereStream(const SphereArray &array);
+        ~SphereStream();
+
+        size_t size() const { return m_x.size(); }
+        bool empty() const { return m_x.empty(); }
+        void resize(size_t count);
+        void clear();
+
+        void fromArray(const SphereArray &array);
+        void toArray(SphereArray &array) const;
+
+        Sphere get(size_t i) const { return Sphere(Vec3(m_x[i], m_y[i], m_z[i]), m_radius[i]); }
+        void set(size_t i, const Sphere &sphere){
+            m_x[i] = sphere.center.x; m_y[i] = sphere.center.y; m_z[i] = sphere.center.z;
+            m_radius[i] = sphere.radius;
+        }
+
+        Real* x() { return m_x.data(); }
+        Real* y() { return m_y.data(); }
+        Real* z() { return m_z.data(); }
+        Real* radius() { return m_radius.data(); }
+        const Real* x() const { return m_x.data(); }
+        const Real* y() const { return m_y.data(); }
+        const Real* z() const { return m_z.data(); }
+        const Real* radius() const { return m_radius.data(); }
+
+    private:
+
+        std::vector<Real> m_x;
+        std::vector<Real> m_y;
+        std::vector<Real> m_z;
+        std::vector<Real> m_radius;
+    };
+}
+
+#endif
@@ -0,0 +1,592 @@
+#include "Spline.h"
+#include "QuaternionStream.h"
+#include "SIMD.h"
+#include <algorithm>
+
+namespace Canaan
+{
+    // parameters evaluated per block of the batched paths
+    static const size_t SPLINE_BLOCK_SIZE = 256;
+    enum { SEGMENT_COEFFICIENTS = 12 };
+
+    // 3 point Gauss-Legendre on [0, 1], integrates the speed of a sample interval
+    static const Real GAUSS_NODES[3] = { 0.112701665f, 0.5f, 0.887298335f };
+    static const Real GAUSS_WEIGHTS[3] = { 0.277777778f, 0.444444444f, 0.277777778f };
+    static const int ARC_LENGTH_NEWTON_STEPS = 2;
+
+    // segment index and local parameter u of the curve parameter t
+    static inline size_t LocateSegment(Real t, size_t segmentCount, Real &u)
+    {
+        Real f = Minimum(Maximum(t, Real(0.0f)), Real(1.0f)) * Real(segmentCount);
+        size_t segment = Minimum(size_t(f), segmentCount - 1);
+        u = f - Real(segment);
+        return segment;
+    }
+
+    ArcLengthTable::ArcLengthTable()
+        : m_offsets(1, 0.0f)
+    {
+
+    }
+
+    ArcLengthTable::~ArcLengthTable()
+    {
+
+    }
+
+    void ArcLengthTable::reset(size_t segments, size_t samplesPerSegment)
+    {
+        cnAssert(samplesPerSegment > 0);
+        m_samplesPerSegment = samplesPerSegment;
+        m_samples.assign(segments * (samplesPerSegment + 1), 0.0f);
+        m_speeds.assign(segments * (samplesPerSegment + 1), 0.0f);
+        m_offsets.assign(segments + 1, 0.0f);
+        m_dirty.assign(segments, 1);
+        m_firstDirty = 0;
+    }
+
+    void ArcLengthTable::invalidate(size_t segment)
+    {
+        cnAssert(segment < getSegmentCount());
+        m_dirty[segment] = 1;
+        m_firstDirty = Minimum(m_firstDirty, segment);
+    }
+
+    void ArcLengthTable::invalidateAll()
+    {
+        std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(1));
+        m_firstDirty = 0;
+    }
+
+    void ArcLengthTable::update()
+    {
+        size_t segments = getSegmentCount();
+        for (size_t s = m_firstDirty; s < segments; ++s)
+        {
+            m_offsets[s + 1] = m_offsets[s] + getSegmentSamples(s)[m_samplesPerSegment];
+            m_dirty[s] = 0;
+        }
+        m_firstDirty = segments;
+    }
+
+    Real ArcLengthTable::getParameter(Real distance) const
+    {
+        cnAssert(!isDirty());
+        size_t segments = getSegmentCount();
+        if (segments == 0)
+            return 0.0f;
+        distance = Minimum(Maximum(distance, Real(0.0f)), getLength());
+
+        // last segment starting at or before distance, then the sample interval within it
+        size_t segment = std::upper_bound(m_offsets.begin() + 1, m_offsets.end() - 1, distance) - (m_offsets.begin() + 1);
+        const Real *samples = getSegmentSamples(segment);
+        const Real *speeds = getSegmentSpeeds(segment);
+        Real local = distance - m_offsets[segment];
+        size_t k = std::upper_bound(samples + 1, samples + m_samplesPerSegment, local) - (samples + 1);
+        Real span = samples[k + 1] - samples[k];
+        Real f = 0.0f;
+        if (span > 0.0f)
+        {
+            // solve the cubic Hermite of the interval for f, from the linear guess
+            Real h = 1.0f / Real(m_samplesPerSegment);
+            Real s0 = samples[k], m0 = speeds[k] * h, m1 = speeds[k + 1] * h;
+            f = Minimum((local - s0) / span, Real(1.0f));
+            for (int n = 0; n < ARC_LENGTH_NEWTON_STEPS; ++n)
+            {
+                Real f2 = f * f, f3 = f2 * f;
+                Real value = s0 + (f3 - 2.0f * f2 + f) * m0 + (3.0f * f2 - 2.0f * f3) * span + (f3 - f2) * m1;
+                Real slope = (3.0f * f2 - 4.0f * f + 1.0f) * m0 + (6.0f * f - 6.0f * f2) * span + (3.0f * f2 - 2.0f * f) * m1;
+                if (slope <= 0.0f)
+                    break;
+                f = Minimum(Maximum(f - (value - local) / slope, Real(0.0f)), Real(1.0f));
+            }
+        }
+        Real u = (Real(k) + f) / Real(m_samplesPerSegment);
+        return (Real(segment) + u) / Real(segments);
+    }
+
+    void ArcLengthTable::getParameters(const Real *distances, Real *out, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = getParameter(distances[i]);
+    }
+
+    // Horner evaluation of the power basis coefficients of the segment each lane
+    // points to, or of their derivative. The single element forms run the SimdOps1
+    // instance, so both agree bit for bit.
+    template<class S, bool DERIVATIVE>
+    static size_t SplineKernel(const Real* const *segments, const Real *u, Real *out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        const V two = S::set1(2.0f);
+        const V three = S::set1(3.0f);
+
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V t = S::load(u + i);
+            V axes[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const Real *p[S::WIDTH];
+                for (int l = 0; l < S::WIDTH; ++l)
+                    p[l] = segments[i + l] + k * 4;
+                V a, b, c, d;
+                S::gather4(p, a, b, c, d);
+                if (DERIVATIVE)
+                    axes[k] = S::add(S::mul(S::add(S::mul(S::mul(three, d), t), S::mul(two, c)), t), b);
+                else
+                    axes[k] = S::add(S::mul(S::add(S::mul(S::add(S::mul(d, t), c), t), b), t), a);
+            }
+            S::store3(out + i * 3, axes[0], axes[1], axes[2]);
+        }
+        return i;
+    }
+
+    template<bool DERIVATIVE>
+    static void EvaluateSpline(const Real *coefficients, size_t segmentCount, const Real *t, Vec3 *out, size_t count)
+    {
+        const Real *segments[SPLINE_BLOCK_SIZE];
+        Real u[SPLINE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += SPLINE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(SPLINE_BLOCK_SIZE, count - begin);
+            for (size_t i = 0; i < n; ++i)
+                segments[i] = coefficients + LocateSegment(t[begin + i], segmentCount, u[i]) * SEGMENT_COEFFICIENTS;
+            Real *o = reinterpret_cast<Real*>(out + begin);
+            size_t i = SplineKernel<SimdOps, DERIVATIVE>(segments, u, o, 0, n);
+            SplineKernel<SimdOps1, DERIVATIVE>(segments, u, o, i, n);
+        }
+    }
+
+    static size_t SegmentCount(SplineType type, size_t points)
+    {
+        if (type == SPLINE_BEZIER)
+        {
+            cnAssert(points >= 4 && (points - 1) % 3 == 0);
+            return points >= 4 ? (points - 1) / 3 : 0;
+        }
+        cnAssert(points >= 2);
+        return points >= 2 ? points - 1 : 0;
+    }
+
+    // segments whose shape depends on control point i
+    static void InfluencedSegments(SplineType type, size_t i, size_t segmentCount, size_t &first, size_t &last)
+    {
+        switch (type)
+        {
+        case SPLINE_BEZIER:
+            first = i / 3 - (i % 3 == 0 && i > 0 ? 1 : 0);
+            last = Minimum(i / 3, segmentCount - 1);
+            break;
+        case SPLINE_CATMULL_ROM:
+            first = i >= 2 ? i - 2 : 0;
+            last = Minimum(i + 1, segmentCount - 1);
+            break;
+        default:
+            first = i >= 1 ? i - 1 : 0;
+            last = Minimum(i, segmentCount - 1);
+            break;
+        }
+    }
+
+    Spline::Spline(SplineType type, size_t samplesPerSegment)
+        : m_type(type)
+    {
+        m_arcLength.reset(0, samplesPerSegment);
+    }
+
+    Spline::~Spline()
+    {
+
+    }
+
+    void Spline::setPoints(const Vec3 *points, size_t count)
+    {
+        if (count != m_points.size())
+            m_tangents.assign(m_type == SPLINE_HERMITE ? count : 0, Vec3::ZERO);
+        m_points.assign(points, points + count);
+        m_segmentCount = SegmentCount(m_type, count);
+        m_coefficients.resize(m_segmentCount * SEGMENT_COEFFICIENTS);
+        for (size_t s = 0; s < m_segmentCount; ++s)
+            updateSegment(s);
+        m_arcLength.reset(m_segmentCount, m_arcLength.getSamplesPerSegment());
+    }
+
+    void Spline::setPoint(size_t i, const Vec3 &point)
+    {
+        cnAssert(i < m_points.size());
+        m_points[i] = point;
+        updateSegments(i);
+    }
+
+    void Spline::setTangents(const Vec3 *tangents, size_t count)
+    {
+        cnAssert(m_type == SPLINE_HERMITE && count == m_points.size());
+        m_tangents.assign(tangents, tangents + count);
+        for (size_t s = 0; s < m_segmentCount; ++s)
+            updateSegment(s);
+        m_arcLength.invalidateAll();
+    }
+
+    void Spline::setTangent(size_t i, const Vec3 &tangent)
+    {
+        cnAssert(m_type == SPLINE_HERMITE && i < m_tangents.size());
+        m_tangents[i] = tangent;
+        updateSegments(i);
+    }
+
+    void Spline::updateSegments(size_t point)
+    {
+        if (m_segmentCount == 0)
+            return;
+        size_t first, last;
+        InfluencedSegments(m_type, point, m_segmentCount, first, last);
+        for (size_t s = first; s <= last; ++s)
+        {
+            updateSegment(s);
+            m_arcLength.invalidate(s);
+        }
+    }
+
+    void Spline::updateSegment(size_t segment)
+    {
+        // the four basis coefficients of the segment as combinations of its controls
+        Vec3 a, b, c, d;
+        if (m_type == SPLINE_BEZIER)
+        {
+            const Vec3 *p = &m_points[segment * 3];
+            a = p[0];
+            b = (p[1] - p[0]) * 3.0f;
+            c = (p[0] - p[1] * 2.0f + p[2]) * 3.0f;
+            d = p[3] - p[0] + (p[1] - p[2]) * 3.0f;
+        }
+        else if (m_type == SPLINE_CATMULL_ROM)
+        {
+            size_t last = m_points.size() - 1;
+            const Vec3 &p1 = m_points[segment];
+            const Vec3 &p2 = m_points[segment + 1];
+            Vec3 p0 = segment > 0 ? m_points[segment - 1] : p1 * 2.0f - p2;
+            Vec3 p3 = segment + 1 < last ? m_points[segment + 2] : p2 * 2.0f - p1;
+            a = p1;
+            b = (p2 - p0) * 0.5f;
+            c = p0 - p1 * 2.5f + p2 * 2.0f - p3 * 0.5f;
+            d = (p3 - p0) * 0.5f + (p1 - p2) * 1.5f;
+        }
+        else
+        {
+            const Vec3 &p0 = m_points[segment];
+            const Vec3 &p1 = m_points[segment + 1];
+            const Vec3 &m0 = m_tangents[segment];
+            const Vec3 &m1 = m_tangents[segment + 1];
+            a = p0;
+            b = m0;
+            c = (p1 - p0) * 3.0f - m0 * 2.0f - m1;
+            d = (p0 - p1) * 2.0f + m0 + m1;
+        }
+        Real *coefficients = &m_coefficients[segment * SEGMENT_COEFFICIENTS];
+        for (int k = 0; k < 3; ++k)
+        {
+            coefficients[k * 4] = a[k];
+            coefficients[k * 4 + 1] = b[k];
+            coefficients[k * 4 + 2] = c[k];
+            coefficients[k * 4 + 3] = d[k];
+        }
+    }
+
+    Vec3 Spline::evaluate(Real t) const
+    {
+        Vec3 v;
+        evaluate(&t, &v, 1);
+        return v;
+    }
+
+    Vec3 Spline::evaluateDerivative(Real t) const
+    {
+        Vec3 v;
+        evaluateDerivative(&t, &v, 1);
+        return v;
+    }
+
+    void Spline::evaluate(const Real *t, Vec3 *out, size_t count) const
+    {
+        cnAssert(m_segmentCount > 0);
+        EvaluateSpline<false>(m_coefficients.data(), m_segmentCount, t, out, count);
+    }
+
+    void Spline::evaluateDerivative(const Real *t, Vec3 *out, size_t count) const
+    {
+        cnAssert(m_segmentCount > 0);
+        EvaluateSpline<true>(m_coefficients.data(), m_segmentCount, t, out, count);
+    }
+
+    void Spline::updateArcLength()
+    {
+        if (!m_arcLength.isDirty())
+            return;
+        size_t samples = m_arcLength.getSamplesPerSegment();
+        Real step = 1.0f / Real(samples);
+        for (size_t s = 0; s < m_segmentCount; ++s)
+        {
+            if (!m_arcLength.isDirty(s))
+                continue;
+            // speed |p'(u)| integrated over each sample interval
+            const Real *c = &m_coefficients[s * SEGMENT_COEFFICIENTS];
+            Real *lengths = m_arcLength.getSegmentSamples(s);
+            Real *speeds = m_arcLength.getSegmentSpeeds(s);
+            auto speed = [c](Real u) {
+                Vec3 v;
+                for (int a = 0; a < 3; ++a)
+                    v[a] = (3.0f * c[a * 4 + 3] * u + 2.0f * c[a * 4 + 2]) * u + c[a * 4 + 1];
+                return v.length();
+            };
+            lengths[0] = 0.0f;
+            for (size_t k = 0; k < samples; ++k)
+            {
+                Real length = 0.0f;
+                for (int g = 0; g < 3; ++g)
+                    length += GAUSS_WEIGHTS[g] * speed((Real(k) + GAUSS_NODES[g]) * step);
+                lengths[k + 1] = lengths[k] + length * step;
+            }
+            for (size_t k = 0; k <= samples; ++k)
+                speeds[k] = speed(Real(k) * step);
+        }
+        m_arcLength.update();
+    }
+
+    Real Spline::getLength()
+    {
+        updateArcLength();
+        return m_arcLength.getLength();
+    }
+
+    Real Spline::getParameterAtDistance(Real distance)
+    {
+        updateArcLength();
+        return m_arcLength.getParameter(distance);
+    }
+
+    Vec3 Spline::evaluateAtDistance(Real distance)
+    {
+        return evaluate(getParameterAtDistance(distance));
+    }
+
+    void Spline::evaluateAtDistance(const Real *distances, Vec3 *out, size_t count)
+    {
+        updateArcLength();
+        Real t[SPLINE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += SPLINE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(SPLINE_BLOCK_SIZE, count - begin);
+            m_arcLength.getParameters(distances + begin, t, n);
+            evaluate(t, out + begin, n);
+        }
+    }
+
+    QuatSpline::QuatSpline(SplineType type, size_t samplesPerSegment)
+        : m_type(type)
+    {
+        m_arcLength.reset(0, samplesPerSegment);
+    }
+
+    QuatSpline::~QuatSpline()
+    {
+
+    }
+
+    void QuatSpline::setKeys(const Quat *keys, size_t count)
+    {
+        if (count != m_keys.size())
+            m_velocities.assign(m_type == SPLINE_HERMITE ? count : 0, Vec3::ZERO);
+        m_keys.assign(keys, keys + count);
+        m_segmentCount = SegmentCount(m_type, count);
+        m_controls.resize(m_segmentCount * 4);
+        for (size_t s = 0; s < m_segmentCount; ++s)
+            updateSegment(s);
+        m_arcLength.reset(m_segmentCount, m_arcLength.getSamplesPerSegment());
+    }
+
+    void QuatSpline::setKey(size_t i, const Quat &key)
+    {
+        cnAssert(i < m_keys.size());
+        m_keys[i] = key;
+        updateSegments(i);
+    }
+
+    void QuatSpline::setAngularVelocities(const Vec3 *velocities, size_t count)
+    {
+        cnAssert(m_type == SPLINE_HERMITE && count == m_keys.size());
+        m_velocities.assign(velocities, velocities + count);
+        for (size_t s = 0; s < m_segmentCount; ++s)
+            updateSegment(s);
+        m_arcLength.invalidateAll();
+    }
+
+    void QuatSpline::setAngularVelocity(size_t i, const Vec3 &velocity)
+    {
+        cnAssert(m_type == SPLINE_HERMITE && i < m_velocities.size());
+        m_velocities[i] = velocity;
+        updateSegments(i);
+    }
+
+    void QuatSpline::updateSegments(size_t key)
+    {
+        if (m_segmentCount == 0)
+            return;
+        size_t first, last;
+        InfluencedSegments(m_type, key, m_segmentCount, first, last);
+        for (size_t s = first; s <= last; ++s)
+        {
+            updateSegment(s);
+            m_arcLength.invalidate(s);
+        }
+    }
+
+    void QuatSpline::updateSegment(size_t segment)
+    {
+        Quat *controls = &m_controls[segment * 4];
+        if (m_type == SPLINE_BEZIER)
+        {
+            for (int k = 0; k < 4; ++k)
+                controls[k] = m_keys[segment * 3 + k];
+        }
+        else if (m_type == SPLINE_CATMULL_ROM)
+        {
+            size_t last = m_keys.size() - 1;
+            const Quat &q1 = m_keys[segment];
+            const Quat &q2 = m_keys[segment + 1];
+            const Quat &q0 = segment > 0 ? m_keys[segment - 1] : q1;
+            const Quat &q3 = segment + 1 < last ? m_keys[segment + 2] : q2;
+            controls[0] = q1;
+            controls[1] = Quat::squadTangent(q0, q1, q2);
+            controls[2] = Quat::squadTangent(q1, q2, q3);
+            controls[3] = q2;
+        }
+        else
+        {
+            // Bezier handles matching the angular velocities: a cubic Bezier on the
+            // sphere leaves q0 with angular velocity w when b1 = exp(w / 6) * q0
+            const Quat &q0 = m_keys[segment];
+            const Quat &q1 = m_keys[segment + 1];
+            const Vec3 w0 = m_velocities[segment] * (1.0f / 6.0f);
+            const Vec3 w1 = m_velocities[segment + 1] * (-1.0f / 6.0f);
+            controls[0] = q0;
+            controls[1] = Quat(0.0f, w0.x, w0.y, w0.z).exp() * q0;
+            controls[2] = Quat(0.0f, w1.x, w1.y, w1.z).exp() * q1;
+            controls[3] = q1;
+        }
+    }
+
+    Quat QuatSpline::evaluate(Real t) const
+    {
+        cnAssert(m_segmentCount > 0);
+        Real u;
+        const Quat *c = &m_controls[LocateSegment(t, m_segmentCount, u) * 4];
+        if (m_type == SPLINE_CATMULL_ROM)
+            return Quat::squadFast(u, c[0], c[1], c[2], c[3], true);
+        // de Casteljau with slerp
+        Quat p01 = Quat::slerpFast(u, c[0], c[1], true);
+        Quat p12 = Quat::slerpFast(u, c[1], c[2], true);
+        Quat p23 = Quat::slerpFast(u, c[2], c[3], true);
+        p01 = Quat::slerpFast(u, p01, p12, true);
+        p12 = Quat::slerpFast(u, p12, p23, true);
+        return Quat::slerpFast(u, p01, p12, true);
+    }
+
+    void QuatSpline::evaluate(const Real *t, Quat *out, size_t count) const
+    {
+        cnAssert(m_segmentCount > 0);
+        QuatStream c0, c1, c2, c3;
+        Real u[SPLINE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += SPLINE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(SPLINE_BLOCK_SIZE, count - begin);
+            c0.resize(n); c1.resize(n); c2.resize(n); c3.resize(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Quat *c = &m_controls[LocateSegment(t[begin + i], m_segmentCount, u[i]) * 4];
+                c0.set(i, c[0]); c1.set(i, c[1]); c2.set(i, c[2]); c3.set(i, c[3]);
+            }
+            if (m_type == SPLINE_CATMULL_ROM)
+                QuatStream::squad(u, c0, c1, c2, c3, c0, true);
+            else
+            {
+                QuatStream::slerp(u, c0, c1, c0, true);
+                QuatStream::slerp(u, c1, c2, c1, true);
+                QuatStream::slerp(u, c2, c3, c2, true);
+                QuatStream::slerp(u, c0, c1, c0, true);
+                QuatStream::slerp(u, c1, c2, c1, true);
+                QuatStream::slerp(u, c0, c1, c0, true);
+            }
+            for (size_t i = 0; i < n; ++i)
+                out[begin + i] = c0.get(i);
+        }
+    }
+
+    void QuatSpline::updateArcLength()
+    {
+        if (!m_arcLength.isDirty())
+            return;
+        size_t samples = m_arcLength.getSamplesPerSegment();
+        std::vector<Real> t(samples + 1);
+        QuatArray q(samples + 1);
+        for (size_t s = 0; s < m_segmentCount; ++s)
+        {
+            if (!m_arcLength.isDirty(s))
+                continue;
+            // rotation angle between consecutive samples
+            for (size_t k = 0; k <= samples; ++k)
+                t[k] = (Real(s) + Real(k) / Real(samples)) / Real(m_segmentCount);
+            t[samples] = Minimum(t[samples], Real(1.0f));
+            evaluate(t.data(), q.data(), samples + 1);
+            Real *angles = m_arcLength.getSegmentSamples(s);
+            Real *speeds = m_arcLength.getSegmentSpeeds(s);
+            angles[0] = 0.0f;
+            for (size_t k = 0; k < samples; ++k)
+            {
+                // atan2 of the relative rotation, acos of the dot loses the small angles
+                Quat inv = q[k];
+                inv.unitInverse();
+                Quat rel = inv * q[k + 1];
+                Real sine = sqrt(rel.x * rel.x + rel.y * rel.y + rel.z * rel.z);
+                angles[k + 1] = angles[k] + 2.0f * atan2(sine, Real(fabs(rel.w)));
+            }
+            // angular speed by differences of the samples, one sided at the ends
+            Real inv = Real(samples);
+            speeds[0] = (angles[1] - angles[0]) * inv;
+            speeds[samples] = (angles[samples] - angles[samples - 1]) * inv;
+            for (size_t k = 1; k < samples; ++k)
+                speeds[k] = (angles[k + 1] - angles[k - 1]) * 0.5f * inv;
+        }
+        m_arcLength.update();
+    }
+
+    Real QuatSpline::getLength()
+    {
+        updateArcLength();
+        return m_arcLength.getLength();
+    }
+
+    Real QuatSpline::getParameterAtDistance(Real angle)
+    {
+        updateArcLength();
+        return m_arcLength.getParameter(angle);
+    }
+
+    Quat QuatSpline::evaluateAtDistance(Real angle)
+    {
+        return evaluate(getParameterAtDistance(angle));
+    }
+
+    void QuatSpline::evaluateAtDistance(const Real *angles, Quat *out, size_t count)
+    {
+        updateArcLength();
+        Real t[SPLINE_BLOCK_SIZE];
+        for (size_t begin = 0; begin < count; begin += SPLINE_BLOCK_SIZE)
+        {
+            size_t n = Minimum(SPLINE_BLOCK_SIZE, count - begin);
+            m_arcLength.getParameters(angles + begin, t, n);
+            evaluate(t, out + begin, n);
+        }
+    }
+}
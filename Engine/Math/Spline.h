@@ -0,0 +1,189 @@
+#ifndef _CN_SPLINE_
+#define _CN_SPLINE_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    /*
+        Piecewise cubic curves over Vec3 (Spline) and Quat (QuatSpline) for
+        camera rails and path following.
+
+        - SPLINE_BEZIER: 3n + 1 control points, knot, out handle, in handle,
+          knot, ... The curve passes through every third point.
+        - SPLINE_CATMULL_ROM: uniform Catmull-Rom through every point, the end
+          segments mirror their neighbour. QuatSpline uses squad with
+          Quat::squadTangent inner points.
+        - SPLINE_HERMITE: points plus one tangent per point. For Spline the
+          tangent is dp/du of the segment parameter u; for QuatSpline it is
+          the angular velocity in radians per unit u, world frame.
+
+        The curve parameter t runs over [0, 1], each segment taking an equal
+        share, and is clamped. The batched forms evaluate many parameters at
+        once and give the same results as the single ones.
+
+        Constant speed traversal goes through an arc-length table of
+        samplesPerSegment entries per segment (distance for Spline, rotation
+        angle for QuatSpline). Changing control points only marks the
+        segments they influence; those are resampled on the next distance
+        query. Between samples the length is a cubic Hermite of the sampled
+        lengths and speeds, inverted with Newton steps.
+    */
+    enum SplineType
+    {
+        SPLINE_BEZIER,
+        SPLINE_CATMULL_ROM,
+        SPLINE_HERMITE,
+    };
+
+    // Cumulative arc length per segment with per segment invalidation, shared
+    // by Spline and QuatSpline
+    class CN_EXPORT ArcLengthTable
+    {
+    public:
+
+        ArcLengthTable();
+        ~ArcLengthTable();
+
+        // every segment starts dirty
+        void reset(size_t segments, size_t samplesPerSegment);
+        void invalidate(size_t segment);
+        void invalidateAll();
+
+        size_t getSegmentCount() const { return m_offsets.size() - 1; }
+        size_t getSamplesPerSegment() const { return m_samplesPerSegment; }
+        bool isDirty() const { return m_firstDirty < getSegmentCount(); }
+        bool isDirty(size_t segment) const { return m_dirty[segment] != 0; }
+
+        // samplesPerSegment + 1 cumulative lengths from 0 at u = k / samplesPerSegment,
+        // to be filled for every dirty segment before update()
+        Real* getSegmentSamples(size_t segment) { return m_samples.data() + segment * (m_samplesPerSegment + 1); }
+        const Real* getSegmentSamples(size_t segment) const { return m_samples.data() + segment * (m_samplesPerSegment + 1); }
+        // the derivative of the length by u at the same samples
+        Real* getSegmentSpeeds(size_t segment) { return m_speeds.data() + segment * (m_samplesPerSegment + 1); }
+        const Real* getSegmentSpeeds(size_t segment) const { return m_speeds.data() + segment * (m_samplesPerSegment + 1); }
+        // sums the segments again from the first dirty one and marks all clean
+        void update();
+
+        Real getLength() const { return m_offsets.back(); }
+        // curve parameter t in [0, 1] at distance, distance is clamped to [0, getLength()]
+        Real getParameter(Real distance) const;
+        void getParameters(const Real *distances, Real *out, size_t count) const;
+
+    private:
+
+        size_t m_samplesPerSegment = 0;
+        size_t m_firstDirty = 0;
+        std::vector<Real> m_samples;
+        std::vector<Real> m_speeds;
+        // length of the curve up to each segment, segments + 1 entries
+        std::vector<Real> m_offsets;
+        std::vector<uint8_t> m_dirty;
+    };
+
+    class CN_EXPORT Spline
+    {
+    public:
+
+        explicit Spline(SplineType type = SPLINE_CATMULL_ROM, size_t samplesPerSegment = 16);
+        ~Spline();
+
+        SplineType getType() const { return m_type; }
+
+        // at least 4 points for Bezier (3n + 1), 2 otherwise. Hermite tangents are
+        // kept when the count does not change and set to zero otherwise.
+        void setPoints(const Vec3 *points, size_t count);
+        void setPoint(size_t i, const Vec3 &point);
+        const Vec3& getPoint(size_t i) const { return m_points[i]; }
+        size_t getPointCount() const { return m_points.size(); }
+
+        // Hermite only, one per point
+        void setTangents(const Vec3 *tangents, size_t count);
+        void setTangent(size_t i, const Vec3 &tangent);
+        const Vec3& getTangent(size_t i) const { return m_tangents[i]; }
+
+        size_t getSegmentCount() const { return m_segmentCount; }
+
+        Vec3 evaluate(Real t) const;
+        // derivative by the segment parameter u, the curve velocity direction
+        Vec3 evaluateDerivative(Real t) const;
+        void evaluate(const Real *t, Vec3 *out, size_t count) const;
+        void evaluateDerivative(const Real *t, Vec3 *out, size_t count) const;
+
+        // arc length, resamples the segments changed since the last query
+        Real getLength();
+        Real getParameterAtDistance(Real distance);
+        Vec3 evaluateAtDistance(Real distance);
+        void evaluateAtDistance(const Real *distances, Vec3 *out, size_t count);
+
+    private:
+
+        void updateSegment(size_t segment);
+        void updateSegments(size_t point);
+        void updateArcLength();
+
+    private:
+
+        SplineType m_type;
+        size_t m_segmentCount = 0;
+        Vec3Array m_points;
+        Vec3Array m_tangents;
+        // power basis per segment, a + b u + c u^2 + d u^3 as (a, b, c, d) for x, y then z
+        std::vector<Real> m_coefficients;
+        ArcLengthTable m_arcLength;
+    };
+
+    class CN_EXPORT QuatSpline
+    {
+    public:
+
+        explicit QuatSpline(SplineType type = SPLINE_CATMULL_ROM, size_t samplesPerSegment = 16);
+        ~QuatSpline();
+
+        SplineType getType() const { return m_type; }
+
+        // unit keys, same counts as Spline::setPoints
+        void setKeys(const Quat *keys, size_t count);
+        void setKey(size_t i, const Quat &key);
+        const Quat& getKey(size_t i) const { return m_keys[i]; }
+        size_t getKeyCount() const { return m_keys.size(); }
+
+        // Hermite only, angular velocity per key
+        void setAngularVelocities(const Vec3 *velocities, size_t count);
+        void setAngularVelocity(size_t i, const Vec3 &velocity);
+        const Vec3& getAngularVelocity(size_t i) const { return m_velocities[i]; }
+
+        size_t getSegmentCount() const { return m_segmentCount; }
+
+        // fast tier interpolation (Quat::slerpFast, Quat::squadFast), batched
+        // through QuatStream
+        Quat evaluate(Real t) const;
+        void evaluate(const Real *t, Quat *out, size_t count) const;
+
+        // arc length is the rotation angle, for constant angular speed
+        Real getLength();
+        Real getParameterAtDistance(Real angle);
+        Quat evaluateAtDistance(Real angle);
+        void evaluateAtDistance(const Real *angles, Quat *out, size_t count);
+
+    private:
+
+        void updateSegment(size_t segment);
+        void updateSegments(size_t key);
+        void updateArcLength();
+
+    private:
+
+        SplineType m_type;
+        size_t m_segmentCount = 0;
+        QuatArray m_keys;
+        Vec3Array m_velocities;
+        // four controls per segment: the Bezier points, or the squad keys and inner points
+        QuatArray m_controls;
+        ArcLengthTable m_arcLength;
+    };
+}
+
+#endif
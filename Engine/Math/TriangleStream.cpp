@@ -0,0 +1,77 @@
+#include "TriangleStream.h"
+
+namespace Canaan
+{
+    const uint32_t TriangleHit::NO_HIT;
+
+    TriangleStream::TriangleStream()
+    {
+
+    }
+
+    TriangleStream::TriangleStream(size_t count)
+    {
+        resize(count);
+    }
+
+    TriangleStream::~TriangleStream()
+    {
+
+    }
+
+    void TriangleStream::resize(size_t count)
+    {
+        m_v0X.resize(count);
+        m_v0Y.resize(count);
+        m_v0Z.resize(count);
+        m_e1X.resize(count);
+        m_e1Y.resize(count);
+        m_e1Z.resize(count);
+        m_e2X.resize(count);
+        m_e2Y.resize(count);
+        m_e2Z.resize(count);
+    }
+
+    void TriangleStream::clear()
+    {
+        m_v0X.clear();
+        m_v0Y.clear();
+        m_v0Z.clear();
+        m_e1X.clear();
+        m_e1Y.clear();
+        m_e1Z.clear();
+        m_e2X.clear();
+        m_e2Y.clear();
+        m_e2Z.clear();
+    }
+
+    void TriangleStream::fromVertices(const Vec3 *vertices, size_t triangleCount)
+    {
+        resize(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i)
+            set(i, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+    }
+
+    void TriangleStream::fromIndexed(const Vec3 *vertices, const uint32_t *indices, size_t triangleCount)
+    {
+        resize(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i)
+            set(i, vertices[indices[i * 3]], vertices[indices[i * 3 + 1]], vertices[indices[i * 3 + 2]]);
+    }
+
+    void TriangleStream::set(size_t i, const Vec3 &v0, const Vec3 &v1, const Vec3 &v2)
+    {
+        Vec3 e1 = v1 - v0;
+        Vec3 e2 = v2 - v0;
+        m_v0X[i] = v0.x; m_v0Y[i] = v0.y; m_v0Z[i] = v0.z;
+        m_e1X[i] = e1.x; m_e1Y[i] = e1.y; m_e1Z[i] = e1.z;
+        m_e2X[i] = e2.x; m_e2Y[i] = e2.y; m_e2Z[i] = e2.z;
+    }
+
+    void TriangleStream::get(size_t i, Vec3 &v0, Vec3 &v1, Vec3 &v2) const
+    {
+        v0 = Vec3(m_v0X[i], m_v0Y[i], m_v0Z[i]);
+        v1 = v0 + Vec3(m_e1X[i], m_e1Y[i], m_e1Z[i]);
+        v2 = v0 + Vec3(m_e2X[i], m_e2Y[i], m_e2Z[i]);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef _CN_TRIANGLE_STREAM_
+#define _CN_TRIANGLE_STREAM_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include <stdint.h>
+
+namespace Canaan
+{
+    /*
+        Structure-of-arrays triangles for the Moller-Trumbore ray tests of Ray
+        and RayStream: the first vertex and the two edges e1 = v1 - v0 and
+        e2 = v2 - v0 are stored, so the tests start from the edges.
+    */
+    class CN_EXPORT TriangleStream
+    {
+    public:
+
+        TriangleStream();
+        explicit TriangleStream(size_t count);
+        ~TriangleStream();
+
+        size_t size() const { return m_v0X.size(); }
+        bool empty() const { return m_v0X.empty(); }
+        void resize(size_t count);
+        void clear();
+
+        // three vertices per triangle
+        void fromVertices(const Vec3 *vertices, size_t triangleCount);
+        // indexed mesh, three indices per triangle
+        void fromIndexed(const Vec3 *vertices, const uint32_t *indices, size_t triangleCount);
+
+        void set(size_t i, const Vec3 &v0, const Vec3 &v1, const Vec3 &v2);
+        void get(size_t i, Vec3 &v0, Vec3 &v1, Vec3 &v2) const;
+
+        Real* v0X() { return m_v0X.data(); }
+        Real* v0Y() { return m_v0Y.data(); }
+        Real* v0Z() { return m_v0Z.data(); }
+        Real* e1X() { return m_e1X.data(); }
+        Real* e1Y() { return m_e1Y.data(); }
+        Real* e1Z() { return m_e1Z.data(); }
+        Real* e2X() { return m_e2X.data(); }
+        Real* e2Y() { return m_e2Y.data(); }
+        Real* e2Z() { return m_e2Z.data(); }
+        const Real* v0X() const { return m_v0X.data(); }
+        const Real* v0Y() const { return m_v0Y.data(); }
+        const Real* v0Z() const { return m_v0Z.data(); }
+        const Real* e1X() const { return m_e1X.data(); }
+        const Real* e1Y() const { return m_e1Y.data(); }
+        const Real* e1Z() const { return m_e1Z.data(); }
+        const Real* e2X() const { return m_e2X.data(); }
+        const Real* e2Y() const { return m_e2Y.data(); }
+        const Real* e2Z() const { return m_e2Z.data(); }
+
+    private:
+
+        std::vector<Real> m_v0X;
+        std::vector<Real> m_v0Y;
+        std::vector<Real> m_v0Z;
+        std::vector<Real> m_e1X;
+        std::vector<Real> m_e1Y;
+        std::vector<Real> m_e1Z;
+        std::vector<Real> m_e2X;
+        std::vector<Real> m_e2Y;
+        std::vector<Real> m_e2Z;
+    };
+
+    // nearest hit of a ray, point = v0 + e1 * u + e2 * v. index is NO_HIT on a miss,
+    // distance then FLOAT_MAX
+    struct TriangleHit
+    {
+        static const uint32_t NO_HIT = 0xffffffffu;
+
+        Real distance;
+        Real u;
+        Real v;
+        uint32_t index;
+    };
+}
+
+#endif
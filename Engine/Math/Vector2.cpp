@@ -1,51 +1,16 @@
 #include "Vector2.h"
+#include <type_traits>
 
 namespace Canaan
 {
-    const Vec2 Vec2::ZERO            = Vec2();
-    const Vec2 Vec2::UNIT_X          = Vec2(1.0f, 0.0f);
-    const Vec2 Vec2::UNIT_Y          = Vec2(0.0f, 1.0f);
-    const Vec2 Vec2::NEGATIVE_UNIT_X = Vec2(-1.0f, 0.0f);
-    const Vec2 Vec2::NEGATIVE_UNIT_Y = Vec2(0.0f, -1.0f);
-    const Vec2 Vec2::UNIT_SCALE      = Vec2(1.0f);
+    static_assert(std::is_trivially_copyable<Vec2>::value, "Vec2 arrays are copied with memcpy");
 
-    Vec2::Vec2()
-        : x(0.0f)
-        , y(0.0f)
-    {
+    constexpr Vec2 Vec2::ZERO            = Vec2();
+    constexpr Vec2 Vec2::UNIT_X          = Vec2(1.0f, 0.0f);
+    constexpr Vec2 Vec2::UNIT_Y          = Vec2(0.0f, 1.0f);
+    constexpr Vec2 Vec2::NEGATIVE_UNIT_X = Vec2(-1.0f, 0.0f);
+    constexpr Vec2 Vec2::NEGATIVE_UNIT_Y = Vec2(0.0f, -1.0f);
+    constexpr Vec2 Vec2::UNIT_SCALE      = Vec2(1.0f);
 
-    }
-
-    Vec2::Vec2(const Vec2 &copy)
-        : x(copy.x)
-        , y(copy.y)
-    {
-
-    }
-
-    Vec2::Vec2(const Real scaler)
-        : x(scaler)
-        , y(scaler)
-    {
-
-    }
-
-    Vec2::Vec2(Real *xy)
-        : x(xy[0])
-        , y(xy[1])
-    {
-
-    }
-
-    Vec2::Vec2(const Real x, const Real y)
-        : x(x)
-        , y(y)
-    {
-
-    }
-
-    Vec2::~Vec2()
-    {
-
-    }
+    static_assert(Vec2::UNIT_Y.y == 1.0f, "Vec2 constants are compile-time");
 }
@@ -17,12 +17,10 @@ namespace Canaan
         static const Vec2 NEGATIVE_UNIT_Y;
         static const Vec2 UNIT_SCALE;
 
-        Vec2();
-        Vec2(const Vec2 &copy);
-        Vec2(const Real scaler);
-        Vec2(Real *xy);
-        Vec2(const Real x, const Real y);
-        ~Vec2();
+        constexpr Vec2() : x(0.0f), y(0.0f) {}
+        constexpr Vec2(const Real scaler) : x(scaler), y(scaler) {}
+        constexpr Vec2(const Real *xy) : x(xy[0]), y(xy[1]) {}
+        constexpr Vec2(const Real x, const Real y) : x(x), y(y) {}
 
         Real length() const { return sqrt(x * x + y * y); }
         Real squaredLength() const { return x * x + y * y; }
@@ -67,13 +65,6 @@ namespace Canaan
             return *(&x + i);
         }
 
-        inline Vec2& operator = (const Vec2& rkVector){
-            x = rkVector.x;
-            y = rkVector.y;
-
-            return *this;
-        }
-
         inline Vec2& operator = (const Real fScalar){
             x = fScalar;
             y = fScalar;
@@ -1,62 +1,21 @@
 #include "Vector3.h"
 #include "Quaternion.h"
-#include "Matrix4.h"
+#include <type_traits>
 
 namespace Canaan
 {
-    const Vec3 Vec3::ZERO            = Vec3();
-    const Vec3 Vec3::UNIT_X          = Vec3(1.0f, 0.0f, 0.0f);
-    const Vec3 Vec3::UNIT_Y          = Vec3(0.0f, 1.0f, 0.0f);
-    const Vec3 Vec3::UNIT_Z          = Vec3(0.0f, 0.0f, 1.0f);
-    const Vec3 Vec3::NEGATIVE_UNIT_X = Vec3(-1.0f, 0.0f, 0.0f);
-    const Vec3 Vec3::NEGATIVE_UNIT_Y = Vec3(0.0f, -1.0f, 0.0f);
-    const Vec3 Vec3::NEGATIVE_UNIT_Z = Vec3(0.0f, 0.0f, -1.0f);
-    const Vec3 Vec3::UNIT_SCALE      = Vec3(1.0f);
+    static_assert(std::is_trivially_copyable<Vec3>::value, "Vec3 arrays are copied with memcpy and reinterpreted as packed Reals");
 
-    Vec3::Vec3()
-        : x(0.0f)
-        , y(0.0f)
-        , z(0.0f)
-    {
-
-    }
-
-    Vec3::Vec3(const Vec3 &copy)
-        : x(copy.x)
-        , y(copy.y)
-        , z(copy.z)
-    {
-
-    }
-
-    Vec3::Vec3(const Real scaler)
-        : x(scaler)
-        , y(scaler)
-        , z(scaler)
-    {
-
-    }
-
-    Vec3::Vec3(Real *xyz)
-        : x(xyz[0])
-        , y(xyz[1])
-        , z(xyz[2])
-    {
+    constexpr Vec3 Vec3::ZERO            = Vec3();
+    constexpr Vec3 Vec3::UNIT_X          = Vec3(1.0f, 0.0f, 0.0f);
+    constexpr Vec3 Vec3::UNIT_Y          = Vec3(0.0f, 1.0f, 0.0f);
+    constexpr Vec3 Vec3::UNIT_Z          = Vec3(0.0f, 0.0f, 1.0f);
+    constexpr Vec3 Vec3::NEGATIVE_UNIT_X = Vec3(-1.0f, 0.0f, 0.0f);
+    constexpr Vec3 Vec3::NEGATIVE_UNIT_Y = Vec3(0.0f, -1.0f, 0.0f);
+    constexpr Vec3 Vec3::NEGATIVE_UNIT_Z = Vec3(0.0f, 0.0f, -1.0f);
+    constexpr Vec3 Vec3::UNIT_SCALE      = Vec3(1.0f);
 
-    }
-
-    Vec3::Vec3(const Real x, const Real y, const Real z)
-        : x(x)
-        , y(y)
-        , z(z)
-    {
-
-    }
-
-    Vec3::~Vec3()
-    {
-
-    }
+    static_assert(Vec3::UNIT_Z.z == 1.0f && Vec3::ZERO.x == 0.0f, "Vec3 constants are compile-time");
 
     Vec3 Vec3::perpendicular()
     {
@@ -73,9 +32,18 @@ namespace Canaan
     Vec3 Vec3::randomDeviat(Real angle, const Vec3 &up)
     {
         Vec3 newUp = up == Vec3::ZERO? this->perpendicular() : up;
-        Mat4 mat = Mat4::rotation(Quat(RandomUnitization() * TWO_PI, *this));
-        newUp = mat * newUp;
-        mat = Mat4::rotation(Quat(angle, newUp));
-        return mat * (*this);
+        newUp = Quat(RandomUnitization() * TWO_PI, *this) * newUp;
+        return Quat(angle, newUp) * (*this);
+    }
+
+    Vec3 Vec3::randomDeviatFast(Real angle, const Vec3 &up)
+    {
+        // same as randomDeviat with the fast tier
+        Vec3 newUp = up == Vec3::ZERO? this->perpendicular() : up;
+        Quat rot;
+        rot.setFast(RandomUnitization() * TWO_PI, *this);
+        newUp = rot * newUp;
+        rot.setFast(angle, newUp);
+        return rot * (*this);
     }
 }
@@ -19,12 +19,10 @@ namespace Canaan
         static const Vec3 NEGATIVE_UNIT_Z;
         static const Vec3 UNIT_SCALE;
 
-        Vec3();
-        Vec3(const Vec3 &copy);
-        Vec3(const Real scaler);
-        Vec3(Real *xyz);
-        Vec3(const Real x, const Real y, const Real z);
-        ~Vec3();
+        constexpr Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+        constexpr Vec3(const Real scaler) : x(scaler), y(scaler), z(scaler) {}
+        constexpr Vec3(const Real *xyz) : x(xyz[0]), y(xyz[1]), z(xyz[2]) {}
+        constexpr Vec3(const Real x, const Real y, const Real z) : x(x), y(y), z(z) {}
 
         Real length() const { return sqrt(x * x + y * y + z * z); }
         Real squaredLength() const { return x * x + y * y + z * z; }
@@ -37,6 +35,8 @@ namespace Canaan
         
         Vec3 perpendicular();
         Vec3 randomDeviat(Real angle, const Vec3 &up = Vec3::ZERO);
+        // randomDeviat on the fast approximate tier (Mathematics.h), for particles
+        Vec3 randomDeviatFast(Real angle, const Vec3 &up = Vec3::ZERO);
 
         Real normalize(){
             Real fLength = sqrt(x * x + y * y + z * z);
@@ -52,6 +52,22 @@ namespace Canaan
             return fLength;
         }
 
+        // normalize() using FastInvSqrt
+        Real normalizeFast(){
+            Real fSqLength = x * x + y * y + z * z;
+
+            if (fSqLength > Real(0.0f))
+            {
+                Real fInvLength = FastInvSqrt(fSqLength);
+                x *= fInvLength;
+                y *= fInvLength;
+                z *= fInvLength;
+                return fSqLength * fInvLength;
+            }
+
+            return 0.0f;
+        }
+
         Vec3 reflect(const Vec3& normal) const{
             return Vec3(*this - (2 * this->dotProduct(normal) * normal));
         }
@@ -76,14 +92,6 @@ namespace Canaan
             return *(&x + i);
         }
 
-        inline Vec3& operator = (const Vec3& rkVector){
-            x = rkVector.x;
-            y = rkVector.y;
-            z = rkVector.z;
-
-            return *this;
-        }
-
         inline Vec3& operator = (const Real fScalar){
             x = fScalar;
             y = fScalar;
@@ -0,0 +1,193 @@
+#include "Vector3Stream.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    template<class S>
+    static size_t NormalizeStreamKernel(Real* x, Real* y, Real* z, size_t count)
+    {
+        typedef typename S::V V;
+        const V zero = S::set1(0.0f);
+        const V one = S::set1(1.0f);
+
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V vx = S::load(x + i), vy = S::load(y + i), vz = S::load(z + i);
+            V len = S::sqrt(S::add(S::add(S::mul(vx, vx), S::mul(vy, vy)), S::mul(vz, vz)));
+            V invLen = S::select(S::cmpgt(len, zero), S::div(one, len), one);
+            S::store(x + i, S::mul(vx, invLen));
+            S::store(y + i, S::mul(vy, invLen));
+            S::store(z + i, S::mul(vz, invLen));
+        }
+        return i;
+    }
+
+    template<class S, bool SQRT>
+    static size_t LengthStreamKernel(const Real* x, const Real* y, const Real* z, Real* out, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = 0;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V vx = S::load(x + i), vy = S::load(y + i), vz = S::load(z + i);
+            V len = S::add(S::add(S::mul(vx, vx), S::mul(vy, vy)), S::mul(vz, vz));
+            S::store(out + i, SQRT ? S::sqrt(len) : len);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t DotStreamKernel(const Vec3Stream &a, const Vec3Stream &b, Real* out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V d = S::mul(S::load(a.x() + i), S::load(b.x() + i));
+            d = S::add(d, S::mul(S::load(a.y() + i), S::load(b.y() + i)));
+            d = S::add(d, S::mul(S::load(a.z() + i), S::load(b.z() + i)));
+            S::store(out + i, d);
+        }
+        return i;
+    }
+
+    template<class S>
+    static size_t CrossStreamKernel(const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            V ax = S::load(a.x() + i), ay = S::load(a.y() + i), az = S::load(a.z() + i);
+            V bx = S::load(b.x() + i), by = S::load(b.y() + i), bz = S::load(b.z() + i);
+            S::store(out.x() + i, S::sub(S::mul(ay, bz), S::mul(az, by)));
+            S::store(out.y() + i, S::sub(S::mul(az, bx), S::mul(ax, bz)));
+            S::store(out.z() + i, S::sub(S::mul(ax, by), S::mul(ay, bx)));
+        }
+        return i;
+    }
+
+    template<class S, bool PER_ELEMENT>
+    static size_t LerpStreamKernel(const Real* fT, const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out, size_t begin, size_t count)
+    {
+        typedef typename S::V V;
+        V t = PER_ELEMENT ? S::set1(0.0f) : S::set1(fT[0]);
+        size_t i = begin;
+        for (; i + S::WIDTH <= count; i += S::WIDTH)
+        {
+            if (PER_ELEMENT)
+                t = S::load(fT + i);
+            V ax = S::load(a.x() + i), ay = S::load(a.y() + i), az = S::load(a.z() + i);
+            S::store(out.x() + i, S::add(ax, S::mul(S::sub(S::load(b.x() + i), ax), t)));
+            S::store(out.y() + i, S::add(ay, S::mul(S::sub(S::load(b.y() + i), ay), t)));
+            S::store(out.z() + i, S::add(az, S::mul(S::sub(S::load(b.z() + i), az), t)));
+        }
+        return i;
+    }
+
+    Vec3Stream::Vec3Stream()
+    {
+
+    }
+
+    Vec3Stream::Vec3Stream(size_t count)
+    {
+        resize(count);
+    }
+
+    Vec3Stream::Vec3Stream(const Vec3Array &array)
+    {
+        fromArray(array);
+    }
+
+    Vec3Stream::~Vec3Stream()
+    {
+
+    }
+
+    void Vec3Stream::resize(size_t count)
+    {
+        m_x.resize(count);
+        m_y.resize(count);
+        m_z.resize(count);
+    }
+
+    void Vec3Stream::clear()
+    {
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+    }
+
+    void Vec3Stream::fromArray(const Vec3Array &array)
+    {
+        resize(array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            m_x[i] = array[i].x;
+            m_y[i] = array[i].y;
+            m_z[i] = array[i].z;
+        }
+    }
+
+    void Vec3Stream::toArray(Vec3Array &array) const
+    {
+        array.resize(size());
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            array[i].x = m_x[i];
+            array[i].y = m_y[i];
+            array[i].z = m_z[i];
+        }
+    }
+
+    void Vec3Stream::normalize()
+    {
+        size_t i = NormalizeStreamKernel<SimdOps>(x(), y(), z(), size());
+        NormalizeStreamKernel<SimdOps1>(x() + i, y() + i, z() + i, size() - i);
+    }
+
+    void Vec3Stream::length(Real *out) const
+    {
+        size_t i = LengthStreamKernel<SimdOps, true>(x(), y(), z(), out, size());
+        LengthStreamKernel<SimdOps1, true>(x() + i, y() + i, z() + i, out + i, size() - i);
+    }
+
+    void Vec3Stream::squaredLength(Real *out) const
+    {
+        size_t i = LengthStreamKernel<SimdOps, false>(x(), y(), z(), out, size());
+        LengthStreamKernel<SimdOps1, false>(x() + i, y() + i, z() + i, out + i, size() - i);
+    }
+
+    void Vec3Stream::dotProduct(const Vec3Stream &a, const Vec3Stream &b, Real *out)
+    {
+        cnAssert(a.size() == b.size());
+        size_t i = DotStreamKernel<SimdOps>(a, b, out, 0, a.size());
+        DotStreamKernel<SimdOps1>(a, b, out, i, a.size());
+    }
+
+    void Vec3Stream::crossProduct(const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out)
+    {
+        cnAssert(a.size() == b.size());
+        out.resize(a.size());
+        size_t i = CrossStreamKernel<SimdOps>(a, b, out, 0, a.size());
+        CrossStreamKernel<SimdOps1>(a, b, out, i, a.size());
+    }
+
+    void Vec3Stream::lerp(Real fT, const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out)
+    {
+        cnAssert(a.size() == b.size());
+        out.resize(a.size());
+        size_t i = LerpStreamKernel<SimdOps, false>(&fT, a, b, out, 0, a.size());
+        LerpStreamKernel<SimdOps1, false>(&fT, a, b, out, i, a.size());
+    }
+
+    void Vec3Stream::lerp(const Real *fT, const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out)
+    {
+        cnAssert(a.size() == b.size());
+        out.resize(a.size());
+        size_t i = LerpStreamKernel<SimdOps, true>(fT, a, b, out, 0, a.size());
+        LerpStreamKernel<SimdOps1, true>(fT, a, b, out, i, a.size());
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef _CN_VECTOR3_STREAM_
+#define _CN_VECTOR3_STREAM_
+#include "Prerequisites.h"
+#include "Vector3.h"
+
+namespace Canaan
+{
+    /*
+        Structure-of-arrays storage for Vec3: x, y and z live in separate
+        contiguous arrays so whole-stream operations fill every SIMD lane.
+        Results of the static operations may be written to one of the
+        operand streams.
+    */
+    class CN_EXPORT Vec3Stream
+    {
+    public:
+
+        Vec3Stream();
+        explicit Vec3Stream(size_t count);
+        explicit Vec3Stream(const Vec3Array &array);
+        ~Vec3Stream();
+
+        size_t size() const { return m_x.size(); }
+        bool empty() const { return m_x.empty(); }
+        void resize(size_t count);
+        void clear();
+
+        void fromArray(const Vec3Array &array);
+        void toArray(Vec3Array &array) const;
+
+        Vec3 get(size_t i) const { return Vec3(m_x[i], m_y[i], m_z[i]); }
+        void set(size_t i, const Vec3 &v) { m_x[i] = v.x; m_y[i] = v.y; m_z[i] = v.z; }
+
+        Real* x() { return m_x.data(); }
+        Real* y() { return m_y.data(); }
+        Real* z() { return m_z.data(); }
+        const Real* x() const { return m_x.data(); }
+        const Real* y() const { return m_y.data(); }
+        const Real* z() const { return m_z.data(); }
+
+        // in place, zero length vectors are left untouched
+        void normalize();
+        // out must hold size() Reals
+        void length(Real *out) const;
+        void squaredLength(Real *out) const;
+
+        static void dotProduct(const Vec3Stream &a, const Vec3Stream &b, Real *out);
+        static void crossProduct(const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out);
+        static void lerp(Real fT, const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out);
+        // per element weights, fT must hold a.size() Reals
+        static void lerp(const Real *fT, const Vec3Stream &a, const Vec3Stream &b, Vec3Stream &out);
+
+    private:
+
+        std::vector<Real> m_x;
+        std::vector<Real> m_y;
+        std::vector<Real> m_z;
+    };
+}
+
+#endif
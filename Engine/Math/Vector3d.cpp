@@ -0,0 +1,9 @@
+#include "Vector3d.h"
+#include <type_traits>
+
+namespace Canaan
+{
+    static_assert(std::is_trivially_copyable<Vec3d>::value, "Vec3d arrays are copied with memcpy");
+
+    constexpr Vec3d Vec3d::ZERO = Vec3d();
+}
@@ -0,0 +1,97 @@
+#ifndef _CN_VECTOR3D_
+#define _CN_VECTOR3D_
+#include "Prerequisites.h"
+#include "Vector3.h"
+
+namespace Canaan
+{
+    /*
+        Double precision position for large worlds. Only positions need it:
+        directions, scales and the offsets between nearby points stay Vec3.
+        Subtracting a nearby origin (see WorldOrigin) gives back a Vec3 that
+        keeps full float precision.
+    */
+    class CN_EXPORT Vec3d
+    {
+    public:
+
+        static const Vec3d ZERO;
+
+        constexpr Vec3d() : x(0.0), y(0.0), z(0.0) {}
+        constexpr Vec3d(const double x, const double y, const double z) : x(x), y(y), z(z) {}
+        // implicit, a Vec3 is always exactly representable
+        constexpr Vec3d(const Vec3 &v) : x(v.x), y(v.y), z(v.z) {}
+
+        // rounds to Real
+        Vec3 toVec3() const { return Vec3(Real(x), Real(y), Real(z)); }
+
+        double length() const { return sqrt(x * x + y * y + z * z); }
+        double squaredLength() const { return x * x + y * y + z * z; }
+        double distance(const Vec3d& rhs) const { return (*this - rhs).length(); }
+        double squaredDistance(const Vec3d& rhs) const { return (*this - rhs).squaredLength(); }
+
+        inline double operator [] (const size_t i) const{
+            cnAssert(i < 3);
+            return *(&x + i);
+        }
+
+        inline double& operator [] (const size_t i){
+            cnAssert(i < 3);
+            return *(&x + i);
+        }
+
+        inline bool operator == (const Vec3d& rhs) const{
+            return (x == rhs.x && y == rhs.y && z == rhs.z);
+        }
+
+        inline bool operator != (const Vec3d& rhs) const{
+            return (x != rhs.x || y != rhs.y || z != rhs.z);
+        }
+
+        inline Vec3d operator + (const Vec3d& rhs) const{
+            return Vec3d(x + rhs.x, y + rhs.y, z + rhs.z);
+        }
+
+        inline Vec3d operator - (const Vec3d& rhs) const{
+            return Vec3d(x - rhs.x, y - rhs.y, z - rhs.z);
+        }
+
+        inline Vec3d operator * (const double scalar) const{
+            return Vec3d(x * scalar, y * scalar, z * scalar);
+        }
+
+        inline Vec3d operator - () const{
+            return Vec3d(-x, -y, -z);
+        }
+
+        inline Vec3d& operator += (const Vec3d& rhs){
+            x += rhs.x;
+            y += rhs.y;
+            z += rhs.z;
+            return *this;
+        }
+
+        inline Vec3d& operator -= (const Vec3d& rhs){
+            x -= rhs.x;
+            y -= rhs.y;
+            z -= rhs.z;
+            return *this;
+        }
+
+        double x;
+        double y;
+        double z;
+    };
+
+    typedef std::vector<Vec3d> Vec3dArray;
+
+    // Position type of Transform: Vec3d in the large world mode (CN_LARGE_WORLD),
+    // Vec3 otherwise
+#if CN_LARGE_WORLD == 1
+    typedef Vec3d WorldVec3;
+#else
+    typedef Vec3 WorldVec3;
+#endif
+}
+
+#endif
@@ -13,12 +13,10 @@ namespace Canaan
         static const Vec4 ZERO;
         static const Vec4 UNIT_SCALE;
 
-        Vec4();
-        Vec4(const Vec4 &copy);
-        Vec4(const Real scaler);
-        Vec4(Real *xyzw);
-        Vec4(const Real x, const Real y, const Real z, const Real w);
-        ~Vec4();
+        constexpr Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+        constexpr Vec4(const Real scaler) : x(scaler), y(scaler), z(scaler), w(scaler) {}
+        constexpr Vec4(const Real *xyzw) : x(xyzw[0]), y(xyzw[1]), z(xyzw[2]), w(xyzw[3]) {}
+        constexpr Vec4(const Real x, const Real y, const Real z, const Real w) : x(x), y(y), z(z), w(w) {}
 
         bool isNaN() const{
             return IsNaN(x) || IsNaN(y) || IsNaN(z);
@@ -40,15 +38,6 @@ namespace Canaan
             return *(&x + i);
         }
 
-        inline Vec4& operator = (const Vec4& rkVector){
-            x = rkVector.x;
-            y = rkVector.y;
-            z = rkVector.z;
-            w = rkVector.w;
-
-            return *this;
-        }
-
         inline Vec4& operator = (const Real fScalar){
             x = fScalar;
             y = fScalar;
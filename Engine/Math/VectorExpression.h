@@ -0,0 +1,390 @@
+#ifndef _CN_VECTOR_EXPRESSION_
+#define _CN_VECTOR_EXPRESSION_
+#include "Prerequisites.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Vector3Stream.h"
+#include "SIMD.h"
+
+namespace Canaan
+{
+    /*
+        Opt-in expression templates for Vec3 and Vec4 arithmetic. Operands
+        wrapped with Lazy() combine into an expression tree instead of
+        temporaries; Evaluate() or Assign() then computes it in one pass.
+
+            Vec3 r = Evaluate(Lazy(v) - 2.0f * DotProduct(Lazy(v), Lazy(n)) * Lazy(n));
+            Assign(positions, Lazy(positions) + Lazy(velocities) * dt);
+
+        Over Vec3Array, Vec4Array, Vec3Stream and Real array operands every
+        element goes through the whole expression at once, S::WIDTH elements
+        per SIMD iteration, so no intermediate arrays are allocated. Single
+        values (Lazy(const Vec3&), plain Reals) broadcast to every element.
+        The result may be written to one of the array operands.
+
+        Results match the Vec3 / Vec4 operators written the same way: each
+        node does the same operation in the same order, and a division by a
+        Real multiplies by its reciprocal like Vec3::operator / (Real).
+        DotProduct gives one Real per element and broadcasts across
+        components.
+
+        Expressions keep references to their operands; evaluate them in the
+        statement that builds them.
+    */
+    template<class E>
+    struct VecExpr
+    {
+        const E& self() const { return static_cast<const E&>(*this); }
+    };
+
+    template<int DIM> struct VecExprValue;
+    template<> struct VecExprValue<1> { typedef Real Type; };
+    template<> struct VecExprValue<3> { typedef Vec3 Type; };
+    template<> struct VecExprValue<4> { typedef Vec4 Type; };
+
+    // one Real, Vec3 or Vec4 for every element
+    template<int D>
+    class VecExprConstant : public VecExpr<VecExprConstant<D>>
+    {
+    public:
+
+        enum { DIM = D };
+
+        explicit VecExprConstant(const Real *v) : m_v(v) {}
+
+        // 0 for values broadcast to any size
+        size_t size() const { return 0; }
+
+        template<class S>
+        void eval(size_t, typename S::V *out) const
+        {
+            for (int c = 0; c < D; ++c)
+                out[c] = S::set1(m_v[c]);
+        }
+
+    private:
+
+        const Real *m_v;
+    };
+
+    class VecExprScalar : public VecExpr<VecExprScalar>
+    {
+    public:
+
+        enum { DIM = 1 };
+
+        explicit VecExprScalar(Real v) : m_v(v) {}
+
+        size_t size() const { return 0; }
+
+        template<class S>
+        void eval(size_t, typename S::V *out) const { out[0] = S::set1(m_v); }
+
+    private:
+
+        Real m_v;
+    };
+
+    // count packed Reals, Vec3s or Vec4s
+    template<int D>
+    class VecExprArray : public VecExpr<VecExprArray<D>>
+    {
+    public:
+
+        enum { DIM = D };
+
+        VecExprArray(const Real *p, size_t count) : m_p(p), m_count(count) {}
+
+        size_t size() const { return m_count; }
+
+        template<class S>
+        void eval(size_t i, typename S::V *out) const { Load<S>(m_p + i * D, out, Dim<D>()); }
+
+    private:
+
+        template<int N> struct Dim {};
+        template<class S> static void Load(const Real *p, typename S::V *out, Dim<1>) { out[0] = S::load(p); }
+        template<class S> static void Load(const Real *p, typename S::V *out, Dim<3>) { S::load3(p, out[0], out[1], out[2]); }
+        template<class S> static void Load(const Real *p, typename S::V *out, Dim<4>) { S::load4(p, out[0], out[1], out[2], out[3]); }
+
+        const Real *m_p;
+        size_t m_count;
+    };
+
+    class VecExprStream : public VecExpr<VecExprStream>
+    {
+    public:
+
+        enum { DIM = 3 };
+
+        explicit VecExprStream(const Vec3Stream &stream) : m_stream(stream) {}
+
+        size_t size() const { return m_stream.size(); }
+
+        template<class S>
+        void eval(size_t i, typename S::V *out) const
+        {
+            out[0] = S::load(m_stream.x() + i);
+            out[1] = S::load(m_stream.y() + i);
+            out[2] = S::load(m_stream.z() + i);
+        }
+
+    private:
+
+        const Vec3Stream &m_stream;
+    };
+
+    struct VecExprAdd { template<class S> static typename S::V apply(typename S::V a, typename S::V b) { return S::add(a, b); } };
+    struct VecExprSub { template<class S> static typename S::V apply(typename S::V a, typename S::V b) { return S::sub(a, b); } };
+    struct VecExprMul { template<class S> static typename S::V apply(typename S::V a, typename S::V b) { return S::mul(a, b); } };
+    struct VecExprDiv { template<class S> static typename S::V apply(typename S::V a, typename S::V b) { return S::div(a, b); } };
+
+    // component wise, a one component side broadcasts across the other
+    template<class Op, class L, class R>
+    class VecExprBinary : public VecExpr<VecExprBinary<Op, L, R>>
+    {
+    public:
+
+        enum { DIM = int(L::DIM) > int(R::DIM) ? int(L::DIM) : int(R::DIM) };
+        static_assert(int(L::DIM) == int(R::DIM) || L::DIM == 1 || R::DIM == 1, "Vec3 and Vec4 operands do not mix");
+
+        VecExprBinary(const L &l, const R &r) : m_l(l), m_r(r) {}
+
+        size_t size() const
+        {
+            cnAssert(m_l.size() == 0 || m_r.size() == 0 || m_l.size() == m_r.size());
+            return m_l.size() ? m_l.size() : m_r.size();
+        }
+
+        template<class S>
+        void eval(size_t i, typename S::V *out) const
+        {
+            typename S::V l[L::DIM], r[R::DIM];
+            m_l.template eval<S>(i, l);
+            m_r.template eval<S>(i, r);
+            for (int c = 0; c < DIM; ++c)
+                out[c] = Op::template apply<S>(l[L::DIM == 1 ? 0 : c], r[R::DIM == 1 ? 0 : c]);
+        }
+
+    private:
+
+        L m_l;
+        R m_r;
+    };
+
+    template<class E>
+    class VecExprNegate : public VecExpr<VecExprNegate<E>>
+    {
+    public:
+
+        enum { DIM = E::DIM };
+
+        explicit VecExprNegate(const E &e) : m_e(e) {}
+
+        size_t size() const { return m_e.size(); }
+
+        template<class S>
+        void eval(size_t i, typename S::V *out) const
+        {
+            m_e.template eval<S>(i, out);
+            for (int c = 0; c < DIM; ++c)
+                out[c] = S::mul(out[c], S::set1(-1.0f));
+        }
+
+    private:
+
+        E m_e;
+    };
+
+    // Vec3::dotProduct / Vec4::dotProduct order, one component
+    template<class L, class R>
+    class VecExprDot : public VecExpr<VecExprDot<L, R>>
+    {
+    public:
+
+        enum { DIM = 1 };
+        static_assert(int(L::DIM) == int(R::DIM) && L::DIM > 1, "DotProduct takes two Vec3 or two Vec4 expressions");
+
+        VecExprDot(const L &l, const R &r) : m_l(l), m_r(r) {}
+
+        size_t size() const { return VecExprBinary<VecExprMul, L, R>(m_l, m_r).size(); }
+
+        template<class S>
+        void eval(size_t i, typename S::V *out) const
+        {
+            typename S::V l[L::DIM], r[R::DIM];
+            m_l.template eval<S>(i, l);
+            m_r.template eval<S>(i, r);
+            out[0] = S::mul(l[0], r[0]);
+            for (int c = 1; c < L::DIM; ++c)
+                out[0] = S::add(out[0], S::mul(l[c], r[c]));
+        }
+
+    private:
+
+        L m_l;
+        R m_r;
+    };
+
+    // Vec3::crossProduct
+    template<class L, class R>
+    class VecExprCross : public VecExpr<VecExprCross<L, R>>
+    {
+    public:
+
+        enum { DIM = 3 };
+        static_assert(L::DIM == 3 && R::DIM == 3, "CrossProduct takes two Vec3 expressions");
+
+        VecExprCross(const L &l, const R &r) : m_l(l), m_r(r) {}
+
+        size_t size() const { return VecExprBinary<VecExprMul, L, R>(m_l, m_r).size(); }
+
+        template<class S>
+        void eval(size_t i, typename S::V *out) const
+        {
+            typename S::V l[3], r[3];
+            m_l.template eval<S>(i, l);
+            m_r.template eval<S>(i, r);
+            out[0] = S::sub(S::mul(l[1], r[2]), S::mul(l[2], r[1]));
+            out[1] = S::sub(S::mul(l[2], r[0]), S::mul(l[0], r[2]));
+            out[2] = S::sub(S::mul(l[0], r[1]), S::mul(l[1], r[0]));
+        }
+
+    private:
+
+        L m_l;
+        R m_r;
+    };
+
+    inline VecExprConstant<3> Lazy(const Vec3 &v) { return VecExprConstant<3>(&v.x); }
+    inline VecExprConstant<4> Lazy(const Vec4 &v) { return VecExprConstant<4>(&v.x); }
+    inline VecExprArray<3> Lazy(const Vec3Array &a) { return VecExprArray<3>(a.empty() ? nullptr : &a[0].x, a.size()); }
+    inline VecExprArray<4> Lazy(const Vec4Array &a) { return VecExprArray<4>(a.empty() ? nullptr : &a[0].x, a.size()); }
+    inline VecExprArray<1> Lazy(const Real *a, size_t count) { return VecExprArray<1>(a, count); }
+    inline VecExprStream Lazy(const Vec3Stream &s) { return VecExprStream(s); }
+
+    template<class L, class R>
+    inline VecExprBinary<VecExprAdd, L, R> operator + (const VecExpr<L> &l, const VecExpr<R> &r) { return VecExprBinary<VecExprAdd, L, R>(l.self(), r.self()); }
+    template<class L, class R>
+    inline VecExprBinary<VecExprSub, L, R> operator - (const VecExpr<L> &l, const VecExpr<R> &r) { return VecExprBinary<VecExprSub, L, R>(l.self(), r.self()); }
+    template<class L, class R>
+    inline VecExprBinary<VecExprMul, L, R> operator * (const VecExpr<L> &l, const VecExpr<R> &r) { return VecExprBinary<VecExprMul, L, R>(l.self(), r.self()); }
+    template<class L, class R>
+    inline VecExprBinary<VecExprDiv, L, R> operator / (const VecExpr<L> &l, const VecExpr<R> &r) { return VecExprBinary<VecExprDiv, L, R>(l.self(), r.self()); }
+
+    template<class L>
+    inline VecExprBinary<VecExprAdd, L, VecExprScalar> operator + (const VecExpr<L> &l, Real r) { return VecExprBinary<VecExprAdd, L, VecExprScalar>(l.self(), VecExprScalar(r)); }
+    template<class L>
+    inline VecExprBinary<VecExprSub, L, VecExprScalar> operator - (const VecExpr<L> &l, Real r) { return VecExprBinary<VecExprSub, L, VecExprScalar>(l.self(), VecExprScalar(r)); }
+    template<class L>
+    inline VecExprBinary<VecExprMul, L, VecExprScalar> operator * (const VecExpr<L> &l, Real r) { return VecExprBinary<VecExprMul, L, VecExprScalar>(l.self(), VecExprScalar(r)); }
+    // multiplies by the reciprocal, as Vec3 / Real and Vec4 / Real do
+    template<class L>
+    inline VecExprBinary<VecExprMul, L, VecExprScalar> operator / (const VecExpr<L> &l, Real r) { return VecExprBinary<VecExprMul, L, VecExprScalar>(l.self(), VecExprScalar(1.0f / r)); }
+
+    template<class R>
+    inline VecExprBinary<VecExprAdd, VecExprScalar, R> operator + (Real l, const VecExpr<R> &r) { return VecExprBinary<VecExprAdd, VecExprScalar, R>(VecExprScalar(l), r.self()); }
+    template<class R>
+    inline VecExprBinary<VecExprSub, VecExprScalar, R> operator - (Real l, const VecExpr<R> &r) { return VecExprBinary<VecExprSub, VecExprScalar, R>(VecExprScalar(l), r.self()); }
+    template<class R>
+    inline VecExprBinary<VecExprMul, VecExprScalar, R> operator * (Real l, const VecExpr<R> &r) { return VecExprBinary<VecExprMul, VecExprScalar, R>(VecExprScalar(l), r.self()); }
+    template<class R>
+    inline VecExprBinary<VecExprDiv, VecExprScalar, R> operator / (Real l, const VecExpr<R> &r) { return VecExprBinary<VecExprDiv, VecExprScalar, R>(VecExprScalar(l), r.self()); }
+
+    template<class E>
+    inline VecExprNegate<E> operator - (const VecExpr<E> &e) { return VecExprNegate<E>(e.self()); }
+
+    template<class L, class R>
+    inline VecExprDot<L, R> DotProduct(const VecExpr<L> &l, const VecExpr<R> &r) { return VecExprDot<L, R>(l.self(), r.self()); }
+    template<class L, class R>
+    inline VecExprCross<L, R> CrossProduct(const VecExpr<L> &l, const VecExpr<R> &r) { return VecExprCross<L, R>(l.self(), r.self()); }
+
+    // an expression of single values only
+    template<class E>
+    inline typename VecExprValue<E::DIM>::Type Evaluate(const VecExpr<E> &e)
+    {
+        cnAssert(e.self().size() == 0);
+        typename VecExprValue<E::DIM>::Type value;
+        e.self().template eval<SimdOps1>(0, reinterpret_cast<Real*>(&value));
+        return value;
+    }
+
+    template<int D> struct VecExprStore;
+    template<> struct VecExprStore<1> { static void store(Real *p, const SimdOps::V *v) { SimdOps::store(p, v[0]); } };
+    template<> struct VecExprStore<3> { static void store(Real *p, const SimdOps::V *v) { SimdOps::store3(p, v[0], v[1], v[2]); } };
+    template<> struct VecExprStore<4> { static void store(Real *p, const SimdOps::V *v) { SimdOps::store4(p, v[0], v[1], v[2], v[3]); } };
+
+    // count packed elements of E::DIM Reals
+    template<class E>
+    inline void AssignPacked(Real *out, const E &e, size_t count)
+    {
+        size_t i = 0;
+        for (; i + SimdOps::WIDTH <= count; i += SimdOps::WIDTH)
+        {
+            SimdOps::V v[E::DIM];
+            e.template eval<SimdOps>(i, v);
+            VecExprStore<E::DIM>::store(out + i * E::DIM, v);
+        }
+        for (; i < count; ++i)
+            e.template eval<SimdOps1>(i, out + i * E::DIM);
+    }
+
+    // the Assign forms resize out to the size of the array operands
+    template<class E>
+    inline void Assign(Vec3Array &out, const VecExpr<E> &e)
+    {
+        static_assert(E::DIM == 3, "Vec3Array takes a Vec3 expression");
+        size_t count = e.self().size();
+        out.resize(count);
+        if (count)
+            AssignPacked(&out[0].x, e.self(), count);
+    }
+
+    template<class E>
+    inline void Assign(Vec4Array &out, const VecExpr<E> &e)
+    {
+        static_assert(E::DIM == 4, "Vec4Array takes a Vec4 expression");
+        size_t count = e.self().size();
+        out.resize(count);
+        if (count)
+            AssignPacked(&out[0].x, e.self(), count);
+    }
+
+    template<class E>
+    inline void Assign(std::vector<Real> &out, const VecExpr<E> &e)
+    {
+        static_assert(E::DIM == 1, "Real arrays take a DotProduct or other one component expression");
+        size_t count = e.self().size();
+        out.resize(count);
+        if (count)
+            AssignPacked(out.data(), e.self(), count);
+    }
+
+    template<class E>
+    inline void Assign(Vec3Stream &out, const VecExpr<E> &e)
+    {
+        static_assert(E::DIM == 3, "Vec3Stream takes a Vec3 expression");
+        size_t count = e.self().size();
+        out.resize(count);
+        Real *x = out.x(), *y = out.y(), *z = out.z();
+        size_t i = 0;
+        for (; i + SimdOps::WIDTH <= count; i += SimdOps::WIDTH)
+        {
+            SimdOps::V v[3];
+            e.self().template eval<SimdOps>(i, v);
+            SimdOps::store(x + i, v[0]);
+            SimdOps::store(y + i, v[1]);
+            SimdOps::store(z + i, v[2]);
+        }
+        for (; i < count; ++i)
+        {
+            Real v[3];
+            e.self().template eval<SimdOps1>(i, v);
+            x[i] = v[0];
+            y[i] = v[1];
+            z[i] = v[2];
+        }
+    }
+}
+
+#endif
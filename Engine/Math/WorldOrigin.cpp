@@ -0,0 +1,44 @@
+#include "WorldOrigin.h"
+
+namespace Canaan
+{
+    static_assert(sizeof(Affine3) == 12 * sizeof(Real), "Affine3 arrays are read as packed rows");
+
+    void WorldOrigin::toRelative(const Vec3d *positions, Vec3 *out, size_t count) const
+    {
+        const double ox = m_origin.x, oy = m_origin.y, oz = m_origin.z;
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i].x = Real(positions[i].x - ox);
+            out[i].y = Real(positions[i].y - oy);
+            out[i].z = Real(positions[i].z - oz);
+        }
+    }
+
+    void WorldOrigin::toRelative(const Affine3 *linears, const Vec3d *positions, Affine3 *out, size_t count) const
+    {
+        const double ox = m_origin.x, oy = m_origin.y, oz = m_origin.z;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Real *src = linears[i][0];
+            Real *dst = out[i][0];
+            dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];  dst[3] = Real(positions[i].x - ox);
+            dst[4] = src[4]; dst[5] = src[5]; dst[6] = src[6];  dst[7] = Real(positions[i].y - oy);
+            dst[8] = src[8]; dst[9] = src[9]; dst[10] = src[10]; dst[11] = Real(positions[i].z - oz);
+        }
+    }
+
+    void WorldOrigin::toRelative(const Affine3 *linears, const Vec3d *positions, Mat4 *out, size_t count) const
+    {
+        const double ox = m_origin.x, oy = m_origin.y, oz = m_origin.z;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Real *src = linears[i][0];
+            Real *dst = out[i][0];
+            dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];  dst[3] = Real(positions[i].x - ox);
+            dst[4] = src[4]; dst[5] = src[5]; dst[6] = src[6];  dst[7] = Real(positions[i].y - oy);
+            dst[8] = src[8]; dst[9] = src[9]; dst[10] = src[10]; dst[11] = Real(positions[i].z - oz);
+            dst[12] = 0.0f; dst[13] = 0.0f; dst[14] = 0.0f; dst[15] = 1.0f;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef _CN_WORLD_ORIGIN_
+#define _CN_WORLD_ORIGIN_
+#include "Prerequisites.h"
+#include "Vector3d.h"
+#include "Affine3.h"
+#include "Matrix4.h"
+
+namespace Canaan
+{
+    /*
+        Movable origin for rendering large worlds in float. Positions are
+        kept in double (Vec3d); everything sent to the GPU or to the float
+        SIMD paths is made relative to an origin near the camera, so float
+        precision is spent where the viewer is. Set the origin to the camera
+        position each frame, then the view matrix only carries the camera
+        rotation and the world matrices come from toRelative (or
+        Transform::getRelativeWorldAffines).
+
+        Only the translation is computed in double, the 3x3 part of each
+        matrix is copied as is. Moving the origin is just setOrigin; nothing
+        stored needs rebasing.
+    */
+    class CN_EXPORT WorldOrigin
+    {
+    public:
+
+        explicit WorldOrigin(const Vec3d &origin = Vec3d::ZERO) : m_origin(origin) {}
+
+        void setOrigin(const Vec3d &origin) { m_origin = origin; }
+        const Vec3d& getOrigin() const { return m_origin; }
+
+        Vec3 toRelative(const Vec3d &position) const { return (position - m_origin).toVec3(); }
+        Vec3d toWorld(const Vec3 &relative) const { return m_origin + Vec3d(relative); }
+
+        void toRelative(const Vec3d *positions, Vec3 *out, size_t count) const;
+        // out[i] is linears[i] with the translation replaced by positions[i] relative
+        // to the origin, the translation column of linears is ignored
+        void toRelative(const Affine3 *linears, const Vec3d *positions, Affine3 *out, size_t count) const;
+        void toRelative(const Affine3 *linears, const Vec3d *positions, Mat4 *out, size_t count) const;
+
+    private:
+
+        Vec3d m_origin;
+    };
+}
+
+#endif
@@ -23,6 +23,9 @@ typedef double Real;
 typedef float Real;
 #endif
 
+// CN_LARGE_WORLD == 1 keeps Transform positions in double whatever Real is,
+// see Math/WorldOrigin.h
+
 #define  CN_SAFE_DELETE(_PTR) do { if (_PTR){ delete _PTR; _PTR = nullptr; } } while (false);
 #define  CN_SAFE_DELETE_ARRAY(_PTR) do { if (_PTR){ delete[] _PTR; _PTR = nullptr; } } while (false);
 
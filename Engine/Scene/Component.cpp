@@ -20,6 +20,15 @@ namespace Canaan
     {
     }
 
+    void Component::setTransformChangedSubscribed(bool subscribed)
+    {
+        if (m_transformChangedSubscribed == subscribed)
+            return;
+        m_transformChangedSubscribed = subscribed;
+        if (m_attachedSO)
+            m_attachedSO->m_transformSubscriberCount += subscribed ? 1 : -1;
+    }
+
     void Component::OnAttachedSceneObject(SceneObject* so)
     {
     }
@@ -20,6 +20,11 @@ namespace Canaan
         
         Transform* GetTransform() const;
         
+        // receive onTransformChanged from TransformStore::dispatchNotifications,
+        // when the store defers them. Immediate notifications go to every component.
+        void setTransformChangedSubscribed(bool subscribed);
+        bool isTransformChangedSubscribed() const { return m_transformChangedSubscribed; }
+        
         virtual void OnAttachedSceneObject(SceneObject* so);
         virtual void OnDetachedSceneObject(SceneObject* so);
         virtual void onTransformChanged();
@@ -27,7 +32,9 @@ namespace Canaan
     protected:
         
         friend class SceneObject;
+        friend class Transform;
         bool         m_isEnabled  = true;
+        bool         m_transformChangedSubscribed = false;
         SceneObject* m_attachedSO = nullptr;
     };
 }
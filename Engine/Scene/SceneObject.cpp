@@ -7,6 +7,7 @@
 //
 
 #include "SceneObject.h"
+#include "Math/Bounds.h"
 
 namespace Canaan
 {
@@ -28,6 +29,8 @@ namespace Canaan
         if (!converted_ok)
             return nullptr;
         comp->m_attachedSO = this;
+        if (comp->m_transformChangedSubscribed)
+            ++m_transformSubscriberCount;
         comp->OnAttachedSceneObject(this);
         m_componentList.push_back(comp);
         return comp.get();
@@ -38,6 +41,8 @@ namespace Canaan
         auto iter = findComponentBy(ctype);
         if (iter != m_componentList.end())
         {
+            if ((*iter)->m_transformChangedSubscribed)
+                --m_transformSubscriberCount;
             (*iter)->m_attachedSO = nullptr;
             (*iter)->OnDetachedSceneObject(this);
             m_componentList.erase(iter);
@@ -58,6 +63,8 @@ namespace Canaan
         {
             if ((**iter).get_type().get_name().to_string() == ctype)
             {
+                if ((*iter)->m_transformChangedSubscribed)
+                    --m_transformSubscriberCount;
                 (*iter)->m_attachedSO = nullptr;
                 (*iter)->OnDetachedSceneObject(this);
                 iter = m_componentList.erase(iter);
@@ -75,6 +82,7 @@ namespace Canaan
             comp->OnDetachedSceneObject(this);
         }
         m_componentList.clear();
+        m_transformSubscriberCount = 0;
     }
 
     std::vector<Component*> SceneObject::getComponentsBy(const std::string &ctype)
@@ -102,11 +110,38 @@ namespace Canaan
     {
         child->m_parent = this;
         m_children.push_back(child);
+        cnAssert(child->m_transform->m_store == m_transform->m_store);
+        m_transform->m_store->setParent(child->m_transform->m_id, m_transform->m_id);
     }
 
     void SceneObject::removeChild(const std::shared_ptr<SceneObject>& child)
     {
         m_children.erase(std::find(m_children.begin(), m_children.end(), child));
+        child->m_parent = nullptr;
+        child->m_transform->m_store->setParent(child->m_transform->m_id, TransformStore::INVALID);
     }
 
+    AABB SceneObject::getWorldBounds()
+    {
+        if (m_localBounds.isEmpty())
+            return AABB::EMPTY;
+        AABB box = m_localBounds;
+        box.transform(m_transform->getWorldAffine());
+        return box;
+    }
+
+    AABB SceneObject::getSubtreeBounds()
+    {
+        AABBArray boxes;
+        collectWorldBounds(boxes);
+        return Bounds::merge(boxes.data(), boxes.size());
+    }
+
+    void SceneObject::collectWorldBounds(AABBArray &boxes)
+    {
+        if (!m_localBounds.isEmpty())
+            boxes.push_back(getWorldBounds());
+        for (auto &child : m_children)
+            child->collectWorldBounds(boxes);
+    }
 }
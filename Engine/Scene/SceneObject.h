@@ -3,6 +3,7 @@
 #include "Prerequisites.h"
 #include "Component.h"
 #include "Transform.h"
+#include "Math/AABB.h"
 #include <rttr/registration>
 
 namespace Canaan
@@ -46,21 +47,39 @@ namespace Canaan
         void addChild(const std::shared_ptr<SceneObject>& child);
         void removeChild(const std::shared_ptr<SceneObject>& child);
         size_t getChildrenCount() const { return m_children.size(); }
+        const std::vector<std::shared_ptr<SceneObject>>& getChildren() const { return m_children; }
         
         SceneObject* getParent() { return m_parent; }
         
+        // object space bounds of the attached geometry, e.g. Bounds::computeAABB
+        // of the mesh vertices. AABB::EMPTY (the default) for objects without any.
+        void setLocalBounds(const AABB& bounds) { m_localBounds = bounds; }
+        const AABB& getLocalBounds() const { return m_localBounds; }
+        // local bounds through the world transform
+        AABB getWorldBounds();
+        // world bounds of this object and all its descendants
+        AABB getSubtreeBounds();
+        
     private:
         
         std::vector<std::shared_ptr<Component>>::iterator findComponentBy(const std::string &type);
+        void collectWorldBounds(AABBArray &boxes);
         
     private:
         
+        friend class Component;
+        friend class Transform;
+        
         std::string                             m_name;
         std::unique_ptr<Transform>              m_transform;
         std::vector<std::shared_ptr<Component>> m_componentList;
+        // components with isTransformChangedSubscribed
+        int m_transformSubscriberCount = 0;
         
         std::vector<std::shared_ptr<SceneObject>> m_children;
-        SceneObject* m_parent;
+        SceneObject* m_parent = nullptr;
+        
+        AABB m_localBounds = AABB::EMPTY;
     };
 
     template<class T>
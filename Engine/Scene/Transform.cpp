@@ -9,100 +9,251 @@
 #include "Transform.h"
 #include "SceneObject.h"
 #include "Component.h"
+#include "Math/WorldOrigin.h"
 
 namespace Canaan
 {
-    static const int TRANSFORM_LOCAL_MATRIX_DIRTY_FLAG = 1;
-    static const int TRANSFORM_WORLD_MATRIX_DIRTY_FLAG = 1 << 1;
-    static const int TRANSFORM_ALL_FLAG = TRANSFORM_LOCAL_MATRIX_DIRTY_FLAG | TRANSFORM_WORLD_MATRIX_DIRTY_FLAG;
+#if CN_LARGE_WORLD == 1
+    // the 3x3 part of mat applied to a double offset, accumulated in double
+    static inline Vec3d TransformDirection(const Affine3& mat, const Vec3d& v)
+    {
+        return Vec3d(
+            mat[0][0] * v.x + mat[0][1] * v.y + mat[0][2] * v.z,
+            mat[1][0] * v.x + mat[1][1] * v.y + mat[1][2] * v.z,
+            mat[2][0] * v.x + mat[2][1] * v.y + mat[2][2] * v.z);
+    }
+#endif
 
     Transform::Transform()
-    : m_dirtyFlag(TRANSFORM_ALL_FLAG)
+    : Transform(TransformStore::getInstance())
+    {
+    }
+
+    Transform::Transform(TransformStore& store)
+    : m_store(&store)
     {
+        m_id = m_store->create(this);
     }
 
     Transform::~Transform()
     {
-        
+        m_store->destroy(m_id);
+    }
+
+    Mat4 Transform::getLocalMatrix()
+    {
+        return getLocalAffine().toMat4();
+    }
+
+    Mat4 Transform::getWorldMatrix()
+    {
+        return getWorldAffine().toMat4();
+    }
+
+    const Affine3& Transform::getLocalAffine()
+    {
+        return m_store->updateLocal(slot());
+    }
+
+    const Affine3& Transform::getWorldAffine()
+    {
+        return m_store->updateWorld(slot());
     }
 
-    const Mat4& Transform::getLocalMatrix()
+    void Transform::getRelativeWorldAffines(Transform* const* transforms, size_t count, const WorldOrigin& origin, Affine3* out)
     {
-        if (m_dirtyFlag & TRANSFORM_LOCAL_MATRIX_DIRTY_FLAG)
+        const Vec3d& o = origin.getOrigin();
+        for (size_t i = 0; i < count; ++i)
         {
-            m_localMat = Mat4::transform(m_localPosition, m_localScale, m_localOrientation);
+            out[i] = transforms[i]->getWorldAffine();
+#if CN_LARGE_WORLD == 1
+            const Vec3d& p = transforms[i]->m_store->m_worldPosition[transforms[i]->slot()];
+#else
+            Vec3d p = out[i].getTranslation();
+#endif
+            out[i][0][3] = Real(p.x - o.x);
+            out[i][1][3] = Real(p.y - o.y);
+            out[i][2][3] = Real(p.z - o.z);
         }
-        return m_localMat;
     }
 
-    const Mat4& Transform::getWorldMatrix()
+    void Transform::getRelativeWorldMatrices(Transform* const* transforms, size_t count, const WorldOrigin& origin, Mat4* out)
     {
-        if (m_dirtyFlag & TRANSFORM_WORLD_MATRIX_DIRTY_FLAG)
+        for (size_t i = 0; i < count; ++i)
         {
-            m_worldMat = m_attachedSO->getParent() ? m_attachedSO->getParent()->getTransform()->getWorldMatrix() * getLocalMatrix(): getLocalMatrix();
+            Affine3 mat;
+            getRelativeWorldAffines(transforms + i, 1, origin, &mat);
+            out[i] = mat.toMat4();
         }
-        return m_worldMat;
     }
     
-    void Transform::setLocalPosition(const Vec3& pos)
+    const Mat3& Transform::getNormalMatrix()
     {
-        m_localPosition = pos;
-        m_dirtyFlag |= TRANSFORM_LOCAL_MATRIX_DIRTY_FLAG;
-        m_dirtyFlag |= TRANSFORM_WORLD_MATRIX_DIRTY_FLAG;
-        onNotifyTransformChanged();
+        Transform* self = this;
+        getNormalMatrices(&self, 1, nullptr);
+        return m_store->m_normalMat[slot()];
+    }
+
+    void Transform::getNormalMatrices(Transform* const* transforms, size_t count, Mat3* out)
+    {
+        // stale ones split by the uniform scale shortcut, then one batch each
+        std::vector<Transform*> stale[2];
+        std::vector<Affine3> worldMats[2];
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Affine3& worldMat = transforms[i]->getWorldAffine();
+            TransformStore& store = *transforms[i]->m_store;
+            uint32_t slot = transforms[i]->slot();
+            if (store.m_normalVersion[slot] != store.m_worldVersion[slot])
+            {
+                int uniform = transforms[i]->hasUniformWorldScale() ? 1 : 0;
+                stale[uniform].push_back(transforms[i]);
+                worldMats[uniform].push_back(worldMat);
+            }
+        }
+        Mat3Array normalMats;
+        for (int uniform = 0; uniform < 2; ++uniform)
+        {
+            normalMats.resize(stale[uniform].size());
+            Affine3::normalMatrices(worldMats[uniform].data(), normalMats.data(), normalMats.size(), uniform == 1);
+            for (size_t i = 0; i < normalMats.size(); ++i)
+            {
+                TransformStore& store = *stale[uniform][i]->m_store;
+                uint32_t slot = stale[uniform][i]->slot();
+                store.m_normalMat[slot] = normalMats[i];
+                store.m_normalVersion[slot] = store.m_worldVersion[slot];
+            }
+        }
+        if (out)
+        {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = transforms[i]->m_store->m_normalMat[transforms[i]->slot()];
+        }
     }
 
-    const Vec3& Transform::getLocalPosition() const
+    bool Transform::hasUniformWorldScale() const
     {
-        return m_localPosition;
+        for (const Transform* t = this; t; t = t->getParent())
+        {
+            const Vec3& scale = t->getLocalScale();
+            if (scale.x != scale.y || scale.x != scale.z)
+                return false;
+        }
+        return true;
     }
     
-    void Transform::setWorldPosition(Vec3 pos)
+    void Transform::getWorldPoses(Transform* const* transforms, size_t count, Vec3* positions, Quat* orientations)
     {
-        if (m_attachedSO->getParent())
+        Affine3 worldMat;
+        for (size_t i = 0; i < count; ++i)
         {
-            Mat4 worldMat = m_attachedSO->getParent()->getTransform()->getWorldMatrix();
-            worldMat.inverse();
-            setLocalPosition(worldMat * pos);
+            Transform* parent = transforms[i]->getParent();
+            if (i > 0 && parent == transforms[i - 1])
+            {
+                worldMat = worldMat * transforms[i]->getLocalAffine();
+                orientations[i] = orientations[i - 1] * transforms[i]->getLocalOrientation();
+            }
+            else
+            {
+                worldMat = transforms[i]->getWorldAffine();
+                orientations[i] = transforms[i]->getWorldOrientation();
+            }
+            positions[i] = worldMat.getTranslation();
         }
-        else
+    }
+
+    void Transform::setWorldOrientations(Transform* const* transforms, const Quat* orientations, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
         {
-            setLocalPosition(pos);
+            Transform* parent = transforms[i]->getParent();
+            if (parent)
+            {
+                if (i > 0 && parent == transforms[i - 1])
+                {
+                    Quat parentRot = orientations[i - 1];
+                    parentRot.inverse();
+                    transforms[i]->setLocalOrientation(parentRot * orientations[i]);
+                }
+                else
+                {
+                    transforms[i]->setWorldOrientation(orientations[i]);
+                }
+            }
+            else
+            {
+                transforms[i]->setLocalOrientation(orientations[i]);
+            }
         }
     }
 
-    Vec3 Transform::getWorldPosition() const
+    void Transform::setLocalPosition(const WorldVec3& pos)
+    {
+        uint32_t i = slot();
+        m_store->m_localPosition[i] = pos;
+        m_store->m_flags[i] |= TransformStore::LOCAL_DIRTY;
+        m_store->markWorldDirty(i);
+        onNotifyTransformChanged();
+    }
+
+    const WorldVec3& Transform::getLocalPosition() const
     {
-        if (m_attachedSO->getParent())
+        return m_store->m_localPosition[slot()];
+    }
+    
+    void Transform::setWorldPosition(WorldVec3 pos)
+    {
+        Transform* parent = getParent();
+        if (parent)
         {
-            return m_attachedSO->getParent()->getTransform()->getWorldMatrix() * m_localPosition;
+            uint32_t p = parent->slot();
+            m_store->updateInverseWorld(p);
+#if CN_LARGE_WORLD == 1
+            // solve in double relative to the parent's position, only the 3x3 part is inverted
+            setLocalPosition(TransformDirection(m_store->m_inverseWorldMat[p], pos - m_store->m_worldPosition[p]));
+#else
+            setLocalPosition(m_store->m_inverseWorldMat[p] * pos);
+#endif
         }
         else
         {
-            return m_localPosition;
+            setLocalPosition(pos);
         }
     }
+
+    WorldVec3 Transform::getWorldPosition() const
+    {
+        uint32_t i = slot();
+#if CN_LARGE_WORLD == 1
+        m_store->updateWorld(i);
+        return m_store->m_worldPosition[i];
+#else
+        return m_store->updateWorld(i).getTranslation();
+#endif
+    }
     
     void Transform::setLocalOrientation(const Quat& rot)
     {
-        m_localOrientation = rot;
-        m_dirtyFlag |= TRANSFORM_LOCAL_MATRIX_DIRTY_FLAG;
-        m_dirtyFlag |= TRANSFORM_WORLD_MATRIX_DIRTY_FLAG;
+        uint32_t i = slot();
+        m_store->m_localOrientation[i] = rot;
+        m_store->m_flags[i] |= TransformStore::LOCAL_DIRTY;
+        m_store->markWorldDirty(i);
         onNotifyTransformChanged();
     }
 
     const Quat& Transform::getLocalOrientation() const
     {
-        return m_localOrientation;
+        return m_store->m_localOrientation[slot()];
     }
     
     void Transform::setWorldOrientation(Quat rot)
     {
-        if (m_attachedSO->getParent())
+        Transform* parent = getParent();
+        if (parent)
         {
-            Quat worldRot = m_attachedSO->getParent()->getTransform()->getWorldOrientation();
-            worldRot.inverse();
-            setLocalOrientation(worldRot * rot);
+            uint32_t p = parent->slot();
+            m_store->updateInverseWorld(p);
+            setLocalOrientation(m_store->m_inverseWorldOrientation[p] * rot);
         }
         else
         {
@@ -112,34 +263,33 @@ namespace Canaan
 
     Quat Transform::getWorldOrientation() const
     {
-        if (m_attachedSO->getParent())
-        {
-            return m_attachedSO->getParent()->getTransform()->getWorldOrientation() * m_localOrientation;
-        }
-        else
-        {
-            return m_localOrientation;
-        }
+        uint32_t i = slot();
+        m_store->updateWorld(i);
+        return m_store->m_worldOrientation[i];
     }
     
     void Transform::setLocalScale(const Vec3& scl)
     {
-        m_localScale = scl;
-        m_dirtyFlag |= TRANSFORM_LOCAL_MATRIX_DIRTY_FLAG;
-        m_dirtyFlag |= TRANSFORM_WORLD_MATRIX_DIRTY_FLAG;
+        uint32_t i = slot();
+        m_store->m_localScale[i] = scl;
+        m_store->m_flags[i] |= TransformStore::LOCAL_DIRTY;
+        m_store->markWorldDirty(i);
         onNotifyTransformChanged();
     }
 
     const Vec3& Transform::getLocalScale() const
     {
-        return m_localScale;
+        return m_store->m_localScale[slot()];
     }
     
     void Transform::setWorldScale(Vec3 scl)
     {
-        if (m_attachedSO->getParent())
+        Transform* parent = getParent();
+        if (parent)
         {
-            setLocalScale(scl / m_attachedSO->getParent()->getTransform()->getWorldScale());
+            uint32_t p = parent->slot();
+            m_store->updateWorld(p);
+            setLocalScale(scl / m_store->m_worldScale[p]);
         }
         else
         {
@@ -149,23 +299,40 @@ namespace Canaan
 
     Vec3 Transform::getWorldScale() const
     {
-        if (m_attachedSO->getParent())
+        uint32_t i = slot();
+        m_store->updateWorld(i);
+        return m_store->m_worldScale[i];
+    }
+
+    Transform* Transform::getParent() const
+    {
+        uint32_t parent = m_store->m_parent[slot()];
+        return parent == TransformStore::INVALID ? nullptr : m_store->m_transform[parent];
+    }
+
+    void Transform::onNotifyTransformChanged()
+    {
+        if (m_store->m_deferNotifications)
         {
-            return m_attachedSO->getParent()->getTransform()->getWorldScale() * m_localScale;
+            m_store->queueNotification(slot());
+            return;
         }
-        else
+        if (m_attachedSO == nullptr)
+            return;
+        for (auto &comp : m_attachedSO->getAllComponent())
         {
-            return m_localScale;
+            comp->onTransformChanged();
         }
     }
 
-    void Transform::onNotifyTransformChanged()
+    void Transform::dispatchTransformChanged()
     {
-        if (m_attachedSO == nullptr)
+        if (m_attachedSO == nullptr || m_attachedSO->m_transformSubscriberCount == 0)
             return;
         for (auto &comp : m_attachedSO->getAllComponent())
         {
-            comp->onTransformChanged();
+            if (comp->m_transformChangedSubscribed)
+                comp->onTransformChanged();
         }
     }
 }
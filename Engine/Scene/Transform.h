@@ -2,27 +2,86 @@
 #define _CN_TRANSFORM_
 #include "Prerequisites.h"
 #include "Math/Matrix4.h"
+#include "Math/Matrix3.h"
+#include "Math/Affine3.h"
 #include "Math/Vector3.h"
 #include "Math/Quaternion.h"
+#include "Math/Vector3d.h"
+#include "TransformStore.h"
 
 namespace Canaan
 {
     class SceneObject;
+    class WorldOrigin;
+    /*
+        Positions are WorldVec3: double in the large world mode
+        (CN_LARGE_WORLD), where the world translation is accumulated in
+        double from the root down while rotations, scales and the matrices
+        stay Real. The translation of getWorldAffine / getWorldMatrix is then
+        rounded to Real; render from getRelativeWorldAffines instead, which
+        rebases onto a WorldOrigin near the camera.
+
+        The data lives in a TransformStore, a Transform is the handle of one
+        of its nodes; the references returned here point into the store.
+        Transforms are not thread safe: construct, destroy and modify them on
+        the thread that owns their store only (see TransformStore).
+    */
     class CN_EXPORT Transform
     {
     public:
         
         Transform();
+        // a root node of store rather than TransformStore::getInstance()
+        explicit Transform(TransformStore& store);
         ~Transform();
+        Transform(const Transform&) = delete;
+        Transform& operator=(const Transform&) = delete;
+        
+        TransformStore* getStore() const { return m_store; }
+        uint32_t getId() const { return m_id; }
+        
+        // the matrices are kept as 3x4 affines, these expand them on request
+        Mat4 getLocalMatrix();
+        Mat4 getWorldMatrix();
+        
+        const Affine3& getLocalAffine();
+        const Affine3& getWorldAffine();
         
-        const Mat4& getLocalMatrix();
-        const Mat4& getWorldMatrix();
+        // bumped every time the matrix is recomputed after a change; compare
+        // with a stored value to tell whether it changed since. A change marks
+        // the world matrices of the whole subtree dirty, they are recomputed
+        // on the next read only.
+        uint32_t getLocalVersion() const { return m_store->m_localVersion[slot()]; }
+        uint32_t getWorldVersion() const { return m_store->m_worldVersion[slot()]; }
         
-        void setLocalPosition(const Vec3& pos);
-        const Vec3& getLocalPosition() const;
+        // world affines with the translation relative to origin, in bulk
+        static void getRelativeWorldAffines(Transform* const* transforms, size_t count, const WorldOrigin& origin, Affine3* out);
+        static void getRelativeWorldMatrices(Transform* const* transforms, size_t count, const WorldOrigin& origin, Mat4* out);
         
-        void setWorldPosition(Vec3 pos);
-        Vec3 getWorldPosition() const;
+        // inverse transpose of the world 3x3, for normals. Cached and only
+        // recomputed when the world version changes; the uniform scale shortcut of
+        // Mat4::normalMatrices is taken when this and every ancestor scale uniformly.
+        const Mat3& getNormalMatrix();
+        // getNormalMatrix in bulk, the stale caches are recomputed in one batch
+        static void getNormalMatrices(Transform* const* transforms, size_t count, Mat3* out);
+        
+        // world positions and orientations in bulk, e.g. the joints of IK
+        // chains. A transform listed right after its parent continues from
+        // it instead of walking up the hierarchy again.
+        static void getWorldPoses(Transform* const* transforms, size_t count, Vec3* positions, Quat* orientations);
+        // setWorldOrientation in bulk, parents listed before their children
+        // use the orientation given here rather than the old one
+        static void setWorldOrientations(Transform* const* transforms, const Quat* orientations, size_t count);
+        
+        void setLocalPosition(const WorldVec3& pos);
+        const WorldVec3& getLocalPosition() const;
+        
+        // the world position, orientation and scale are cached with the world
+        // matrix and go stale with it, so reads of a clean transform are O(1).
+        // The world setters solve against the parent's cached inverse, which
+        // is refreshed only when the parent's world version changes.
+        void setWorldPosition(WorldVec3 pos);
+        WorldVec3 getWorldPosition() const;
         
         void setLocalOrientation(const Quat& rot);
         const Quat& getLocalOrientation() const;
@@ -38,20 +97,21 @@ namespace Canaan
         
     private:
         
+        uint32_t slot() const { return m_store->getSlot(m_id); }
         void onNotifyTransformChanged();
+        // the subscribed components, from TransformStore::dispatchNotifications
+        void dispatchTransformChanged();
+        Transform* getParent() const;
+        bool hasUniformWorldScale() const;
         
     private:
         
-        Mat4 m_localMat;
-        Mat4 m_worldMat;
-        Vec3 m_localPosition;
-        Vec3 m_localScale       = Vec3::UNIT_SCALE;
-        Quat m_localOrientation = Quat::IDENTITY;
+        TransformStore* m_store;
+        uint32_t m_id;
         
         friend class SceneObject;
+        friend class TransformStore;
         SceneObject* m_attachedSO = nullptr;
-        
-        int m_dirtyFlag = 0;
     };
 }
 
@@ -0,0 +1,486 @@
+#include "TransformStore.h"
+#include "Transform.h"
+#include "Math/Parallel.h"
+
+namespace Canaan
+{
+    // largest range of slots in one task of the parallel update, also the
+    // size below which the update stays serial
+    static const uint32_t HIERARCHY_TASK_SLOTS = 4096;
+
+#if CN_LARGE_WORLD == 1
+    // the 3x3 part of mat applied to a double offset, accumulated in double
+    static inline Vec3d TransformDirection(const Affine3& mat, const Vec3d& v)
+    {
+        return Vec3d(
+            mat[0][0] * v.x + mat[0][1] * v.y + mat[0][2] * v.z,
+            mat[1][0] * v.x + mat[1][1] * v.y + mat[1][2] * v.z,
+            mat[2][0] * v.x + mat[2][1] * v.y + mat[2][2] * v.z);
+    }
+
+    static inline Vec3 ToVec3(const Vec3d& v) { return v.toVec3(); }
+#else
+    static inline const Vec3& ToVec3(const Vec3& v) { return v; }
+#endif
+
+    // v[i] = old v[order[i]]
+    template<class T>
+    static void Permute(std::vector<T> &v, const std::vector<uint32_t> &order)
+    {
+        std::vector<T> sorted;
+        sorted.reserve(order.size());
+        for (uint32_t slot : order)
+            sorted.push_back(v[slot]);
+        v.swap(sorted);
+    }
+
+    static void RemapSlots(std::vector<uint32_t> &slots, const std::vector<uint32_t> &newSlot)
+    {
+        for (uint32_t &slot : slots)
+            slot = slot == TransformStore::INVALID ? slot : newSlot[slot];
+    }
+
+    const uint32_t TransformStore::INVALID;
+
+    TransformStore& TransformStore::getInstance()
+    {
+        // never destroyed, Transforms in static objects may outlive any static store
+        static TransformStore *s_store = new TransformStore();
+        return *s_store;
+    }
+
+    TransformStore::TransformStore()
+    : m_ownerThread(std::this_thread::get_id())
+    {
+
+    }
+
+    TransformStore::~TransformStore()
+    {
+
+    }
+
+    uint32_t TransformStore::create(Transform *transform)
+    {
+        cnAssert(isOwnerThread());
+        // compact once most slots are garbage
+        if (m_destroyedCount > 1024 && m_destroyedCount * 2 > m_parent.size())
+            sort();
+
+        uint32_t id;
+        if (m_freeIds.empty())
+        {
+            id = uint32_t(m_slotOfId.size());
+            m_slotOfId.push_back(INVALID);
+        }
+        else
+        {
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
+        }
+        m_slotOfId[id] = uint32_t(m_parent.size());
+
+        m_localPosition.push_back(WorldVec3());
+        m_localOrientation.push_back(Quat::IDENTITY);
+        m_localScale.push_back(Vec3::UNIT_SCALE);
+        m_localMat.push_back(Affine3::IDENTITY);
+        m_worldMat.push_back(Affine3::IDENTITY);
+        m_worldOrientation.push_back(Quat::IDENTITY);
+        m_worldScale.push_back(Vec3::UNIT_SCALE);
+#if CN_LARGE_WORLD == 1
+        m_worldPosition.push_back(Vec3d());
+#endif
+        m_normalMat.push_back(Mat3::IDENTITY);
+        m_flags.push_back(LOCAL_DIRTY | WORLD_DIRTY);
+        m_localVersion.push_back(0);
+        m_worldVersion.push_back(0);
+        m_normalVersion.push_back(0);
+        m_inverseWorldMat.push_back(Affine3::IDENTITY);
+        m_inverseWorldOrientation.push_back(Quat::IDENTITY);
+        m_inverseVersion.push_back(0);
+        m_parent.push_back(INVALID);
+        m_firstChild.push_back(INVALID);
+        m_nextSibling.push_back(INVALID);
+        m_prevSibling.push_back(INVALID);
+        m_subtreeEnd.push_back(uint32_t(m_parent.size()));
+        m_idOfSlot.push_back(id);
+        m_transform.push_back(transform);
+        return id;
+    }
+
+    void TransformStore::destroy(uint32_t id)
+    {
+        cnAssert(isOwnerThread());
+        uint32_t slot = m_slotOfId[id];
+        unlink(slot);
+        for (uint32_t child = m_firstChild[slot]; child != INVALID;)
+        {
+            uint32_t next = m_nextSibling[child];
+            m_parent[child] = INVALID;
+            m_nextSibling[child] = INVALID;
+            m_prevSibling[child] = INVALID;
+            markWorldDirty(child);
+            if (m_deferNotifications)
+                queueNotification(child);
+            child = next;
+        }
+        m_firstChild[slot] = INVALID;
+        m_flags[slot] = DESTROYED;
+        m_idOfSlot[slot] = INVALID;
+        m_transform[slot] = nullptr;
+        m_slotOfId[id] = INVALID;
+        m_freeIds.push_back(id);
+        ++m_destroyedCount;
+    }
+
+    void TransformStore::setParent(uint32_t id, uint32_t parentId)
+    {
+        cnAssert(isOwnerThread());
+        uint32_t slot = m_slotOfId[id];
+        uint32_t parentSlot = parentId == INVALID ? INVALID : m_slotOfId[parentId];
+        if (m_parent[slot] == parentSlot)
+            return;
+        unlink(slot);
+        if (parentSlot != INVALID)
+        {
+            m_parent[slot] = parentSlot;
+            m_nextSibling[slot] = m_firstChild[parentSlot];
+            if (m_firstChild[parentSlot] != INVALID)
+                m_prevSibling[m_firstChild[parentSlot]] = slot;
+            m_firstChild[parentSlot] = slot;
+            if (parentSlot > slot)
+                m_sorted = false;
+        }
+        m_contiguous = false;
+        markWorldDirty(slot);
+        if (m_deferNotifications)
+            queueNotification(slot);
+    }
+
+    void TransformStore::updateWorldMatrices()
+    {
+        cnAssert(isOwnerThread());
+        if (ParallelWorkerCount() > 0 && m_parent.size() > HIERARCHY_TASK_SLOTS)
+        {
+            updateWorldMatricesParallel();
+            return;
+        }
+        if (!m_sorted || m_destroyedCount)
+            sort();
+        // parents are up to date before their children are reached, so
+        // updateWorld never walks up here
+        uint32_t count = uint32_t(m_parent.size());
+        for (uint32_t slot = 0; slot < count; ++slot)
+        {
+            if (m_flags[slot] & WORLD_DIRTY)
+                updateWorld(slot);
+        }
+    }
+
+    void TransformStore::updateWorldMatricesParallel()
+    {
+        if (!m_contiguous || m_destroyedCount)
+            sort();
+
+        // walk the large subtrees from the roots down, updating their root
+        // nodes here and cutting the small subtrees below them into tasks of
+        // adjacent ranges. A cursor is the next subtree and the end of its
+        // parent's range, the roots are the children of a virtual root.
+        std::vector<std::pair<uint32_t, uint32_t>> tasks;
+        std::vector<std::pair<uint32_t, uint32_t>> cursors;
+        cursors.push_back(std::make_pair(0u, uint32_t(m_parent.size())));
+        uint32_t taskBegin = 0, taskEnd = 0;
+        while (!cursors.empty())
+        {
+            uint32_t slot = cursors.back().first;
+            if (slot >= cursors.back().second)
+            {
+                cursors.pop_back();
+                continue;
+            }
+            uint32_t end = m_subtreeEnd[slot];
+            cursors.back().first = end;
+            if (end - slot <= HIERARCHY_TASK_SLOTS)
+            {
+                if (taskEnd == slot && end - taskBegin <= HIERARCHY_TASK_SLOTS)
+                {
+                    taskEnd = end;
+                    continue;
+                }
+                if (taskEnd > taskBegin)
+                    tasks.push_back(std::make_pair(taskBegin, taskEnd));
+                taskBegin = slot;
+                taskEnd = end;
+            }
+            else
+            {
+                updateWorld(slot);
+                cursors.push_back(std::make_pair(slot + 1, end));
+            }
+        }
+        if (taskEnd > taskBegin)
+            tasks.push_back(std::make_pair(taskBegin, taskEnd));
+
+        // within a task parents still come first, the parents of its
+        // subtrees are up to date already
+        ParallelTasks(tasks.size(), [&](size_t task){
+            for (uint32_t slot = tasks[task].first; slot < tasks[task].second; ++slot)
+            {
+                if (m_flags[slot] & WORLD_DIRTY)
+                    updateWorld(slot);
+            }
+        });
+    }
+
+    const Affine3& TransformStore::updateLocal(uint32_t slot)
+    {
+        if (m_flags[slot] & LOCAL_DIRTY)
+        {
+            m_localMat[slot] = Affine3::transform(ToVec3(m_localPosition[slot]), m_localScale[slot], m_localOrientation[slot]);
+            m_flags[slot] &= ~LOCAL_DIRTY;
+            ++m_localVersion[slot];
+        }
+        return m_localMat[slot];
+    }
+
+    const Affine3& TransformStore::updateWorld(uint32_t slot)
+    {
+        if (!(m_flags[slot] & WORLD_DIRTY))
+            return m_worldMat[slot];
+        // the dirty ancestors form a chain up from the parent, update them
+        // top down; never taken by the bulk updates, whose parents are done
+        uint32_t parent = m_parent[slot];
+        if (parent != INVALID && (m_flags[parent] & WORLD_DIRTY))
+        {
+            m_walkStack.clear();
+            for (; parent != INVALID && (m_flags[parent] & WORLD_DIRTY); parent = m_parent[parent])
+                m_walkStack.push_back(parent);
+            while (!m_walkStack.empty())
+            {
+                computeWorld(m_walkStack.back());
+                m_walkStack.pop_back();
+            }
+        }
+        computeWorld(slot);
+        return m_worldMat[slot];
+    }
+
+    void TransformStore::computeWorld(uint32_t slot)
+    {
+        uint32_t parent = m_parent[slot];
+        const Affine3& localMat = updateLocal(slot);
+        if (parent != INVALID)
+        {
+            const Affine3& parentMat = m_worldMat[parent];
+            m_worldMat[slot] = parentMat * localMat;
+            m_worldOrientation[slot] = m_worldOrientation[parent] * m_localOrientation[slot];
+            m_worldScale[slot] = m_worldScale[parent] * m_localScale[slot];
+#if CN_LARGE_WORLD == 1
+            m_worldPosition[slot] = m_worldPosition[parent] + TransformDirection(parentMat, m_localPosition[slot]);
+#endif
+        }
+        else
+        {
+            m_worldMat[slot] = localMat;
+            m_worldOrientation[slot] = m_localOrientation[slot];
+            m_worldScale[slot] = m_localScale[slot];
+#if CN_LARGE_WORLD == 1
+            m_worldPosition[slot] = m_localPosition[slot];
+#endif
+        }
+#if CN_LARGE_WORLD == 1
+        m_worldMat[slot][0][3] = Real(m_worldPosition[slot].x);
+        m_worldMat[slot][1][3] = Real(m_worldPosition[slot].y);
+        m_worldMat[slot][2][3] = Real(m_worldPosition[slot].z);
+#endif
+        m_flags[slot] &= ~WORLD_DIRTY;
+        ++m_worldVersion[slot];
+    }
+
+    void TransformStore::updateInverseWorld(uint32_t slot)
+    {
+        updateWorld(slot);
+        if (m_inverseVersion[slot] != m_worldVersion[slot])
+        {
+            // may carry non-uniform scale under rotation, so the general affine inverse
+            m_inverseWorldMat[slot] = m_worldMat[slot];
+            m_inverseWorldMat[slot].inverse();
+            m_inverseWorldOrientation[slot] = m_worldOrientation[slot];
+            m_inverseWorldOrientation[slot].inverse();
+            m_inverseVersion[slot] = m_worldVersion[slot];
+        }
+    }
+
+    void TransformStore::markWorldDirty(uint32_t slot)
+    {
+        // descendants of a dirty transform are dirty already
+        if (m_flags[slot] & WORLD_DIRTY)
+            return;
+        m_flags[slot] |= WORLD_DIRTY;
+        m_walkStack.clear();
+        m_walkStack.push_back(slot);
+        while (!m_walkStack.empty())
+        {
+            uint32_t parent = m_walkStack.back();
+            m_walkStack.pop_back();
+            for (uint32_t child = m_firstChild[parent]; child != INVALID; child = m_nextSibling[child])
+            {
+                if (m_flags[child] & WORLD_DIRTY)
+                    continue;
+                m_flags[child] |= WORLD_DIRTY;
+                m_walkStack.push_back(child);
+            }
+        }
+    }
+
+    void TransformStore::queueNotification(uint32_t slot)
+    {
+        if (m_flags[slot] & NOTIFY_PENDING)
+            return;
+        m_flags[slot] |= NOTIFY_PENDING;
+        m_changedIds.push_back(m_idOfSlot[slot]);
+    }
+
+    void TransformStore::setDeferredNotifications(bool deferred)
+    {
+        if (m_deferNotifications && !deferred)
+            dispatchNotifications();
+        m_deferNotifications = deferred;
+    }
+
+    size_t TransformStore::dispatchNotifications()
+    {
+        // gather the changed subtrees breadth first, as slots; a subtree
+        // reached before is skipped whole, its descendants were reached with it
+        m_notifyIds.clear();
+        for (uint32_t id : m_changedIds)
+        {
+            // destroyed since, or the id was reused by a transform not changed yet
+            uint32_t slot = m_slotOfId[id];
+            if (slot == INVALID || !(m_flags[slot] & NOTIFY_PENDING))
+                continue;
+            m_flags[slot] &= ~NOTIFY_PENDING;
+            if (m_flags[slot] & NOTIFY_VISITED)
+                continue;
+            m_flags[slot] |= NOTIFY_VISITED;
+            size_t i = m_notifyIds.size();
+            m_notifyIds.push_back(slot);
+            for (; i < m_notifyIds.size(); ++i)
+            {
+                for (uint32_t child = m_firstChild[m_notifyIds[i]]; child != INVALID; child = m_nextSibling[child])
+                {
+                    if (m_flags[child] & NOTIFY_VISITED)
+                        continue;
+                    m_flags[child] |= NOTIFY_VISITED;
+                    m_notifyIds.push_back(child);
+                }
+            }
+        }
+        m_changedIds.clear();
+
+        // the callbacks may create, reparent or destroy transforms, which
+        // moves slots and reuses ids, so the slots are turned into ids before
+        // any of them runs. The flag moves with the slot; a transform created
+        // since under a reused id does not have it
+        for (uint32_t &slot : m_notifyIds)
+            slot = m_idOfSlot[slot];
+        size_t count = 0;
+        for (size_t i = 0; i < m_notifyIds.size(); ++i)
+        {
+            uint32_t slot = m_slotOfId[m_notifyIds[i]];
+            if (slot == INVALID || !(m_flags[slot] & NOTIFY_VISITED))
+                continue;
+            m_flags[slot] &= ~NOTIFY_VISITED;
+            m_transform[slot]->dispatchTransformChanged();
+            ++count;
+        }
+        return count;
+    }
+
+    void TransformStore::unlink(uint32_t slot)
+    {
+        uint32_t parent = m_parent[slot];
+        if (parent == INVALID)
+            return;
+        if (m_prevSibling[slot] != INVALID)
+            m_nextSibling[m_prevSibling[slot]] = m_nextSibling[slot];
+        else
+            m_firstChild[parent] = m_nextSibling[slot];
+        if (m_nextSibling[slot] != INVALID)
+            m_prevSibling[m_nextSibling[slot]] = m_prevSibling[slot];
+        m_parent[slot] = INVALID;
+        m_nextSibling[slot] = INVALID;
+        m_prevSibling[slot] = INVALID;
+    }
+
+    void TransformStore::sort()
+    {
+        // depth first from the roots in slot order, children in the order they were added
+        std::vector<uint32_t> order;
+        order.reserve(m_parent.size() - m_destroyedCount);
+        std::vector<uint32_t> stack;
+        for (uint32_t root = 0; root < m_parent.size(); ++root)
+        {
+            if ((m_flags[root] & DESTROYED) || m_parent[root] != INVALID)
+                continue;
+            stack.push_back(root);
+            while (!stack.empty())
+            {
+                uint32_t slot = stack.back();
+                stack.pop_back();
+                order.push_back(slot);
+                for (uint32_t child = m_firstChild[slot]; child != INVALID; child = m_nextSibling[child])
+                    stack.push_back(child);
+            }
+        }
+
+        std::vector<uint32_t> newSlot(m_parent.size(), INVALID);
+        for (uint32_t slot = 0; slot < order.size(); ++slot)
+            newSlot[order[slot]] = slot;
+
+        Permute(m_localPosition, order);
+        Permute(m_localOrientation, order);
+        Permute(m_localScale, order);
+        Permute(m_localMat, order);
+        Permute(m_worldMat, order);
+        Permute(m_worldOrientation, order);
+        Permute(m_worldScale, order);
+#if CN_LARGE_WORLD == 1
+        Permute(m_worldPosition, order);
+#endif
+        Permute(m_normalMat, order);
+        Permute(m_flags, order);
+        Permute(m_localVersion, order);
+        Permute(m_worldVersion, order);
+        Permute(m_normalVersion, order);
+        Permute(m_inverseWorldMat, order);
+        Permute(m_inverseWorldOrientation, order);
+        Permute(m_inverseVersion, order);
+        Permute(m_parent, order);
+        Permute(m_firstChild, order);
+        Permute(m_nextSibling, order);
+        Permute(m_prevSibling, order);
+        Permute(m_idOfSlot, order);
+        Permute(m_transform, order);
+        RemapSlots(m_parent, newSlot);
+        RemapSlots(m_firstChild, newSlot);
+        RemapSlots(m_nextSibling, newSlot);
+        RemapSlots(m_prevSibling, newSlot);
+        for (uint32_t slot = 0; slot < order.size(); ++slot)
+            m_slotOfId[m_idOfSlot[slot]] = slot;
+
+        // children follow their parent, so subtree ends accumulate backwards
+        m_subtreeEnd.resize(order.size());
+        for (uint32_t slot = 0; slot < order.size(); ++slot)
+            m_subtreeEnd[slot] = slot + 1;
+        for (uint32_t slot = uint32_t(order.size()); slot-- > 0;)
+        {
+            if (m_parent[slot] != INVALID)
+                m_subtreeEnd[m_parent[slot]] = std::max(m_subtreeEnd[m_parent[slot]], m_subtreeEnd[slot]);
+        }
+
+        m_destroyedCount = 0;
+        m_sorted = true;
+        m_contiguous = true;
+    }
+}
@@ -0,0 +1,180 @@
+#ifndef _CN_TRANSFORM_STORE_
+#define _CN_TRANSFORM_STORE_
+#include "Prerequisites.h"
+#include "Math/Affine3.h"
+#include "Math/Matrix3.h"
+#include "Math/Vector3.h"
+#include "Math/Quaternion.h"
+#include "Math/Vector3d.h"
+#include <stdint.h>
+#include <thread>
+
+namespace Canaan
+{
+    class Transform;
+    /*
+        Scene-wide storage of every Transform: local TRS, local and world
+        matrices, world TRS, dirty flags, versions and the hierarchy links live in
+        parallel arrays indexed by slot, and a Transform is a handle holding
+        its id. Ids are stable for the life of the Transform, slots are not.
+
+        Slots are kept sorted so a parent comes before its children, and
+        updateWorldMatrices recomputes every dirty world matrix in one
+        linear pass over them. Reparenting under a later slot only flags
+        the order; the next update re-sorts the slots depth first, which
+        also drops the slots of destroyed transforms. Reads through
+        Transform stay lazy and walk up the parent slots as before.
+        The world TRS and the inverses used by the world setters are
+        cached per slot alongside the world matrix.
+
+        With worker threads (Parallel.h) and more than a few thousand
+        slots the update runs in parallel instead. The depth first order
+        keeps every subtree in a contiguous range of slots; the nodes with
+        large subtrees are updated first on the calling thread, then the
+        ranges of small subtrees below them become tasks for ParallelTasks.
+        Each matrix is computed by the same code as the serial pass, so the
+        results are identical. Any reparenting re-sorts before a parallel
+        update.
+
+        References into the arrays (e.g. Transform::getWorldAffine) are
+        valid until the next create, setParent or updateWorldMatrices.
+
+        A store is not synchronized. Its transforms are created, destroyed,
+        reparented and modified on the thread that constructed it only; for
+        getInstance that is the thread of its first use, the main thread in
+        practice. Build objects on a loading thread in a store of their own.
+        create, destroy, setParent and updateWorldMatrices check the thread
+        with cnAssert in debug builds.
+
+        Changes reach the components through Component::onTransformChanged.
+        By default every setter notifies every component of its object right
+        away. With deferred notifications the setters, reparenting included,
+        only add the transform to a set of changed ones; dispatchNotifications
+        then notifies each changed transform and each of its descendants once,
+        and only the components that subscribed. Call it once per frame, e.g.
+        after updateWorldMatrices, and not from the callbacks; changes made by
+        the callbacks wait for the next dispatch.
+    */
+    class CN_EXPORT TransformStore
+    {
+    public:
+
+        static const uint32_t INVALID = 0xffffffff;
+
+        // the store every Transform is created in
+        static TransformStore& getInstance();
+
+        TransformStore();
+        ~TransformStore();
+
+        // a new root at identity owned by transform, returns its id
+        uint32_t create(Transform *transform);
+        // children of id become roots
+        void destroy(uint32_t id);
+        // INVALID parentId makes id a root
+        void setParent(uint32_t id, uint32_t parentId);
+
+        uint32_t getSlot(uint32_t id) const { return m_slotOfId[id]; }
+        // slots in use, destroyed ones included until the next sort
+        size_t getSlotCount() const { return m_parent.size(); }
+        bool isSorted() const { return m_sorted; }
+
+        // sorts the slots if needed, then brings every world matrix up to date
+        void updateWorldMatrices();
+
+        // per slot, parents first once sorted; INVALID for roots
+        const uint32_t* getParentSlots() const { return m_parent.data(); }
+        const Affine3* getWorldAffines() const { return m_worldMat.data(); }
+
+        // turning it off dispatches the pending changes first
+        void setDeferredNotifications(bool deferred);
+        bool isDeferringNotifications() const { return m_deferNotifications; }
+        // returns the number of transforms notified
+        size_t dispatchNotifications();
+
+    private:
+
+        enum
+        {
+            LOCAL_DIRTY = 1,
+            WORLD_DIRTY = 1 << 1,
+            DESTROYED   = 1 << 2,
+            // in m_changedIds
+            NOTIFY_PENDING = 1 << 3,
+            // reached by the current dispatch, until notified
+            NOTIFY_VISITED = 1 << 4,
+        };
+
+        const Affine3& updateLocal(uint32_t slot);
+        const Affine3& updateWorld(uint32_t slot);
+        // from the local matrix and the up to date world matrix of the parent
+        void computeWorld(uint32_t slot);
+        void updateInverseWorld(uint32_t slot);
+        bool isOwnerThread() const { return std::this_thread::get_id() == m_ownerThread; }
+        void markWorldDirty(uint32_t slot);
+        void queueNotification(uint32_t slot);
+        void unlink(uint32_t slot);
+        void sort();
+        void updateWorldMatricesParallel();
+
+    private:
+
+        friend class Transform;
+
+        std::vector<WorldVec3> m_localPosition;
+        QuatArray m_localOrientation;
+        Vec3Array m_localScale;
+        Affine3Array m_localMat;
+        Affine3Array m_worldMat;
+        // parent world orientation * local orientation, parent world scale * local scale
+        QuatArray m_worldOrientation;
+        Vec3Array m_worldScale;
+#if CN_LARGE_WORLD == 1
+        // the exact translation of m_worldMat
+        Vec3dArray m_worldPosition;
+#endif
+        Mat3Array m_normalMat;
+        std::vector<uint8_t> m_flags;
+        std::vector<uint32_t> m_localVersion;
+        std::vector<uint32_t> m_worldVersion;
+        // m_worldVersion m_normalMat was derived from
+        std::vector<uint32_t> m_normalVersion;
+        // inverses of m_worldMat and m_worldOrientation at m_inverseVersion,
+        // for the world setters of the children
+        Affine3Array m_inverseWorldMat;
+        QuatArray m_inverseWorldOrientation;
+        std::vector<uint32_t> m_inverseVersion;
+
+        // hierarchy links as slots, children in a doubly linked sibling list
+        std::vector<uint32_t> m_parent;
+        std::vector<uint32_t> m_firstChild;
+        std::vector<uint32_t> m_nextSibling;
+        std::vector<uint32_t> m_prevSibling;
+        // one past the last slot of the subtree, while m_contiguous
+        std::vector<uint32_t> m_subtreeEnd;
+
+        std::vector<uint32_t> m_idOfSlot;
+        std::vector<Transform*> m_transform;
+        std::vector<uint32_t> m_slotOfId;
+        std::vector<uint32_t> m_freeIds;
+        size_t m_destroyedCount = 0;
+        bool m_sorted = true;
+        // depth first, every subtree in one range of slots
+        bool m_contiguous = true;
+
+        // slots pending in markWorldDirty and updateWorld, which walk the
+        // hierarchy without recursion so long chains cannot overflow the stack
+        std::vector<uint32_t> m_walkStack;
+
+        // the only thread allowed to change the store
+        std::thread::id m_ownerThread;
+
+        bool m_deferNotifications = false;
+        // ids changed since the last dispatch, each once
+        std::vector<uint32_t> m_changedIds;
+        // the changed transforms and their descendants, reused by every dispatch
+        std::vector<uint32_t> m_notifyIds;
+    };
+}
+
+#endif
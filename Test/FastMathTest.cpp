@@ -0,0 +1,43 @@
+#include "Test.h"
+#include "Math/Mathematics.h"
+#include "Math/Random.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Canaan;
+
+// the bound documented in Mathematics.h
+static const double INV_SQRT_RELATIVE_ERROR = 3e-7;
+// odd, so the bulk form also runs its scalar tail
+static const size_t INV_SQRT_ARRAY_SIZE = 19;
+
+CN_TEST(FastMath, InvSqrtOfZeroIsInfinite)
+{
+    const Real inf = std::numeric_limits<Real>::infinity();
+    CN_CHECK(FastInvSqrt(Real(0.0f)) == inf);
+
+    // zeros in a vector lane and in the tail
+    Random &random = Random::getThreadLocal();
+    random.seed(37);
+    std::vector<Real> in(INV_SQRT_ARRAY_SIZE), out(INV_SQRT_ARRAY_SIZE);
+    for (size_t i = 0; i < INV_SQRT_ARRAY_SIZE; ++i)
+        in[i] = (i % 6 == 0) ? Real(0.0f) : random.nextRange(1e-6f, 1e6f);
+    FastInvSqrt(in.data(), out.data(), in.size());
+
+    size_t mismatches = 0;
+    double maxError = 0.0;
+    for (size_t i = 0; i < INV_SQRT_ARRAY_SIZE; ++i)
+    {
+        if (in[i] == Real(0.0f))
+        {
+            if (out[i] != inf)
+                ++mismatches;
+            continue;
+        }
+        double expected = 1.0 / std::sqrt(double(in[i]));
+        maxError = std::max(maxError, std::abs(double(out[i]) - expected) / expected);
+    }
+    CN_CHECK_EQ(mismatches, 0u);
+    CN_CHECK_LE(maxError, INV_SQRT_RELATIVE_ERROR);
+}
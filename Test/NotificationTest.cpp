@@ -0,0 +1,166 @@
+#include "Test.h"
+#include "Scene/SceneObject.h"
+#include "Scene/Transform.h"
+#include <functional>
+#include <rttr/registration>
+
+using namespace Canaan;
+
+// every onTransformChanged of every probe
+static int s_notifications = 0;
+
+// counts its notifications and runs onChanged from them
+class NotifyProbe : public Component
+{
+    RTTR_ENABLE(Component)
+public:
+
+    void onTransformChanged() override
+    {
+        ++notifications;
+        ++s_notifications;
+        if (onChanged)
+            onChanged();
+    }
+
+    int notifications = 0;
+    std::function<void()> onChanged;
+};
+
+RTTR_REGISTRATION
+{
+    rttr::registration::class_<Component>("Component");
+    rttr::registration::class_<NotifyProbe>("NotifyProbe").constructor<>();
+    // addComponentBy converts the created shared_ptr to one of Component
+    rttr::type::register_wrapper_converter_for_base_classes<std::shared_ptr<NotifyProbe>>();
+}
+
+// defers the notifications of the default store for one test, and leaves it
+// with nothing pending
+struct DeferredNotifications
+{
+    DeferredNotifications() { TransformStore::getInstance().setDeferredNotifications(true); }
+    ~DeferredNotifications() { TransformStore::getInstance().setDeferredNotifications(false); }
+
+    size_t dispatch() { return TransformStore::getInstance().dispatchNotifications(); }
+};
+
+static std::shared_ptr<SceneObject> MakeObject(NotifyProbe *&probe, bool subscribed = true)
+{
+    std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+    probe = object->addComponent<NotifyProbe>();
+    CN_CHECK(probe != nullptr);
+    probe->setTransformChangedSubscribed(subscribed);
+    return object;
+}
+
+CN_TEST(Notification, SettersCoalesce)
+{
+    NotifyProbe *probe;
+    std::shared_ptr<SceneObject> object = MakeObject(probe);
+    DeferredNotifications deferred;
+
+    Transform *transform = object->getTransform();
+    transform->setLocalPosition(Vec3(1.0f, 2.0f, 3.0f));
+    transform->setLocalOrientation(Quat(0.5f, Vec3::UNIT_Y));
+    transform->setLocalScale(Vec3(2.0f));
+    CN_CHECK_EQ(probe->notifications, 0);
+    CN_CHECK_EQ(deferred.dispatch(), 1u);
+    CN_CHECK_EQ(probe->notifications, 1);
+    CN_CHECK_EQ(deferred.dispatch(), 0u);
+    CN_CHECK_EQ(probe->notifications, 1);
+}
+
+CN_TEST(Notification, DescendantsNotifiedOnce)
+{
+    NotifyProbe *rootProbe, *childProbe, *grandchildProbe, *otherProbe;
+    std::shared_ptr<SceneObject> root = MakeObject(rootProbe);
+    std::shared_ptr<SceneObject> child = MakeObject(childProbe);
+    std::shared_ptr<SceneObject> grandchild = MakeObject(grandchildProbe);
+    std::shared_ptr<SceneObject> other = MakeObject(otherProbe);
+    root->addChild(child);
+    child->addChild(grandchild);
+    DeferredNotifications deferred;
+
+    // the child changes itself and through its parent
+    child->getTransform()->setLocalScale(Vec3(2.0f));
+    root->getTransform()->setLocalPosition(Vec3(1.0f, 0.0f, 0.0f));
+    CN_CHECK_EQ(deferred.dispatch(), 3u);
+    CN_CHECK_EQ(rootProbe->notifications, 1);
+    CN_CHECK_EQ(childProbe->notifications, 1);
+    CN_CHECK_EQ(grandchildProbe->notifications, 1);
+    CN_CHECK_EQ(otherProbe->notifications, 0);
+
+    // reparenting notifies the moved subtree only
+    grandchild->addChild(other);
+    CN_CHECK_EQ(deferred.dispatch(), 1u);
+    CN_CHECK_EQ(otherProbe->notifications, 1);
+    CN_CHECK_EQ(grandchildProbe->notifications, 1);
+}
+
+CN_TEST(Notification, UnsubscribedSkipped)
+{
+    NotifyProbe *subscribed;
+    std::shared_ptr<SceneObject> object = MakeObject(subscribed);
+    NotifyProbe *unsubscribed = object->addComponent<NotifyProbe>();
+    NotifyProbe *silentProbe;
+    std::shared_ptr<SceneObject> silent = MakeObject(silentProbe, false);
+
+    // immediate notifications reach every component
+    object->getTransform()->setLocalPosition(Vec3(1.0f, 0.0f, 0.0f));
+    CN_CHECK_EQ(subscribed->notifications, 1);
+    CN_CHECK_EQ(unsubscribed->notifications, 1);
+
+    DeferredNotifications deferred;
+    object->getTransform()->setLocalPosition(Vec3(2.0f, 0.0f, 0.0f));
+    silent->getTransform()->setLocalPosition(Vec3(2.0f, 0.0f, 0.0f));
+    deferred.dispatch();
+    CN_CHECK_EQ(subscribed->notifications, 2);
+    CN_CHECK_EQ(unsubscribed->notifications, 1);
+    CN_CHECK_EQ(silentProbe->notifications, 0);
+
+    // unsubscribing between the change and the dispatch
+    object->getTransform()->setLocalPosition(Vec3(3.0f, 0.0f, 0.0f));
+    subscribed->setTransformChangedSubscribed(false);
+    deferred.dispatch();
+    CN_CHECK_EQ(subscribed->notifications, 2);
+}
+
+CN_TEST(Notification, DestroyDuringDispatch)
+{
+    NotifyProbe *firstProbe, *childProbe, *secondProbe;
+    std::shared_ptr<SceneObject> first = MakeObject(firstProbe);
+    std::shared_ptr<SceneObject> child = MakeObject(childProbe);
+    std::shared_ptr<SceneObject> second = MakeObject(secondProbe);
+    first->addChild(child);
+    DeferredNotifications deferred;
+
+    // pending after the first: its child, reached through it, and the second.
+    // The callback destroys both and creates objects that may reuse their
+    // transform ids, which were not changed and are not notified either
+    std::vector<std::shared_ptr<SceneObject>> created;
+    firstProbe->onChanged = [&]{
+        first->removeChild(child);
+        child.reset();
+        second.reset();
+        for (int i = 0; i < 2; ++i)
+        {
+            NotifyProbe *probe;
+            created.push_back(MakeObject(probe));
+        }
+    };
+    first->getTransform()->setLocalPosition(Vec3(1.0f, 0.0f, 0.0f));
+    second->getTransform()->setLocalPosition(Vec3(1.0f, 0.0f, 0.0f));
+
+    int before = s_notifications;
+    CN_CHECK_EQ(deferred.dispatch(), 1u);
+    CN_CHECK_EQ(s_notifications - before, 1);
+    CN_CHECK_EQ(firstProbe->notifications, 1);
+    firstProbe->onChanged = nullptr;
+
+    // nothing left pending, the new objects are notified once changed
+    CN_CHECK_EQ(deferred.dispatch(), 0u);
+    created[0]->getTransform()->setLocalScale(Vec3(2.0f));
+    CN_CHECK_EQ(deferred.dispatch(), 1u);
+    CN_CHECK_EQ(s_notifications - before, 2);
+}
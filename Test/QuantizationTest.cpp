@@ -0,0 +1,333 @@
+#include "Test.h"
+#include "Math/Quantization.h"
+#include "Math/Random.h"
+#include "Math/Mathematics.h"
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+using namespace Canaan;
+
+// the bounds documented in Quantization.h
+static const double QUAT32_STORED_ERROR = 7e-4;
+static const double QUAT32_REBUILT_ERROR = 2.1e-3;
+static const double QUAT32_ANGLE_ERROR = 4.8e-3;
+static const double QUAT48_STORED_ERROR = 2.2e-5;
+static const double QUAT48_REBUILT_ERROR = 6.5e-5;
+static const double QUAT48_ANGLE_ERROR = 1.5e-4;
+static const double HALF_RELATIVE_ERROR = 1.0 / 2048.0;
+static const double HALF_ABSOLUTE_ERROR = 1.0 / 33554432.0;
+static const double HALF_MIN_NORMAL = 6.103515625e-5;
+static const double HALF_MAX = 65504.0;
+
+static Quat Normalized(double w, double x, double y, double z)
+{
+    double len = std::sqrt(w * w + x * x + y * y + z * z);
+    return Quat(Real(w / len), Real(x / len), Real(y / len), Real(z / len));
+}
+
+static Quat RandomQuat(Random &random)
+{
+    return Normalized(random.nextRange(-1.0f, 1.0f), random.nextRange(-1.0f, 1.0f),
+        random.nextRange(-1.0f, 1.0f), random.nextRange(-1.0f, 1.0f));
+}
+
+// unit quaternions where the largest component is tied with another one,
+// give or take a few ulps, for every pair of components and signs
+static void AddLargestComponentSwitches(std::vector<Quat> &quats)
+{
+    const double offsets[] = { 0.0, 1e-7, -1e-7, 1e-4, -1e-4 };
+    for (int a = 0; a < 4; ++a)
+    {
+        for (int b = a + 1; b < 4; ++b)
+        {
+            for (double offset : offsets)
+            {
+                for (int signs = 0; signs < 4; ++signs)
+                {
+                    double c[4] = { 0.3, -0.2, 0.1, 0.25 };
+                    c[a] = (signs & 1 ? -0.8 : 0.8) + offset;
+                    c[b] = signs & 2 ? -0.8 : 0.8;
+                    quats.push_back(Normalized(c[0], c[1], c[2], c[3]));
+                    // only two components, the others zero
+                    double d[4] = { 0.0, 0.0, 0.0, 0.0 };
+                    d[a] = c[a];
+                    d[b] = c[b];
+                    quats.push_back(Normalized(d[0], d[1], d[2], d[3]));
+                }
+            }
+        }
+    }
+    // a single component, of either sign
+    for (int a = 0; a < 4; ++a)
+    {
+        double c[4] = { 0.0, 0.0, 0.0, 0.0 };
+        c[a] = 1.0;
+        quats.push_back(Normalized(c[0], c[1], c[2], c[3]));
+        c[a] = -1.0;
+        quats.push_back(Normalized(c[0], c[1], c[2], c[3]));
+    }
+}
+
+static std::vector<Quat> TestQuats()
+{
+    std::vector<Quat> quats;
+    AddLargestComponentSwitches(quats);
+    Random &random = Random::getThreadLocal();
+    random.seed(13);
+    for (int i = 0; i < 50000; ++i)
+        quats.push_back(RandomQuat(random));
+    // all four components near 1/2, the worst case of the rebuilt component
+    for (int i = 0; i < 50000; ++i)
+    {
+        double c[4];
+        for (int k = 0; k < 4; ++k)
+            c[k] = (random.nextUnit() < 0.5f ? -0.5 : 0.5) + random.nextRange(-0.01f, 0.01f);
+        quats.push_back(Normalized(c[0], c[1], c[2], c[3]));
+    }
+    return quats;
+}
+
+struct QuatErrors
+{
+    double stored = 0.0;
+    double rebuilt = 0.0;
+    double angle = 0.0;
+    double length = 0.0;
+};
+
+// decoded against q, either sign of decoded; dropped is the encoded index of
+// the rebuilt component. The angle comes from the chord between the
+// normalized quaternions, acos of their dot product is too ill conditioned.
+static void AddQuatError(const Quat &q, const Quat &decoded, unsigned dropped, QuatErrors &errors)
+{
+    const double in[4] = { q.w, q.x, q.y, q.z };
+    const double out[4] = { decoded.w, decoded.x, decoded.y, decoded.z };
+    double dot = 0.0, inLength = 0.0, outLength = 0.0;
+    for (int k = 0; k < 4; ++k)
+    {
+        dot += in[k] * out[k];
+        inLength += in[k] * in[k];
+        outLength += out[k] * out[k];
+    }
+    inLength = std::sqrt(inLength);
+    outLength = std::sqrt(outLength);
+    double sign = dot < 0.0 ? -1.0 : 1.0;
+    double chord = 0.0;
+    for (unsigned k = 0; k < 4; ++k)
+    {
+        double error = std::fabs(sign * out[k] - in[k]);
+        if (k == dropped)
+            errors.rebuilt = Maximum(errors.rebuilt, error);
+        else
+            errors.stored = Maximum(errors.stored, error);
+        double d = sign * out[k] / outLength - in[k] / inLength;
+        chord += d * d;
+    }
+    errors.angle = Maximum(errors.angle, 4.0 * std::asin(Minimum(std::sqrt(chord) * 0.5, 1.0)));
+    errors.length = Maximum(errors.length, std::fabs(outLength - 1.0));
+}
+
+static bool SameBits(const Quat &a, const Quat &b)
+{
+    return memcmp(&a, &b, sizeof(Quat)) == 0;
+}
+
+CN_TEST(Quantization, Quat32RoundTrip)
+{
+    std::vector<Quat> quats = TestQuats();
+    QuatErrors errors;
+    for (const Quat &q : quats)
+    {
+        uint32_t v = QuatCodec::encode32(q);
+        AddQuatError(q, QuatCodec::decode32(v), v >> 30, errors);
+    }
+    CN_CHECK_LE(errors.stored, QUAT32_STORED_ERROR);
+    CN_CHECK_LE(errors.rebuilt, QUAT32_REBUILT_ERROR);
+    CN_CHECK_LE(errors.angle, QUAT32_ANGLE_ERROR);
+    CN_CHECK_LE(errors.length, 1e-6);
+}
+
+CN_TEST(Quantization, Quat48RoundTrip)
+{
+    std::vector<Quat> quats = TestQuats();
+    QuatErrors errors;
+    for (const Quat &q : quats)
+    {
+        uint16_t v[3];
+        QuatCodec::encode48(q, v);
+        AddQuatError(q, QuatCodec::decode48(v), (v[0] >> 15) << 1 | v[1] >> 15, errors);
+    }
+    CN_CHECK_LE(errors.stored, QUAT48_STORED_ERROR);
+    CN_CHECK_LE(errors.rebuilt, QUAT48_REBUILT_ERROR);
+    CN_CHECK_LE(errors.angle, QUAT48_ANGLE_ERROR);
+    CN_CHECK_LE(errors.length, 1e-6);
+}
+
+CN_TEST(Quantization, QuatBulkMatchesSingle)
+{
+    std::vector<Quat> quats = TestQuats();
+    size_t count = quats.size();
+    std::vector<uint32_t> packed32(count);
+    std::vector<uint16_t> packed48(count * 3);
+    std::vector<Quat> decoded32(count), decoded48(count);
+    QuatCodec::encode32(quats.data(), packed32.data(), count);
+    QuatCodec::decode32(packed32.data(), decoded32.data(), count);
+    QuatCodec::encode48(quats.data(), packed48.data(), count);
+    QuatCodec::decode48(packed48.data(), decoded48.data(), count);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint16_t v[3];
+        QuatCodec::encode48(quats[i], v);
+        if (packed32[i] != QuatCodec::encode32(quats[i])
+            || !SameBits(decoded32[i], QuatCodec::decode32(packed32[i]))
+            || memcmp(v, &packed48[i * 3], sizeof(v)) != 0
+            || !SameBits(decoded48[i], QuatCodec::decode48(&packed48[i * 3])))
+            ++mismatches;
+    }
+    CN_CHECK_EQ(mismatches, 0u);
+}
+
+static std::vector<Real> TestHalfValues()
+{
+    // edges: zeros, the normal range limits, halfway points around the largest half
+    const Real edges[] = { 0.0f, -0.0f, 1.0f, -1.0f, Real(HALF_MIN_NORMAL), Real(-HALF_MIN_NORMAL),
+        Real(HALF_MAX), Real(-HALF_MAX), 65519.0f, -65519.0f, 65520.0f, -65520.0f, 1e6f, -1e6f,
+        5.9604645e-8f, 2.9802322e-8f, 1e-9f, -1e-9f,
+        std::numeric_limits<Real>::infinity(), -std::numeric_limits<Real>::infinity(),
+        std::numeric_limits<Real>::quiet_NaN() };
+    std::vector<Real> values(edges, edges + sizeof(edges) / sizeof(edges[0]));
+
+    Random &random = Random::getThreadLocal();
+    random.seed(17);
+    for (int i = 0; i < 20000; ++i)
+    {
+        // log uniform over the subnormal and normal half range, both signs
+        Real v = Real(std::pow(2.0, double(random.nextRange(-26.0f, 16.0f))));
+        values.push_back(i & 1 ? -v : v);
+    }
+    return values;
+}
+
+CN_TEST(Quantization, HalfRoundTrip)
+{
+    std::vector<Real> values = TestHalfValues();
+    double maxRelative = 0.0, maxAbsolute = 0.0;
+    for (Real v : values)
+    {
+        double magnitude = std::fabs(double(v));
+        if (std::isnan(v) || magnitude > HALF_MAX)
+            continue;
+        double decoded = HalfCodec::decode(HalfCodec::encode(v));
+        if (magnitude >= HALF_MIN_NORMAL)
+            maxRelative = Maximum(maxRelative, std::fabs(decoded - v) / magnitude);
+        else
+            maxAbsolute = Maximum(maxAbsolute, std::fabs(decoded - v));
+    }
+    CN_CHECK_LE(maxRelative, HALF_RELATIVE_ERROR);
+    CN_CHECK_LE(maxAbsolute, HALF_ABSOLUTE_ERROR);
+}
+
+CN_TEST(Quantization, HalfEdges)
+{
+    CN_CHECK_EQ(HalfCodec::encode(0.0f), 0x0000u);
+    CN_CHECK_EQ(HalfCodec::encode(-0.0f), 0x8000u);
+    CN_CHECK(!std::signbit(HalfCodec::decode(0x0000)) && HalfCodec::decode(0x0000) == 0.0f);
+    CN_CHECK(std::signbit(HalfCodec::decode(0x8000)) && HalfCodec::decode(0x8000) == 0.0f);
+
+    // the largest half, and the values rounding to it or overflowing
+    CN_CHECK_EQ(HalfCodec::encode(Real(HALF_MAX)), 0x7bffu);
+    CN_CHECK_EQ(HalfCodec::encode(65519.0f), 0x7bffu);
+    CN_CHECK_EQ(HalfCodec::encode(-65519.0f), 0xfbffu);
+    CN_CHECK_EQ(HalfCodec::encode(65520.0f), 0x7c00u);
+    CN_CHECK_EQ(HalfCodec::encode(-65520.0f), 0xfc00u);
+    CN_CHECK_EQ(HalfCodec::encode(1e6f), 0x7c00u);
+    CN_CHECK_EQ(HalfCodec::encode(std::numeric_limits<Real>::infinity()), 0x7c00u);
+    CN_CHECK_EQ(HalfCodec::encode(-std::numeric_limits<Real>::infinity()), 0xfc00u);
+    CN_CHECK(std::isinf(HalfCodec::decode(0x7c00)) && HalfCodec::decode(0x7c00) > 0.0f);
+
+    CN_CHECK(std::isnan(HalfCodec::decode(HalfCodec::encode(std::numeric_limits<Real>::quiet_NaN()))));
+
+    // the smallest subnormal, and the halfway value rounding to even (zero)
+    CN_CHECK_EQ(HalfCodec::encode(5.9604645e-8f), 0x0001u);
+    CN_CHECK_EQ(HalfCodec::encode(2.9802322e-8f), 0x0000u);
+}
+
+CN_TEST(Quantization, HalfBulkMatchesSingle)
+{
+    std::vector<Real> values = TestHalfValues();
+    size_t count = values.size();
+    std::vector<uint16_t> packed(count);
+    std::vector<Real> decoded(count);
+    HalfCodec::encode(values.data(), packed.data(), count);
+    HalfCodec::decode(packed.data(), decoded.data(), count);
+
+    size_t vecCount = count / 3;
+    std::vector<uint16_t> packedVec(vecCount * 3);
+    std::vector<Vec3> decodedVec(vecCount);
+    HalfCodec::encode(reinterpret_cast<const Vec3*>(values.data()), packedVec.data(), vecCount);
+    HalfCodec::decode(packedVec.data(), decodedVec.data(), vecCount);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint16_t h = HalfCodec::encode(values[i]);
+        Real v = HalfCodec::decode(h);
+        if (packed[i] != h || memcmp(&decoded[i], &v, sizeof(Real)) != 0)
+            ++mismatches;
+        if (i < vecCount * 3 && (packedVec[i] != h || memcmp(&decodedVec[i / 3][i % 3], &v, sizeof(Real)) != 0))
+            ++mismatches;
+    }
+    CN_CHECK_EQ(mismatches, 0u);
+}
+
+CN_TEST(Quantization, PositionRoundTrip)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(19);
+    size_t failures = 0, bulkMismatches = 0;
+    for (unsigned bits = 1; bits <= 16; ++bits)
+    {
+        Vec3 minimum(random.nextRange(-1000.0f, 0.0f), random.nextRange(-10.0f, 0.0f), random.nextRange(-1.0f, 0.0f));
+        Vec3 maximum = minimum + Vec3(random.nextRange(0.1f, 2000.0f), random.nextRange(0.1f, 20.0f), random.nextRange(0.1f, 2.0f));
+        PositionCodec codec(AABB(minimum, maximum), bits);
+        Vec3 maxError = codec.getMaxError();
+        // the float rounding of the decoded coordinate, a few ulps of the box
+        Real extent = Maximum(Maximum(std::fabs(minimum.x), std::fabs(maximum.x)), Maximum(std::fabs(minimum.y), std::fabs(maximum.y)));
+        extent = Maximum(extent, Maximum(std::fabs(minimum.z), std::fabs(maximum.z)));
+        Real rounding = 4.0f * std::numeric_limits<Real>::epsilon() * extent;
+
+        std::vector<Vec3> points = { minimum, maximum, (minimum + maximum) * 0.5f };
+        for (int i = 0; i < 2000; ++i)
+        {
+            points.push_back(Vec3(random.nextRange(minimum.x, maximum.x), random.nextRange(minimum.y, maximum.y),
+                random.nextRange(minimum.z, maximum.z)));
+        }
+        // outside the box, checked against the clamped point
+        points.push_back(minimum - Vec3(10.0f));
+        points.push_back(maximum + Vec3(10.0f));
+
+        std::vector<uint16_t> packed(points.size() * 3);
+        std::vector<Vec3> decoded(points.size());
+        codec.encode(points.data(), packed.data(), points.size());
+        codec.decode(packed.data(), decoded.data(), points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            uint16_t v[3];
+            codec.encode(points[i], v);
+            Vec3 single = codec.decode(v);
+            if (memcmp(v, &packed[i * 3], sizeof(v)) != 0 || memcmp(&single, &decoded[i], sizeof(Vec3)) != 0)
+                ++bulkMismatches;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                Real clamped = Minimum(Maximum(points[i][axis], minimum[axis]), maximum[axis]);
+                if (std::fabs(single[axis] - clamped) > maxError[axis] + rounding)
+                    ++failures;
+            }
+        }
+    }
+    CN_CHECK_EQ(failures, 0u);
+    CN_CHECK_EQ(bulkMismatches, 0u);
+}
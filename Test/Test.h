@@ -0,0 +1,48 @@
+#ifndef _CN_TEST_
+#define _CN_TEST_
+#include "Prerequisites.h"
+
+namespace Canaan
+{
+    typedef void (*TestFunc)();
+
+    struct TestCase
+    {
+        std::string group;
+        std::string name;
+        TestFunc    func;
+    };
+
+    std::vector<TestCase>& GetTestCases();
+
+    struct TestRegistrar
+    {
+        TestRegistrar(const char *group, const char *name, TestFunc func)
+        {
+            GetTestCases().push_back({ group, name, func });
+        }
+    };
+
+    // records a failed check of the running case, the case keeps running
+    void ReportTestFailure(const char *file, int line, const char *expr);
+    void ReportTestFailure(const char *file, int line, const char *expr, double lhs, double rhs);
+}
+
+#define CN_TEST(_GROUP, _NAME) \
+    static void _GROUP##_##_NAME(); \
+    static Canaan::TestRegistrar _GROUP##_##_NAME##_registrar(#_GROUP, #_NAME, _GROUP##_##_NAME); \
+    static void _GROUP##_##_NAME()
+
+#define CN_CHECK(_COND) \
+    do { if (!(_COND)) Canaan::ReportTestFailure(__FILE__, __LINE__, #_COND); } while (0)
+
+// the operands are evaluated once, they may be calls with side effects
+#define CN_CHECK_EQ(_A, _B) \
+    do { const auto &_a = (_A); const auto &_b = (_B); \
+        if (!(_a == _b)) Canaan::ReportTestFailure(__FILE__, __LINE__, #_A " == " #_B, double(_a), double(_b)); } while (0)
+
+#define CN_CHECK_LE(_A, _B) \
+    do { const auto &_a = (_A); const auto &_b = (_B); \
+        if (!(_a <= _b)) Canaan::ReportTestFailure(__FILE__, __LINE__, #_A " <= " #_B, double(_a), double(_b)); } while (0)
+
+#endif
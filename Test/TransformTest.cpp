@@ -0,0 +1,338 @@
+#include "Test.h"
+#include "Scene/SceneObject.h"
+#include "Scene/Transform.h"
+#include "Math/Random.h"
+#include "Math/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string.h>
+
+using namespace Canaan;
+
+static const size_t HIERARCHY_NODE_COUNT = 1365;
+static const size_t HIERARCHY_BRANCHING = 4;
+
+// a complete 4-ary tree in breadth first order, node 0 is the root
+struct Hierarchy
+{
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    std::vector<Transform*> transforms;
+    std::vector<uint32_t> versions;
+
+    Hierarchy()
+    {
+        Random &random = Random::getThreadLocal();
+        random.seed(21);
+        for (size_t i = 0; i < HIERARCHY_NODE_COUNT; ++i)
+        {
+            std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+            Transform *transform = object->getTransform();
+            transform->setLocalPosition(random.nextUnitVector());
+            if (i > 0)
+                objects[(i - 1) / HIERARCHY_BRANCHING]->addChild(object);
+            objects.push_back(object);
+            transforms.push_back(transform);
+        }
+        versions.resize(HIERARCHY_NODE_COUNT);
+    }
+
+    // reads every world matrix, returns the nodes whose world matrix was
+    // recomputed since the last call
+    std::vector<size_t> readWorldAffines()
+    {
+        std::vector<size_t> recomputed;
+        for (size_t i = 0; i < transforms.size(); ++i)
+        {
+            transforms[i]->getWorldAffine();
+            uint32_t version = transforms[i]->getWorldVersion();
+            if (version != versions[i])
+            {
+                // at most once per read
+                CN_CHECK_EQ(version - versions[i], 1u);
+                recomputed.push_back(i);
+            }
+            versions[i] = version;
+        }
+        return recomputed;
+    }
+
+    bool isInSubtree(size_t node, size_t root) const
+    {
+        while (node > root)
+            node = (node - 1) / HIERARCHY_BRANCHING;
+        return node == root;
+    }
+};
+
+CN_TEST(Transform, CleanReadRecomputesNothing)
+{
+    Hierarchy hierarchy;
+    CN_CHECK_EQ(hierarchy.readWorldAffines().size(), HIERARCHY_NODE_COUNT);
+    CN_CHECK_EQ(hierarchy.readWorldAffines().size(), 0u);
+    // bulk update of a clean store does not touch the matrices either
+    TransformStore::getInstance().updateWorldMatrices();
+    CN_CHECK_EQ(hierarchy.readWorldAffines().size(), 0u);
+}
+
+CN_TEST(Transform, LeafMoveRecomputesLeaf)
+{
+    Hierarchy hierarchy;
+    hierarchy.readWorldAffines();
+    size_t leaf = HIERARCHY_NODE_COUNT - 1;
+    hierarchy.transforms[leaf]->setLocalPosition(Vec3(1.0f, 2.0f, 3.0f));
+    std::vector<size_t> recomputed = hierarchy.readWorldAffines();
+    CN_CHECK_EQ(recomputed.size(), 1u);
+    CN_CHECK(!recomputed.empty() && recomputed[0] == leaf);
+}
+
+CN_TEST(Transform, InnerMoveRecomputesSubtree)
+{
+    Hierarchy hierarchy;
+    hierarchy.readWorldAffines();
+    // depth 2, a subtree of 1 + 4 + 16 + 64 nodes
+    size_t node = 7;
+    hierarchy.transforms[node]->setLocalOrientation(Quat(0.5f, Vec3::UNIT_Y));
+    std::vector<size_t> recomputed = hierarchy.readWorldAffines();
+    CN_CHECK_EQ(recomputed.size(), 85u);
+    for (size_t i : recomputed)
+        CN_CHECK(hierarchy.isInSubtree(i, node));
+}
+
+CN_TEST(Transform, RootMoveRecomputesAll)
+{
+    Hierarchy hierarchy;
+    hierarchy.readWorldAffines();
+    for (int move = 0; move < 2; ++move)
+    {
+        hierarchy.transforms[0]->setLocalPosition(Vec3(Real(move), 0.0f, 0.0f));
+        CN_CHECK_EQ(hierarchy.readWorldAffines().size(), HIERARCHY_NODE_COUNT);
+    }
+    // through the bulk update instead of the lazy reads
+    hierarchy.transforms[0]->setLocalScale(Vec3(2.0f));
+    TransformStore::getInstance().updateWorldMatrices();
+    CN_CHECK_EQ(hierarchy.readWorldAffines().size(), HIERARCHY_NODE_COUNT);
+}
+
+// a store of its own, so the slot order only depends on the test
+struct StoreHierarchy
+{
+    TransformStore store;
+    std::vector<std::unique_ptr<Transform>> transforms;
+    // index of the parent transform, -1 for roots and destroyed ones
+    std::vector<int> parents;
+
+    explicit StoreHierarchy(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            transforms.emplace_back(new Transform(store));
+        parents.resize(count, -1);
+    }
+
+    void setParent(size_t node, int parent)
+    {
+        store.setParent(transforms[node]->getId(),
+            parent < 0 ? TransformStore::INVALID : transforms[parent]->getId());
+        parents[node] = parent;
+    }
+
+    void setRandomLocal(size_t node, Random &random)
+    {
+        transforms[node]->setLocalPosition(random.nextUnitVector());
+        transforms[node]->setLocalOrientation(Quat(random.nextRange(-1.0f, 1.0f), random.nextUnitVector()));
+        transforms[node]->setLocalScale(Vec3(random.nextRange(0.9f, 1.1f)));
+    }
+
+    bool isAncestor(int ancestor, size_t node) const
+    {
+        for (int i = int(node); i >= 0; i = parents[i])
+        {
+            if (i == ancestor)
+                return true;
+        }
+        return false;
+    }
+
+    void destroy(size_t node)
+    {
+        transforms[node].reset();
+        for (int &parent : parents)
+        {
+            if (parent == int(node))
+                parent = -1;
+        }
+        parents[node] = -1;
+    }
+
+    // the world matrix as the product of the local ones up the parent chain
+    Affine3 chainProduct(size_t node)
+    {
+        Affine3 world = transforms[node]->getLocalAffine();
+        for (int i = parents[node]; i >= 0; i = parents[i])
+            world = transforms[i]->getLocalAffine() * world;
+        return world;
+    }
+
+    // largest difference to chainProduct over the live nodes
+    double maxChainError(bool bulk)
+    {
+        if (bulk)
+            store.updateWorldMatrices();
+        double error = 0.0;
+        for (size_t i = 0; i < transforms.size(); ++i)
+        {
+            if (!transforms[i])
+                continue;
+            Affine3 expected = chainProduct(i);
+            const Affine3 &world = transforms[i]->getWorldAffine();
+            for (size_t r = 0; r < 3; ++r)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                    error = std::max(error, double(std::abs(world[r][c] - expected[r][c])));
+            }
+        }
+        return error;
+    }
+};
+
+// the products associate differently from the top down update, and in the
+// large world mode the translation is accumulated in double
+static const double CHAIN_PRODUCT_ERROR = 1e-4;
+
+CN_TEST(Transform, ReparentAndDestroyMatchParentChain)
+{
+    const size_t count = 300;
+    StoreHierarchy hierarchy(count);
+    Random &random = Random::getThreadLocal();
+    random.seed(22);
+    for (size_t i = 0; i < count; ++i)
+    {
+        hierarchy.setRandomLocal(i, random);
+        if (i > 0)
+            hierarchy.setParent(i, int(random.nextUInt() % i));
+    }
+    CN_CHECK_LE(hierarchy.maxChainError(true), CHAIN_PRODUCT_ERROR);
+
+    for (int round = 0; round < 4; ++round)
+    {
+        // under later slots, so the store is left unsorted
+        for (int move = 0; move < 40; ++move)
+        {
+            size_t node = random.nextUInt() % (count - 1);
+            int parent = int(node + 1 + random.nextUInt() % (count - 1 - node));
+            if (!hierarchy.transforms[node] || !hierarchy.transforms[parent] || hierarchy.isAncestor(int(node), parent))
+                continue;
+            hierarchy.setParent(node, parent);
+        }
+        CN_CHECK(!hierarchy.store.isSorted());
+
+        // nodes with children, whose children become roots
+        for (int kill = 0; kill < 10; ++kill)
+        {
+            size_t node = random.nextUInt() % count;
+            if (hierarchy.transforms[node] && std::count(hierarchy.parents.begin(), hierarchy.parents.end(), int(node)))
+                hierarchy.destroy(node);
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (hierarchy.transforms[i] && random.nextUnit() < 0.1f)
+                hierarchy.transforms[i]->setLocalPosition(random.nextUnitVector());
+        }
+
+        // lazy reads walk the unsorted slots, the bulk update sorts them first
+        bool bulk = round % 2 == 1;
+        CN_CHECK_LE(hierarchy.maxChainError(bulk), CHAIN_PRODUCT_ERROR);
+        CN_CHECK(hierarchy.store.isSorted() == bulk);
+    }
+}
+
+CN_TEST(Transform, LongChainUpdates)
+{
+    // each node the child of the next one, deeper than the call stack allows
+    // recursing
+    const size_t count = 200000;
+    StoreHierarchy hierarchy(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        hierarchy.transforms[i]->setLocalPosition(Vec3::UNIT_X);
+        if (i + 1 < count)
+            hierarchy.setParent(i, int(i + 1));
+    }
+    Transform &leaf = *hierarchy.transforms[0];
+    CN_CHECK_EQ(leaf.getWorldAffine()[0][3], Real(count));
+
+    // marks the whole chain dirty again
+    hierarchy.transforms[count - 1]->setLocalPosition(Vec3(2.0f, 0.0f, 0.0f));
+    CN_CHECK_EQ(leaf.getWorldAffine()[0][3], Real(count + 1));
+    hierarchy.transforms[count - 1]->setLocalPosition(Vec3(3.0f, 0.0f, 0.0f));
+    hierarchy.store.updateWorldMatrices();
+    CN_CHECK_EQ(leaf.getWorldAffine()[0][3], Real(count + 2));
+}
+
+// same seed, same hierarchy: deep chains with subtrees of more than
+// HIERARCHY_TASK_SLOTS (4096) nodes, updated on the calling thread, above
+// many small ones that become tasks
+static void BuildWideAndDeep(StoreHierarchy &hierarchy, uint32_t seed)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(seed);
+    size_t count = hierarchy.transforms.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        hierarchy.setRandomLocal(i, random);
+        if (i > 0 && random.nextUnit() > 0.001f)
+            hierarchy.setParent(i, int(i - 1 - random.nextUInt() % Minimum<size_t>(i, 64)));
+    }
+}
+
+// moves and reparents the same nodes in both hierarchies
+static void ChangeWideAndDeep(StoreHierarchy &hierarchy, uint32_t seed)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(seed);
+    size_t count = hierarchy.transforms.size();
+    for (int change = 0; change < 500; ++change)
+    {
+        size_t node = random.nextUInt() % count;
+        hierarchy.setRandomLocal(node, random);
+        int parent = int(random.nextUInt() % count);
+        if (!hierarchy.isAncestor(int(node), parent))
+            hierarchy.setParent(node, parent);
+    }
+}
+
+static size_t CountAffineMismatches(StoreHierarchy &a, StoreHierarchy &b)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < a.transforms.size(); ++i)
+    {
+        if (memcmp(&a.transforms[i]->getWorldAffine(), &b.transforms[i]->getWorldAffine(), sizeof(Affine3)) != 0)
+            ++mismatches;
+    }
+    return mismatches;
+}
+
+CN_TEST(Transform, ParallelUpdateMatchesSerial)
+{
+    const size_t count = 20000;
+    size_t workers = ParallelWorkerCount();
+    StoreHierarchy serial(count), parallel(count);
+    BuildWideAndDeep(serial, 23);
+    BuildWideAndDeep(parallel, 23);
+
+    for (uint32_t round = 0; round < 3; ++round)
+    {
+        if (round > 0)
+        {
+            ChangeWideAndDeep(serial, 100 + round);
+            ChangeWideAndDeep(parallel, 100 + round);
+        }
+        SetParallelWorkerCount(0);
+        serial.store.updateWorldMatrices();
+        SetParallelWorkerCount(3);
+        parallel.store.updateWorldMatrices();
+        // both clean now, the reads below only return the matrices
+        CN_CHECK_EQ(CountAffineMismatches(serial, parallel), 0u);
+    }
+    SetParallelWorkerCount(workers);
+}
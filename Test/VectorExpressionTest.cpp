@@ -0,0 +1,109 @@
+#include "Test.h"
+#include "Math/VectorExpression.h"
+#include "Math/Random.h"
+#include <string.h>
+
+using namespace Canaan;
+
+// odd, so the SIMD loops also run their scalar tail
+static const size_t EXPRESSION_ARRAY_SIZE = 199;
+
+template<class T>
+static bool SameBits(const T &a, const T &b)
+{
+    return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+static Real RandomDivisor(Random &random)
+{
+    Real s = random.nextRange(0.01f, 100.0f);
+    return random.nextUnit() < 0.5f ? -s : s;
+}
+
+static Vec4 RandomVec4(Random &random)
+{
+    return Vec4(random.nextRange(-100.0f, 100.0f), random.nextRange(-100.0f, 100.0f),
+        random.nextRange(-100.0f, 100.0f), random.nextRange(-100.0f, 100.0f));
+}
+
+CN_TEST(VectorExpression, ScalarDivisionMatchesOperators)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(23);
+    size_t mismatches = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        Real s = RandomDivisor(random);
+        Vec3 v3 = random.nextUnitVector() * random.nextRange(0.0f, 100.0f);
+        Vec4 v4 = RandomVec4(random);
+        if (!SameBits(Evaluate(Lazy(v3) / s), v3 / s))
+            ++mismatches;
+        if (!SameBits(Evaluate(Lazy(v4) / s), v4 / s))
+            ++mismatches;
+    }
+    CN_CHECK_EQ(mismatches, 0u);
+}
+
+CN_TEST(VectorExpression, ScalarDivisionOverArrays)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(29);
+    Vec3Array a3(EXPRESSION_ARRAY_SIZE), out3;
+    Vec4Array a4(EXPRESSION_ARRAY_SIZE), out4;
+    std::vector<Real> a1(EXPRESSION_ARRAY_SIZE), out1;
+    for (size_t i = 0; i < EXPRESSION_ARRAY_SIZE; ++i)
+    {
+        a3[i] = random.nextUnitVector() * random.nextRange(0.0f, 100.0f);
+        a4[i] = RandomVec4(random);
+        a1[i] = random.nextRange(-100.0f, 100.0f);
+    }
+    Vec3Stream stream(a3), outStream;
+    Real s = RandomDivisor(random);
+
+    Assign(out3, Lazy(a3) / s);
+    Assign(out4, Lazy(a4) / s);
+    Assign(out1, Lazy(a1.data(), a1.size()) / s);
+    Assign(outStream, Lazy(stream) / s);
+    Vec3Array streamResult;
+    outStream.toArray(streamResult);
+
+    size_t mismatches = 0;
+    Real inv = 1.0f / s;
+    for (size_t i = 0; i < EXPRESSION_ARRAY_SIZE; ++i)
+    {
+        if (!SameBits(out3[i], a3[i] / s) || !SameBits(streamResult[i], a3[i] / s))
+            ++mismatches;
+        if (!SameBits(out4[i], a4[i] / s))
+            ++mismatches;
+        if (!SameBits(out1[i], a1[i] * inv))
+            ++mismatches;
+    }
+    CN_CHECK_EQ(mismatches, 0u);
+}
+
+// Real / expression and expression / expression stay true divisions, as
+// the plain operators are
+CN_TEST(VectorExpression, DivisionMatchesOperators)
+{
+    Random &random = Random::getThreadLocal();
+    random.seed(31);
+    Vec3Array a(EXPRESSION_ARRAY_SIZE), b(EXPRESSION_ARRAY_SIZE), quotients, reciprocals;
+    for (size_t i = 0; i < EXPRESSION_ARRAY_SIZE; ++i)
+    {
+        a[i] = random.nextUnitVector() * random.nextRange(0.0f, 100.0f);
+        b[i] = Vec3(RandomDivisor(random), RandomDivisor(random), RandomDivisor(random));
+    }
+    Real s = RandomDivisor(random);
+    Assign(quotients, Lazy(a) / Lazy(b));
+    Assign(reciprocals, s / Lazy(b));
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < EXPRESSION_ARRAY_SIZE; ++i)
+    {
+        if (!SameBits(quotients[i], a[i] / b[i]) || !SameBits(reciprocals[i], s / b[i]))
+            ++mismatches;
+        if (!SameBits(Evaluate(Lazy(a[i]) / Lazy(b[i])), a[i] / b[i]))
+            ++mismatches;
+    }
+    CN_CHECK_EQ(mismatches, 0u);
+}
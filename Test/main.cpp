@@ -0,0 +1,60 @@
+#include "Test.h"
+#include "Math/SIMD.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+    engine_tests [filter]
+
+    Runs every case whose "Group/Name" contains filter and prints the failed
+    checks. Exits with 1 when any check failed, for ctest.
+*/
+
+namespace Canaan
+{
+    static size_t s_failures = 0;
+
+    std::vector<TestCase>& GetTestCases()
+    {
+        static std::vector<TestCase> s_cases;
+        return s_cases;
+    }
+
+    void ReportTestFailure(const char *file, int line, const char *expr)
+    {
+        printf("  %s:%d: check failed: %s\n", file, line, expr);
+        ++s_failures;
+    }
+
+    void ReportTestFailure(const char *file, int line, const char *expr, double lhs, double rhs)
+    {
+        printf("  %s:%d: check failed: %s (%.9g vs %.9g)\n", file, line, expr, lhs, rhs);
+        ++s_failures;
+    }
+}
+
+using namespace Canaan;
+
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : nullptr;
+
+    printf("backend: %s\n", SimdBackendName());
+    size_t failedCases = 0, runCases = 0;
+    for (auto &tc : GetTestCases())
+    {
+        std::string fullName = tc.group + "/" + tc.name;
+        if (filter && strstr(fullName.c_str(), filter) == nullptr)
+            continue;
+
+        size_t failures = s_failures;
+        tc.func();
+        ++runCases;
+        if (s_failures != failures)
+            ++failedCases;
+        printf("%-48s %s\n", fullName.c_str(), s_failures == failures ? "ok" : "FAILED");
+        fflush(stdout);
+    }
+    printf("%zu of %zu cases failed\n", failedCases, runCases);
+    return failedCases ? 1 : 0;
+}